@@ -5,20 +5,41 @@
 // Read the zecale config, include the appropriate pairing selector and define
 // the corresponding pairing parameters type.
 
+#include "aggregator_server/async_call.hpp"
+#include "libzecale/core/admission_controller.hpp"
+#include "libzecale/core/aggregation_snapshot.hpp"
 #include "libzecale/core/aggregator_circuit_wrapper.hpp"
 #include "libzecale/core/application_pool.hpp"
+#include "libzecale/core/logger.hpp"
+#include "libzecale/core/metrics.hpp"
+#include "libzecale/core/metrics_exporter.hpp"
+#include "libzecale/core/mixed_batch.hpp"
+#include "libzecale/core/multi_application_aggregator_circuit_wrapper.hpp"
+#include "libzecale/core/pool_snapshot.hpp"
+#include "libzecale/core/proof_store.hpp"
+#include "libzecale/core/proof_subgroup_check.hpp"
+#include "libzecale/core/prover_scheduler.hpp"
+#include "libzecale/core/server_config.hpp"
 #include "libzecale/serialization/proto_utils.hpp"
 #include "zecale_config.h"
 
+#include <algorithm>
 #include <api/aggregator.grpc.pb.h>
+#include <atomic>
+#include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <grpc/grpc.h>
 #include <grpcpp/security/server_credentials.h>
 #include <grpcpp/server.h>
 #include <grpcpp/server_builder.h>
 #include <grpcpp/server_context.h>
 #include <iostream>
+#include <libff/common/profiling.hpp>
 #include <libsnark/common/data_structures/merkle_tree.hpp>
 #include <libzeth/circuits/circuit_types.hpp>
 #include <libzeth/core/utils.hpp>
@@ -27,12 +48,21 @@
 #include <libzeth/zeth_constants.hpp>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <signal.h>
 #include <stdio.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace proto = google::protobuf;
 namespace po = boost::program_options;
 
+using libzecale::log_fields;
+using libzecale::log_level;
+using libzecale::log_stream;
+
 // Set the wrapper curve type (wpp) based on the build configuration.
 #if defined(ZECALE_CURVE_MNT6)
 #include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
@@ -70,9 +100,51 @@ using wsnark = typename wverifier::snark;
 
 static const size_t batch_size = 1;
 
-/// The aggregator_server class inherits from the Aggregator service defined in
-/// the proto files, and provides an implementation of the service.
-class aggregator_server final : public zecale_proto::Aggregator::Service
+// Number of proofs, and max number of distinct applications, in a
+// multi-application batch.
+static const size_t multi_app_batch_size = 2;
+static const size_t multi_app_num_vks = 2;
+
+using processed_nested_vk = libzecale::processed_nested_verification_key<wpp>;
+
+// Fingerprint of an aggregator verification key, recorded with the stored
+// proofs (see `libzecale::proof_store`)
+static std::string vk_fingerprint(const wsnark::verification_key &vk)
+{
+    zeth_proto::VerificationKey vk_proto;
+    wapi_handler::verification_key_to_proto(vk, &vk_proto);
+    return libzecale::verification_key_fingerprint(
+        vk_proto.SerializeAsString());
+}
+
+// Completes a gRPC call with the given status (see `async_unary_call`)
+using finish_function = std::function<void(const grpc::Status &)>;
+
+using snapshot = libzecale::aggregation_snapshot<npp, nsnark, batch_size>;
+
+using pool_snapshot = libzecale::pool_snapshot<npp, nsnark>;
+
+// Time given to gRPC, once the proofs have been drained, to send the
+// remaining responses before the calls are cancelled.
+static const std::chrono::seconds shutdown_grace_period(5);
+
+// Key of the trailing metadata holding the serialized `ProveTimings` of the
+// proof returned by GenerateAggregateProof (binary, hence the suffix).
+static const char prove_timings_metadata_key[] = "zecale-prove-timings-bin";
+
+using multi_app_aggregator_wrapper =
+    libzecale::multi_application_aggregator_circuit_wrapper<
+        npp,
+        wpp,
+        nsnark,
+        wverifier,
+        multi_app_batch_size,
+        multi_app_num_vks>;
+
+/// The aggregator_server class implements the handlers of the Aggregator
+/// service defined in the proto files. The handlers are called from the
+/// threads polling the gRPC completion queues (see `RunServer`).
+class aggregator_server final
 {
 private:
     libzecale::
@@ -81,39 +153,419 @@ private:
 
     // The keypair is the result of the setup for the aggregation circuit
     wsnark::keypair keypair;
+    // Fingerprints of the verification keys of the proofs (see
+    // `store_proof`)
+    const std::string single_app_vk_fingerprint;
+    const std::string multi_app_vk_fingerprint;
+
+    // Scheduler running the calls to `prove()`, possibly concurrently
+    libzecale::prover_scheduler &scheduler;
+
+    // Metrics recorded by the handlers (thread-safe)
+    libzecale::aggregator_metrics &metrics;
+
+    // Server settings (for the ingest backpressure policy)
+    const libzecale::server_config config;
+
+    // Admission control of the submitted transactions, based on the
+    // measured proving time (thread-safe)
+    libzecale::admission_controller admission;
+
+    // Completed aggregate proofs, which can be fetched again (thread-safe)
+    libzecale::proof_store &proofs;
+
+    // Identifiers of the received transactions and of the proving jobs,
+    // attached to the log records
+    std::atomic<uint64_t> next_tx_id;
+    std::atomic<uint64_t> next_job_id;
+
+    // Set on shutdown: no transaction, application or proof request is
+    // accepted any more, and queued proving jobs are not started.
+    std::atomic<bool> draining;
+    // Set if the running proofs have not completed in time on shutdown.
+    // Their calls are then cancelled, and their transactions are kept for
+    // the pool snapshot.
+    std::atomic<bool> abandoned;
+
+    // Protects `pools_map`, `processed_vks_map` and `in_flight_txs`, which
+    // are accessed from the concurrent gRPC handlers
+    std::mutex pools_mutex;
 
     // The nested verification key is the vk used to verify the nested proofs
     std::map<std::string, libzecale::application_pool<npp, nsnark, batch_size>>
         pools_map;
 
+    // The nested verification keys, processed once at registration (VK bits
+    // and digest), for each application
+    std::map<std::string, std::shared_ptr<const processed_nested_vk>>
+        processed_vks_map;
+
+    // Transactions taken from the pools, for each proving job which has not
+    // completed. They are written back to the pool snapshot if the server
+    // shuts down before the proof is generated.
+    std::map<
+        uint64_t,
+        std::vector<libzecale::transaction_to_aggregate<npp, nsnark>>>
+        in_flight_txs;
+
+    // Multi-application aggregation circuit and its keypair (null if
+    // multi-application aggregation is disabled)
+    multi_app_aggregator_wrapper multi_app_aggregator;
+    std::shared_ptr<wsnark::keypair> multi_app_keypair;
+
+    // Directory in which the inputs of each aggregation are written, to be
+    // replayed with `aggregator_replay` (empty if snapshots are disabled)
+    boost::filesystem::path snapshot_dir;
+    libzecale::circuit_fingerprint fingerprint;
+
+    // Write the inputs of a batch to the snapshot directory. The file is
+    // named after the job and the current time (in milliseconds since the
+    // epoch), so that the snapshots of previous runs of the server, whose
+    // job identifiers may overlap, are not overwritten. A snapshot is only a
+    // diagnostic: failing to write it does not fail the batch.
+    void write_snapshot(
+        const log_fields &fields,
+        const typename nsnark::verification_key &nested_vk,
+        const std::array<
+            const libzeth::extended_proof<npp, nsnark> *,
+            batch_size> &extended_proofs)
+    {
+        const int64_t time_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        const boost::filesystem::path snapshot_file =
+            this->snapshot_dir /
+            ("batch_" + std::to_string(fields.job_id) + "_" +
+             std::to_string(time_ms) + ".snapshot");
+        log_stream(log_level::debug, fields)
+            << "Writing snapshot: " << snapshot_file;
+        try {
+            std::ofstream out(
+                snapshot_file.c_str(),
+                std::ios_base::out | std::ios_base::binary);
+            out.exceptions(
+                std::ios_base::eofbit | std::ios_base::badbit |
+                std::ios_base::failbit);
+            snapshot::write(out, this->fingerprint, nested_vk, extended_proofs);
+        } catch (const std::exception &e) {
+            log_stream(log_level::warning, fields)
+                << "Failed to write the snapshot " << snapshot_file << ": "
+                << e.what();
+        }
+    }
+
+    // Record the timings of a proof in the metrics and in the log
+    void observe_prove(
+        const log_fields &fields,
+        size_t batch_capacity,
+        const libzecale::prove_timings &timings)
+    {
+        this->metrics.observe_witness_generation(timings.witness_seconds());
+        this->metrics.observe_proof_generation(timings.proof_seconds());
+        this->metrics.observe_prove_phases(timings);
+        this->admission.on_batch_proved(
+            batch_capacity,
+            timings.witness_seconds() + timings.proof_seconds());
+
+        log_stream(log_level::info, fields)
+            << "Proof generated (witness: " << timings.witness_seconds()
+            << "s, proof: " << timings.proof_seconds() << "s)";
+        log_stream phases_log(log_level::debug, fields);
+        if (!phases_log.enabled()) {
+            return;
+        }
+        phases_log << "Proof timings (wall/cpu):";
+        for (const auto &name_timing : timings.phases()) {
+            phases_log << " " << name_timing.first << ": "
+                       << name_timing.second.wall_seconds << "s/"
+                       << name_timing.second.cpu_seconds << "s";
+        }
+        phases_log << ", peak rss: " << timings.peak_rss_bytes
+                   << " bytes, constraints: " << timings.num_constraints
+                   << ", variables: " << timings.num_variables;
+    }
+
+    // RESOURCE_EXHAUSTED status for a transaction which was not admitted.
+    // The details of the status hold the `AdmissionRejection`.
+    static grpc::Status rejection_status(
+        const std::string &reason, const libzecale::admission_result &result)
+    {
+        zecale_proto::AdmissionRejection rejection;
+        rejection.set_reason(reason);
+        rejection.set_time_to_proof_seconds(result.time_to_proof_seconds);
+        rejection.set_retry_after_seconds(result.retry_after_seconds);
+        rejection.set_min_fee_in_wei(result.min_fee_wei);
+
+        std::string message = reason;
+        if (result.min_fee_wei != 0) {
+            message +=
+                ", minimum fee: " + std::to_string(result.min_fee_wei) + " wei";
+        }
+        if (result.retry_after_seconds != 0.0) {
+            message += ", retry after " +
+                       std::to_string((uint64_t)std::ceil(
+                           result.retry_after_seconds)) +
+                       "s";
+        }
+        return grpc::Status(
+            grpc::StatusCode::RESOURCE_EXHAUSTED,
+            message,
+            rejection.SerializeAsString());
+    }
+
+    // Forget the transactions of a job (see `in_flight_txs`)
+    void release_in_flight_txs(uint64_t job_id)
+    {
+        std::lock_guard<std::mutex> lock(this->pools_mutex);
+        this->in_flight_txs.erase(job_id);
+    }
+
+    static grpc::Status shutting_down_status()
+    {
+        return grpc::Status(
+            grpc::StatusCode::UNAVAILABLE, "server shutting down");
+    }
+
+    // Keep the proof of a batch (the batch identifier is the job
+    // identifier), so that it can be fetched again. The proof has been
+    // generated: failing to store it does not fail the call.
+    void store_proof(
+        const log_fields &fields,
+        std::vector<std::string> &&application_names,
+        std::vector<uint64_t> &&tx_ids,
+        const zeth_proto::ExtendedProof &proof,
+        const libzecale::prove_timings &timings,
+        const std::string &vk_fingerprint)
+    {
+        libzecale::stored_proof stored;
+        stored.batch_id = fields.job_id;
+        stored.application_names = std::move(application_names);
+        stored.tx_ids = std::move(tx_ids);
+        stored.proof = proof.SerializeAsString();
+        zecale_proto::ProveTimings timings_proto;
+        libzecale::prove_timings_to_proto(timings, &timings_proto);
+        stored.timings = timings_proto.SerializeAsString();
+        stored.vk_fingerprint = vk_fingerprint;
+        try {
+            this->proofs.put(stored);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error, fields)
+                << "Failed to store the proof: " << e.what();
+        }
+    }
+
+    static grpc::Status stored_proof_to_proto(
+        const std::shared_ptr<const libzecale::stored_proof> &stored,
+        zecale_proto::StoredAggregateProof *response)
+    {
+        if (!stored) {
+            return grpc::Status(
+                grpc::StatusCode::NOT_FOUND, "proof not found");
+        }
+        response->set_batch_id(stored->batch_id);
+        for (const std::string &name : stored->application_names) {
+            response->add_application_names(name);
+        }
+        for (const uint64_t tx_id : stored->tx_ids) {
+            response->add_transaction_ids(tx_id);
+        }
+        if (!response->mutable_extended_proof()->ParseFromString(
+                stored->proof)) {
+            return grpc::Status(
+                grpc::StatusCode::INTERNAL, "invalid stored proof");
+        }
+        if (!stored->timings.empty() &&
+            !response->mutable_timings()->ParseFromString(stored->timings)) {
+            return grpc::Status(
+                grpc::StatusCode::INTERNAL, "invalid stored proof timings");
+        }
+        return grpc::Status::OK;
+    }
+
+    // Run `job` on the prover workers, and then complete the call with the
+    // status of the job (an error if it throws). The gRPC polling threads
+    // are therefore never blocked while a proof is generated. The
+    // transactions of the job (see `in_flight_txs`) are released once it
+    // has run. If the server shuts down before the job is started, it is
+    // not run, and its transactions are kept for the pool snapshot.
+    void submit_prove_job(
+        const log_fields &fields,
+        const std::function<void()> &job,
+        const finish_function &finish)
+    {
+        this->scheduler.submit<void>([this, fields, job, finish]() {
+            if (this->draining) {
+                log_stream(log_level::info, fields)
+                    << "Shutting down, proof not generated";
+                finish(shutting_down_status());
+                return;
+            }
+
+            grpc::Status status = grpc::Status::OK;
+            try {
+                job();
+            } catch (const std::exception &e) {
+                log_stream(log_level::error, fields) << e.what();
+                status = grpc::Status(
+                    grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what()));
+            } catch (...) {
+                log_stream(log_level::error, fields) << "In catch all";
+                status = grpc::Status(grpc::StatusCode::UNKNOWN, "");
+            }
+            if (this->abandoned) {
+                return;
+            }
+            this->release_in_flight_txs(fields.job_id);
+            finish(status);
+        });
+    }
+
 public:
     explicit aggregator_server(
         libzecale::
             aggregator_circuit_wrapper<npp, wpp, nsnark, wverifier, batch_size>
                 &aggregator,
-        const wsnark::keypair &keypair)
-        : aggregator(aggregator), keypair(keypair)
+        const wsnark::keypair &keypair,
+        std::shared_ptr<wsnark::keypair> multi_app_keypair,
+        libzecale::prover_scheduler &scheduler,
+        libzecale::aggregator_metrics &metrics,
+        libzecale::proof_store &proofs,
+        const libzecale::server_config &config,
+        const boost::filesystem::path &snapshot_dir)
+        : aggregator(aggregator)
+        , keypair(keypair)
+        , single_app_vk_fingerprint(vk_fingerprint(keypair.vk))
+        , multi_app_vk_fingerprint(
+              multi_app_keypair ? vk_fingerprint(multi_app_keypair->vk) : "")
+        , scheduler(scheduler)
+        , metrics(metrics)
+        , config(config)
+        , admission(
+              config, batch_size, scheduler.partition().num_workers())
+        , proofs(proofs)
+        // Identifiers of the stored proofs are not reused
+        , next_tx_id(proofs.max_tx_id() + 1)
+        , next_job_id(proofs.max_batch_id() + 1)
+        , draining(false)
+        , abandoned(false)
+        , multi_app_keypair(multi_app_keypair)
+        , snapshot_dir(snapshot_dir)
     {
-        // Nothing
+        // The witness of both circuits is checked on the threads of the
+        // prover worker generating the proof
+        std::shared_ptr<libzecale::satisfiability_check_policy> check_policy =
+            std::make_shared<libzecale::satisfiability_check_policy>(
+                config.satisfiability_check,
+                config.satisfiability_check_interval,
+                scheduler.partition().threads_per_worker());
+        this->aggregator.set_satisfiability_check_policy(check_policy);
+        this->multi_app_aggregator.set_satisfiability_check_policy(
+            check_policy);
+
+        if (!this->snapshot_dir.empty()) {
+            boost::filesystem::create_directories(this->snapshot_dir);
+            this->fingerprint = libzecale::circuit_fingerprint::
+                from_constraint_system<npp, wpp>(
+                    aggregator.get_constraint_system(), batch_size);
+        }
+    }
+
+    /// Register the applications of a pool snapshot, and add their
+    /// transactions to the pools. Called before the server starts.
+    void restore_pools(pool_snapshot &&pools)
+    {
+        std::lock_guard<std::mutex> lock(this->pools_mutex);
+        uint64_t max_tx_id = 0;
+        for (pool_snapshot::application &app : pools.applications) {
+            this->processed_vks_map[app.name] =
+                std::make_shared<processed_nested_vk>(
+                    this->aggregator.process_nested_verification_key(
+                        app.nested_vk));
+            libzecale::application_pool<npp, nsnark, batch_size> pool(
+                app.name, app.nested_vk);
+            pool.reserve(app.transactions.size());
+            for (libzecale::transaction_to_aggregate<npp, nsnark> &tx :
+                 app.transactions) {
+                max_tx_id = std::max(max_tx_id, tx.id());
+                pool.add_tx(std::move(tx));
+            }
+            this->metrics.set_pool_size(app.name, pool.tx_pool_size());
+            this->pools_map[app.name] = std::move(pool);
+        }
+        // Identifiers remain unique across restarts
+        this->next_tx_id = std::max<uint64_t>(this->next_tx_id, max_tx_id + 1);
+    }
+
+    /// The registered applications, with their pending transactions and the
+    /// transactions of the proofs in progress.
+    pool_snapshot snapshot_pools()
+    {
+        std::lock_guard<std::mutex> lock(this->pools_mutex);
+        pool_snapshot pools;
+        std::map<std::string, size_t> app_indices;
+        for (const auto &name_pool : this->pools_map) {
+            // Only the applications which have been registered can be
+            // restored
+            if (this->processed_vks_map.count(name_pool.first) == 0) {
+                continue;
+            }
+            app_indices[name_pool.first] = pools.applications.size();
+            pools.applications.emplace_back();
+            pool_snapshot::application &app = pools.applications.back();
+            app.name = name_pool.first;
+            app.nested_vk = name_pool.second.verification_key();
+            app.transactions = name_pool.second.transactions();
+        }
+        for (const auto &job_txs : this->in_flight_txs) {
+            for (const libzecale::transaction_to_aggregate<npp, nsnark> &tx :
+                 job_txs.second) {
+                // The transaction of an application which is not in the
+                // snapshot cannot be restored, but the other ones must not
+                // be lost because of it
+                const auto app_index_it =
+                    app_indices.find(tx.application_name());
+                if (app_index_it == app_indices.end()) {
+                    const log_fields fields(
+                        tx.application_name(), tx.id(), job_txs.first);
+                    log_stream(log_level::warning, fields)
+                        << "Unknown application, transaction not snapshotted";
+                    continue;
+                }
+                pools.applications[app_index_it->second]
+                    .transactions.push_back(tx);
+            }
+        }
+        return pools;
+    }
+
+    /// Stop accepting new transactions and proof requests, and wait (for at
+    /// most `config.drain_timeout_seconds`) for the running proofs to
+    /// complete. Queued proofs are not started. Returns false on timeout, in
+    /// which case the running proofs are abandoned.
+    bool drain()
+    {
+        this->draining = true;
+        if (this->scheduler.wait_idle(this->config.drain_timeout_seconds)) {
+            return true;
+        }
+        this->abandoned = true;
+        return false;
     }
 
     grpc::Status GetVerificationKey(
-        grpc::ServerContext * /*context*/,
-        const proto::Empty * /*request*/,
-        zeth_proto::VerificationKey *response) override
+        const proto::Empty * /*request*/, zeth_proto::VerificationKey *response)
     {
-        std::cout << "[ACK] Received the request to get the verification key"
-                  << std::endl;
-        std::cout << "[DEBUG] Preparing verification key for response..."
-                  << std::endl;
+        log_stream(log_level::info)
+            << "Received the request to get the verification key";
         try {
             wapi_handler::verification_key_to_proto(this->keypair.vk, response);
         } catch (const std::exception &e) {
-            std::cout << "[ERROR] " << e.what() << std::endl;
+            log_stream(log_level::error) << e.what();
             return grpc::Status(
                 grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what()));
         } catch (...) {
-            std::cout << "[ERROR] In catch all" << std::endl;
+            log_stream(log_level::error) << "In catch all";
             return grpc::Status(grpc::StatusCode::UNKNOWN, "");
         }
 
@@ -121,110 +573,498 @@ public:
     }
 
     grpc::Status RegisterApplication(
-        grpc::ServerContext * /*context*/,
         const zecale_proto::ApplicationRegistration *registration,
-        proto::Empty * /*response*/) override
+        proto::Empty * /*response*/)
     {
-        std::cout << "[ACK] Received 'register application' request"
-                  << std::endl;
-        std::cout << "[DEBUG] Registering application..." << std::endl;
+        const log_fields fields(registration->name());
+        log_stream(log_level::info, fields)
+            << "Received 'register application' request";
+        if (this->draining) {
+            return shutting_down_status();
+        }
         try {
             // Add the application to the list of supported applications on the
             // aggregator server.
             typename nsnark::verification_key registered_vk =
-                napi_handler::verification_key_from_proto(registration->vk());
-            libzecale::application_pool<npp, nsnark, batch_size> app_pool(
-                registration->name(), registered_vk);
-            this->pools_map[registration->name()] = app_pool;
+                libzecale::verification_key_from_registration<napi_handler>(
+                    *registration);
+            std::shared_ptr<const processed_nested_vk> processed_vk =
+                std::make_shared<processed_nested_vk>(
+                    this->aggregator.process_nested_verification_key(
+                        registered_vk));
+            log_stream(log_level::debug, fields)
+                << "VK hash: " << processed_vk->hash;
+
+            std::lock_guard<std::mutex> lock(this->pools_mutex);
+            this->processed_vks_map[registration->name()] = processed_vk;
+            this->pools_map[registration->name()] =
+                libzecale::application_pool<npp, nsnark, batch_size>(
+                    registration->name(), registered_vk);
         } catch (const std::exception &e) {
-            std::cout << "[ERROR] " << e.what() << std::endl;
+            log_stream(log_level::error, fields) << e.what();
             return grpc::Status(
                 grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what()));
         } catch (...) {
-            std::cout << "[ERROR] In catch all" << std::endl;
+            log_stream(log_level::error, fields) << "In catch all";
             return grpc::Status(grpc::StatusCode::UNKNOWN, "");
         }
 
         return grpc::Status::OK;
     }
 
-    grpc::Status GenerateAggregateProof(
-        grpc::ServerContext * /*context*/,
+    /// Pop a batch from the pool of the application, and queue its
+    /// aggregation on the prover workers. `finish` is called from the worker
+    /// once `proof` holds the aggregate proof. The `ProveTimings` of the
+    /// proof are sent in the trailing metadata of the call (see
+    /// `prove_timings_metadata_key`), since the response is a bare
+    /// `ExtendedProof`.
+    void GenerateAggregateProof(
+        grpc::ServerContext *context,
         const zecale_proto::ApplicationName *app_name,
-        zeth_proto::ExtendedProof *proof) override
+        zeth_proto::ExtendedProof *proof,
+        const finish_function &finish)
     {
-        std::cout
-            << "[ACK] Received the request to generate an aggregation proof"
-            << std::endl;
+        const log_fields fields(app_name->name(), 0, this->next_job_id++);
+        log_stream(log_level::info, fields)
+            << "Received the request to generate an aggregation proof";
+        if (this->draining) {
+            finish(shutting_down_status());
+            return;
+        }
+
+        // The batch is held by the proving job, until the proof is generated
+        using batch_type = std::array<
+            libzecale::transaction_to_aggregate<npp, nsnark>,
+            batch_size>;
+        std::shared_ptr<batch_type> batch = std::make_shared<batch_type>();
+        std::shared_ptr<const processed_nested_vk> nested_vk;
+        std::array<const libzeth::extended_proof<npp, nsnark> *, batch_size>
+            extended_proofs{nullptr};
+        // Number of transactions taken from the pool (the remaining entries
+        // of the batch are default-constructed)
+        size_t num_txs = 0;
         try {
-            std::cout << "[DEBUG] Pop batch from the pool..." << std::endl;
-            // Select the application pool corresponding to the request
-            libzecale::application_pool<npp, nsnark, batch_size> app_pool =
-                this->pools_map[app_name->name()];
-            // Retrieve batch from the pool
-            std::array<
-                libzecale::transaction_to_aggregate<npp, nsnark>,
-                batch_size>
-                batch = app_pool.get_next_batch();
-
-            std::cout << "[DEBUG] Parse batch and generate witness..."
-                      << std::endl;
+            std::unique_ptr<typename nsnark::verification_key> raw_nested_vk;
+            {
+                std::lock_guard<std::mutex> lock(this->pools_mutex);
+                // Retrieve the (processed) application verification key for
+                // the proof aggregation
+                nested_vk = this->processed_vks_map.at(app_name->name());
+                // Retrieve batch from the pool corresponding to the request
+                // (the transactions are moved out of the pool)
+                libzecale::application_pool<npp, nsnark, batch_size> &pool =
+                    this->pools_map.at(app_name->name());
+                num_txs = std::min(pool.tx_pool_size(), batch_size);
+                *batch = pool.get_next_batch();
+                this->in_flight_txs[fields.job_id].assign(
+                    batch->begin(), batch->begin() + num_txs);
+                this->metrics.set_pool_size(
+                    app_name->name(), pool.tx_pool_size());
+                if (!this->snapshot_dir.empty()) {
+                    raw_nested_vk.reset(new typename nsnark::verification_key(
+                        pool.verification_key()));
+                }
+            }
+            this->metrics.on_batch(app_name->name(), num_txs, batch_size);
+            {
+                log_stream batch_log(log_level::debug, fields);
+                batch_log << "Popped " << num_txs << " transaction(s):";
+                for (size_t i = 0; i < num_txs; i++) {
+                    batch_log << " " << (*batch)[i].id();
+                }
+            }
+
             // Get batch of proofs to aggregate
-            std::array<const libzeth::extended_proof<npp, nsnark> *, batch_size>
-                extended_proofs{nullptr};
-            for (size_t i = 0; i < batch.size(); i++) {
-                extended_proofs[i] = &(batch[i].extended_proof());
+            for (size_t i = 0; i < batch->size(); i++) {
+                extended_proofs[i] = &((*batch)[i].extended_proof());
             }
 
-            // Retrieve the application verification key for the proof
-            // aggregation
-            nsnark::verification_key nested_vk = app_pool.verification_key();
+            if (raw_nested_vk) {
+                this->write_snapshot(fields, *raw_nested_vk, extended_proofs);
+            }
+        } catch (const std::exception &e) {
+            log_stream(log_level::error, fields) << e.what();
+            this->release_in_flight_txs(fields.job_id);
+            finish(grpc::Status(
+                grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what())));
+            return;
+        } catch (...) {
+            log_stream(log_level::error, fields) << "In catch all";
+            this->release_in_flight_txs(fields.job_id);
+            finish(grpc::Status(grpc::StatusCode::UNKNOWN, ""));
+            return;
+        }
 
-            std::cout << "[DEBUG] Generating the proof..." << std::endl;
-            libzeth::extended_proof<wpp, wsnark> wrapping_proof =
-                this->aggregator.prove(
-                    nested_vk, extended_proofs, this->keypair.pk);
+        log_stream(log_level::debug, fields) << "Generating the proof...";
+        this->submit_prove_job(
+            fields,
+            [=]() {
+                libzecale::prove_timings timings;
+                libzeth::extended_proof<wpp, wsnark> wrapping_proof =
+                    this->aggregator.prove(
+                        *nested_vk,
+                        extended_proofs,
+                        this->keypair.pk,
+                        &timings);
+                this->observe_prove(fields, batch_size, timings);
+                for (size_t i = 0; i < num_txs; i++) {
+                    this->metrics.observe_end_to_end(
+                        libzecale::seconds_since((*batch)[i].received_time()));
+                }
 
-            std::cout << "[DEBUG] Displaying the extended proof" << std::endl;
-            wrapping_proof.write_json(std::cout);
+                {
+                    // Only serialise the proof if it is actually logged
+                    log_stream proof_log(log_level::debug, fields);
+                    if (proof_log.enabled()) {
+                        proof_log << "Extended proof:\n";
+                        wrapping_proof.write_json(proof_log.stream());
+                    }
+                }
 
-            std::cout << "[DEBUG] Preparing response..." << std::endl;
-            wapi_handler::extended_proof_to_proto(wrapping_proof, proof);
+                wapi_handler::extended_proof_to_proto(wrapping_proof, proof);
+                zecale_proto::ProveTimings timings_proto;
+                libzecale::prove_timings_to_proto(timings, &timings_proto);
+                context->AddTrailingMetadata(
+                    prove_timings_metadata_key,
+                    timings_proto.SerializeAsString());
+
+                std::vector<uint64_t> tx_ids;
+                for (size_t i = 0; i < num_txs; i++) {
+                    tx_ids.push_back((*batch)[i].id());
+                }
+                this->store_proof(
+                    fields,
+                    {app_name->name()},
+                    std::move(tx_ids),
+                    *proof,
+                    timings,
+                    this->single_app_vk_fingerprint);
+            },
+            finish);
+    }
+
+    grpc::Status GetMultiApplicationVerificationKey(
+        const proto::Empty * /*request*/, zeth_proto::VerificationKey *response)
+    {
+        log_stream(log_level::info) << "Received the request to get the "
+                                       "multi-application verification key";
+        if (!this->multi_app_keypair) {
+            return grpc::Status(
+                grpc::StatusCode::FAILED_PRECONDITION,
+                "multi-application aggregation disabled");
+        }
+
+        try {
+            wapi_handler::verification_key_to_proto(
+                this->multi_app_keypair->vk, response);
         } catch (const std::exception &e) {
-            std::cout << "[ERROR] " << e.what() << std::endl;
+            log_stream(log_level::error) << e.what();
             return grpc::Status(
                 grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what()));
         } catch (...) {
-            std::cout << "[ERROR] In catch all" << std::endl;
+            log_stream(log_level::error) << "In catch all";
             return grpc::Status(grpc::StatusCode::UNKNOWN, "");
         }
 
         return grpc::Status::OK;
     }
 
-    grpc::Status SubmitTransaction(
+    /// Pop a mixed batch from the pools, and queue its aggregation on the
+    /// prover workers (see `GenerateAggregateProof`).
+    void GenerateMultiApplicationAggregateProof(
         grpc::ServerContext * /*context*/,
+        const proto::Empty * /*request*/,
+        zecale_proto::MultiApplicationAggregateProof *response,
+        const finish_function &finish)
+    {
+        const log_fields fields("", 0, this->next_job_id++);
+        log_stream(log_level::info, fields)
+            << "Received the request to generate a multi-application "
+               "aggregation proof";
+        if (!this->multi_app_keypair) {
+            finish(grpc::Status(
+                grpc::StatusCode::FAILED_PRECONDITION,
+                "multi-application aggregation disabled"));
+            return;
+        }
+        if (this->draining) {
+            finish(shutting_down_status());
+            return;
+        }
+
+        using batch_type = libzecale::
+            mixed_batch<npp, nsnark, multi_app_batch_size, multi_app_num_vks>;
+        std::shared_ptr<batch_type> batch = std::make_shared<batch_type>();
+        try {
+            {
+                std::lock_guard<std::mutex> lock(this->pools_mutex);
+                std::vector<
+                    libzecale::application_pool<npp, nsnark, batch_size> *>
+                    pools;
+                size_t num_pending_txs = 0;
+                for (auto &name_pool : this->pools_map) {
+                    pools.push_back(&name_pool.second);
+                    num_pending_txs += name_pool.second.tx_pool_size();
+                }
+                if (num_pending_txs < multi_app_batch_size) {
+                    throw std::invalid_argument(
+                        "not enough pending transactions");
+                }
+                *batch = libzecale::get_next_mixed_batch<
+                    npp,
+                    nsnark,
+                    batch_size,
+                    multi_app_batch_size,
+                    multi_app_num_vks>(pools);
+                // The transactions are left in the pools if they cannot
+                // fill a batch (e.g. too many distinct applications)
+                if (batch->num_txs() == 0) {
+                    throw std::invalid_argument(
+                        "not enough pending transactions");
+                }
+                std::vector<libzecale::transaction_to_aggregate<npp, nsnark>>
+                    &txs = this->in_flight_txs[fields.job_id];
+                for (size_t i = 0; i < batch->num_txs(); i++) {
+                    txs.push_back(batch->tx(i));
+                }
+                for (auto &name_pool : this->pools_map) {
+                    this->metrics.set_pool_size(
+                        name_pool.first, name_pool.second.tx_pool_size());
+                }
+            }
+
+            // Mixed batches are always full. Each application is accounted
+            // for the slots filled by its transactions.
+            std::map<std::string, size_t> num_txs_per_application;
+            for (size_t i = 0; i < batch->num_txs(); i++) {
+                ++num_txs_per_application[batch->tx(i).application_name()];
+            }
+            for (const auto &name_num_txs : num_txs_per_application) {
+                this->metrics.on_batch(
+                    name_num_txs.first,
+                    name_num_txs.second,
+                    name_num_txs.second);
+            }
+            {
+                log_stream batch_log(log_level::debug, fields);
+                batch_log << "Popped " << batch->num_txs()
+                          << " transaction(s):";
+                for (size_t i = 0; i < batch->num_txs(); i++) {
+                    batch_log << " " << batch->tx(i).application_name()
+                              << "/" << batch->tx(i).id();
+                }
+            }
+        } catch (const std::exception &e) {
+            log_stream(log_level::error, fields) << e.what();
+            this->release_in_flight_txs(fields.job_id);
+            finish(grpc::Status(
+                grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what())));
+            return;
+        } catch (...) {
+            log_stream(log_level::error, fields) << "In catch all";
+            this->release_in_flight_txs(fields.job_id);
+            finish(grpc::Status(grpc::StatusCode::UNKNOWN, ""));
+            return;
+        }
+
+        log_stream(log_level::debug, fields) << "Generating the proof...";
+        this->submit_prove_job(
+            fields,
+            [=]() {
+                libzecale::prove_timings timings;
+                libzeth::extended_proof<wpp, wsnark> wrapping_proof =
+                    this->multi_app_aggregator.prove(
+                        *batch, this->multi_app_keypair->pk, &timings);
+                this->observe_prove(fields, multi_app_batch_size, timings);
+                for (size_t i = 0; i < batch->num_txs(); i++) {
+                    this->metrics.observe_end_to_end(libzecale::seconds_since(
+                        batch->tx(i).received_time()));
+                }
+
+                std::vector<std::string> application_names;
+                for (size_t k = 0; k < batch->num_applications(); k++) {
+                    response->add_application_names(
+                        batch->application_name(k));
+                    application_names.push_back(batch->application_name(k));
+                }
+                response->set_batch_id(fields.job_id);
+                wapi_handler::extended_proof_to_proto(
+                    wrapping_proof, response->mutable_extended_proof());
+                libzecale::prove_timings_to_proto(
+                    timings, response->mutable_timings());
+
+                std::vector<uint64_t> tx_ids;
+                for (size_t i = 0; i < batch->num_txs(); i++) {
+                    tx_ids.push_back(batch->tx(i).id());
+                }
+                this->store_proof(
+                    fields,
+                    std::move(application_names),
+                    std::move(tx_ids),
+                    response->extended_proof(),
+                    timings,
+                    this->multi_app_vk_fingerprint);
+            },
+            finish);
+    }
+
+    grpc::Status SubmitTransaction(
         const zecale_proto::TransactionToAggregate *transaction,
-        proto::Empty * /*response*/) override
+        zecale_proto::SubmittedTransaction *response)
     {
-        std::cout << "[ACK] Received the request to submit transaction"
-                  << std::endl;
-        std::cout << "[DEBUG] Submitting transaction..." << std::endl;
+        const log_fields fields(
+            transaction->application_name(), this->next_tx_id++);
+        if (this->draining) {
+            return shutting_down_status();
+        }
         try {
-            // Add the application to the list of applications supported by the
-            // server.
+            // Parse the transaction. It is only added to the pool if its
+            // application is registered.
             libzecale::transaction_to_aggregate<npp, nsnark> tx = libzecale::
                 transaction_to_aggregate_from_proto<npp, napi_handler>(
                     *transaction);
-            libzecale::application_pool<npp, nsnark, batch_size> app_pool =
-                this->pools_map[transaction->application_name()];
-            app_pool.add_tx(tx);
+            // A point outside of G1 or G2 would make the whole batch
+            // unsatisfiable: the transaction is rejected now instead.
+            libzecale::check_proof_points(tx.extended_proof().get_proof());
+            tx.set_id(fields.tx_id);
+            size_t pool_size;
+            libzecale::admission_result admission_result;
+            libzecale::ingest_decision decision =
+                libzecale::ingest_decision::reject;
+            uint64_t evicted_tx_id = 0;
+            {
+                std::lock_guard<std::mutex> lock(this->pools_mutex);
+                const auto app_pool_it =
+                    this->pools_map.find(transaction->application_name());
+                if (app_pool_it == this->pools_map.end()) {
+                    log_stream(log_level::debug, fields)
+                        << "Transaction rejected (unknown application)";
+                    return grpc::Status(
+                        grpc::StatusCode::NOT_FOUND,
+                        "application not registered: " +
+                            transaction->application_name());
+                }
+                libzecale::application_pool<npp, nsnark, batch_size>
+                    &app_pool = app_pool_it->second;
+                pool_size = app_pool.tx_pool_size();
+
+                // Admission control, based on the backlog of all the pools
+                size_t total_pending = 0;
+                size_t num_active_apps = 1;
+                for (const auto &name_pool : this->pools_map) {
+                    const size_t size = name_pool.second.tx_pool_size();
+                    total_pending += size;
+                    if (size != 0 && &name_pool.second != &app_pool) {
+                        ++num_active_apps;
+                    }
+                }
+                admission_result = this->admission.admit(
+                    pool_size, total_pending, num_active_apps, tx.fee_wei());
+
+                // Apply the backpressure policy if the pool is full (the
+                // lowest fee is only looked up in that case)
+                if (admission_result.decision ==
+                    libzecale::admission_decision::admit) {
+                    uint32_t lowest_fee_wei = 0;
+                    if (this->config.max_pool_size != 0 &&
+                        pool_size >= this->config.max_pool_size) {
+                        lowest_fee_wei = app_pool.lowest_fee_tx()->fee_wei();
+                    }
+                    decision = this->config.decide_ingest(
+                        pool_size, lowest_fee_wei, tx.fee_wei());
+                }
+                if (decision == libzecale::ingest_decision::evict_and_accept) {
+                    evicted_tx_id = app_pool.pop_lowest_fee_tx().id();
+                }
+                if (decision != libzecale::ingest_decision::reject) {
+                    app_pool.add_tx(std::move(tx));
+                    pool_size = app_pool.tx_pool_size();
+                    this->metrics.on_transaction_received(
+                        transaction->application_name());
+                    this->metrics.set_pool_size(
+                        transaction->application_name(), pool_size);
+                }
+            }
+
+            if (admission_result.decision !=
+                libzecale::admission_decision::admit) {
+                const char *reason = libzecale::admission_decision_name(
+                    admission_result.decision);
+                log_stream(log_level::debug, fields)
+                    << "Transaction not admitted (" << reason
+                    << ", time-to-proof: "
+                    << admission_result.time_to_proof_seconds << "s)";
+                return rejection_status(reason, admission_result);
+            }
+            if (decision == libzecale::ingest_decision::reject) {
+                log_stream(log_level::debug, fields)
+                    << "Transaction rejected (pool full)";
+                return rejection_status("pool-full", admission_result);
+            }
+            if (evicted_tx_id != 0) {
+                log_stream(log_level::debug, fields)
+                    << "Evicted transaction " << evicted_tx_id;
+            }
+            log_stream(log_level::debug, fields)
+                << "Transaction submitted (pool size: " << pool_size << ")";
+            response->set_transaction_id(fields.tx_id);
         } catch (const std::exception &e) {
-            std::cout << "[ERROR] " << e.what() << std::endl;
+            log_stream(log_level::error, fields) << e.what();
             return grpc::Status(
                 grpc::StatusCode::INVALID_ARGUMENT, grpc::string(e.what()));
         } catch (...) {
-            std::cout << "[ERROR] In catch all" << std::endl;
+            log_stream(log_level::error, fields) << "In catch all";
+            return grpc::Status(grpc::StatusCode::UNKNOWN, "");
+        }
+
+        return grpc::Status::OK;
+    }
+
+    grpc::Status GetAggregateProofByBatch(
+        const zecale_proto::BatchId *batch_id,
+        zecale_proto::StoredAggregateProof *response)
+    {
+        try {
+            return stored_proof_to_proto(
+                this->proofs.find_batch(batch_id->id()), response);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error) << e.what();
+            return grpc::Status(
+                grpc::StatusCode::INTERNAL, grpc::string(e.what()));
+        } catch (...) {
+            log_stream(log_level::error) << "In catch all";
+            return grpc::Status(grpc::StatusCode::UNKNOWN, "");
+        }
+    }
+
+    grpc::Status GetAggregateProofByTransaction(
+        const zecale_proto::TransactionId *tx_id,
+        zecale_proto::StoredAggregateProof *response)
+    {
+        try {
+            return stored_proof_to_proto(
+                this->proofs.find_transaction(tx_id->id()), response);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error) << e.what();
+            return grpc::Status(
+                grpc::StatusCode::INTERNAL, grpc::string(e.what()));
+        } catch (...) {
+            log_stream(log_level::error) << "In catch all";
+            return grpc::Status(grpc::StatusCode::UNKNOWN, "");
+        }
+    }
+
+    grpc::Status GetMetrics(
+        const proto::Empty * /*request*/, zecale_proto::Metrics *response)
+    {
+        try {
+            libzecale::metrics_to_proto(this->metrics.snapshot(), response);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error) << e.what();
+            return grpc::Status(
+                grpc::StatusCode::INTERNAL, grpc::string(e.what()));
+        } catch (...) {
+            log_stream(log_level::error) << "In catch all";
             return grpc::Status(grpc::StatusCode::UNKNOWN, "");
         }
 
@@ -271,35 +1111,306 @@ void display_server_start_message()
               << std::endl;
 }
 
+template<typename RequestT, typename ResponseT>
+using aggregator_call = async_unary_call<
+    zecale_proto::Aggregator::AsyncService,
+    RequestT,
+    ResponseT>;
+
+/// Serve the calls of a method of the service on `cq`, with a handler of
+/// `server` which completes synchronously.
+template<typename RequestT, typename ResponseT>
+static void serve(
+    zecale_proto::Aggregator::AsyncService &service,
+    grpc::ServerCompletionQueue *cq,
+    typename aggregator_call<RequestT, ResponseT>::request_method request,
+    aggregator_server &server,
+    grpc::Status (aggregator_server::*handler)(const RequestT *, ResponseT *))
+{
+    using call = aggregator_call<RequestT, ResponseT>;
+    call::serve(
+        service,
+        cq,
+        request,
+        std::make_shared<const typename call::handler>(
+            [&server, handler](
+                grpc::ServerContext * /*context*/,
+                const RequestT &req,
+                ResponseT *response,
+                const finish_function &finish) {
+                finish((server.*handler)(&req, response));
+            }));
+}
+
+/// Same as above, for a handler which completes asynchronously (by calling
+/// `finish`).
+template<typename RequestT, typename ResponseT>
+static void serve(
+    zecale_proto::Aggregator::AsyncService &service,
+    grpc::ServerCompletionQueue *cq,
+    typename aggregator_call<RequestT, ResponseT>::request_method request,
+    aggregator_server &server,
+    void (aggregator_server::*handler)(
+        grpc::ServerContext *,
+        const RequestT *,
+        ResponseT *,
+        const finish_function &))
+{
+    using call = aggregator_call<RequestT, ResponseT>;
+    call::serve(
+        service,
+        cq,
+        request,
+        std::make_shared<const typename call::handler>(
+            [&server, handler](
+                grpc::ServerContext *context,
+                const RequestT &req,
+                ResponseT *response,
+                const finish_function &finish) {
+                (server.*handler)(context, &req, response, finish);
+            }));
+}
+
+/// Read the pool snapshot, if any, into `server`. The file is removed once
+/// loaded, so that the transactions are not restored again after a crash
+/// (when they may have been aggregated already).
+static void load_pool_snapshot(
+    aggregator_server &server, const boost::filesystem::path &snapshot_file)
+{
+    if (!boost::filesystem::exists(snapshot_file)) {
+        return;
+    }
+    std::ifstream in(
+        snapshot_file.c_str(), std::ios_base::in | std::ios_base::binary);
+    in.exceptions(std::ios_base::badbit);
+    pool_snapshot pools = pool_snapshot::read(in);
+    in.close();
+    log_stream(log_level::info)
+        << "Restored " << pools.num_transactions() << " transaction(s) of "
+        << pools.applications.size()
+        << " application(s) from: " << snapshot_file;
+    server.restore_pools(std::move(pools));
+    boost::filesystem::remove(snapshot_file);
+}
+
+/// Write the pools of `server` to `snapshot_file`. The snapshot is written to
+/// a temporary file first, so that an interrupted write does not leave a
+/// truncated snapshot.
+static void write_pool_snapshot(
+    aggregator_server &server, const boost::filesystem::path &snapshot_file)
+{
+    const pool_snapshot pools = server.snapshot_pools();
+    boost::filesystem::path tmp_file = snapshot_file;
+    tmp_file += ".tmp";
+    {
+        std::ofstream out(
+            tmp_file.c_str(), std::ios_base::out | std::ios_base::binary);
+        out.exceptions(
+            std::ios_base::eofbit | std::ios_base::badbit |
+            std::ios_base::failbit);
+        pools.write(out);
+    }
+    boost::filesystem::rename(tmp_file, snapshot_file);
+    log_stream(log_level::info)
+        << "Saved " << pools.num_transactions() << " transaction(s) of "
+        << pools.applications.size()
+        << " application(s) to: " << snapshot_file;
+}
+
+/// Run the server until SIGTERM or SIGINT (which must be blocked in all
+/// threads, see `main`) is received. The server then shuts down gracefully:
+/// new requests are refused, the running proofs are drained, and the pools
+/// are written to the pool snapshot. If the proofs are not drained within
+/// the drain timeout, they are abandoned and the process exits with
+/// EXIT_FAILURE.
 static void RunServer(
     libzecale::
         aggregator_circuit_wrapper<npp, wpp, nsnark, wverifier, batch_size>
             &aggregator,
-    const typename wsnark::keypair &keypair)
+    const typename wsnark::keypair &keypair,
+    std::shared_ptr<wsnark::keypair> multi_app_keypair,
+    libzecale::prover_scheduler &scheduler,
+    libzecale::aggregator_metrics &metrics,
+    libzecale::proof_store &proofs,
+    const libzecale::server_config &config,
+    const boost::filesystem::path &snapshot_dir)
 {
-    // Listen for incoming connections on 0.0.0.0:50052
-    // TODO: Move this in a config file
-    std::string server_address("0.0.0.0:50052");
-
-    aggregator_server service(aggregator, keypair);
+    aggregator_server server_impl(
+        aggregator,
+        keypair,
+        multi_app_keypair,
+        scheduler,
+        metrics,
+        proofs,
+        config,
+        snapshot_dir);
+    if (!config.pool_snapshot_file.empty()) {
+        try {
+            load_pool_snapshot(server_impl, config.pool_snapshot_file);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error)
+                << "Failed to load the pool snapshot: " << e.what();
+            libzecale::logger::global().flush();
+            exit(1);
+        }
+    }
+    zecale_proto::Aggregator::AsyncService service;
 
     grpc::ServerBuilder builder;
 
     // Listen on the given address without any authentication mechanism.
-    builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
+    builder.AddListeningPort(
+        config.listen_address, grpc::InsecureServerCredentials());
 
     // Register "service" as the instance through which we'll communicate with
-    // clients. In this case it corresponds to an *synchronous* service.
+    // clients. In this case it corresponds to an *asynchronous* service: the
+    // calls are received on the completion queues, and dispatched to
+    // `server_impl` by the polling threads.
     builder.RegisterService(&service);
+    if (config.max_message_size != 0) {
+        builder.SetMaxReceiveMessageSize((int)config.max_message_size);
+        builder.SetMaxSendMessageSize((int)config.max_message_size);
+    }
+    if (config.max_concurrent_streams != 0) {
+        builder.AddChannelArgument(
+            GRPC_ARG_MAX_CONCURRENT_STREAMS,
+            (int)config.max_concurrent_streams);
+    }
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
+    for (size_t i = 0; i < config.num_completion_queues; ++i) {
+        cqs.push_back(builder.AddCompletionQueue());
+    }
 
     // Finally assemble the server.
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
-    std::cout << "[DEBUG] Server listening on " << server_address << std::endl;
+    if (!server) {
+        log_stream(log_level::error)
+            << "Failed to listen on " << config.listen_address;
+        libzecale::logger::global().flush();
+        exit(1);
+    }
+    log_stream(log_level::info)
+        << "Server listening on " << config.listen_address << " ("
+        << config.num_completion_queues << " completion queue(s) x "
+        << config.num_polling_threads << " thread(s))";
+
+    // Wait for the first call of each method on each queue, and start the
+    // threads polling the queues.
+    using async_service = zecale_proto::Aggregator::AsyncService;
+    std::vector<std::thread> polling_threads;
+    for (std::unique_ptr<grpc::ServerCompletionQueue> &cq : cqs) {
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGetVerificationKey,
+            server_impl,
+            &aggregator_server::GetVerificationKey);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestRegisterApplication,
+            server_impl,
+            &aggregator_server::RegisterApplication);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGenerateAggregateProof,
+            server_impl,
+            &aggregator_server::GenerateAggregateProof);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGetMultiApplicationVerificationKey,
+            server_impl,
+            &aggregator_server::GetMultiApplicationVerificationKey);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGenerateMultiApplicationAggregateProof,
+            server_impl,
+            &aggregator_server::GenerateMultiApplicationAggregateProof);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestSubmitTransaction,
+            server_impl,
+            &aggregator_server::SubmitTransaction);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGetAggregateProofByBatch,
+            server_impl,
+            &aggregator_server::GetAggregateProofByBatch);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGetAggregateProofByTransaction,
+            server_impl,
+            &aggregator_server::GetAggregateProofByTransaction);
+        serve(
+            service,
+            cq.get(),
+            &async_service::RequestGetMetrics,
+            server_impl,
+            &aggregator_server::GetMetrics);
+
+        for (size_t i = 0; i < config.num_polling_threads; ++i) {
+            polling_threads.emplace_back(poll_completion_queue, cq.get());
+        }
+    }
+
+    // Shut the server down on the first termination signal. The polling
+    // threads keep serving the calls (refused, from now on) while the
+    // running proofs complete, so that their responses are sent.
+    bool drained = true;
+    std::thread signal_thread([&server, &server_impl, &config, &drained]() {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGTERM);
+        sigaddset(&signals, SIGINT);
+        int signal_number = 0;
+        sigwait(&signals, &signal_number);
+        log_stream(log_level::info)
+            << "Received signal " << signal_number << ", shutting down...";
 
-    // Wait for the server to shutdown. Note that some other thread must be
-    // responsible for shutting down the server for this call to ever return.
+        drained = server_impl.drain();
+        if (!drained) {
+            log_stream(log_level::warning)
+                << "Proofs still running after "
+                << config.drain_timeout_seconds << "s";
+        }
+        server->Shutdown(
+            std::chrono::system_clock::now() + shutdown_grace_period);
+    });
+
+    // Wait for the server to shutdown (see `signal_thread`).
+    libzecale::logger::global().flush();
     display_server_start_message();
     server->Wait();
+    signal_thread.join();
+
+    for (std::unique_ptr<grpc::ServerCompletionQueue> &cq : cqs) {
+        cq->Shutdown();
+    }
+    for (std::thread &thread : polling_threads) {
+        thread.join();
+    }
+
+    if (!config.pool_snapshot_file.empty()) {
+        try {
+            write_pool_snapshot(server_impl, config.pool_snapshot_file);
+        } catch (const std::exception &e) {
+            log_stream(log_level::error)
+                << "Failed to write the pool snapshot: " << e.what();
+        }
+    }
+    log_stream(log_level::info) << "Server stopped";
+    libzecale::logger::global().flush();
+    if (!drained) {
+        // Do not wait for the abandoned proofs (which use `server_impl`).
+        // Their work is lost, hence the exit status reports a failure.
+        std::_Exit(EXIT_FAILURE);
+    }
 }
 
 #ifdef ZKSNARK_GROTH16
@@ -314,10 +1425,144 @@ static wsnark::KeypairT load_keypair(const std::string &keypair_file)
 
 int main(int argc, char **argv)
 {
+    // Block the termination signals in all threads (which inherit the mask
+    // of this one), so that they are only received by the thread waiting for
+    // them in `RunServer`.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     // Options
     po::options_description options("");
     options.add_options()(
         "keypair,k", po::value<std::string>(), "file to load keypair from");
+    options.add_options()(
+        "prover-workers,w",
+        po::value<size_t>(),
+        "number of proofs generated concurrently, each on a dedicated subset "
+        "of the CPUs (0 to select the number maximising the throughput)");
+    options.add_options()(
+        "multi-app,m",
+        "enable aggregation of proofs from several applications in a single "
+        "proof (requires an additional setup)");
+    options.add_options()(
+        "multi-app-keypair",
+        po::value<std::string>(),
+        "file to load the multi-application keypair from (implies "
+        "--multi-app)");
+    options.add_options()(
+        "snapshot-dir,s",
+        po::value<boost::filesystem::path>(),
+        "directory in which to write the inputs of each aggregation "
+        "(batch_<job id>_<time>.snapshot), to be replayed with "
+        "aggregator_replay");
+    options.add_options()(
+        "log-level,l",
+        po::value<std::string>(),
+        "minimum level of the log records (debug, info, warning or error)");
+    options.add_options()(
+        "metrics-file",
+        po::value<std::string>(),
+        "file in which to periodically write the metrics, in the Prometheus "
+        "text format");
+    options.add_options()(
+        "metrics-port",
+        po::value<uint16_t>(),
+        "port on which to serve the metrics over HTTP (on 127.0.0.1), in the "
+        "Prometheus text format");
+    options.add_options()(
+        "config,c",
+        po::value<boost::filesystem::path>(),
+        "file from which to read options (one \"<option>=<value>\" per "
+        "line), overridden by the command line");
+    options.add_options()(
+        "listen-address",
+        po::value<std::string>(),
+        "address (host:port) on which to listen (default: 0.0.0.0:50052)");
+    options.add_options()(
+        "completion-queues",
+        po::value<size_t>(),
+        "number of gRPC completion queues (default: 1)");
+    options.add_options()(
+        "polling-threads",
+        po::value<size_t>(),
+        "number of threads polling each completion queue (default: 2)");
+    options.add_options()(
+        "max-concurrent-streams",
+        po::value<size_t>(),
+        "maximum number of calls in progress per client connection (default: "
+        "gRPC default)");
+    options.add_options()(
+        "max-message-size",
+        po::value<size_t>(),
+        "maximum size of the messages, in bytes (default: gRPC default)");
+    options.add_options()(
+        "max-pool-size",
+        po::value<size_t>(),
+        "maximum number of transactions in the pool of an application "
+        "(default: no limit)");
+    options.add_options()(
+        "ingest-policy",
+        po::value<std::string>(),
+        "behaviour when the pool is full: reject or evict-lowest-fee "
+        "(default: reject)");
+    options.add_options()(
+        "target-time-to-proof",
+        po::value<double>(),
+        "estimated time-to-proof, in seconds, above which the prover is "
+        "congested: minimum fee and per-application quotas apply (default: "
+        "0, no admission control)");
+    options.add_options()(
+        "congested-min-fee",
+        po::value<uint32_t>(),
+        "minimum fee, in wei, of the transactions admitted while congested "
+        "(default: 0)");
+    options.add_options()(
+        "max-application-share",
+        po::value<double>(),
+        "maximum share (0 to 1) of the pending transactions that an "
+        "application may hold while congested (default: 1)");
+    options.add_options()(
+        "max-time-to-proof",
+        po::value<double>(),
+        "estimated time-to-proof, in seconds, above which all transactions "
+        "are rejected (default: 0, no limit)");
+    options.add_options()(
+        "pool-snapshot",
+        po::value<std::string>(),
+        "file in which to save the pending transactions on shutdown (SIGTERM "
+        "or SIGINT), and from which to restore them on start");
+    options.add_options()(
+        "drain-timeout",
+        po::value<double>(),
+        "maximum time, in seconds, to wait on shutdown for the running proofs "
+        "(default: 0, no limit)");
+    options.add_options()(
+        "proof-cache-size",
+        po::value<size_t>(),
+        "number of completed aggregate proofs kept in memory, to be fetched "
+        "again (default: 16)");
+    options.add_options()(
+        "proof-store-dir",
+        po::value<std::string>(),
+        "directory in which to keep the completed aggregate proofs across "
+        "restarts (default: none, proofs are only kept in memory)");
+    options.add_options()(
+        "max-stored-proofs",
+        po::value<size_t>(),
+        "maximum number of aggregate proofs kept in the proof store directory "
+        "(default: 1024)");
+    options.add_options()(
+        "satisfiability-check",
+        po::value<std::string>(),
+        "batches whose witness is checked against the constraints before "
+        "proving: off, sampled or always (default: sampled)");
+    options.add_options()(
+        "satisfiability-check-interval",
+        po::value<size_t>(),
+        "in sampled mode, check one batch out of this number (default: 100)");
 #ifdef DEBUG
     options.add_options()(
         "jr1cs,j",
@@ -335,6 +1580,13 @@ int main(int argc, char **argv)
     };
 
     std::string keypair_file;
+    bool multi_app = false;
+    std::string multi_app_keypair_file;
+    size_t prover_workers = 1;
+    boost::filesystem::path snapshot_dir;
+    std::string metrics_file;
+    uint16_t metrics_port = 0;
+    libzecale::server_config config;
 #ifdef DEBUG
     boost::filesystem::path jr1cs_file;
 #endif
@@ -346,9 +1598,108 @@ int main(int argc, char **argv)
             usage();
             return 0;
         }
+        if (vm.count("config")) {
+            // Values already stored (from the command line) take precedence.
+            const boost::filesystem::path config_file =
+                vm["config"].as<boost::filesystem::path>();
+            std::ifstream config_stream(config_file.c_str());
+            if (!config_stream.is_open()) {
+                throw std::invalid_argument(
+                    "cannot open config file: " + config_file.string());
+            }
+            po::store(po::parse_config_file(config_stream, options), vm);
+        }
         if (vm.count("keypair")) {
             keypair_file = vm["keypair"].as<std::string>();
         }
+        if (vm.count("prover-workers")) {
+            prover_workers = vm["prover-workers"].as<size_t>();
+        }
+        if (vm.count("multi-app")) {
+            multi_app = true;
+        }
+        if (vm.count("multi-app-keypair")) {
+            multi_app = true;
+            multi_app_keypair_file = vm["multi-app-keypair"].as<std::string>();
+        }
+        if (vm.count("snapshot-dir")) {
+            snapshot_dir = vm["snapshot-dir"].as<boost::filesystem::path>();
+        }
+        if (vm.count("log-level")) {
+            libzecale::logger::global().set_level(
+                libzecale::log_level_from_string(
+                    vm["log-level"].as<std::string>()));
+        }
+        if (vm.count("metrics-file")) {
+            metrics_file = vm["metrics-file"].as<std::string>();
+        }
+        if (vm.count("metrics-port")) {
+            metrics_port = vm["metrics-port"].as<uint16_t>();
+        }
+        if (vm.count("listen-address")) {
+            config.listen_address = vm["listen-address"].as<std::string>();
+        }
+        if (vm.count("completion-queues")) {
+            config.num_completion_queues = vm["completion-queues"].as<size_t>();
+        }
+        if (vm.count("polling-threads")) {
+            config.num_polling_threads = vm["polling-threads"].as<size_t>();
+        }
+        if (vm.count("max-concurrent-streams")) {
+            config.max_concurrent_streams =
+                vm["max-concurrent-streams"].as<size_t>();
+        }
+        if (vm.count("max-message-size")) {
+            config.max_message_size = vm["max-message-size"].as<size_t>();
+        }
+        if (vm.count("max-pool-size")) {
+            config.max_pool_size = vm["max-pool-size"].as<size_t>();
+        }
+        if (vm.count("ingest-policy")) {
+            config.pool_full_policy = libzecale::ingest_policy_from_string(
+                vm["ingest-policy"].as<std::string>());
+        }
+        if (vm.count("target-time-to-proof")) {
+            config.target_time_to_proof_seconds =
+                vm["target-time-to-proof"].as<double>();
+        }
+        if (vm.count("congested-min-fee")) {
+            config.congested_min_fee_wei =
+                vm["congested-min-fee"].as<uint32_t>();
+        }
+        if (vm.count("max-application-share")) {
+            config.max_application_share =
+                vm["max-application-share"].as<double>();
+        }
+        if (vm.count("max-time-to-proof")) {
+            config.max_time_to_proof_seconds =
+                vm["max-time-to-proof"].as<double>();
+        }
+        if (vm.count("pool-snapshot")) {
+            config.pool_snapshot_file = vm["pool-snapshot"].as<std::string>();
+        }
+        if (vm.count("drain-timeout")) {
+            config.drain_timeout_seconds = vm["drain-timeout"].as<double>();
+        }
+        if (vm.count("proof-cache-size")) {
+            config.proof_cache_size = vm["proof-cache-size"].as<size_t>();
+        }
+        if (vm.count("proof-store-dir")) {
+            config.proof_store_dir = vm["proof-store-dir"].as<std::string>();
+        }
+        if (vm.count("max-stored-proofs")) {
+            config.max_stored_proofs = vm["max-stored-proofs"].as<size_t>();
+        }
+        if (vm.count("satisfiability-check")) {
+            config.satisfiability_check =
+                libzecale::satisfiability_check_mode_from_string(
+                    vm["satisfiability-check"].as<std::string>());
+        }
+        if (vm.count("satisfiability-check-interval")) {
+            config.satisfiability_check_interval =
+                vm["satisfiability-check-interval"].as<size_t>();
+        }
+        config.validate();
 #ifdef DEBUG
         if (vm.count("jr1cs")) {
             jr1cs_file = vm["jr1cs"].as<boost::filesystem::path>();
@@ -358,10 +1709,22 @@ int main(int argc, char **argv)
         std::cerr << " ERROR: " << error.what() << std::endl;
         usage();
         return 1;
+    } catch (std::invalid_argument &error) {
+        // Invalid log level or server configuration
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        usage();
+        return 1;
     }
 
+    // The profiling of libff is not thread-safe, and proofs are generated
+    // concurrently by the prover workers (and when selecting the partition).
+    // The timings of the proofs are reported by the server instead (see
+    // `observe_prove`).
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
     // We inititalize the curve parameters here
-    std::cout << "[INFO] Init params of both curves" << std::endl;
+    log_stream(log_level::info) << "Init params of both curves";
     npp::init_public_params();
     wpp::init_public_params();
 
@@ -371,32 +1734,127 @@ int main(int argc, char **argv)
     wsnark::keypair keypair = [&keypair_file, &aggregator]() {
         if (!keypair_file.empty()) {
 #ifdef ZKSNARK_GROTH16
-            std::cout << "[INFO] Loading keypair: " << keypair_file
-                      << std::endl;
+            log_stream(log_level::info) << "Loading keypair: " << keypair_file;
             return load_keypair(keypair_file);
 #else
-            std::cout << "Keypair loading not supported in this config"
-                      << std::endl;
+            log_stream(log_level::error)
+                << "Keypair loading not supported in this config";
             exit(1);
 #endif
         }
 
-        std::cout << "[INFO] Generate new keypair" << std::endl;
+        log_stream(log_level::info) << "Generate new keypair";
         wsnark::keypair keypair = aggregator.generate_trusted_setup();
         return keypair;
     }();
 
+    std::shared_ptr<wsnark::keypair> multi_app_keypair;
+    if (!multi_app_keypair_file.empty()) {
+#ifdef ZKSNARK_GROTH16
+        log_stream(log_level::info)
+            << "Loading multi-application keypair: " << multi_app_keypair_file;
+        multi_app_keypair = std::make_shared<wsnark::keypair>(
+            load_keypair(multi_app_keypair_file));
+#else
+        log_stream(log_level::error)
+            << "Keypair loading not supported in this config";
+        exit(1);
+#endif
+    } else if (multi_app) {
+        log_stream(log_level::info) << "Generate multi-application keypair";
+        multi_app_aggregator_wrapper multi_app_aggregator;
+        multi_app_keypair = std::make_shared<wsnark::keypair>(
+            multi_app_aggregator.generate_trusted_setup());
+    }
+
 #ifdef DEBUG
     // Run only if the flag is set
     if (!jr1cs_file.empty()) {
-        std::cout << "[DEBUG] Dump R1CS to json file" << std::endl;
+        log_stream(log_level::debug) << "Dump R1CS to json file";
         std::ofstream jr1cs_stream(jr1cs_file.c_str());
         libzeth::r1cs_write_json<wpp>(
             aggregator.get_constraint_system(), jr1cs_stream);
     }
 #endif
 
-    std::cout << "[INFO] Setup successful, starting the server..." << std::endl;
-    RunServer(aggregator, keypair);
+    const libzecale::cpu_topology topology = libzecale::cpu_topology::detect();
+    libzecale::prover_partition partition;
+    if (prover_workers == 0) {
+        // Time a proof for the aggregation circuit (the witness is irrelevant
+        // for the time taken by the prover) with each candidate partition.
+        log_stream(log_level::info) << "Selecting the prover partition...";
+        const libsnark::protoboard<libff::Fr<wpp>> pb =
+            aggregator.get_constraint_system();
+        partition = libzecale::prover_partition::select(
+            topology, [&](const libzecale::prover_partition &candidate) {
+                const double throughput =
+                    libzecale::measure_prover_throughput(candidate, [&]() {
+                        wsnark::generate_proof(pb, keypair.pk);
+                    });
+                log_stream(log_level::info)
+                    << candidate.num_workers() << " worker(s) x "
+                    << candidate.threads_per_worker()
+                    << " thread(s): " << throughput << " proofs/hour";
+                return throughput;
+            });
+    } else {
+        partition = libzecale::prover_partition::make(topology, prover_workers);
+    }
+    log_stream(log_level::info)
+        << "Prover workers: " << partition.num_workers() << " x "
+        << partition.threads_per_worker() << " thread(s)";
+    libzecale::prover_scheduler scheduler(partition);
+
+    libzecale::aggregator_metrics metrics(
+        partition.num_workers() * partition.threads_per_worker());
+    std::unique_ptr<libzecale::metrics_exporter> exporter;
+    if (!metrics_file.empty() || metrics_port != 0) {
+        exporter.reset(new libzecale::metrics_exporter(
+            metrics, metrics_file, metrics_port));
+        if (exporter->http_port() != 0) {
+            log_stream(log_level::info)
+                << "Serving metrics on 127.0.0.1:" << exporter->http_port();
+        }
+    }
+
+    // Completed proofs (reloaded from the proof store directory, if any).
+    // The stored proofs which do not verify against the current keys (e.g.
+    // if a new setup has been run) are discarded.
+    std::set<std::string> vk_fingerprints = {vk_fingerprint(keypair.vk)};
+    if (multi_app_keypair) {
+        vk_fingerprints.insert(vk_fingerprint(multi_app_keypair->vk));
+    }
+    std::unique_ptr<libzecale::proof_store> proofs;
+    try {
+        proofs.reset(new libzecale::proof_store(
+            config.proof_cache_size,
+            config.proof_store_dir,
+            config.max_stored_proofs,
+            vk_fingerprints));
+    } catch (const std::exception &e) {
+        log_stream(log_level::error)
+            << "Failed to load the proof store: " << e.what();
+        return 1;
+    }
+    if (proofs->num_discarded() != 0) {
+        log_stream(log_level::warning)
+            << "Discarded " << proofs->num_discarded()
+            << " stored proof(s) made with another keypair";
+    }
+    if (proofs->size() != 0) {
+        log_stream(log_level::info)
+            << "Loaded " << proofs->size() << " stored proof(s)";
+    }
+
+    log_stream(log_level::info) << "Setup successful, starting the server...";
+    RunServer(
+        aggregator,
+        keypair,
+        multi_app_keypair,
+        scheduler,
+        metrics,
+        *proofs,
+        config,
+        snapshot_dir);
     return 0;
 }
@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_AGGREGATOR_SERVER_ASYNC_CALL_HPP__
+#define __ZECALE_AGGREGATOR_SERVER_ASYNC_CALL_HPP__
+
+#include <functional>
+#include <grpcpp/completion_queue.h>
+#include <grpcpp/server_context.h>
+#include <grpcpp/support/async_unary_call.h>
+#include <memory>
+
+/// State of a call in progress on a gRPC completion queue. The address of the
+/// object is used as the tag of its operations on the queue.
+class async_call
+{
+public:
+    virtual ~async_call(){};
+
+    /// Called by the thread polling the queue when an operation tagged with
+    /// this call completes. `ok` is false if the operation failed (e.g. if
+    /// the queue is shutting down).
+    virtual void proceed(bool ok) = 0;
+};
+
+/// Poll `cq` until it is shut down and drained, dispatching the completed
+/// operations to their calls.
+inline void poll_completion_queue(grpc::ServerCompletionQueue *cq)
+{
+    void *tag = nullptr;
+    bool ok = false;
+    while (cq->Next(&tag, &ok)) {
+        static_cast<async_call *>(tag)->proceed(ok);
+    }
+}
+
+/// A unary call of the method of an `AsyncService` generated by gRPC. Each
+/// call object waits for one request. When it arrives, a new object is
+/// created to wait for the next one, and the handler is invoked. The handler
+/// fills the response (and possibly the metadata of the context) and calls
+/// the `finish` function it is given, possibly later and from another thread
+/// (e.g. once a proof has been generated).
+template<typename AsyncServiceT, typename RequestT, typename ResponseT>
+class async_unary_call : public async_call
+{
+public:
+    using request_method = void (AsyncServiceT::*)(
+        grpc::ServerContext *,
+        RequestT *,
+        grpc::ServerAsyncResponseWriter<ResponseT> *,
+        grpc::CompletionQueue *,
+        grpc::ServerCompletionQueue *,
+        void *);
+    using finish_function = std::function<void(const grpc::Status &)>;
+    using handler = std::function<void(
+        grpc::ServerContext *context,
+        const RequestT &request,
+        ResponseT *response,
+        finish_function finish)>;
+
+    /// Start waiting for a request on `cq`. The object deletes itself once
+    /// the call is complete.
+    static void serve(
+        AsyncServiceT &service,
+        grpc::ServerCompletionQueue *cq,
+        request_method method,
+        std::shared_ptr<const handler> h)
+    {
+        new async_unary_call(service, cq, method, std::move(h));
+    }
+
+    void proceed(bool ok) override
+    {
+        if (_state == state::waiting_for_request) {
+            if (!ok) {
+                // The server is shutting down: no request will arrive.
+                delete this;
+                return;
+            }
+
+            serve(_service, _cq, _method, _handler);
+            _state = state::processing;
+            (*_handler)(
+                &_context,
+                _request,
+                &_response,
+                [this](const grpc::Status &s) {
+                    _state = state::finishing;
+                    _responder.Finish(_response, s, this);
+                });
+            return;
+        }
+
+        // The response has been sent (or the call cancelled).
+        delete this;
+    }
+
+private:
+    enum class state { waiting_for_request, processing, finishing };
+
+    async_unary_call(
+        AsyncServiceT &service,
+        grpc::ServerCompletionQueue *cq,
+        request_method method,
+        std::shared_ptr<const handler> h)
+        : _service(service)
+        , _cq(cq)
+        , _method(method)
+        , _handler(std::move(h))
+        , _responder(&_context)
+        , _state(state::waiting_for_request)
+    {
+        (_service.*_method)(&_context, &_request, &_responder, _cq, _cq, this);
+    }
+
+    AsyncServiceT &_service;
+    grpc::ServerCompletionQueue *_cq;
+    const request_method _method;
+    const std::shared_ptr<const handler> _handler;
+
+    grpc::ServerContext _context;
+    RequestT _request;
+    ResponseT _response;
+    grpc::ServerAsyncResponseWriter<ResponseT> _responder;
+    state _state;
+};
+
+#endif // __ZECALE_AGGREGATOR_SERVER_ASYNC_CALL_HPP__
@@ -0,0 +1,174 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Compare the time per multiplication (and squaring) in the base field of
+// BLS12-377 of the batch kernels (see bls12_377_fq_batch.hpp), against
+// libff's scalar `operator*`. By default, this runs for each size of the
+// batches computed during the witness generation of the Fp6 and Fp12
+// gadgets.
+
+#include "libzecale/circuits/fields/bls12_377_fq_batch.hpp"
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace po = boost::program_options;
+
+using Fq = libff::bls12_377_Fq;
+
+namespace
+{
+
+double elapsed_ns(
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end,
+    size_t num_operations)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (double)num_operations;
+}
+
+void print_result(const std::string &name, double mul_ns, double square_ns)
+{
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(12) << mul_ns << std::setw(12) << square_ns
+              << "\n";
+}
+
+void run_benchmark(size_t num_products, size_t batch_size)
+{
+    const size_t num_iterations =
+        std::max<size_t>(1, num_products / batch_size);
+    std::vector<Fq> a(batch_size);
+    std::vector<Fq> b(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+        a[i] = Fq::random_element();
+        b[i] = Fq::random_element();
+    }
+    const size_t num_operations = num_iterations * batch_size;
+
+    std::cout << "batch size: " << batch_size << "\n";
+    std::cout << std::fixed << std::setprecision(2) << std::left
+              << std::setw(16) << "kernel" << std::right << std::setw(12)
+              << "mul (ns)" << std::setw(12) << "square (ns)"
+              << "\n";
+
+    // libff
+    std::vector<Fq> expected_product(batch_size);
+    std::vector<Fq> expected_square(batch_size);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < batch_size; ++i) {
+            expected_product[i] = a[i] * b[i];
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < batch_size; ++i) {
+            expected_square[i] = a[i].squared();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    print_result(
+        "libff",
+        elapsed_ns(start, middle, num_operations),
+        elapsed_ns(middle, end, num_operations));
+
+    // Batch kernels
+    const libzecale::fq_batch_kernel kernels[] = {
+        libzecale::fq_batch_kernel::scalar,
+        libzecale::fq_batch_kernel::avx2,
+        libzecale::fq_batch_kernel::avx512_ifma,
+    };
+    for (const libzecale::fq_batch_kernel kernel : kernels) {
+        const std::string name = libzecale::fq_batch_kernel_name(kernel);
+        if (!libzecale::fq_batch_kernel_is_supported(kernel)) {
+            std::cout << std::left << std::setw(16) << name
+                      << "not supported\n";
+            continue;
+        }
+
+        std::vector<Fq> product(batch_size);
+        std::vector<Fq> square(batch_size);
+        start = std::chrono::steady_clock::now();
+        for (size_t iter = 0; iter < num_iterations; ++iter) {
+            libzecale::bls12_377_fq_batch_mul(
+                a.data(), b.data(), product.data(), batch_size, kernel);
+        }
+        middle = std::chrono::steady_clock::now();
+        for (size_t iter = 0; iter < num_iterations; ++iter) {
+            libzecale::bls12_377_fq_batch_square(
+                a.data(), square.data(), batch_size, kernel);
+        }
+        end = std::chrono::steady_clock::now();
+        if (product != expected_product || square != expected_square) {
+            throw std::runtime_error(name + " kernel differs from libff");
+        }
+        print_result(
+            name,
+            elapsed_ns(start, middle, num_operations),
+            elapsed_ns(middle, end, num_operations));
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "products,n",
+        po::value<size_t>(),
+        "number of products to average over (default: 1000000)");
+    options.add_options()(
+        "batch-size,b",
+        po::value<size_t>(),
+        "number of products per batch (default: the sizes of the witness "
+        "generation)");
+
+    size_t num_products = 1000000;
+    // Batches of the Toom-3 (5, 9 and 6 products when squaring) and Toom-6
+    // (11, 36 and 21) gadgets, and of the native Fp6 multiplication (6).
+    std::vector<size_t> batch_sizes = {5, 6, 9, 11, 21, 36};
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("products")) {
+            num_products = vm["products"].as<size_t>();
+        }
+        if (vm.count("batch-size")) {
+            batch_sizes = {vm["batch-size"].as<size_t>()};
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    libff::bls12_377_pp::init_public_params();
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    std::cout << "default kernel: "
+              << libzecale::fq_batch_kernel_name(
+                     libzecale::fq_batch_kernel_default())
+              << "\n";
+    for (const size_t batch_size : batch_sizes) {
+        run_benchmark(num_products, batch_size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Compare the projective and affine in-circuit G2 precomputations for
+// BLS12-377 (over BW6-761), in number of constraints and variables, and in
+// witness generation time, alone and followed by a Miller loop.
+
+#include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace po = boost::program_options;
+
+using wpp = libff::bw6_761_pp;
+using npp = libzecale::other_curve<wpp>;
+using FieldT = libff::Fr<wpp>;
+
+namespace
+{
+
+template<typename precomputeGadgetT>
+void run_benchmark(const std::string &name, size_t num_iterations)
+{
+    const libff::bls12_377_G1 P =
+        libff::bls12_377_Fr::random_element() * libff::bls12_377_G1::one();
+    libff::bls12_377_G2 Q =
+        libff::bls12_377_Fr::random_element() * libff::bls12_377_G2::one();
+    Q.to_affine_coordinates();
+
+    libsnark::protoboard<FieldT> pb;
+    libsnark::G1_variable<wpp> P_var(pb, "P");
+    libsnark::G2_variable<wpp> Q_var(pb, "Q");
+    libsnark::Fqk_variable<wpp> miller_var(pb, "miller");
+
+    libzecale::bls12_377_G1_precomputation<wpp> P_prec;
+    libzecale::bls12_377_G1_precompute_gadget<wpp> precompute_P(
+        pb, P_var, P_prec, "precompute_P");
+
+    const size_t num_variables_before = pb.num_variables();
+    libzecale::bls12_377_G2_precomputation<wpp> Q_prec;
+    precomputeGadgetT precompute_Q(pb, Q_var, Q_prec, "precompute_Q");
+    const size_t num_precompute_variables =
+        pb.num_variables() - num_variables_before;
+
+    libzecale::bls12_377_miller_loop_gadget<wpp> miller_loop(
+        pb, P_prec, Q_prec, miller_var, "miller_loop");
+
+    precompute_P.generate_r1cs_constraints();
+    const size_t num_constraints_before = pb.num_constraints();
+    precompute_Q.generate_r1cs_constraints();
+    const size_t num_precompute_constraints =
+        pb.num_constraints() - num_constraints_before;
+    miller_loop.generate_r1cs_constraints();
+
+    P_var.generate_r1cs_witness(P);
+    Q_var.generate_r1cs_witness(Q);
+    precompute_P.generate_r1cs_witness();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iterations; ++i) {
+        precompute_Q.generate_r1cs_witness();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    miller_loop.generate_r1cs_witness();
+    if (!pb.is_satisfied()) {
+        throw std::runtime_error(name + ": constraints not satisfied");
+    }
+
+    const double witness_ms =
+        std::chrono::duration<double, std::milli>(end - start).count() /
+        (double)num_iterations;
+    std::cout << name << ":\n"
+              << "  precompute constraints:       "
+              << num_precompute_constraints << "\n"
+              << "  precompute variables:         " << num_precompute_variables
+              << "\n"
+              << "  precompute + miller loop:     " << pb.num_constraints()
+              << " constraints, " << pb.num_variables() << " variables\n"
+              << "  precompute witness time (ms): " << witness_ms << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "iterations,n",
+        po::value<size_t>(),
+        "number of witness generations to average over (default: 10)");
+
+    size_t num_iterations = 10;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("iterations")) {
+            num_iterations = vm["iterations"].as<size_t>();
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    npp::init_public_params();
+    wpp::init_public_params();
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    run_benchmark<libzecale::bls12_377_G2_precompute_gadget<wpp>>(
+        "projective", num_iterations);
+    run_benchmark<libzecale::bls12_377_G2_affine_precompute_gadget<wpp>>(
+        "affine", num_iterations);
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Compare the time to generate the witness of the BLS12-377 pairing check
+// circuit (G2 precomputations, 4-pair Miller loop and final exponentiation,
+// over BW6-761), gadget by gadget and natively, against the time to compute
+// the same pairing product out of circuit.
+
+#include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace po = boost::program_options;
+
+using wpp = libff::bw6_761_pp;
+using npp = libzecale::other_curve<wpp>;
+using FieldT = libff::Fr<wpp>;
+
+namespace
+{
+
+const size_t num_pairs = 4;
+
+double elapsed_ms(
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end,
+    size_t num_iterations)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count() /
+           (double)num_iterations;
+}
+
+void run_benchmark(size_t num_iterations)
+{
+    std::vector<libff::G1<npp>> P;
+    std::vector<libff::G2<npp>> Q;
+    for (size_t i = 0; i < num_pairs; ++i) {
+        P.push_back(libff::Fr<npp>::random_element() * libff::G1<npp>::one());
+        Q.push_back(libff::Fr<npp>::random_element() * libff::G2<npp>::one());
+    }
+
+    libsnark::protoboard<FieldT> pb;
+    std::vector<std::shared_ptr<libsnark::G1_variable<wpp>>> P_vars;
+    std::vector<std::shared_ptr<libsnark::G2_variable<wpp>>> Q_vars;
+    std::vector<libzecale::bls12_377_G1_precomputation<wpp>> P_precs(
+        num_pairs);
+    std::vector<libzecale::bls12_377_G2_precomputation<wpp>> Q_precs(
+        num_pairs);
+    std::vector<std::shared_ptr<libzecale::bls12_377_G1_precompute_gadget<wpp>>>
+        precompute_Ps;
+    std::vector<std::shared_ptr<libzecale::bls12_377_G2_precompute_gadget<wpp>>>
+        precompute_Qs;
+    for (size_t i = 0; i < num_pairs; ++i) {
+        const std::string idx = std::to_string(i);
+        P_vars.emplace_back(new libsnark::G1_variable<wpp>(pb, "P" + idx));
+        Q_vars.emplace_back(new libsnark::G2_variable<wpp>(pb, "Q" + idx));
+        precompute_Ps.emplace_back(
+            new libzecale::bls12_377_G1_precompute_gadget<wpp>(
+                pb, *P_vars.back(), P_precs[i], "precompute_P" + idx));
+        precompute_Qs.emplace_back(
+            new libzecale::bls12_377_G2_precompute_gadget<wpp>(
+                pb, *Q_vars.back(), Q_precs[i], "precompute_Q" + idx));
+    }
+
+    libzecale::Fqk_variable<wpp> miller_var(pb, "miller");
+    libzecale::bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<wpp>
+        miller_loop(
+            pb,
+            P_precs[0],
+            Q_precs[0],
+            P_precs[1],
+            Q_precs[1],
+            P_precs[2],
+            Q_precs[2],
+            P_precs[3],
+            Q_precs[3],
+            miller_var,
+            "miller_loop");
+    libsnark::pb_variable<FieldT> result_is_one;
+    result_is_one.allocate(pb, "result_is_one");
+    libzecale::bls12_377_final_exp_gadget<wpp> final_exp(
+        pb, miller_var, result_is_one, "final_exp");
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        precompute_Ps[i]->generate_r1cs_constraints();
+        precompute_Qs[i]->generate_r1cs_constraints();
+        P_vars[i]->generate_r1cs_witness(P[i]);
+        Q_vars[i]->generate_r1cs_witness(Q[i]);
+        precompute_Ps[i]->generate_r1cs_witness();
+    }
+    miller_loop.generate_r1cs_constraints();
+    final_exp.generate_r1cs_constraints();
+
+    // Gadget by gadget
+    const auto per_gadget_start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < num_pairs; ++i) {
+            precompute_Qs[i]->generate_r1cs_witness_per_gadget();
+        }
+        miller_loop.generate_r1cs_witness_per_gadget();
+        final_exp.generate_r1cs_witness_per_gadget();
+    }
+    const auto per_gadget_end = std::chrono::steady_clock::now();
+    const libsnark::r1cs_variable_assignment<FieldT> per_gadget_assignment =
+        pb.full_variable_assignment();
+
+    // Native
+    const auto native_start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < num_pairs; ++i) {
+            precompute_Qs[i]->generate_r1cs_witness();
+        }
+        miller_loop.generate_r1cs_witness();
+        final_exp.generate_r1cs_witness();
+    }
+    const auto native_end = std::chrono::steady_clock::now();
+    if (pb.full_variable_assignment() != per_gadget_assignment) {
+        throw std::runtime_error("native and per-gadget witnesses differ");
+    }
+    if (!pb.is_satisfied()) {
+        throw std::runtime_error("constraints not satisfied");
+    }
+
+    // Out of circuit
+    const auto libff_start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        libff::Fqk<npp> f = libff::Fqk<npp>::one();
+        for (size_t i = 0; i < num_pairs; ++i) {
+            const libff::G1<npp> P_i = (i == num_pairs - 1) ? -P[i] : P[i];
+            f = f * npp::miller_loop(
+                        npp::precompute_G1(P_i), npp::precompute_G2(Q[i]));
+        }
+        npp::final_exponentiation(f);
+    }
+    const auto libff_end = std::chrono::steady_clock::now();
+
+    std::cout << "constraints:                    " << pb.num_constraints()
+              << "\n"
+              << "variables:                      " << pb.num_variables()
+              << "\n"
+              << "per-gadget witness time (ms):   "
+              << elapsed_ms(per_gadget_start, per_gadget_end, num_iterations)
+              << "\n"
+              << "native witness time (ms):       "
+              << elapsed_ms(native_start, native_end, num_iterations) << "\n"
+              << "out-of-circuit pairing (ms):    "
+              << elapsed_ms(libff_start, libff_end, num_iterations) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "iterations,n",
+        po::value<size_t>(),
+        "number of witness generations to average over (default: 10)");
+
+    size_t num_iterations = 10;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("iterations")) {
+            num_iterations = vm["iterations"].as<size_t>();
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    npp::init_public_params();
+    wpp::init_public_params();
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    run_benchmark(num_iterations);
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Compare the size, and the time to encode and decode, of a nested (Groth16
+// over BLS12-377) extended proof in the zeth_proto messages, against the
+// compact binary encoding (see compact_encoding.hpp), with and without point
+// compression.
+
+#include "libzecale/serialization/compact_encoding.hpp"
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <libzeth/snarks/groth16/groth16_api_handler.hpp>
+#include <stdexcept>
+
+namespace po = boost::program_options;
+
+using ppT = libff::bls12_377_pp;
+using snark = libzeth::groth16_snark<ppT>;
+using api_handler = libzeth::groth16_api_handler<ppT>;
+using ext_proof = libzeth::extended_proof<ppT, snark>;
+
+namespace
+{
+
+// Number of primary inputs of the nested proofs
+const size_t num_inputs = 9;
+
+double elapsed_us(
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end,
+    size_t num_operations)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count() /
+           (double)num_operations;
+}
+
+void print_result(
+    const std::string &name,
+    size_t num_bytes,
+    double encode_us,
+    double decode_us)
+{
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(12) << num_bytes << std::setw(14) << encode_us
+              << std::setw(14) << decode_us << "\n";
+}
+
+std::string encode_proto(const ext_proof &proof)
+{
+    zeth_proto::ExtendedProof proof_proto;
+    api_handler::extended_proof_to_proto(proof, &proof_proto);
+    return proof_proto.SerializeAsString();
+}
+
+ext_proof decode_proto(const std::string &bytes)
+{
+    zeth_proto::ExtendedProof proof_proto;
+    if (!proof_proto.ParseFromString(bytes)) {
+        throw std::runtime_error("failed to parse ExtendedProof");
+    }
+    return api_handler::extended_proof_from_proto(proof_proto);
+}
+
+template<typename EncodeT, typename DecodeT>
+void measure(
+    const std::string &name,
+    const std::vector<ext_proof> &proofs,
+    size_t num_iterations,
+    EncodeT encode,
+    DecodeT decode)
+{
+    std::vector<std::string> encoded(proofs.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < proofs.size(); ++i) {
+            encoded[i] = encode(proofs[i]);
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (size_t iter = 0; iter < num_iterations; ++iter) {
+        for (size_t i = 0; i < proofs.size(); ++i) {
+            const ext_proof decoded = decode(encoded[i]);
+            if (iter == 0 && !(decoded.get_proof() == proofs[i].get_proof() &&
+                               decoded.get_primary_inputs() ==
+                                   proofs[i].get_primary_inputs())) {
+                throw std::runtime_error(name + " does not round-trip");
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    const size_t num_operations = num_iterations * proofs.size();
+    print_result(
+        name,
+        encoded[0].size(),
+        elapsed_us(start, middle, num_operations),
+        elapsed_us(middle, end, num_operations));
+}
+
+void run_benchmark(size_t num_iterations, size_t num_proofs)
+{
+    std::vector<ext_proof> proofs;
+    proofs.reserve(num_proofs);
+    for (size_t i = 0; i < num_proofs; ++i) {
+        libsnark::r1cs_gg_ppzksnark_proof<ppT> proof(
+            libff::G1<ppT>::random_element(),
+            libff::G2<ppT>::random_element(),
+            libff::G1<ppT>::random_element());
+        std::vector<libff::Fr<ppT>> inputs;
+        for (size_t j = 0; j < num_inputs; ++j) {
+            inputs.push_back(libff::Fr<ppT>::random_element());
+        }
+        proofs.emplace_back(std::move(proof), std::move(inputs));
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << std::left
+              << std::setw(16) << "encoding" << std::right << std::setw(12)
+              << "bytes" << std::setw(14) << "encode (us)" << std::setw(14)
+              << "decode (us)"
+              << "\n";
+
+    measure("zeth_proto", proofs, num_iterations, encode_proto, decode_proto);
+    measure(
+        "compact",
+        proofs,
+        num_iterations,
+        [](const ext_proof &proof) {
+            return libzecale::extended_proof_to_compact(proof, false);
+        },
+        libzecale::extended_proof_from_compact<ppT, snark>);
+    measure(
+        "compact-pt",
+        proofs,
+        num_iterations,
+        [](const ext_proof &proof) {
+            return libzecale::extended_proof_to_compact(proof, true);
+        },
+        libzecale::extended_proof_from_compact<ppT, snark>);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "iterations,n",
+        po::value<size_t>(),
+        "number of passes over the proofs to average over (default: 100)");
+    options.add_options()(
+        "proofs,p",
+        po::value<size_t>(),
+        "number of distinct random proofs (default: 16)");
+
+    size_t num_iterations = 100;
+    size_t num_proofs = 16;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("iterations")) {
+            num_iterations = vm["iterations"].as<size_t>();
+        }
+        if (vm.count("proofs")) {
+            num_proofs = vm["proofs"].as<size_t>();
+        }
+        if (num_iterations == 0 || num_proofs == 0) {
+            throw po::error("iterations and proofs must be positive");
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    libff::bls12_377_pp::init_public_params();
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    run_benchmark(num_iterations, num_proofs);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Compare the throughput (in aggregate proofs per hour) of one prover using
+// all the CPUs of the machine, against several concurrent provers, each
+// using a subset of the CPUs. The aggregation circuit is the one of the
+// aggregator_server for the configured curve and snark.
+
+#include "libzecale/core/aggregator_circuit_wrapper.hpp"
+#include "libzecale/core/prover_scheduler.hpp"
+#include "zecale_config.h"
+
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <libff/common/profiling.hpp>
+
+namespace po = boost::program_options;
+
+#if defined(ZECALE_CURVE_MNT6)
+#include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
+using wpp = libff::mnt6_pp;
+#elif defined(ZECALE_CURVE_BW6_761)
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+using wpp = libff::bw6_761_pp;
+#else
+#error "ZECALE_CURVE_* variable not set to supported curve"
+#endif
+
+using npp = libzecale::other_curve<wpp>;
+
+#if defined(ZECALE_SNARK_PGHR13)
+#include <libzecale/circuits/pghr13_verifier/pghr13_verifier_parameters.hpp>
+using wverifier = libzecale::pghr13_verifier_parameters<wpp>;
+using nsnark = libzeth::pghr13_snark<npp>;
+#elif defined(ZECALE_SNARK_GROTH16)
+#include <libzecale/circuits/groth16_verifier/groth16_verifier_parameters.hpp>
+using wverifier = libzecale::groth16_verifier_parameters<wpp>;
+using nsnark = libzeth::groth16_snark<npp>;
+#else
+#error "ZECALE_SNARK_* variable not set to supported ZK snark"
+#endif
+
+using wsnark = typename wverifier::snark;
+
+static const size_t batch_size = 1;
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "proofs-per-worker,p",
+        po::value<size_t>(),
+        "number of proofs generated by each worker (default: 2)");
+    options.add_options()(
+        "workers,w",
+        po::value<std::vector<size_t>>()->multitoken(),
+        "numbers of workers to compare (default: all candidates)");
+
+    size_t proofs_per_worker = 2;
+    std::vector<size_t> num_workers;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("proofs-per-worker")) {
+            proofs_per_worker = vm["proofs-per-worker"].as<size_t>();
+        }
+        if (vm.count("workers")) {
+            num_workers = vm["workers"].as<std::vector<size_t>>();
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    npp::init_public_params();
+    wpp::init_public_params();
+    // The proofs are generated concurrently: the profiling of libff is not
+    // thread-safe (see prover_scheduler.hpp).
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    const libzecale::cpu_topology topology = libzecale::cpu_topology::detect();
+    std::cout << "CPUs: " << topology.num_cpus()
+              << ", NUMA nodes: " << topology.nodes.size() << std::endl;
+    if (num_workers.empty()) {
+        num_workers =
+            libzecale::prover_partition::candidate_num_workers(topology);
+    }
+
+    libzecale::
+        aggregator_circuit_wrapper<npp, wpp, nsnark, wverifier, batch_size>
+            aggregator;
+    const libsnark::protoboard<libff::Fr<wpp>> pb =
+        aggregator.get_constraint_system();
+    std::cout << "Constraints: " << pb.num_constraints() << std::endl;
+    const typename wsnark::keypair keypair =
+        aggregator.generate_trusted_setup();
+
+    // The time taken by the prover does not depend on the witness, hence we
+    // use the (unsatisfied) default witness of the constraint system.
+    std::cout << "workers\tthreads/worker\tproofs/hour" << std::endl;
+    double best_throughput = 0.0;
+    size_t best_num_workers = 0;
+    for (size_t w : num_workers) {
+        const libzecale::prover_partition partition =
+            libzecale::prover_partition::make(topology, w);
+        const double throughput = libzecale::measure_prover_throughput(
+            partition,
+            [&pb, &keypair]() { wsnark::generate_proof(pb, keypair.pk); },
+            proofs_per_worker);
+        std::cout << partition.num_workers() << "\t"
+                  << partition.threads_per_worker() << "\t" << throughput
+                  << std::endl;
+        if (throughput > best_throughput) {
+            best_throughput = throughput;
+            best_num_workers = w;
+        }
+    }
+
+    std::cout << "Best: " << best_num_workers << " worker(s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,249 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Count the heap allocations, and measure the time, of the path of a
+// transaction from the TransactionToAggregate message to the inputs of the
+// aggregator prover (the nested proofs and verification key). The path which
+// moves the parsed proof is compared against one which copies the
+// transactions as the server used to: the proof was copied into the
+// transaction, add_tx took its argument by value, std::priority_queue::top()
+// was copied out of the pool, and the nested verification key was copied for
+// each batch.
+
+#include "libzecale/core/application_pool.hpp"
+#include "libzecale/serialization/proto_utils.hpp"
+
+#include <array>
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <libzeth/snarks/groth16/groth16_api_handler.hpp>
+#include <new>
+#include <stdexcept>
+
+namespace po = boost::program_options;
+
+using ppT = libff::bls12_377_pp;
+using snark = libzeth::groth16_snark<ppT>;
+using api_handler = libzeth::groth16_api_handler<ppT>;
+using ext_proof = libzeth::extended_proof<ppT, snark>;
+using tx_type = libzecale::transaction_to_aggregate<ppT, snark>;
+
+// As in the aggregator_server
+static const size_t batch_size = 1;
+
+using pool_type = libzecale::application_pool<ppT, snark, batch_size>;
+using batch_type = std::array<tx_type, batch_size>;
+
+namespace
+{
+
+// Number of primary inputs of the nested proofs
+const size_t num_inputs = 9;
+
+std::atomic<size_t> num_allocations(0);
+std::atomic<size_t> num_allocated_bytes(0);
+
+} // namespace
+
+// Count all the allocations made through operator new (and new[], which
+// calls it).
+void *operator new(size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+namespace
+{
+
+double elapsed_us(
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end,
+    size_t num_operations)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count() /
+           (double)num_operations;
+}
+
+/// Run `ingest` on all the requests, and print the number of allocations,
+/// the allocated bytes and the time per transaction. Returns the value
+/// returned by `ingest` (which depends on the transactions, so that their
+/// copies cannot be optimized out).
+template<typename IngestT>
+uint64_t measure(
+    const std::string &name,
+    const std::vector<zecale_proto::TransactionToAggregate> &requests,
+    const snark::verification_key &vk,
+    IngestT ingest)
+{
+    pool_type pool("app", vk);
+    pool.reserve(requests.size());
+
+    const size_t allocations_before = num_allocations.load();
+    const size_t bytes_before = num_allocated_bytes.load();
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t checksum = ingest(pool, requests);
+    const auto end = std::chrono::steady_clock::now();
+    const size_t allocations = num_allocations.load() - allocations_before;
+    const size_t bytes = num_allocated_bytes.load() - bytes_before;
+
+    const double num_txs = (double)requests.size();
+    std::cout << std::left << std::setw(8) << name << std::right
+              << std::setw(16) << (double)allocations / num_txs
+              << std::setw(16) << (double)bytes / num_txs << std::setw(12)
+              << elapsed_us(start, end, requests.size()) << "\n";
+    return checksum;
+}
+
+/// Sum of the fees of the batch, and of the number of inputs of its proofs
+uint64_t batch_checksum(
+    const std::array<const ext_proof *, batch_size> &proofs,
+    const batch_type &batch,
+    const snark::verification_key &nested_vk)
+{
+    uint64_t checksum = nested_vk.ABC_g1.rest.values.size();
+    for (size_t i = 0; i < batch_size; ++i) {
+        checksum += batch[i].fee_wei() + proofs[i]->get_primary_inputs().size();
+    }
+    return checksum;
+}
+
+uint64_t ingest_by_copy(
+    pool_type &pool,
+    const std::vector<zecale_proto::TransactionToAggregate> &requests)
+{
+    for (const zecale_proto::TransactionToAggregate &request : requests) {
+        const ext_proof proof =
+            api_handler::extended_proof_from_proto(request.extended_proof());
+        const tx_type tx(
+            request.application_name(), proof, uint32_t(request.fee_in_wei()));
+        // add_tx took its argument by value
+        const tx_type tx_arg = tx;
+        pool.add_tx(tx_arg);
+    }
+
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < requests.size() / batch_size; ++i) {
+        // Copies of std::priority_queue::top()
+        const batch_type moved_batch = pool.get_next_batch();
+        const batch_type batch = moved_batch;
+        std::array<const ext_proof *, batch_size> proofs;
+        for (size_t j = 0; j < batch_size; ++j) {
+            proofs[j] = &batch[j].extended_proof();
+        }
+        const snark::verification_key nested_vk = pool.verification_key();
+        checksum += batch_checksum(proofs, batch, nested_vk);
+    }
+    return checksum;
+}
+
+uint64_t ingest_by_move(
+    pool_type &pool,
+    const std::vector<zecale_proto::TransactionToAggregate> &requests)
+{
+    for (const zecale_proto::TransactionToAggregate &request : requests) {
+        tx_type tx =
+            libzecale::transaction_to_aggregate_from_proto<ppT, api_handler>(
+                request);
+        pool.add_tx(std::move(tx));
+    }
+
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < requests.size() / batch_size; ++i) {
+        const batch_type batch = pool.get_next_batch();
+        std::array<const ext_proof *, batch_size> proofs;
+        for (size_t j = 0; j < batch_size; ++j) {
+            proofs[j] = &batch[j].extended_proof();
+        }
+        const snark::verification_key &nested_vk = pool.verification_key();
+        checksum += batch_checksum(proofs, batch, nested_vk);
+    }
+    return checksum;
+}
+
+void run_benchmark(size_t num_txs)
+{
+    std::vector<zecale_proto::TransactionToAggregate> requests(num_txs);
+    for (size_t i = 0; i < num_txs; ++i) {
+        libsnark::r1cs_gg_ppzksnark_proof<ppT> proof(
+            libff::G1<ppT>::random_element(),
+            libff::G2<ppT>::random_element(),
+            libff::G1<ppT>::random_element());
+        std::vector<libff::Fr<ppT>> inputs;
+        for (size_t j = 0; j < num_inputs; ++j) {
+            inputs.push_back(libff::Fr<ppT>::random_element());
+        }
+        requests[i].set_application_name("app");
+        requests[i].set_fee_in_wei(i);
+        api_handler::extended_proof_to_proto(
+            ext_proof(std::move(proof), std::move(inputs)),
+            requests[i].mutable_extended_proof());
+    }
+    const snark::verification_key vk =
+        libsnark::r1cs_gg_ppzksnark_verification_key<
+            ppT>::dummy_verification_key(num_inputs);
+
+    std::cout << std::fixed << std::setprecision(2) << std::left
+              << std::setw(8) << "path" << std::right << std::setw(16)
+              << "allocs / tx" << std::setw(16) << "bytes / tx"
+              << std::setw(12) << "us / tx"
+              << "\n";
+    const uint64_t copy_checksum =
+        measure("copy", requests, vk, ingest_by_copy);
+    const uint64_t move_checksum =
+        measure("move", requests, vk, ingest_by_move);
+    if (copy_checksum != move_checksum) {
+        throw std::runtime_error("the two paths produce different batches");
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "transactions,n",
+        po::value<size_t>(),
+        "number of transactions to ingest (default: 10000)");
+
+    size_t num_txs = 10000;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                      << options << std::endl;
+            return 0;
+        }
+        if (vm.count("transactions")) {
+            num_txs = vm["transactions"].as<size_t>();
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        return 1;
+    }
+
+    ppT::init_public_params();
+    libff::inhibit_profiling_info = true;
+    libff::inhibit_profiling_counters = true;
+
+    run_benchmark(num_txs);
+
+    return 0;
+}
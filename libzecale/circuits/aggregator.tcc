@@ -5,7 +5,10 @@
 #ifndef __ZECALE_CIRCUITS_AGGREGATOR_TCC__
 #define __ZECALE_CIRCUITS_AGGREGATOR_TCC__
 
+#include "libzecale/circuits/verification_key_hash.tcc"
+
 // Contains the circuits for the notes
+#include <libzeth/circuits/circuit_types.hpp>
 #include <libzeth/circuits/notes/note.hpp>
 #include <libzeth/core/joinsplit_input.hpp>
 
@@ -54,6 +57,9 @@ private:
     using proof_variable_gadget = typename wverifierT::proof_variable_gadget;
     using verification_key_variable_gadget =
         typename wverifierT::verification_key_variable_gadget;
+    using vk_hash_gadget = verification_key_hash_gadget<
+        libff::Fr<wppT>,
+        verification_key_variable_gadget>;
 
     std::array<std::shared_ptr<verifier_gadget>, NumProofs> verifiers;
 
@@ -63,6 +69,12 @@ private:
     ///
     /// The primary inputs lie in the scalar field `libff::Fr<wppT>`
     ///
+    /// Digest of the nested verification key (see `compute_nested_vk_hash`).
+    /// Exposing it as a primary input binds the proof to the VK registered
+    /// for the application, and prevents proofs against a malicious VK (one
+    /// for which the trapdoor is known).
+    libsnark::pb_variable<libff::Fr<wppT>> nested_vk_hash;
+    ///
     /// The Zeth primary inputs associated with the Zeth proofs in the witness
     /// We need to convert them to `libff::Fr<wppT>` elements so that they
     /// constitute valid values for the wires of our circuit which is defined
@@ -112,6 +124,9 @@ private:
     /// which is where we do arithmetic here
     std::shared_ptr<verification_key_variable_gadget> nested_vk;
 
+    /// Computes the digest of the nested VK into `nested_vk_hash`
+    std::shared_ptr<vk_hash_gadget> nested_vk_hasher;
+
 public:
     // Make sure that we do not exceed the number of proofs
     // specified in zeth's configuration file (see: zeth.h file)
@@ -137,6 +152,10 @@ public:
         // inputs associated with the Zeth proofs directly as elements of
         // `libff::Fr<wppT>`
         {
+            // The first primary input is the digest of the nested VK
+            nested_vk_hash.allocate(
+                pb, FMT(this->annotation_prefix, " nested_vk_hash"));
+
             // == The # of primary inputs for Zeth proofs is 9 ==
             // since the primary inputs are:
             // [Root, NullifierS (2), CommitmentS (2), h_sig, h_iS (2), Residual
@@ -161,6 +180,7 @@ public:
             }
 
             // The primary inputs are:
+            // - The digest of the nested VK
             // - The Zeth PrimaryInputs associated to the Zeth proofs in the
             // auxiliary inputs
             // - Each verification result corresponding to each Zeth proofs and
@@ -185,16 +205,15 @@ public:
             //  - Verify the `N` proofs by invoking the `N` verifiers
             //  - Hash all the primary inputs values to a value H which now
             //  becomes the only primary inputs
-            const size_t primary_input_size = NumProofs * (nb_zeth_inputs + 1);
+            const size_t primary_input_size =
+                1 + NumProofs * (nb_zeth_inputs + 1);
             pb.set_input_sizes(primary_input_size);
             // ---------------------------------------------------------------
             //
             // Allocation of the auxiliary input after the primary inputs
             // The auxiliary inputs are:
-            // - The VK to use to verify the Zeth proofs - Note, to avoid proofs
-            // generated with malicious keypair (one for which the trapdoor is
-            // known) we will need to add the "hash to the vk" as part of the
-            // primary inputs
+            // - The VK to use to verify the Zeth proofs (bound to the
+            // `nested_vk_hash` primary input)
             // - The Zeth proofs
             wZero.allocate(pb, FMT(this->annotation_prefix, " wZero"));
             // == The nested vk ==
@@ -217,6 +236,14 @@ public:
                 nb_zeth_inputs,
                 FMT(this->annotation_prefix, " nested_vk")));
 
+            // Hash the packed VK into `nested_vk_hash`
+            nested_vk_hasher.reset(new vk_hash_gadget(
+                pb,
+                *nested_vk,
+                wZero,
+                nested_vk_hash,
+                FMT(this->annotation_prefix, " nested_vk_hasher")));
+
             // Initialize the proof variable gadgets. The protoboard allocation
             // is done in the constructor `r1cs_ppzksnark_proof_variable()`
             for (size_t i = 0; i < NumProofs; i++) {
@@ -258,6 +285,9 @@ public:
         // Generate constraints for the verification key
         nested_vk->generate_r1cs_constraints(true); // ensure bitness
 
+        // Generate constraints for the digest of the verification key
+        nested_vk_hasher->generate_r1cs_constraints();
+
         // Generate constraints...
         for (size_t i = 0; i < NumProofs; i++) {
             // ... For the nested_proofs
@@ -282,6 +312,46 @@ public:
 
         // Witness the VK
         nested_vk->generate_r1cs_witness(in_nested_vk);
+        generate_r1cs_witness_vk_hash_and_proofs(in_extended_proofs);
+    }
+
+    /// Same as above, but takes the VK as bits, as returned by
+    /// `get_nested_vk_bits`. This avoids the (native) conversion of the VK
+    /// when it has been done once and cached by the caller.
+    void generate_r1cs_witness(
+        const libff::bit_vector &in_nested_vk_bits,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &in_extended_proofs)
+    {
+        this->pb.val(wZero) = libff::Fr<wppT>::zero();
+        nested_vk->generate_r1cs_witness(in_nested_vk_bits);
+        generate_r1cs_witness_vk_hash_and_proofs(in_extended_proofs);
+    }
+
+    /// Returns the bit representation of a nested VK, as used in the circuit.
+    static libff::bit_vector get_nested_vk_bits(
+        const typename nsnarkT::verification_key &vk)
+    {
+        return verification_key_variable_gadget::get_verification_key_bits(vk);
+    }
+
+    /// Compute (natively) the digest of a nested VK given as bits. This is
+    /// the value of the `nested_vk_hash` primary input.
+    static libff::Fr<wppT> compute_nested_vk_hash(
+        const libff::bit_vector &vk_bits)
+    {
+        return vk_hash_gadget::compute_hash(vk_bits);
+    }
+
+private:
+    void generate_r1cs_witness_vk_hash_and_proofs(
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &in_extended_proofs)
+    {
+        // Witness the digest of the VK
+        nested_vk_hasher->generate_r1cs_witness();
 
         // Witness...
         for (size_t i = 0; i < NumProofs; i++) {
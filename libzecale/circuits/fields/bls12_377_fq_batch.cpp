@@ -0,0 +1,656 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/circuits/fields/bls12_377_fq_batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ZECALE_FQ_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace libzecale
+{
+
+namespace
+{
+
+using Fq = libff::bls12_377_Fq;
+
+const size_t num_limbs = 6;
+
+static_assert(
+    Fq::num_limbs == num_limbs, "unexpected number of limbs for Fq");
+static_assert(
+    sizeof(mp_limb_t) == sizeof(uint64_t), "64-bit limbs are required");
+
+// The modulus q (libff::bls12_377_modulus_q), as 64-bit limbs (least
+// significant first), and -q^{-1} mod 2^64 (libff::bls12_377_Fq::inv).
+const mp_limb_t q64[num_limbs] = {0x8508c00000000001ULL,
+                                  0x170b5d4430000000ULL,
+                                  0x1ef3622fba094800ULL,
+                                  0x1a22d9f300f5138fULL,
+                                  0xc63b05c06ca1493bULL,
+                                  0x01ae3a4617c510eaULL};
+const uint64_t q_inv64 = 0x8508bfffffffffffULL;
+
+// Scalar kernel
+//
+// Montgomery multiplication with 64-bit limbs (as in libff, but with the
+// product and the reduction interleaved, and without calls to GMP). Squaring
+// uses the same code. If 128-bit integers are not available, it falls back
+// to libff.
+
+#ifdef __SIZEOF_INT128__
+
+using uint128 = unsigned __int128;
+
+/// result = t if t < q, t - q otherwise (for t < 2q).
+void scalar_reduce_once(const uint64_t *t, mp_limb_t *result)
+{
+    uint64_t d[num_limbs];
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < num_limbs; ++i) {
+        const uint128 s = (uint128)t[i] - q64[i] - borrow;
+        d[i] = (uint64_t)s;
+        borrow = (uint64_t)(s >> 64) & 1;
+    }
+
+    const uint64_t *src = borrow ? t : d;
+    for (size_t i = 0; i < num_limbs; ++i) {
+        result[i] = src[i];
+    }
+}
+
+void scalar_mul(const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *result)
+{
+    // Coarsely Integrated Operand Scanning, without the extra carry limbs:
+    // since the top limb of q is smaller than 2^62, t stays below 2q (for a,
+    // b < q) and fits in num_limbs limbs.
+    uint64_t t[num_limbs] = {0};
+    for (size_t i = 0; i < num_limbs; ++i) {
+        // t = (t + a * b[i] + m * q) / 2^64
+        uint128 s = (uint128)a[0] * b[i] + t[0];
+        uint64_t carry_ab = (uint64_t)(s >> 64);
+        const uint64_t m = (uint64_t)s * q_inv64;
+        s = (uint128)m * q64[0] + (uint64_t)s;
+        uint64_t carry_mq = (uint64_t)(s >> 64);
+        for (size_t j = 1; j < num_limbs; ++j) {
+            s = (uint128)a[j] * b[i] + t[j] + carry_ab;
+            carry_ab = (uint64_t)(s >> 64);
+            s = (uint128)m * q64[j] + (uint64_t)s + carry_mq;
+            carry_mq = (uint64_t)(s >> 64);
+            t[j - 1] = (uint64_t)s;
+        }
+        t[num_limbs - 1] = carry_ab + carry_mq;
+    }
+
+    scalar_reduce_once(t, result);
+}
+
+void scalar_batch_mul(const Fq *a, const Fq *b, Fq *result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        scalar_mul(
+            a[i].mont_repr.data, b[i].mont_repr.data, result[i].mont_repr.data);
+    }
+}
+
+void scalar_batch_square(const Fq *a, Fq *result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        scalar_mul(
+            a[i].mont_repr.data, a[i].mont_repr.data, result[i].mont_repr.data);
+    }
+}
+
+#else // __SIZEOF_INT128__
+
+void scalar_batch_mul(const Fq *a, const Fq *b, Fq *result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = a[i] * b[i];
+    }
+}
+
+void scalar_batch_square(const Fq *a, Fq *result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = a[i].squared();
+    }
+}
+
+#endif // __SIZEOF_INT128__
+
+#ifdef ZECALE_FQ_BATCH_X86
+
+// AVX2 kernel
+//
+// Each 64-bit lane holds a 32-bit limb of one of 4 elements, so that the
+// 32x32-bit products of _mm256_mul_epu32 can be accumulated together with a
+// limb and a carry without overflow. Montgomery reduction in radix 2^32 over
+// 12 limbs divides by 2^384, as libff does in radix 2^64 (Coarsely
+// Integrated Operand Scanning).
+
+#define ZECALE_TARGET_AVX2 __attribute__((target("avx2")))
+
+const size_t avx2_lanes = 4;
+const size_t avx2_limbs = 12;
+
+/// Gather the limbs of x[0], ..., x[count - 1] (in 64-bit lanes), and split
+/// them into 32-bit limbs (the lanes past count are 0).
+ZECALE_TARGET_AVX2 void avx2_load(
+    const Fq *x, size_t count, __m256i limbs[avx2_limbs])
+{
+    const long long stride = sizeof(Fq) / sizeof(mp_limb_t);
+    const __m256i index =
+        _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    const __m256i lanes = _mm256_cmpgt_epi64(
+        _mm256_set1_epi64x((long long)count), _mm256_set_epi64x(3, 2, 1, 0));
+    const __m256i mask = _mm256_set1_epi64x(0xffffffffLL);
+    for (size_t i = 0; i < num_limbs; ++i) {
+        const __m256i word = _mm256_mask_i64gather_epi64(
+            _mm256_setzero_si256(),
+            (const long long *)(x->mont_repr.data + i),
+            index,
+            lanes,
+            8);
+        limbs[2 * i] = _mm256_and_si256(word, mask);
+        limbs[2 * i + 1] = _mm256_srli_epi64(word, 32);
+    }
+}
+
+ZECALE_TARGET_AVX2 void avx2_store(
+    const __m256i limbs[avx2_limbs], size_t count, Fq *x)
+{
+    alignas(32) uint64_t buffer[avx2_limbs][avx2_lanes];
+    for (size_t i = 0; i < avx2_limbs; ++i) {
+        _mm256_store_si256((__m256i *)buffer[i], limbs[i]);
+    }
+    for (size_t lane = 0; lane < count; ++lane) {
+        mp_limb_t *data = x[lane].mont_repr.data;
+        for (size_t i = 0; i < num_limbs; ++i) {
+            data[i] = buffer[2 * i][lane] | (buffer[2 * i + 1][lane] << 32);
+        }
+    }
+}
+
+/// The limbs of q (broadcast to all lanes).
+ZECALE_TARGET_AVX2 void avx2_modulus(__m256i q[avx2_limbs])
+{
+    for (size_t i = 0; i < num_limbs; ++i) {
+        q[2 * i] = _mm256_set1_epi64x((long long)(q64[i] & 0xffffffff));
+        q[2 * i + 1] = _mm256_set1_epi64x((long long)(q64[i] >> 32));
+    }
+}
+
+ZECALE_TARGET_AVX2 void avx2_mul(
+    const __m256i q[avx2_limbs],
+    const __m256i a[avx2_limbs],
+    const __m256i b[avx2_limbs],
+    __m256i result[avx2_limbs])
+{
+    const __m256i mask = _mm256_set1_epi64x(0xffffffffLL);
+    const __m256i inv = _mm256_set1_epi64x((long long)(q_inv64 & 0xffffffff));
+    __m256i t[avx2_limbs + 2];
+    for (size_t i = 0; i < avx2_limbs + 2; ++i) {
+        t[i] = _mm256_setzero_si256();
+    }
+
+    for (size_t i = 0; i < avx2_limbs; ++i) {
+        // t += a * b[i]
+        __m256i carry = _mm256_setzero_si256();
+        for (size_t j = 0; j < avx2_limbs; ++j) {
+            const __m256i s = _mm256_add_epi64(
+                _mm256_add_epi64(_mm256_mul_epu32(a[j], b[i]), t[j]), carry);
+            t[j] = _mm256_and_si256(s, mask);
+            carry = _mm256_srli_epi64(s, 32);
+        }
+        __m256i s = _mm256_add_epi64(t[avx2_limbs], carry);
+        t[avx2_limbs] = _mm256_and_si256(s, mask);
+        t[avx2_limbs + 1] = _mm256_srli_epi64(s, 32);
+
+        // t = (t + m * q) / 2^32, where m = -t * q^{-1} mod 2^32
+        // (_mm256_mul_epu32 only reads the low 32 bits of m).
+        const __m256i m = _mm256_mul_epu32(t[0], inv);
+        s = _mm256_add_epi64(_mm256_mul_epu32(m, q[0]), t[0]);
+        carry = _mm256_srli_epi64(s, 32);
+        for (size_t j = 1; j < avx2_limbs; ++j) {
+            s = _mm256_add_epi64(
+                _mm256_add_epi64(_mm256_mul_epu32(m, q[j]), t[j]), carry);
+            t[j - 1] = _mm256_and_si256(s, mask);
+            carry = _mm256_srli_epi64(s, 32);
+        }
+        s = _mm256_add_epi64(t[avx2_limbs], carry);
+        t[avx2_limbs - 1] = _mm256_and_si256(s, mask);
+        t[avx2_limbs] =
+            _mm256_add_epi64(t[avx2_limbs + 1], _mm256_srli_epi64(s, 32));
+    }
+
+    // t < 2q: subtract q from the lanes where t >= q (i.e. where the
+    // subtraction does not borrow).
+    __m256i d[avx2_limbs];
+    __m256i borrow = _mm256_setzero_si256();
+    for (size_t i = 0; i < avx2_limbs; ++i) {
+        const __m256i s =
+            _mm256_sub_epi64(_mm256_sub_epi64(t[i], q[i]), borrow);
+        d[i] = _mm256_and_si256(s, mask);
+        borrow = _mm256_srli_epi64(s, 63);
+    }
+    const __m256i t_ge_q = _mm256_cmpeq_epi64(borrow, _mm256_setzero_si256());
+    for (size_t i = 0; i < avx2_limbs; ++i) {
+        result[i] = _mm256_blendv_epi8(t[i], d[i], t_ge_q);
+    }
+}
+
+ZECALE_TARGET_AVX2 void avx2_batch_mul(
+    const Fq *a, const Fq *b, Fq *result, size_t n)
+{
+    __m256i q[avx2_limbs];
+    avx2_modulus(q);
+    __m256i a_limbs[avx2_limbs];
+    __m256i b_limbs[avx2_limbs];
+    __m256i result_limbs[avx2_limbs];
+    for (size_t offset = 0; offset < n; offset += avx2_lanes) {
+        const size_t count = std::min(avx2_lanes, n - offset);
+        avx2_load(a + offset, count, a_limbs);
+        avx2_load(b + offset, count, b_limbs);
+        avx2_mul(q, a_limbs, b_limbs, result_limbs);
+        avx2_store(result_limbs, count, result + offset);
+    }
+}
+
+ZECALE_TARGET_AVX2 void avx2_batch_square(const Fq *a, Fq *result, size_t n)
+{
+    __m256i q[avx2_limbs];
+    avx2_modulus(q);
+    __m256i a_limbs[avx2_limbs];
+    __m256i result_limbs[avx2_limbs];
+    for (size_t offset = 0; offset < n; offset += avx2_lanes) {
+        const size_t count = std::min(avx2_lanes, n - offset);
+        avx2_load(a + offset, count, a_limbs);
+        avx2_mul(q, a_limbs, a_limbs, result_limbs);
+        avx2_store(result_limbs, count, result + offset);
+    }
+}
+
+// AVX-512 IFMA kernel
+//
+// Each 64-bit lane holds a 52-bit limb of one of 8 elements. The products
+// (computed by _mm512_madd52lo_epu64 and _mm512_madd52hi_epu64) are
+// accumulated without carry propagation, and then reduced. Since 384 is not
+// a multiple of 52, the Montgomery reduction is made of 7 steps of 52 bits
+// and a last step of 20 bits.
+
+#define ZECALE_TARGET_AVX512_IFMA                                              \
+    __attribute__((target("avx512f,avx512ifma")))
+
+const size_t avx512_lanes = 8;
+const size_t avx512_limbs = 8;
+const uint64_t mask52 = (1ULL << 52) - 1;
+
+// Logical shifts of each lane. The masked versions of the intrinsics are used
+// since _mm512_srli_epi64 and _mm512_slli_epi64 trigger spurious
+// -Wuninitialized warnings with some versions of GCC.
+
+ZECALE_TARGET_AVX512_IFMA inline __m512i avx512_srli(__m512i x, unsigned shift)
+{
+    return _mm512_maskz_srli_epi64(0xff, x, shift);
+}
+
+ZECALE_TARGET_AVX512_IFMA inline __m512i avx512_slli(__m512i x, unsigned shift)
+{
+    return _mm512_maskz_slli_epi64(0xff, x, shift);
+}
+
+/// Split the 64-bit limbs of x < 2^384 into 52-bit limbs.
+void to_limbs52(const mp_limb_t *x, uint64_t limbs[avx512_limbs])
+{
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        const size_t word = 52 * i / 64;
+        const size_t offset = 52 * i % 64;
+        uint64_t limb = x[word] >> offset;
+        if (offset > 12 && word + 1 < num_limbs) {
+            limb |= x[word + 1] << (64 - offset);
+        }
+        limbs[i] = limb & mask52;
+    }
+}
+
+/// The offset (in limbs) of the elements x[0], ..., x[7] from x[0].
+ZECALE_TARGET_AVX512_IFMA __m512i avx512_lane_index()
+{
+    const long long stride = sizeof(Fq) / sizeof(mp_limb_t);
+    return _mm512_set_epi64(
+        7 * stride,
+        6 * stride,
+        5 * stride,
+        4 * stride,
+        3 * stride,
+        2 * stride,
+        stride,
+        0);
+}
+
+/// Gather the limbs of x[0], ..., x[count - 1] (in 64-bit lanes), and split
+/// them into 52-bit limbs (the lanes past count are 0).
+ZECALE_TARGET_AVX512_IFMA void avx512_load(
+    const Fq *x, size_t count, __m512i limbs[avx512_limbs])
+{
+    const __mmask8 lanes = (__mmask8)((1u << count) - 1);
+    const __m512i index = avx512_lane_index();
+    __m512i words[num_limbs];
+    for (size_t i = 0; i < num_limbs; ++i) {
+        words[i] = _mm512_mask_i64gather_epi64(
+            _mm512_setzero_si512(),
+            lanes,
+            index,
+            (const void *)(x->mont_repr.data + i),
+            8);
+    }
+
+    const __m512i mask = _mm512_set1_epi64((long long)mask52);
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        const size_t word = 52 * i / 64;
+        const size_t offset = 52 * i % 64;
+        __m512i limb = avx512_srli(words[word], offset);
+        if (offset > 12 && word + 1 < num_limbs) {
+            limb = _mm512_or_si512(
+                limb, avx512_slli(words[word + 1], 64 - offset));
+        }
+        limbs[i] = _mm512_and_si512(limb, mask);
+    }
+}
+
+/// Inverse of avx512_load (the limbs must be normalised, i.e. < 2^52).
+ZECALE_TARGET_AVX512_IFMA void avx512_store(
+    const __m512i limbs[avx512_limbs], size_t count, Fq *x)
+{
+    __m512i words[num_limbs];
+    for (size_t i = 0; i < num_limbs; ++i) {
+        words[i] = _mm512_setzero_si512();
+    }
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        const size_t word = 52 * i / 64;
+        const size_t offset = 52 * i % 64;
+        words[word] =
+            _mm512_or_si512(words[word], avx512_slli(limbs[i], offset));
+        if (offset > 12 && word + 1 < num_limbs) {
+            words[word + 1] = _mm512_or_si512(
+                words[word + 1], avx512_srli(limbs[i], 64 - offset));
+        }
+    }
+
+    const __mmask8 lanes = (__mmask8)((1u << count) - 1);
+    const __m512i index = avx512_lane_index();
+    for (size_t i = 0; i < num_limbs; ++i) {
+        _mm512_mask_i64scatter_epi64(
+            (void *)(x->mont_repr.data + i), lanes, index, words[i], 8);
+    }
+}
+
+/// The limbs of q (broadcast to all lanes).
+ZECALE_TARGET_AVX512_IFMA void avx512_modulus(__m512i q[avx512_limbs])
+{
+    uint64_t q_limbs[avx512_limbs];
+    to_limbs52(q64, q_limbs);
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        q[i] = _mm512_set1_epi64((long long)q_limbs[i]);
+    }
+}
+
+/// result = t / 2^384 mod q, where t is given by 2 * avx512_limbs
+/// (unnormalised) columns t[k] of weight 2^(52 * k), and t < q * 2^384. t is
+/// overwritten.
+ZECALE_TARGET_AVX512_IFMA void avx512_montgomery_reduce(
+    const __m512i q[avx512_limbs],
+    __m512i t[2 * avx512_limbs],
+    __m512i result[avx512_limbs])
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask = _mm512_set1_epi64((long long)mask52);
+    const __m512i inv = _mm512_set1_epi64((long long)(q_inv64 & mask52));
+
+    // 7 steps of 52 bits. At step k, the columns below k are 0 and t[k]
+    // holds the carry of t[k-1], so that m = -t * q^{-1} mod 2^52 only
+    // depends on t[k] (_mm512_madd52lo_epu64 reads the low 52 bits of its
+    // operands).
+    for (size_t k = 0; k < avx512_limbs - 1; ++k) {
+        const __m512i m = _mm512_madd52lo_epu64(zero, t[k], inv);
+        for (size_t j = 0; j < avx512_limbs; ++j) {
+            t[k + j] = _mm512_madd52lo_epu64(t[k + j], m, q[j]);
+            t[k + j + 1] = _mm512_madd52hi_epu64(t[k + j + 1], m, q[j]);
+        }
+        t[k + 1] = _mm512_add_epi64(t[k + 1], avx512_srli(t[k], 52));
+    }
+
+    // Last step of 20 bits (52 * 7 + 20 = 384)
+    const size_t base = avx512_limbs - 1;
+    const __m512i m = _mm512_and_si512(
+        _mm512_madd52lo_epu64(zero, t[base], inv),
+        _mm512_set1_epi64((1LL << 20) - 1));
+    for (size_t j = 0; j < avx512_limbs; ++j) {
+        t[base + j] = _mm512_madd52lo_epu64(t[base + j], m, q[j]);
+        t[base + j + 1] = _mm512_madd52hi_epu64(t[base + j + 1], m, q[j]);
+    }
+
+    // Normalise the limbs of t / 2^364 (< 2q * 2^20 < 2^416, so that the
+    // last column is 0), and shift them by 20 bits.
+    for (size_t k = base; k < 2 * avx512_limbs - 1; ++k) {
+        t[k + 1] = _mm512_add_epi64(t[k + 1], avx512_srli(t[k], 52));
+        t[k] = _mm512_and_si512(t[k], mask);
+    }
+    __m512i r[avx512_limbs];
+    for (size_t i = 0; i < avx512_limbs - 1; ++i) {
+        r[i] = _mm512_or_si512(
+            avx512_srli(t[base + i], 20),
+            _mm512_and_si512(avx512_slli(t[base + i + 1], 32), mask));
+    }
+    r[avx512_limbs - 1] = avx512_srli(t[2 * avx512_limbs - 2], 20);
+
+    // r < 2q: subtract q from the lanes where r >= q.
+    __m512i d[avx512_limbs];
+    __m512i borrow = zero;
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        const __m512i s =
+            _mm512_sub_epi64(_mm512_sub_epi64(r[i], q[i]), borrow);
+        d[i] = _mm512_and_si512(s, mask);
+        borrow = avx512_srli(s, 63);
+    }
+    const __mmask8 r_ge_q = _mm512_cmpeq_epi64_mask(borrow, zero);
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        result[i] = _mm512_mask_blend_epi64(r_ge_q, r[i], d[i]);
+    }
+}
+
+ZECALE_TARGET_AVX512_IFMA void avx512_mul(
+    const __m512i q[avx512_limbs],
+    const __m512i a[avx512_limbs],
+    const __m512i b[avx512_limbs],
+    __m512i result[avx512_limbs])
+{
+    __m512i t[2 * avx512_limbs];
+    for (size_t k = 0; k < 2 * avx512_limbs; ++k) {
+        t[k] = _mm512_setzero_si512();
+    }
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        for (size_t j = 0; j < avx512_limbs; ++j) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], b[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], b[j]);
+        }
+    }
+
+    avx512_montgomery_reduce(q, t, result);
+}
+
+ZECALE_TARGET_AVX512_IFMA void avx512_square(
+    const __m512i q[avx512_limbs],
+    const __m512i a[avx512_limbs],
+    __m512i result[avx512_limbs])
+{
+    // Products a[i] * a[j] for i < j, doubled, and the squares a[i]^2
+    __m512i t[2 * avx512_limbs];
+    for (size_t k = 0; k < 2 * avx512_limbs; ++k) {
+        t[k] = _mm512_setzero_si512();
+    }
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        for (size_t j = i + 1; j < avx512_limbs; ++j) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], a[i], a[j]);
+            t[i + j + 1] = _mm512_madd52hi_epu64(t[i + j + 1], a[i], a[j]);
+        }
+    }
+    for (size_t k = 0; k < 2 * avx512_limbs; ++k) {
+        t[k] = _mm512_add_epi64(t[k], t[k]);
+    }
+    for (size_t i = 0; i < avx512_limbs; ++i) {
+        t[2 * i] = _mm512_madd52lo_epu64(t[2 * i], a[i], a[i]);
+        t[2 * i + 1] = _mm512_madd52hi_epu64(t[2 * i + 1], a[i], a[i]);
+    }
+
+    avx512_montgomery_reduce(q, t, result);
+}
+
+ZECALE_TARGET_AVX512_IFMA void avx512_batch_mul(
+    const Fq *a, const Fq *b, Fq *result, size_t n)
+{
+    __m512i q[avx512_limbs];
+    avx512_modulus(q);
+    __m512i a_limbs[avx512_limbs];
+    __m512i b_limbs[avx512_limbs];
+    __m512i result_limbs[avx512_limbs];
+    for (size_t offset = 0; offset < n; offset += avx512_lanes) {
+        const size_t count = std::min(avx512_lanes, n - offset);
+        avx512_load(a + offset, count, a_limbs);
+        avx512_load(b + offset, count, b_limbs);
+        avx512_mul(q, a_limbs, b_limbs, result_limbs);
+        avx512_store(result_limbs, count, result + offset);
+    }
+}
+
+ZECALE_TARGET_AVX512_IFMA void avx512_batch_square(
+    const Fq *a, Fq *result, size_t n)
+{
+    __m512i q[avx512_limbs];
+    avx512_modulus(q);
+    __m512i a_limbs[avx512_limbs];
+    __m512i result_limbs[avx512_limbs];
+    for (size_t offset = 0; offset < n; offset += avx512_lanes) {
+        const size_t count = std::min(avx512_lanes, n - offset);
+        avx512_load(a + offset, count, a_limbs);
+        avx512_square(q, a_limbs, result_limbs);
+        avx512_store(result_limbs, count, result + offset);
+    }
+}
+
+#endif // ZECALE_FQ_BATCH_X86
+
+fq_batch_kernel detect_kernel()
+{
+    if (fq_batch_kernel_is_supported(fq_batch_kernel::avx512_ifma)) {
+        return fq_batch_kernel::avx512_ifma;
+    }
+    if (fq_batch_kernel_is_supported(fq_batch_kernel::avx2)) {
+        return fq_batch_kernel::avx2;
+    }
+    return fq_batch_kernel::scalar;
+}
+
+void check_supported(fq_batch_kernel kernel)
+{
+    if (!fq_batch_kernel_is_supported(kernel)) {
+        throw std::invalid_argument(
+            std::string("unsupported Fq batch kernel: ") +
+            fq_batch_kernel_name(kernel));
+    }
+}
+
+} // namespace
+
+const char *fq_batch_kernel_name(fq_batch_kernel kernel)
+{
+    switch (kernel) {
+    case fq_batch_kernel::scalar:
+        return "scalar";
+    case fq_batch_kernel::avx2:
+        return "avx2";
+    case fq_batch_kernel::avx512_ifma:
+        return "avx512_ifma";
+    }
+    return "unknown";
+}
+
+bool fq_batch_kernel_is_supported(fq_batch_kernel kernel)
+{
+    switch (kernel) {
+    case fq_batch_kernel::scalar:
+        return true;
+#ifdef ZECALE_FQ_BATCH_X86
+    case fq_batch_kernel::avx2:
+        return __builtin_cpu_supports("avx2");
+    case fq_batch_kernel::avx512_ifma:
+        return __builtin_cpu_supports("avx512f") &&
+               __builtin_cpu_supports("avx512ifma");
+#endif
+    default:
+        return false;
+    }
+}
+
+fq_batch_kernel fq_batch_kernel_default()
+{
+    static const fq_batch_kernel kernel = detect_kernel();
+    return kernel;
+}
+
+void bls12_377_fq_batch_mul(
+    const Fq *a, const Fq *b, Fq *result, size_t n, fq_batch_kernel kernel)
+{
+    check_supported(kernel);
+    switch (kernel) {
+#ifdef ZECALE_FQ_BATCH_X86
+    case fq_batch_kernel::avx2:
+        avx2_batch_mul(a, b, result, n);
+        return;
+    case fq_batch_kernel::avx512_ifma:
+        avx512_batch_mul(a, b, result, n);
+        return;
+#endif
+    default:
+        scalar_batch_mul(a, b, result, n);
+        return;
+    }
+}
+
+void bls12_377_fq_batch_square(
+    const Fq *a, Fq *result, size_t n, fq_batch_kernel kernel)
+{
+    check_supported(kernel);
+    switch (kernel) {
+#ifdef ZECALE_FQ_BATCH_X86
+    case fq_batch_kernel::avx2:
+        avx2_batch_square(a, result, n);
+        return;
+    case fq_batch_kernel::avx512_ifma:
+        avx512_batch_square(a, result, n);
+        return;
+#endif
+    default:
+        scalar_batch_square(a, result, n);
+        return;
+    }
+}
+
+std::vector<Fq> fp_batch_mul(const std::vector<Fq> &a, const std::vector<Fq> &b)
+{
+    std::vector<Fq> result(a.size());
+    bls12_377_fq_batch_mul(
+        a.data(), b.data(), result.data(), a.size(), fq_batch_kernel::scalar);
+    return result;
+}
+
+} // namespace libzecale
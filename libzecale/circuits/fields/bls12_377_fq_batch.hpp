@@ -0,0 +1,70 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_BLS12_377_FQ_BATCH_HPP__
+#define __ZECALE_CIRCUITS_FIELDS_BLS12_377_FQ_BATCH_HPP__
+
+#include <cstddef>
+#include <libff/algebra/curves/bls12_377/bls12_377_init.hpp>
+#include <vector>
+
+namespace libzecale
+{
+
+/// Implementations of the batch Montgomery multiplication in the base field
+/// Fq of BLS12-377. Fq is also the scalar field of BW6-761, so that all the
+/// witness arithmetic of the BLS12-377 pairing gadgets takes place in Fq.
+///
+/// Elements are in Montgomery form (with R = 2^384), using the same
+/// representation as libff::bls12_377_Fq, and all kernels return exactly the
+/// same (fully reduced) values as libff's `operator*`.
+enum class fq_batch_kernel {
+    /// Portable: 64-bit limbs and 128-bit products, one element at a time.
+    scalar,
+    /// AVX2: 4 elements at a time, as 12 32-bit limbs in 64-bit lanes.
+    avx2,
+    /// AVX-512 IFMA: 8 elements at a time, as 8 52-bit limbs.
+    avx512_ifma,
+};
+
+/// The name of a kernel ("scalar", "avx2" or "avx512_ifma").
+const char *fq_batch_kernel_name(fq_batch_kernel kernel);
+
+/// Whether the kernel is compiled in, and supported by the CPU.
+bool fq_batch_kernel_is_supported(fq_batch_kernel kernel);
+
+/// The kernel used by default, i.e. the fastest one supported by the CPU
+/// (detected on the first call).
+fq_batch_kernel fq_batch_kernel_default();
+
+/// result[i] = a[i] * b[i], for 0 <= i < n. `result` may alias `a` or `b`.
+/// Throws if `kernel` is not supported.
+void bls12_377_fq_batch_mul(
+    const libff::bls12_377_Fq *a,
+    const libff::bls12_377_Fq *b,
+    libff::bls12_377_Fq *result,
+    size_t n,
+    fq_batch_kernel kernel = fq_batch_kernel_default());
+
+/// result[i] = a[i]^2, for 0 <= i < n. `result` may alias `a`. Throws if
+/// `kernel` is not supported.
+void bls12_377_fq_batch_square(
+    const libff::bls12_377_Fq *a,
+    libff::bls12_377_Fq *result,
+    size_t n,
+    fq_batch_kernel kernel = fq_batch_kernel_default());
+
+/// Overload of fp_batch_mul (see fp2_native_witness.hpp) for Fq, using the
+/// scalar kernel. The batches of the witness generation stay within one Fp6
+/// or Fp12 operation (5, 6, 9, 11, 21 or 36 elements), which is too small
+/// for the SIMD kernels to make up for the conversion of their inputs and
+/// outputs, and for their unused lanes. The SIMD kernels are for callers
+/// with large batches (see benchmarks/bls12_377_fq_batch_mul_benchmark.cpp).
+std::vector<libff::bls12_377_Fq> fp_batch_mul(
+    const std::vector<libff::bls12_377_Fq> &a,
+    const std::vector<libff::bls12_377_Fq> &b);
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_FIELDS_BLS12_377_FQ_BATCH_HPP__
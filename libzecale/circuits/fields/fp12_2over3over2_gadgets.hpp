@@ -11,6 +11,7 @@
 #ifndef __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_GADGETS_HPP__
 #define __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_GADGETS_HPP__
 
+#include "libzecale/circuits/fields/fp2_lean_gadgets.hpp"
 #include "libzecale/circuits/fields/fp6_3over2_gadgets.hpp"
 
 namespace libzecale
@@ -117,6 +118,12 @@ public:
     const Fp12_2over3over2_variable<Fp12T> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the value a of A (which is
+    /// not read from the protoboard), and return the value of the result.
+    /// The same holds for the generate_r1cs_witness_native() methods of the
+    /// other gadgets below.
+    Fp12T generate_r1cs_witness_native(const Fp12T &a);
 };
 
 /// Optimal multiplication in Fp12 of z = ((z0, z1, z2), (z3, z4, z5)), by some
@@ -182,6 +189,80 @@ public:
     void generate_r1cs_witness();
 };
 
+/// Multiplication in Fp12 of two sparse elements x = ((x0, 0, x2), (0, x4, 0))
+/// and y = ((y0, 0, y2), (0, y4, 0)) (such as two line evaluations in a Miller
+/// loop). Writing x = X0 + X1 * w, with X0 = x0 + x2 * v^2, X1 = x4 * v, and
+/// v^3 = non_residue:
+///
+///   x * y = ((x0*y0 + non_residue * x4*y4,
+///             non_residue * x2*y2,
+///             x0*y2 + x2*y0),
+///            (non_residue * (x2*y4 + x4*y2),
+///             x0*y4 + x4*y0,
+///             0))
+///
+/// which requires 6 multiplications in Fp2 (using Karatsuba for the cross
+/// terms), against 13 for Fp12_2over3over2_mul_by_024_gadget. The result is
+/// allocated by the gadget, with its last component set to the constant 0.
+template<typename Fp12T>
+class Fp12_2over3over2_mul_024_by_024_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+    using Fp2T = typename Fp12T::my_Fp2;
+
+    libsnark::Fp2_variable<Fp2T> _X_0;
+    libsnark::Fp2_variable<Fp2T> _X_2;
+    libsnark::Fp2_variable<Fp2T> _X_4;
+    libsnark::Fp2_variable<Fp2T> _Y_0;
+    libsnark::Fp2_variable<Fp2T> _Y_2;
+    libsnark::Fp2_variable<Fp2T> _Y_4;
+
+    // No variable is allocated for the products with a constant operand
+    // (e.g. x0*y0 when one line function comes from a constant G2
+    // precomputation).
+    Fp2_lean_mul_gadget<Fp2T> _compute_x0_y0;
+    Fp2_lean_mul_gadget<Fp2T> _compute_x2_y2;
+    Fp2_lean_mul_gadget<Fp2T> _compute_x4_y4;
+
+    Fp12_2over3over2_variable<Fp12T> _result;
+
+    // out_z2 = x0*y2 + x2*y0
+    // => (x0 + x2)*(y0 + y2) = out_z2 + x0*y0 + x2*y2
+    libsnark::Fp2_mul_gadget<Fp2T> _compute_x02_y02;
+
+    // out_z3 = non_residue * (x2*y4 + x4*y2)
+    // => (x2 + x4)*(y2 + y4) = out_z3 / non_residue + x2*y2 + x4*y4
+    libsnark::Fp2_mul_gadget<Fp2T> _compute_x24_y24;
+
+    // out_z4 = x0*y4 + x4*y0
+    // => (x0 + x4)*(y0 + y4) = out_z4 + x0*y0 + x4*y4
+    libsnark::Fp2_mul_gadget<Fp2T> _compute_x04_y04;
+
+    Fp12_2over3over2_mul_024_by_024_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &X_0,
+        const libsnark::Fp2_variable<Fp2T> &X_2,
+        const libsnark::Fp2_variable<Fp2T> &X_4,
+        const libsnark::Fp2_variable<Fp2T> &Y_0,
+        const libsnark::Fp2_variable<Fp2T> &Y_2,
+        const libsnark::Fp2_variable<Fp2T> &Y_4,
+        const std::string &annotation_prefix);
+
+    const Fp12_2over3over2_variable<Fp12T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(
+        const Fp2T &x0,
+        const Fp2T &x2,
+        const Fp2T &x4,
+        const Fp2T &y0,
+        const Fp2T &y2,
+        const Fp2T &y4);
+};
+
 /// Full multiplication of Fp12 variables.
 template<typename Fp12T>
 class Fp12_2over3over2_mul_gadget
@@ -207,6 +288,7 @@ public:
     const Fp12_2over3over2_variable<Fp12T> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp12T &a, const Fp12T &b);
 };
 
 /// Inverse of Fp12 variable
@@ -231,8 +313,85 @@ public:
     const Fp12_2over3over2_variable<Fp12T> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp12T &a);
 };
 
+/// Full multiplication of Fp12 variables by interpolation (Toom-6), viewing
+/// Fp12 as Fp2[w] / (w^6 - non_residue), where
+///   z = (z0, z1, z2), (z3, z4, z5)
+///     = z0 + z3 * w + z1 * w^2 + z4 * w^3 + z2 * w^4 + z5 * w^5.
+/// Uses 11 multiplications in Fp2 (33 constraints), against 18 (54
+/// constraints) for Fp12_2over3over2_mul_gadget. See
+/// Fp2_polynomial_mul_gadget.
+template<typename Fp12T>
+class Fp12_2over3over2_toom6_mul_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp2T = typename Fp12T::my_Fp2;
+
+    Fp12_2over3over2_variable<Fp12T> _A;
+    Fp12_2over3over2_variable<Fp12T> _B;
+    Fp12_2over3over2_variable<Fp12T> _result;
+    Fp2_polynomial_mul_gadget<Fp2T> _compute_product;
+
+    Fp12_2over3over2_toom6_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp12_2over3over2_variable<Fp12T> &A,
+        const Fp12_2over3over2_variable<Fp12T> &B,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix);
+    const Fp12_2over3over2_variable<Fp12T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp12T &a, const Fp12T &b);
+};
+
+/// Squaring of Fp12 variables by interpolation, using 11 squarings in Fp2 (22
+/// constraints, against 36 for Fp12_2over3over2_square_gadget). For elements
+/// of the cyclotomic subgroup, Fp12_2over3over2_cyclotomic_square_gadget is
+/// cheaper.
+template<typename Fp12T>
+class Fp12_2over3over2_toom6_square_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp2T = typename Fp12T::my_Fp2;
+
+    Fp12_2over3over2_variable<Fp12T> _A;
+    Fp12_2over3over2_variable<Fp12T> _result;
+    Fp2_polynomial_mul_gadget<Fp2T> _compute_square;
+
+    Fp12_2over3over2_toom6_square_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp12_2over3over2_variable<Fp12T> &A,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix);
+    const Fp12_2over3over2_variable<Fp12T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp12T &a);
+};
+
+/// The coefficients of an Fp12 variable in Fp2, in order of increasing power
+/// of w.
+template<typename Fp12T>
+std::vector<libsnark::Fp2_variable<typename Fp12T::my_Fp2>> fp12_coefficients(
+    const Fp12_2over3over2_variable<Fp12T> &el);
+
+/// The coefficients of an Fp12 element in Fp2, in the order of
+/// fp12_coefficients.
+template<typename Fp12T>
+std::vector<typename Fp12T::my_Fp2> fp12_coefficient_values(const Fp12T &el);
+
+/// The Fp12 element with the given coefficients, in the order of
+/// fp12_coefficients.
+template<typename Fp12T>
+Fp12T fp12_from_coefficient_values(
+    const std::vector<typename Fp12T::my_Fp2> &coeffs);
+
 template<typename Fp12T>
 class Fp12_2over3over2_cyclotomic_square_gadget
     : public libsnark::gadget<typename Fp12T::my_Fp>
@@ -294,6 +453,7 @@ public:
     const Fp12_2over3over2_variable<Fp12T> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp12T &a);
 };
 
 } // namespace libzecale
@@ -181,6 +181,21 @@ void Fp12_2over3over2_square_gadget<Fp12T>::generate_r1cs_witness()
     _compute_beta.generate_r1cs_witness();
 }
 
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_square_gadget<Fp12T>::generate_r1cs_witness_native(
+    const Fp12T &a)
+{
+    const Fp6T &a0 = a.coeffs[0];
+    const Fp6T &a1 = a.coeffs[1];
+    const Fp6T alpha = _compute_alpha.generate_r1cs_witness_native(a0, a1);
+    const Fp6T beta = _compute_beta.generate_r1cs_witness_native(
+        a0 + a1, a0 + Fp12T::mul_by_non_residue(a1));
+    const Fp12T result(
+        beta - Fp12T::mul_by_non_residue(alpha) - alpha, alpha + alpha);
+    _result.generate_r1cs_witness(result);
+    return result;
+}
+
 // Fp12_2over3over2_mul_by_024_gadget methods
 
 template<typename Fp12T>
@@ -416,6 +431,180 @@ void Fp12_2over3over2_mul_by_024_gadget<Fp12T>::generate_r1cs_witness()
     _compute_out_z5_plus_S.generate_r1cs_witness();
 }
 
+// Fp12_2over3over2_mul_024_by_024_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_mul_024_by_024_gadget<Fp12T>::
+    Fp12_2over3over2_mul_024_by_024_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &X_0,
+        const libsnark::Fp2_variable<Fp2T> &X_2,
+        const libsnark::Fp2_variable<Fp2T> &X_4,
+        const libsnark::Fp2_variable<Fp2T> &Y_0,
+        const libsnark::Fp2_variable<Fp2T> &Y_2,
+        const libsnark::Fp2_variable<Fp2T> &Y_4,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _X_0(X_0)
+    , _X_2(X_2)
+    , _X_4(X_4)
+    , _Y_0(Y_0)
+    , _Y_2(Y_2)
+    , _Y_4(Y_4)
+    , _compute_x0_y0(
+          pb, X_0, Y_0, FMT(annotation_prefix, " _compute_x0_y0"))
+    , _compute_x2_y2(
+          pb, X_2, Y_2, FMT(annotation_prefix, " _compute_x2_y2"))
+    , _compute_x4_y4(
+          pb, X_4, Y_4, FMT(annotation_prefix, " _compute_x4_y4"))
+    // out_z0 = x0*y0 + non_residue * x4*y4
+    // out_z1 = non_residue * x2*y2
+    // out_z5 = 0
+    , _result(
+          pb,
+          Fp6_3over2_variable<Fp6T>(
+              pb,
+              _compute_x0_y0.result +
+                  _compute_x4_y4.result * Fp6T::non_residue,
+              _compute_x2_y2.result * Fp6T::non_residue,
+              libsnark::Fp2_variable<Fp2T>(
+                  pb, FMT(annotation_prefix, " out_z2")),
+              FMT(annotation_prefix, " out_c0")),
+          Fp6_3over2_variable<Fp6T>(
+              pb,
+              libsnark::Fp2_variable<Fp2T>(
+                  pb, FMT(annotation_prefix, " out_z3")),
+              libsnark::Fp2_variable<Fp2T>(
+                  pb, FMT(annotation_prefix, " out_z4")),
+              libsnark::Fp2_variable<Fp2T>(
+                  pb, Fp2T::zero(), FMT(annotation_prefix, " out_z5")),
+              FMT(annotation_prefix, " out_c1")),
+          FMT(annotation_prefix, " result"))
+    // out_z2 = x0*y2 + x2*y0
+    // => (x0 + x2)*(y0 + y2) = out_z2 + x0*y0 + x2*y2
+    , _compute_x02_y02(
+          pb,
+          X_0 + X_2,
+          Y_0 + Y_2,
+          _result._c0._c2 + _compute_x0_y0.result + _compute_x2_y2.result,
+          FMT(annotation_prefix, " _compute_x02_y02"))
+    // out_z3 = non_residue * (x2*y4 + x4*y2)
+    // => (x2 + x4)*(y2 + y4) = out_z3 / non_residue + x2*y2 + x4*y4
+    , _compute_x24_y24(
+          pb,
+          X_2 + X_4,
+          Y_2 + Y_4,
+          _result._c1._c0 * Fp6T::non_residue.inverse() +
+              _compute_x2_y2.result + _compute_x4_y4.result,
+          FMT(annotation_prefix, " _compute_x24_y24"))
+    // out_z4 = x0*y4 + x4*y0
+    // => (x0 + x4)*(y0 + y4) = out_z4 + x0*y0 + x4*y4
+    , _compute_x04_y04(
+          pb,
+          X_0 + X_4,
+          Y_0 + Y_4,
+          _result._c1._c1 + _compute_x0_y0.result + _compute_x4_y4.result,
+          FMT(annotation_prefix, " _compute_x04_y04"))
+{
+}
+
+template<typename Fp12T>
+const Fp12_2over3over2_variable<Fp12T>
+    &Fp12_2over3over2_mul_024_by_024_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_mul_024_by_024_gadget<
+    Fp12T>::generate_r1cs_constraints()
+{
+    _compute_x0_y0.generate_r1cs_constraints();
+    _compute_x2_y2.generate_r1cs_constraints();
+    _compute_x4_y4.generate_r1cs_constraints();
+    _compute_x02_y02.generate_r1cs_constraints();
+    _compute_x24_y24.generate_r1cs_constraints();
+    _compute_x04_y04.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_mul_024_by_024_gadget<Fp12T>::generate_r1cs_witness()
+{
+    const Fp2T x0 = _X_0.get_element();
+    const Fp2T x2 = _X_2.get_element();
+    const Fp2T x4 = _X_4.get_element();
+    const Fp2T y0 = _Y_0.get_element();
+    const Fp2T y2 = _Y_2.get_element();
+    const Fp2T y4 = _Y_4.get_element();
+
+    _compute_x0_y0.generate_r1cs_witness();
+    _compute_x2_y2.generate_r1cs_witness();
+    _compute_x4_y4.generate_r1cs_witness();
+    const Fp2T x0_y0 = _compute_x0_y0.result.get_element();
+    const Fp2T x2_y2 = _compute_x2_y2.result.get_element();
+    const Fp2T x4_y4 = _compute_x4_y4.result.get_element();
+
+    // out_z2 = x0*y2 + x2*y0
+    _result._c0._c2.generate_r1cs_witness(
+        (x0 + x2) * (y0 + y2) - x0_y0 - x2_y2);
+    _compute_x02_y02.A.evaluate();
+    _compute_x02_y02.B.evaluate();
+    _compute_x02_y02.generate_r1cs_witness();
+
+    // out_z3 = non_residue * (x2*y4 + x4*y2)
+    _result._c1._c0.generate_r1cs_witness(
+        Fp6T::non_residue * ((x2 + x4) * (y2 + y4) - x2_y2 - x4_y4));
+    _compute_x24_y24.A.evaluate();
+    _compute_x24_y24.B.evaluate();
+    _compute_x24_y24.generate_r1cs_witness();
+
+    // out_z4 = x0*y4 + x4*y0
+    _result._c1._c1.generate_r1cs_witness(
+        (x0 + x4) * (y0 + y4) - x0_y0 - x4_y4);
+    _compute_x04_y04.A.evaluate();
+    _compute_x04_y04.B.evaluate();
+    _compute_x04_y04.generate_r1cs_witness();
+
+    // out_z0 and out_z1 are linear combinations of the above
+    _result.evaluate();
+}
+
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_mul_024_by_024_gadget<Fp12T>::
+    generate_r1cs_witness_native(
+        const Fp2T &x0,
+        const Fp2T &x2,
+        const Fp2T &x4,
+        const Fp2T &y0,
+        const Fp2T &y2,
+        const Fp2T &y4)
+{
+    const Fp2T x0_y0 =
+        _compute_x0_y0.generate_r1cs_witness_native(x0, y0);
+    const Fp2T x2_y2 =
+        _compute_x2_y2.generate_r1cs_witness_native(x2, y2);
+    const Fp2T x4_y4 =
+        _compute_x4_y4.generate_r1cs_witness_native(x4, y4);
+    const Fp2T x02_y02 = fp2_mul_native_witness(
+        this->pb, _compute_x02_y02, x0 + x2, y0 + y2);
+    const Fp2T x24_y24 = fp2_mul_native_witness(
+        this->pb, _compute_x24_y24, x2 + x4, y2 + y4);
+    const Fp2T x04_y04 = fp2_mul_native_witness(
+        this->pb, _compute_x04_y04, x0 + x4, y0 + y4);
+
+    const Fp12T result(
+        Fp6T(
+            x0_y0 + Fp6T::non_residue * x4_y4,
+            Fp6T::non_residue * x2_y2,
+            x02_y02 - x0_y0 - x2_y2),
+        Fp6T(
+            Fp6T::non_residue * (x24_y24 - x2_y2 - x4_y4),
+            x04_y04 - x0_y0 - x4_y4,
+            Fp2T::zero()));
+    _result.generate_r1cs_witness(result);
+    return result;
+}
+
 // Fp12_2over3over2_mul_gadget methods
 
 template<typename Fp12T>
@@ -494,6 +683,156 @@ void Fp12_2over3over2_mul_gadget<Fp12T>::generate_r1cs_witness()
     _compute_a0_plus_a1_times_b0_plus_b1.generate_r1cs_witness();
 }
 
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_mul_gadget<Fp12T>::generate_r1cs_witness_native(
+    const Fp12T &a, const Fp12T &b)
+{
+    const Fp6T &a0 = a.coeffs[0];
+    const Fp6T &a1 = a.coeffs[1];
+    const Fp6T &b0 = b.coeffs[0];
+    const Fp6T &b1 = b.coeffs[1];
+    const Fp6T a0b0 = _compute_v0.generate_r1cs_witness_native(a0, b0);
+    const Fp6T a1b1 = _compute_v1.generate_r1cs_witness_native(a1, b1);
+    const Fp6T a0a1_times_b0b1 =
+        _compute_a0_plus_a1_times_b0_plus_b1.generate_r1cs_witness_native(
+            a0 + a1, b0 + b1);
+
+    const Fp12T result(
+        a0b0 + Fp12T::mul_by_non_residue(a1b1), a0a1_times_b0b1 - a0b0 - a1b1);
+    _result.generate_r1cs_witness(result);
+    return result;
+}
+
+template<typename Fp12T>
+std::vector<libsnark::Fp2_variable<typename Fp12T::my_Fp2>> fp12_coefficients(
+    const Fp12_2over3over2_variable<Fp12T> &el)
+{
+    return {
+        el._c0._c0, el._c1._c0, el._c0._c1, el._c1._c1, el._c0._c2, el._c1._c2};
+}
+
+template<typename Fp12T>
+std::vector<typename Fp12T::my_Fp2> fp12_coefficient_values(const Fp12T &el)
+{
+    return {el.coeffs[0].coeffs[0],
+            el.coeffs[1].coeffs[0],
+            el.coeffs[0].coeffs[1],
+            el.coeffs[1].coeffs[1],
+            el.coeffs[0].coeffs[2],
+            el.coeffs[1].coeffs[2]};
+}
+
+template<typename Fp12T>
+Fp12T fp12_from_coefficient_values(
+    const std::vector<typename Fp12T::my_Fp2> &coeffs)
+{
+    using Fp6T = typename Fp12T::my_Fp6;
+    assert(coeffs.size() == 6);
+    return Fp12T(
+        Fp6T(coeffs[0], coeffs[2], coeffs[4]),
+        Fp6T(coeffs[1], coeffs[3], coeffs[5]));
+}
+
+// Fp12_2over3over2_toom6_mul_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_toom6_mul_gadget<Fp12T>::Fp12_2over3over2_toom6_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const Fp12_2over3over2_variable<Fp12T> &A,
+    const Fp12_2over3over2_variable<Fp12T> &B,
+    const Fp12_2over3over2_variable<Fp12T> &result,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(B)
+    , _result(result)
+    , _compute_product(
+          pb,
+          fp12_coefficients(A),
+          fp12_coefficients(B),
+          fp12_coefficients(result),
+          Fp12T::my_Fp6::non_residue,
+          FMT(annotation_prefix, " _compute_product"))
+{
+}
+
+template<typename Fp12T>
+const Fp12_2over3over2_variable<Fp12T>
+    &Fp12_2over3over2_toom6_mul_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_toom6_mul_gadget<Fp12T>::generate_r1cs_constraints()
+{
+    _compute_product.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_toom6_mul_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _compute_product.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_toom6_mul_gadget<Fp12T>::generate_r1cs_witness_native(
+    const Fp12T &a, const Fp12T &b)
+{
+    return fp12_from_coefficient_values<Fp12T>(
+        _compute_product.generate_r1cs_witness_native(
+            fp12_coefficient_values(a), fp12_coefficient_values(b)));
+}
+
+// Fp12_2over3over2_toom6_square_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_toom6_square_gadget<Fp12T>::
+    Fp12_2over3over2_toom6_square_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp12_2over3over2_variable<Fp12T> &A,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _result(result)
+    , _compute_square(
+          pb,
+          fp12_coefficients(A),
+          fp12_coefficients(result),
+          Fp12T::my_Fp6::non_residue,
+          FMT(annotation_prefix, " _compute_square"))
+{
+}
+
+template<typename Fp12T>
+const Fp12_2over3over2_variable<Fp12T>
+    &Fp12_2over3over2_toom6_square_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_toom6_square_gadget<Fp12T>::generate_r1cs_constraints()
+{
+    _compute_square.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_toom6_square_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _compute_square.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_toom6_square_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp12T &a)
+{
+    const std::vector<Fp2T> a_coeffs = fp12_coefficient_values(a);
+    return fp12_from_coefficient_values<Fp12T>(
+        _compute_square.generate_r1cs_witness_native(a_coeffs, a_coeffs));
+}
+
 // Fp12_2over3over2_inv_gadget methods
 
 template<typename Fp12T>
@@ -540,6 +879,16 @@ void Fp12_2over3over2_inv_gadget<Fp12T>::generate_r1cs_witness()
     _compute_A_times_result.generate_r1cs_witness();
 }
 
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_inv_gadget<Fp12T>::generate_r1cs_witness_native(
+    const Fp12T &a)
+{
+    const Fp12T result = a.inverse();
+    _result.generate_r1cs_witness(result);
+    _compute_A_times_result.generate_r1cs_witness_native(a, result);
+    return result;
+}
+
 // Fp12_2over3over2_cyclotomic_square_gadget methods
 
 template<typename Fp12T>
@@ -707,6 +1056,60 @@ void Fp12_2over3over2_cyclotomic_square_gadget<Fp12T>::generate_r1cs_witness()
     _check_result_2.generate_r1cs_witness();
 }
 
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_cyclotomic_square_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp12T &a)
+{
+    const Fp2T &z0 = a.coeffs[0].coeffs[0];
+    const Fp2T &z1 = a.coeffs[0].coeffs[1];
+    const Fp2T &z2 = a.coeffs[0].coeffs[2];
+    const Fp2T &z3 = a.coeffs[1].coeffs[0];
+    const Fp2T &z4 = a.coeffs[1].coeffs[1];
+    const Fp2T &z5 = a.coeffs[1].coeffs[2];
+    const Fp2T one_plus_non_residue = Fp2T::one() + Fp6T::non_residue;
+
+    // See generate_r1cs_witness for the formulae.
+    const Fp2T z0z4 = fp2_mul_native_witness(this->pb, _compute_z0z4, z0, z4);
+    const Fp2T t0_L = fp2_mul_native_witness(
+        this->pb,
+        _check_result_0,
+        FieldT(3) * (z0 + z4),
+        z0 + Fp6T::non_residue * z4);
+    const Fp2T t0_R = z0z4 * one_plus_non_residue;
+
+    const Fp2T z3z2 = fp2_mul_native_witness(this->pb, _compute_z3z2, z3, z2);
+    const Fp2T t2_L = fp2_mul_native_witness(
+        this->pb,
+        _check_result_1,
+        FieldT(3) * (z3 + z2),
+        z3 + Fp6T::non_residue * z2);
+    const Fp2T t2_R = z3z2 * one_plus_non_residue;
+
+    const Fp2T z1z5 = fp2_mul_native_witness(this->pb, _compute_z1z5, z1, z5);
+    const Fp2T t4_L = fp2_mul_native_witness(
+        this->pb,
+        _check_result_2,
+        FieldT(3) * (z1 + z5),
+        z1 + Fp6T::non_residue * z5);
+    const Fp2T t4_R = z1z5 * one_plus_non_residue;
+
+    // t*_L above are multiplied by 3
+    const Fp2T z0z4_2 = z0z4 + z0z4;
+    const Fp2T z3z2_2 = z3z2 + z3z2;
+    const Fp2T z1z5_2 = z1z5 + z1z5;
+    const Fp12T result(
+        Fp6T(
+            t0_L - t0_R - t0_R - t0_R - z0 - z0,
+            t2_L - t2_R - t2_R - t2_R - z1 - z1,
+            t4_L - t4_R - t4_R - t4_R - z2 - z2),
+        Fp6T(
+            (z1z5_2 + z1z5_2 + z1z5_2) * Fp6T::non_residue + z3 + z3,
+            z0z4_2 + z0z4_2 + z0z4_2 + z4 + z4,
+            z3z2_2 + z3z2_2 + z3z2_2 + z5 + z5));
+    _result.generate_r1cs_witness(result);
+    return result;
+}
+
 } // namespace libzecale
 
 #endif // __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_GADGETS_TCC__
@@ -0,0 +1,236 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+/// Reference
+/// \[RS03]
+///  "Torus-Based Cryptography"
+///  Rubin and Silverberg,
+///  CRYPTO 2003
+/// \[NBS08]
+///  "On Compressible Pairings and Their Computation"
+///  Naehrig, Barreto and Schwabe,
+///  IACR Cryptology ePrint Archive 2007, <https://eprint.iacr.org/2007/429.pdf>
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_HPP__
+#define __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_HPP__
+
+#include "libzecale/circuits/fields/fp12_2over3over2_gadgets.hpp"
+
+namespace libzecale
+{
+
+// Arithmetic in the torus T2(Fp6) [RS03], [NBS08]. Elements g = g0 + g1 * w of
+// Fp12 = Fp6[w] / (w^2 - v) with norm g0^2 - v * g1^2 = 1 (in particular the
+// elements of the cyclotomic subgroup, such as the output of the first part
+// of the final exponentiation) other than 1 are represented by the single
+// element of Fp6:
+//
+//   c = (1 + g0) / g1,   g = (c + w) / (c - w)
+//
+// In this representation:
+//
+//   g * h     <=> (c_g * c_h + v) / (c_g + c_h)
+//   g^2       <=> (c_g^2 + v) / (2 * c_g)
+//   g^(-1)    <=> -c_g                          (unitary inverse)
+//   g^(q^i)   <=> c_g^(q^i) / gamma_i           (Frobenius map)
+//
+// where gamma_i = Fp12::Frobenius_coeffs_c1[i], so that the inverse and
+// Frobenius maps are linear combinations, and multiplications and squarings
+// are enforced by 2 and 1 multiplications in Fp6 respectively (30 and 15
+// constraints, against 33 for Fp12_2over3over2_toom6_mul_gadget and 18 for
+// Fp12_2over3over2_cyclotomic_square_gadget).
+//
+// Note that 1 has no compressed representation, so that the constraints
+// below are unsatisfiable (but never satisfied by an incorrect result) when
+// the input to compress, or the result of a multiplication or squaring, is 1.
+// The result of Fp12_2over3over2_torus_mul_decompress_gadget (used for the
+// last multiplication, whose result is expected to be 1 in a pairing check)
+// can be 1.
+
+/// The element v = w^2 of Fp6.
+template<typename Fp12T> typename Fp12T::my_Fp6 fp12_torus_w_squared();
+
+/// The compressed representation of a (with a.c1 != 0).
+template<typename Fp12T>
+typename Fp12T::my_Fp6 fp12_torus_compress(const Fp12T &a);
+
+/// The element of Fp12 with compressed representation c.
+template<typename Fp12T>
+Fp12T fp12_torus_decompress(const typename Fp12T::my_Fp6 &c);
+
+/// The compressed representation of g^(q^power), where c is the compressed
+/// representation of g.
+template<typename Fp12T>
+Fp6_3over2_variable<typename Fp12T::my_Fp6> fp12_torus_frobenius_map(
+    const Fp6_3over2_variable<typename Fp12T::my_Fp6> &c, size_t power);
+
+/// Native equivalent of the above.
+template<typename Fp12T>
+typename Fp12T::my_Fp6 fp12_torus_frobenius_map(
+    const typename Fp12T::my_Fp6 &c, size_t power);
+
+/// Compression of an element A of the torus:
+///
+///   result * A.c1 = A.c0 + 1
+///
+/// Note that this is satisfied by any result when A = -1, which is not in
+/// the cyclotomic subgroup (of odd order), so that A must be constrained to
+/// be in this subgroup, or to be different from -1, by the caller.
+template<typename Fp12T>
+class Fp12_2over3over2_torus_compress_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    Fp12_2over3over2_variable<Fp12T> _A;
+    Fp6_3over2_variable<Fp6T> _result;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _check_result;
+
+    Fp12_2over3over2_torus_compress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp12_2over3over2_variable<Fp12T> &A,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fp6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp6T generate_r1cs_witness_native(const Fp12T &a);
+};
+
+/// Decompression of a compressed element A. Writing result = (r0, r1):
+///
+///   A * r1 = r0 + 1
+///   A * (r0 - 1) = v * r1
+///
+/// which determine r0 and r1 uniquely since A^2 != v.
+template<typename Fp12T>
+class Fp12_2over3over2_torus_decompress_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp12_2over3over2_variable<Fp12T> _result;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _check_result_c0;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _check_result_c1;
+
+    Fp12_2over3over2_torus_decompress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp12_2over3over2_variable<Fp12T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp6T &a);
+};
+
+/// Multiplication of compressed elements:
+///
+///   result * (A + B) = A * B + v
+template<typename Fp12T>
+class Fp12_2over3over2_torus_mul_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp6_3over2_variable<Fp6T> _B;
+    Fp6_3over2_variable<Fp6T> _result;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _compute_A_times_B;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _check_result;
+
+    Fp12_2over3over2_torus_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &B,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fp6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp6T generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b);
+};
+
+/// Squaring of a compressed element:
+///
+///   result = (A^2 + v) / (2 * A)
+///   <=> A * (2 * result - A) = v
+template<typename Fp12T>
+class Fp12_2over3over2_torus_square_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp6_3over2_variable<Fp6T> _result;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _check_result;
+
+    Fp12_2over3over2_torus_square_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fp6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp6T generate_r1cs_witness_native(const Fp6T &a);
+};
+
+/// Multiplication of compressed elements A and B, with an uncompressed
+/// result (which may be 1). Since
+///
+///   (A + w) * (B + w) = X + Y * w,   (A - w) * (B - w) = X - Y * w
+///
+/// for X = A * B + v and Y = A + B, this is enforced by:
+///
+///   result * (X - Y * w) = X + Y * w
+///
+/// where X - Y * w is never 0 (as A^2 != v), at the cost of a multiplication
+/// in Fp6 and one in Fp12 (48 constraints), against 93 to decompress A and B
+/// and multiply the results.
+template<typename Fp12T>
+class Fp12_2over3over2_torus_mul_decompress_gadget
+    : public libsnark::gadget<typename Fp12T::my_Fp>
+{
+public:
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp6_3over2_variable<Fp6T> _B;
+    Fp12_2over3over2_variable<Fp12T> _result;
+    Fp6_3over2_toom3_mul_gadget<Fp6T> _compute_A_times_B;
+    Fp12_2over3over2_toom6_mul_gadget<Fp12T> _check_result;
+
+    Fp12_2over3over2_torus_mul_decompress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &B,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp12_2over3over2_variable<Fp12T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp12T generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b);
+};
+
+} // namespace libzecale
+
+#include "libzecale/circuits/fields/fp12_2over3over2_torus_gadgets.tcc"
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_HPP__
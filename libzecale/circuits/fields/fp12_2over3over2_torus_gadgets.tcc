@@ -0,0 +1,405 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_TCC__
+#define __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_TCC__
+
+#include "libzecale/circuits/fields/fp12_2over3over2_torus_gadgets.hpp"
+
+namespace libzecale
+{
+
+template<typename Fp12T> typename Fp12T::my_Fp6 fp12_torus_w_squared()
+{
+    using Fp2T = typename Fp12T::my_Fp2;
+    using Fp6T = typename Fp12T::my_Fp6;
+    return Fp6T(Fp2T::zero(), Fp2T::one(), Fp2T::zero());
+}
+
+template<typename Fp12T>
+typename Fp12T::my_Fp6 fp12_torus_compress(const Fp12T &a)
+{
+    using Fp6T = typename Fp12T::my_Fp6;
+    return (Fp6T::one() + a.coeffs[0]) * a.coeffs[1].inverse();
+}
+
+template<typename Fp12T>
+Fp12T fp12_torus_decompress(const typename Fp12T::my_Fp6 &c)
+{
+    // (c + w) / (c - w) = (c^2 + v + 2 * c * w) / (c^2 - v)
+    const typename Fp12T::my_Fp6 v = fp12_torus_w_squared<Fp12T>();
+    const typename Fp12T::my_Fp6 c_squared = c.squared();
+    const typename Fp12T::my_Fp6 denominator_inverse =
+        (c_squared - v).inverse();
+    return Fp12T(
+        (c_squared + v) * denominator_inverse, (c + c) * denominator_inverse);
+}
+
+template<typename Fp12T>
+Fp6_3over2_variable<typename Fp12T::my_Fp6> fp12_torus_frobenius_map(
+    const Fp6_3over2_variable<typename Fp12T::my_Fp6> &c, size_t power)
+{
+    return c.frobenius_map(power) *
+           Fp12T::Frobenius_coeffs_c1[power % 12].inverse();
+}
+
+template<typename Fp12T>
+typename Fp12T::my_Fp6 fp12_torus_frobenius_map(
+    const typename Fp12T::my_Fp6 &c, size_t power)
+{
+    return Fp12T::Frobenius_coeffs_c1[power % 12].inverse() *
+           c.Frobenius_map(power);
+}
+
+// Fp12_2over3over2_torus_compress_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_torus_compress_gadget<Fp12T>::
+    Fp12_2over3over2_torus_compress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp12_2over3over2_variable<Fp12T> &A,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _result(result)
+    // result * A.c1 = A.c0 + 1
+    , _check_result(
+          pb,
+          result,
+          A._c1,
+          A._c0 +
+              Fp6_3over2_variable<Fp6T>(
+                  pb, Fp6T::one(), FMT(annotation_prefix, " one")),
+          FMT(annotation_prefix, " _check_result"))
+{
+}
+
+template<typename Fp12T>
+const Fp6_3over2_variable<typename Fp12T::my_Fp6>
+    &Fp12_2over3over2_torus_compress_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_compress_gadget<Fp12T>::generate_r1cs_constraints()
+{
+    _check_result.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_compress_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _A.evaluate();
+    _result.generate_r1cs_witness(fp12_torus_compress(_A.get_element()));
+    _check_result.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+typename Fp12T::my_Fp6 Fp12_2over3over2_torus_compress_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp12T &a)
+{
+    const Fp6T c = fp12_torus_compress(a);
+    _result.generate_r1cs_witness(c);
+    _check_result.generate_r1cs_witness_native(c, a.coeffs[1]);
+    return c;
+}
+
+// Fp12_2over3over2_torus_decompress_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_torus_decompress_gadget<Fp12T>::
+    Fp12_2over3over2_torus_decompress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _result(result)
+    // A * r1 = r0 + 1
+    , _check_result_c0(
+          pb,
+          A,
+          result._c1,
+          result._c0 +
+              Fp6_3over2_variable<Fp6T>(
+                  pb, Fp6T::one(), FMT(annotation_prefix, " one")),
+          FMT(annotation_prefix, " _check_result_c0"))
+    // A * (r0 - 1) = v * r1
+    , _check_result_c1(
+          pb,
+          A,
+          result._c0 - Fp6_3over2_variable<Fp6T>(
+                           pb, Fp6T::one(), FMT(annotation_prefix, " one")),
+          fp6_mul_by_non_residue<Fp12T>(
+              pb, result._c1, FMT(annotation_prefix, " v_times_r1")),
+          FMT(annotation_prefix, " _check_result_c1"))
+{
+}
+
+template<typename Fp12T>
+const Fp12_2over3over2_variable<Fp12T>
+    &Fp12_2over3over2_torus_decompress_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_decompress_gadget<
+    Fp12T>::generate_r1cs_constraints()
+{
+    _check_result_c0.generate_r1cs_constraints();
+    _check_result_c1.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_decompress_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _A.evaluate();
+    _result.generate_r1cs_witness(
+        fp12_torus_decompress<Fp12T>(_A.get_element()));
+    _check_result_c0.generate_r1cs_witness();
+    _check_result_c1.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_torus_decompress_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp6T &a)
+{
+    const Fp12T result = fp12_torus_decompress<Fp12T>(a);
+    _result.generate_r1cs_witness(result);
+    _check_result_c0.generate_r1cs_witness_native(a, result.coeffs[1]);
+    _check_result_c1.generate_r1cs_witness_native(
+        a, result.coeffs[0] - Fp6T::one());
+    return result;
+}
+
+// Fp12_2over3over2_torus_mul_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_torus_mul_gadget<Fp12T>::Fp12_2over3over2_torus_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const Fp6_3over2_variable<Fp6T> &A,
+    const Fp6_3over2_variable<Fp6T> &B,
+    const Fp6_3over2_variable<Fp6T> &result,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(B)
+    , _result(result)
+    , _compute_A_times_B(
+          pb,
+          A,
+          B,
+          Fp6_3over2_variable<Fp6T>(pb, FMT(annotation_prefix, " A_times_B")),
+          FMT(annotation_prefix, " _compute_A_times_B"))
+    // result * (A + B) = A * B + v
+    , _check_result(
+          pb,
+          result,
+          A + B,
+          _compute_A_times_B.result() +
+              Fp6_3over2_variable<Fp6T>(
+                  pb,
+                  fp12_torus_w_squared<Fp12T>(),
+                  FMT(annotation_prefix, " v")),
+          FMT(annotation_prefix, " _check_result"))
+{
+}
+
+template<typename Fp12T>
+const Fp6_3over2_variable<typename Fp12T::my_Fp6>
+    &Fp12_2over3over2_torus_mul_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_mul_gadget<Fp12T>::generate_r1cs_constraints()
+{
+    _compute_A_times_B.generate_r1cs_constraints();
+    _check_result.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_mul_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _A.evaluate();
+    _B.evaluate();
+    const Fp6T a = _A.get_element();
+    const Fp6T b = _B.get_element();
+    _result.generate_r1cs_witness(
+        (a * b + fp12_torus_w_squared<Fp12T>()) * (a + b).inverse());
+    _compute_A_times_B.generate_r1cs_witness();
+    _check_result.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+typename Fp12T::my_Fp6 Fp12_2over3over2_torus_mul_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b)
+{
+    const Fp6T a_times_b =
+        _compute_A_times_B.generate_r1cs_witness_native(a, b);
+    const Fp6T result =
+        (a_times_b + fp12_torus_w_squared<Fp12T>()) * (a + b).inverse();
+    _result.generate_r1cs_witness(result);
+    _check_result.generate_r1cs_witness_native(result, a + b);
+    return result;
+}
+
+// Fp12_2over3over2_torus_square_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_torus_square_gadget<Fp12T>::
+    Fp12_2over3over2_torus_square_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _result(result)
+    // A * (2 * result - A) = v
+    , _check_result(
+          pb,
+          A,
+          result * FieldT(2) - A,
+          Fp6_3over2_variable<Fp6T>(
+              pb, fp12_torus_w_squared<Fp12T>(), FMT(annotation_prefix, " v")),
+          FMT(annotation_prefix, " _check_result"))
+{
+}
+
+template<typename Fp12T>
+const Fp6_3over2_variable<typename Fp12T::my_Fp6>
+    &Fp12_2over3over2_torus_square_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_square_gadget<Fp12T>::generate_r1cs_constraints()
+{
+    _check_result.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_square_gadget<Fp12T>::generate_r1cs_witness()
+{
+    _A.evaluate();
+    const Fp6T a = _A.get_element();
+    _result.generate_r1cs_witness(
+        (a.squared() + fp12_torus_w_squared<Fp12T>()) * (a + a).inverse());
+    _check_result.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+typename Fp12T::my_Fp6 Fp12_2over3over2_torus_square_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp6T &a)
+{
+    const Fp6T result =
+        (a.squared() + fp12_torus_w_squared<Fp12T>()) * (a + a).inverse();
+    _result.generate_r1cs_witness(result);
+    _check_result.generate_r1cs_witness_native(a, result + result - a);
+    return result;
+}
+
+// Fp12_2over3over2_torus_mul_decompress_gadget methods
+
+template<typename Fp12T>
+Fp12_2over3over2_torus_mul_decompress_gadget<Fp12T>::
+    Fp12_2over3over2_torus_mul_decompress_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &B,
+        const Fp12_2over3over2_variable<Fp12T> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(B)
+    , _result(result)
+    , _compute_A_times_B(
+          pb,
+          A,
+          B,
+          Fp6_3over2_variable<Fp6T>(pb, FMT(annotation_prefix, " A_times_B")),
+          FMT(annotation_prefix, " _compute_A_times_B"))
+    // result * (X - Y * w) = X + Y * w
+    //   where
+    //     X = A * B + v
+    //     Y = A + B
+    , _check_result(
+          pb,
+          result,
+          Fp12_2over3over2_variable<Fp12T>(
+              pb,
+              _compute_A_times_B.result() +
+                  Fp6_3over2_variable<Fp6T>(
+                      pb,
+                      fp12_torus_w_squared<Fp12T>(),
+                      FMT(annotation_prefix, " v")),
+              -(A + B),
+              FMT(annotation_prefix, " X_minus_Yw")),
+          Fp12_2over3over2_variable<Fp12T>(
+              pb,
+              _compute_A_times_B.result() +
+                  Fp6_3over2_variable<Fp6T>(
+                      pb,
+                      fp12_torus_w_squared<Fp12T>(),
+                      FMT(annotation_prefix, " v")),
+              A + B,
+              FMT(annotation_prefix, " X_plus_Yw")),
+          FMT(annotation_prefix, " _check_result"))
+{
+}
+
+template<typename Fp12T>
+const Fp12_2over3over2_variable<Fp12T>
+    &Fp12_2over3over2_torus_mul_decompress_gadget<Fp12T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_mul_decompress_gadget<
+    Fp12T>::generate_r1cs_constraints()
+{
+    _compute_A_times_B.generate_r1cs_constraints();
+    _check_result.generate_r1cs_constraints();
+}
+
+template<typename Fp12T>
+void Fp12_2over3over2_torus_mul_decompress_gadget<
+    Fp12T>::generate_r1cs_witness()
+{
+    _A.evaluate();
+    _B.evaluate();
+    const Fp6T a = _A.get_element();
+    const Fp6T b = _B.get_element();
+    const Fp6T X = a * b + fp12_torus_w_squared<Fp12T>();
+    const Fp6T Y = a + b;
+    _result.generate_r1cs_witness(Fp12T(X, Y) * Fp12T(X, -Y).inverse());
+    _compute_A_times_B.generate_r1cs_witness();
+    _check_result.generate_r1cs_witness();
+}
+
+template<typename Fp12T>
+Fp12T Fp12_2over3over2_torus_mul_decompress_gadget<
+    Fp12T>::generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b)
+{
+    const Fp6T X = _compute_A_times_B.generate_r1cs_witness_native(a, b) +
+                   fp12_torus_w_squared<Fp12T>();
+    const Fp6T Y = a + b;
+    const Fp12T X_minus_Yw(X, -Y);
+    const Fp12T result = Fp12T(X, Y) * X_minus_Yw.inverse();
+    _result.generate_r1cs_witness(result);
+    _check_result.generate_r1cs_witness_native(result, X_minus_Yw);
+    return result;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP12_2OVER3OVER2_TORUS_GADGETS_TCC__
@@ -0,0 +1,107 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_HPP__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_HPP__
+
+#include "libzecale/circuits/fields/fp2_native_witness.hpp"
+
+#include <libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.hpp>
+#include <memory>
+
+namespace libzecale
+{
+
+// Products in Fp2 which only allocate variables for the results that must be
+// constrained. When one of the operands is a constant (for example the line
+// coefficients of a G2 precomputation created from a constant point, such as
+// the generator of G2 in a verification key), the product is linear in the
+// other operand, and the result is a linear combination of the other
+// operand. In this case, no variable or constraint is added to the circuit.
+// Otherwise, the result is allocated and constrained by the corresponding
+// libsnark gadget.
+
+/// Returns true if both components of `A` are constant linear combinations.
+template<typename Fp2T>
+bool fp2_variable_is_constant(const libsnark::Fp2_variable<Fp2T> &A);
+
+/// result = A * B
+template<typename Fp2T>
+class Fp2_lean_mul_gadget : public libsnark::gadget<typename Fp2T::my_Fp>
+{
+public:
+    using FieldT = typename Fp2T::my_Fp;
+
+    libsnark::Fp2_variable<Fp2T> A;
+    libsnark::Fp2_variable<Fp2T> B;
+    libsnark::Fp2_variable<Fp2T> result;
+
+    // Only created if neither A nor B is constant.
+    std::shared_ptr<libsnark::Fp2_mul_gadget<Fp2T>> _compute_result;
+
+    Fp2_lean_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &A,
+        const libsnark::Fp2_variable<Fp2T> &B,
+        const std::string &annotation_prefix);
+
+    /// True if the result is a linear combination of the operands.
+    bool is_lean() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+    /// Assign the witness given the values of A and B (see
+    /// fp2_native_witness.hpp), and return the value of the result.
+    Fp2T generate_r1cs_witness_native(const Fp2T &a, const Fp2T &b);
+
+private:
+    static libsnark::Fp2_variable<Fp2T> lean_result(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &A,
+        const libsnark::Fp2_variable<Fp2T> &B,
+        const std::string &annotation_prefix);
+};
+
+/// result = A * lc
+template<typename Fp2T>
+class Fp2_lean_mul_by_lc_gadget : public libsnark::gadget<typename Fp2T::my_Fp>
+{
+public:
+    using FieldT = typename Fp2T::my_Fp;
+
+    libsnark::Fp2_variable<Fp2T> A;
+    libsnark::pb_linear_combination<FieldT> lc;
+    libsnark::Fp2_variable<Fp2T> result;
+
+    // Only created if neither A nor lc is constant.
+    std::shared_ptr<libsnark::Fp2_mul_by_lc_gadget<Fp2T>> _compute_result;
+
+    Fp2_lean_mul_by_lc_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &A,
+        const libsnark::pb_linear_combination<FieldT> &lc,
+        const std::string &annotation_prefix);
+
+    /// True if the result is a linear combination of the operands.
+    bool is_lean() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+    /// Assign the witness given the values of A and lc (see
+    /// fp2_native_witness.hpp), and return the value of the result.
+    Fp2T generate_r1cs_witness_native(const Fp2T &a, const FieldT &lc_value);
+
+private:
+    static libsnark::Fp2_variable<Fp2T> lean_result(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::Fp2_variable<Fp2T> &A,
+        const libsnark::pb_linear_combination<FieldT> &lc,
+        const std::string &annotation_prefix);
+};
+
+} // namespace libzecale
+
+#include "libzecale/circuits/fields/fp2_lean_gadgets.tcc"
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_HPP__
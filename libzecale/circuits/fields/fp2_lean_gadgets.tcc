@@ -0,0 +1,172 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_TCC__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_TCC__
+
+#include "libzecale/circuits/fields/fp2_lean_gadgets.hpp"
+
+namespace libzecale
+{
+
+template<typename Fp2T>
+bool fp2_variable_is_constant(const libsnark::Fp2_variable<Fp2T> &A)
+{
+    return A.c0.is_constant() && A.c1.is_constant();
+}
+
+// Fp2_lean_mul_gadget methods
+
+template<typename Fp2T>
+Fp2_lean_mul_gadget<Fp2T>::Fp2_lean_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const libsnark::Fp2_variable<Fp2T> &A,
+    const libsnark::Fp2_variable<Fp2T> &B,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , A(A)
+    , B(B)
+    , result(lean_result(pb, A, B, annotation_prefix))
+{
+    if (!is_lean()) {
+        _compute_result.reset(new libsnark::Fp2_mul_gadget<Fp2T>(
+            pb, A, B, result, FMT(annotation_prefix, " _compute_result")));
+    }
+}
+
+template<typename Fp2T>
+bool Fp2_lean_mul_gadget<Fp2T>::is_lean() const
+{
+    return fp2_variable_is_constant(A) || fp2_variable_is_constant(B);
+}
+
+template<typename Fp2T>
+void Fp2_lean_mul_gadget<Fp2T>::generate_r1cs_constraints()
+{
+    if (_compute_result) {
+        _compute_result->generate_r1cs_constraints();
+    }
+}
+
+template<typename Fp2T>
+void Fp2_lean_mul_gadget<Fp2T>::generate_r1cs_witness()
+{
+    if (_compute_result) {
+        _compute_result->generate_r1cs_witness();
+    } else {
+        result.evaluate();
+    }
+}
+
+template<typename Fp2T>
+Fp2T Fp2_lean_mul_gadget<Fp2T>::generate_r1cs_witness_native(
+    const Fp2T &a, const Fp2T &b)
+{
+    if (_compute_result) {
+        return fp2_mul_native_witness(this->pb, *_compute_result, a, b);
+    }
+
+    const Fp2T a_times_b = a * b;
+    result.generate_r1cs_witness(a_times_b);
+    return a_times_b;
+}
+
+template<typename Fp2T>
+libsnark::Fp2_variable<Fp2T> Fp2_lean_mul_gadget<Fp2T>::lean_result(
+    libsnark::protoboard<FieldT> &pb,
+    const libsnark::Fp2_variable<Fp2T> &A,
+    const libsnark::Fp2_variable<Fp2T> &B,
+    const std::string &annotation_prefix)
+{
+    if (fp2_variable_is_constant(A)) {
+        return B * Fp2T(A.c0.constant_term(), A.c1.constant_term());
+    }
+    if (fp2_variable_is_constant(B)) {
+        return A * Fp2T(B.c0.constant_term(), B.c1.constant_term());
+    }
+    return libsnark::Fp2_variable<Fp2T>(
+        pb, FMT(annotation_prefix, " result"));
+}
+
+// Fp2_lean_mul_by_lc_gadget methods
+
+template<typename Fp2T>
+Fp2_lean_mul_by_lc_gadget<Fp2T>::Fp2_lean_mul_by_lc_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const libsnark::Fp2_variable<Fp2T> &A,
+    const libsnark::pb_linear_combination<FieldT> &lc,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , A(A)
+    , lc(lc)
+    , result(lean_result(pb, A, lc, annotation_prefix))
+{
+    if (!is_lean()) {
+        _compute_result.reset(new libsnark::Fp2_mul_by_lc_gadget<Fp2T>(
+            pb, A, lc, result, FMT(annotation_prefix, " _compute_result")));
+    }
+}
+
+template<typename Fp2T>
+bool Fp2_lean_mul_by_lc_gadget<Fp2T>::is_lean() const
+{
+    return fp2_variable_is_constant(A) || lc.is_constant();
+}
+
+template<typename Fp2T>
+void Fp2_lean_mul_by_lc_gadget<Fp2T>::generate_r1cs_constraints()
+{
+    if (_compute_result) {
+        _compute_result->generate_r1cs_constraints();
+    }
+}
+
+template<typename Fp2T>
+void Fp2_lean_mul_by_lc_gadget<Fp2T>::generate_r1cs_witness()
+{
+    if (_compute_result) {
+        _compute_result->generate_r1cs_witness();
+    } else {
+        result.evaluate();
+    }
+}
+
+template<typename Fp2T>
+Fp2T Fp2_lean_mul_by_lc_gadget<Fp2T>::generate_r1cs_witness_native(
+    const Fp2T &a, const FieldT &lc_value)
+{
+    if (_compute_result) {
+        return fp2_mul_by_lc_native_witness(*_compute_result, a, lc_value);
+    }
+
+    const Fp2T a_times_lc = lc_value * a;
+    result.generate_r1cs_witness(a_times_lc);
+    return a_times_lc;
+}
+
+template<typename Fp2T>
+libsnark::Fp2_variable<Fp2T> Fp2_lean_mul_by_lc_gadget<Fp2T>::lean_result(
+    libsnark::protoboard<FieldT> &pb,
+    const libsnark::Fp2_variable<Fp2T> &A,
+    const libsnark::pb_linear_combination<FieldT> &lc,
+    const std::string &annotation_prefix)
+{
+    if (lc.is_constant()) {
+        return A * lc.constant_term();
+    }
+    if (fp2_variable_is_constant(A)) {
+        libsnark::pb_linear_combination<FieldT> c0;
+        libsnark::pb_linear_combination<FieldT> c1;
+        c0.assign(pb, lc * A.c0.constant_term());
+        c1.assign(pb, lc * A.c1.constant_term());
+        return libsnark::Fp2_variable<Fp2T>(
+            pb, c0, c1, FMT(annotation_prefix, " result"));
+    }
+    return libsnark::Fp2_variable<Fp2T>(
+        pb, FMT(annotation_prefix, " result"));
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_LEAN_GADGETS_TCC__
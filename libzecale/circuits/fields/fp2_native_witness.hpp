@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_HPP__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_HPP__
+
+#include "libzecale/circuits/fields/bls12_377_fq_batch.hpp"
+
+#include <cassert>
+#include <libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.hpp>
+#include <vector>
+
+namespace libzecale
+{
+
+// Native witness generation for the libsnark Fp2 gadgets. Each function
+// assigns the witness of the gadget given the (native) values of its inputs,
+// which are NOT read from the protoboard (so the input linear combinations
+// need not be evaluated), and returns the value of the result. These are the
+// building blocks of the generate_r1cs_witness_native() methods of the Fp6,
+// Fp12 and pairing gadgets.
+
+/// result = a * b
+template<typename Fp2T>
+Fp2T fp2_mul_native_witness(
+    libsnark::protoboard<typename Fp2T::my_Fp> &pb,
+    libsnark::Fp2_mul_gadget<Fp2T> &gadget,
+    const Fp2T &a,
+    const Fp2T &b);
+
+/// result = a^2
+template<typename Fp2T>
+Fp2T fp2_sqr_native_witness(
+    libsnark::Fp2_sqr_gadget<Fp2T> &gadget, const Fp2T &a);
+
+/// result = a * lc
+template<typename Fp2T>
+Fp2T fp2_mul_by_lc_native_witness(
+    libsnark::Fp2_mul_by_lc_gadget<Fp2T> &gadget,
+    const Fp2T &a,
+    const typename Fp2T::my_Fp &lc);
+
+// Batches of independent products. The products in Fp2 are reduced to
+// batches of products in the base field, computed by the overload of
+// fp_batch_mul for BLS12-377's Fq (see bls12_377_fq_batch.hpp) when
+// available.
+
+/// result[i] = a[i] * b[i], in a prime field.
+template<typename FieldT>
+std::vector<FieldT> fp_batch_mul(
+    const std::vector<FieldT> &a, const std::vector<FieldT> &b);
+
+/// result[i] = a[i] * b[i], in Fp2 (Karatsuba: 3 batches of products in Fp).
+template<typename Fp2T>
+std::vector<Fp2T> fp2_batch_mul(
+    const std::vector<Fp2T> &a, const std::vector<Fp2T> &b);
+
+/// result[i] = a[i]^2, in Fp2 (complex squaring: 2 batches of products in
+/// Fp).
+template<typename Fp2T>
+std::vector<Fp2T> fp2_batch_squared(const std::vector<Fp2T> &a);
+
+/// fp2_mul_native_witness for the independent gadgets `gadgets[i]`, given the
+/// values a[i] and b[i] of their inputs.
+template<typename Fp2T>
+std::vector<Fp2T> fp2_mul_native_witness_batch(
+    libsnark::protoboard<typename Fp2T::my_Fp> &pb,
+    const std::vector<libsnark::Fp2_mul_gadget<Fp2T> *> &gadgets,
+    const std::vector<Fp2T> &a,
+    const std::vector<Fp2T> &b);
+
+/// fp2_sqr_native_witness for the independent gadgets `gadgets[i]`, given the
+/// values a[i] of their inputs.
+template<typename Fp2T>
+std::vector<Fp2T> fp2_sqr_native_witness_batch(
+    const std::vector<libsnark::Fp2_sqr_gadget<Fp2T> *> &gadgets,
+    const std::vector<Fp2T> &a);
+
+} // namespace libzecale
+
+#include "libzecale/circuits/fields/fp2_native_witness.tcc"
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_HPP__
@@ -0,0 +1,178 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_TCC__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_TCC__
+
+#include "libzecale/circuits/fields/fp2_native_witness.hpp"
+
+namespace libzecale
+{
+
+template<typename Fp2T>
+Fp2T fp2_mul_native_witness(
+    libsnark::protoboard<typename Fp2T::my_Fp> &pb,
+    libsnark::Fp2_mul_gadget<Fp2T> &gadget,
+    const Fp2T &a,
+    const Fp2T &b)
+{
+    // Fp2_mul_gadget allocates v1 = a.c1 * b.c1 (see
+    // libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.tcc).
+    pb.val(gadget.v1) = a.c1 * b.c1;
+    const Fp2T result = a * b;
+    gadget.result.generate_r1cs_witness(result);
+    return result;
+}
+
+template<typename Fp2T>
+Fp2T fp2_sqr_native_witness(
+    libsnark::Fp2_sqr_gadget<Fp2T> &gadget, const Fp2T &a)
+{
+    const Fp2T result = a.squared();
+    gadget.result.generate_r1cs_witness(result);
+    return result;
+}
+
+template<typename Fp2T>
+Fp2T fp2_mul_by_lc_native_witness(
+    libsnark::Fp2_mul_by_lc_gadget<Fp2T> &gadget,
+    const Fp2T &a,
+    const typename Fp2T::my_Fp &lc)
+{
+    const Fp2T result = lc * a;
+    gadget.result.generate_r1cs_witness(result);
+    return result;
+}
+
+namespace internal
+{
+
+/// Karatsuba multiplication of a[i] and b[i], which also returns the products
+/// a[i].c1 * b[i].c1 (the variable v1 of libsnark::Fp2_mul_gadget).
+template<typename Fp2T>
+std::vector<Fp2T> fp2_batch_mul(
+    const std::vector<Fp2T> &a,
+    const std::vector<Fp2T> &b,
+    std::vector<typename Fp2T::my_Fp> &a1_times_b1)
+{
+    using FieldT = typename Fp2T::my_Fp;
+    const size_t n = a.size();
+    assert(b.size() == n);
+
+    std::vector<FieldT> a0(n);
+    std::vector<FieldT> a1(n);
+    std::vector<FieldT> a0_plus_a1(n);
+    std::vector<FieldT> b0(n);
+    std::vector<FieldT> b1(n);
+    std::vector<FieldT> b0_plus_b1(n);
+    for (size_t i = 0; i < n; ++i) {
+        a0[i] = a[i].c0;
+        a1[i] = a[i].c1;
+        a0_plus_a1[i] = a[i].c0 + a[i].c1;
+        b0[i] = b[i].c0;
+        b1[i] = b[i].c1;
+        b0_plus_b1[i] = b[i].c0 + b[i].c1;
+    }
+
+    const std::vector<FieldT> a0_times_b0 = fp_batch_mul(a0, b0);
+    a1_times_b1 = fp_batch_mul(a1, b1);
+    const std::vector<FieldT> cross = fp_batch_mul(a0_plus_a1, b0_plus_b1);
+
+    std::vector<Fp2T> result(n);
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = Fp2T(
+            a0_times_b0[i] + Fp2T::non_residue * a1_times_b1[i],
+            cross[i] - a0_times_b0[i] - a1_times_b1[i]);
+    }
+    return result;
+}
+
+} // namespace internal
+
+template<typename FieldT>
+std::vector<FieldT> fp_batch_mul(
+    const std::vector<FieldT> &a, const std::vector<FieldT> &b)
+{
+    assert(b.size() == a.size());
+    std::vector<FieldT> result(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        result[i] = a[i] * b[i];
+    }
+    return result;
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> fp2_batch_mul(
+    const std::vector<Fp2T> &a, const std::vector<Fp2T> &b)
+{
+    std::vector<typename Fp2T::my_Fp> a1_times_b1;
+    return internal::fp2_batch_mul(a, b, a1_times_b1);
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> fp2_batch_squared(const std::vector<Fp2T> &a)
+{
+    using FieldT = typename Fp2T::my_Fp;
+    const size_t n = a.size();
+
+    // (c0 + c1 * u)^2 = (c0 + c1) * (c0 + non_residue * c1) - c0 * c1 -
+    // non_residue * c0 * c1 + 2 * c0 * c1 * u
+    std::vector<FieldT> c0(n);
+    std::vector<FieldT> c1(n);
+    std::vector<FieldT> c0_plus_c1(n);
+    std::vector<FieldT> c0_plus_non_residue_c1(n);
+    for (size_t i = 0; i < n; ++i) {
+        c0[i] = a[i].c0;
+        c1[i] = a[i].c1;
+        c0_plus_c1[i] = a[i].c0 + a[i].c1;
+        c0_plus_non_residue_c1[i] = a[i].c0 + Fp2T::non_residue * a[i].c1;
+    }
+
+    const std::vector<FieldT> c0_times_c1 = fp_batch_mul(c0, c1);
+    const std::vector<FieldT> cross =
+        fp_batch_mul(c0_plus_c1, c0_plus_non_residue_c1);
+
+    std::vector<Fp2T> result(n);
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = Fp2T(
+            cross[i] - c0_times_c1[i] - Fp2T::non_residue * c0_times_c1[i],
+            c0_times_c1[i] + c0_times_c1[i]);
+    }
+    return result;
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> fp2_mul_native_witness_batch(
+    libsnark::protoboard<typename Fp2T::my_Fp> &pb,
+    const std::vector<libsnark::Fp2_mul_gadget<Fp2T> *> &gadgets,
+    const std::vector<Fp2T> &a,
+    const std::vector<Fp2T> &b)
+{
+    assert(a.size() == gadgets.size());
+    std::vector<typename Fp2T::my_Fp> a1_times_b1;
+    const std::vector<Fp2T> result =
+        internal::fp2_batch_mul(a, b, a1_times_b1);
+    for (size_t i = 0; i < gadgets.size(); ++i) {
+        pb.val(gadgets[i]->v1) = a1_times_b1[i];
+        gadgets[i]->result.generate_r1cs_witness(result[i]);
+    }
+    return result;
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> fp2_sqr_native_witness_batch(
+    const std::vector<libsnark::Fp2_sqr_gadget<Fp2T> *> &gadgets,
+    const std::vector<Fp2T> &a)
+{
+    assert(a.size() == gadgets.size());
+    const std::vector<Fp2T> result = fp2_batch_squared(a);
+    for (size_t i = 0; i < gadgets.size(); ++i) {
+        gadgets[i]->result.generate_r1cs_witness(result[i]);
+    }
+    return result;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_NATIVE_WITNESS_TCC__
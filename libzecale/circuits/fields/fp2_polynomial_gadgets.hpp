@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_HPP__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_HPP__
+
+#include "libzecale/circuits/fields/fp2_native_witness.hpp"
+
+#include <cassert>
+#include <libff/algebra/curves/public_params.hpp>
+#include <libsnark/gadgetlib1/gadget.hpp>
+#include <libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.hpp>
+#include <memory>
+#include <vector>
+
+namespace libzecale
+{
+
+/// Evaluate the polynomial with (Fp2) coefficients `coeffs` (in order of
+/// increasing degree) at the constant `t`, as a linear combination.
+template<typename Fp2T>
+libsnark::Fp2_variable<Fp2T> fp2_polynomial_evaluate(
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &coeffs,
+    const typename Fp2T::my_Fp &t,
+    size_t first_coeff = 0);
+
+/// Multiplication (or squaring) in Fp2[X] / (X^n - non_residue), where A, B
+/// and result are given by their n coefficients in Fp2. This is used to
+/// implement multiplication in Fp6 = Fp2[v] / (v^3 - non_residue) and Fp12 =
+/// Fp2[w] / (w^6 - non_residue).
+///
+/// The (unreduced) product C = A * B has degree 2n - 2, and is determined by
+/// its value at 2n - 1 points. Since multiplications by constants and
+/// additions are free in R1CS, we allocate the n - 1 high coefficients
+/// c_n, ..., c_{2n-2} of C (the low coefficients are then linear combinations
+/// of those and of the reduced result:
+///
+///   c_i = result_i - non_residue * c_{n+i}, 0 <= i < n - 1
+///   c_{n-1} = result_{n-1}
+///
+/// ) and enforce A(t) * B(t) = C(t) for t in {0, 1, -1, 2, -2, ...} and at
+/// infinity (a_{n-1} * b_{n-1} = c_{2n-2}). This costs 2n - 1 multiplications
+/// (or squarings) in Fp2, i.e. 5 for Fp6 (Toom-3) and 11 for Fp12 (Toom-6),
+/// against 6 and 18 for the Karatsuba-based gadgets.
+template<typename Fp2T>
+class Fp2_polynomial_mul_gadget : public libsnark::gadget<typename Fp2T::my_Fp>
+{
+public:
+    using FieldT = typename Fp2T::my_Fp;
+
+    std::vector<libsnark::Fp2_variable<Fp2T>> _A;
+    std::vector<libsnark::Fp2_variable<Fp2T>> _B;
+    std::vector<libsnark::Fp2_variable<Fp2T>> _result;
+    Fp2T _non_residue;
+
+    // Allocated high coefficients c_n, ..., c_{2n-2}, and all coefficients
+    // of C (as linear combinations).
+    std::vector<libsnark::Fp2_variable<Fp2T>> _high;
+    std::vector<libsnark::Fp2_variable<Fp2T>> _C;
+
+    // A(t) * B(t) = C(t) (only one of these is populated)
+    std::vector<std::shared_ptr<libsnark::Fp2_mul_gadget<Fp2T>>> _mul_gadgets;
+    std::vector<std::shared_ptr<libsnark::Fp2_sqr_gadget<Fp2T>>> _sqr_gadgets;
+
+    /// Multiplication
+    Fp2_polynomial_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const std::vector<libsnark::Fp2_variable<Fp2T>> &A,
+        const std::vector<libsnark::Fp2_variable<Fp2T>> &B,
+        const std::vector<libsnark::Fp2_variable<Fp2T>> &result,
+        const Fp2T &non_residue,
+        const std::string &annotation_prefix);
+
+    /// Squaring
+    Fp2_polynomial_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const std::vector<libsnark::Fp2_variable<Fp2T>> &A,
+        const std::vector<libsnark::Fp2_variable<Fp2T>> &result,
+        const Fp2T &non_residue,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the coefficients a and b of
+    /// A and B (which are not read from the protoboard), and return the
+    /// coefficients of the result. For squaring, b is ignored.
+    std::vector<Fp2T> generate_r1cs_witness_native(
+        const std::vector<Fp2T> &a, const std::vector<Fp2T> &b);
+
+    /// The i-th evaluation point (i < 2n - 2). The last evaluation is at
+    /// infinity.
+    static FieldT evaluation_point(size_t i);
+
+private:
+    void initialize(
+        libsnark::protoboard<FieldT> &pb,
+        bool square,
+        const std::string &annotation_prefix);
+
+    /// Compute the (unreduced) product of a and b, and assign _high and
+    /// _result. Returns the coefficients of the result.
+    std::vector<Fp2T> assign_product(
+        const std::vector<Fp2T> &a, const std::vector<Fp2T> &b);
+
+    /// Evaluate the polynomial with coefficients `coeffs` at t.
+    static Fp2T evaluate_native(
+        const std::vector<Fp2T> &coeffs, const FieldT &t);
+};
+
+} // namespace libzecale
+
+#include "libzecale/circuits/fields/fp2_polynomial_gadgets.tcc"
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_HPP__
@@ -0,0 +1,267 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_TCC__
+#define __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_TCC__
+
+#include "libzecale/circuits/fields/fp2_polynomial_gadgets.hpp"
+
+namespace libzecale
+{
+
+template<typename Fp2T>
+libsnark::Fp2_variable<Fp2T> fp2_polynomial_evaluate(
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &coeffs,
+    const typename Fp2T::my_Fp &t,
+    size_t first_coeff)
+{
+    // Horner's rule
+    assert(first_coeff < coeffs.size());
+    if (first_coeff == coeffs.size() - 1) {
+        return coeffs[first_coeff];
+    }
+
+    return coeffs[first_coeff] +
+           fp2_polynomial_evaluate(coeffs, t, first_coeff + 1) * t;
+}
+
+// Fp2_polynomial_mul_gadget methods
+
+template<typename Fp2T>
+Fp2_polynomial_mul_gadget<Fp2T>::Fp2_polynomial_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &A,
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &B,
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &result,
+    const Fp2T &non_residue,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(B)
+    , _result(result)
+    , _non_residue(non_residue)
+{
+    assert(_B.size() == _A.size());
+    initialize(pb, false, annotation_prefix);
+}
+
+template<typename Fp2T>
+Fp2_polynomial_mul_gadget<Fp2T>::Fp2_polynomial_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &A,
+    const std::vector<libsnark::Fp2_variable<Fp2T>> &result,
+    const Fp2T &non_residue,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(A)
+    , _result(result)
+    , _non_residue(non_residue)
+{
+    initialize(pb, true, annotation_prefix);
+}
+
+template<typename Fp2T>
+void Fp2_polynomial_mul_gadget<Fp2T>::initialize(
+    libsnark::protoboard<FieldT> &pb,
+    bool square,
+    const std::string &annotation_prefix)
+{
+    const size_t n = _A.size();
+    assert(n > 1);
+    assert(_result.size() == n);
+
+    // c_n, ..., c_{2n-2}
+    _high.reserve(n - 1);
+    for (size_t i = 0; i < n - 1; ++i) {
+        _high.emplace_back(pb, FMT(annotation_prefix, " c%zu", n + i));
+    }
+
+    // c_0, ..., c_{2n-2}
+    _C.reserve(2 * n - 1);
+    for (size_t i = 0; i < n - 1; ++i) {
+        _C.push_back(_result[i] + _high[i] * -_non_residue);
+    }
+    _C.push_back(_result[n - 1]);
+    for (size_t i = 0; i < n - 1; ++i) {
+        _C.push_back(_high[i]);
+    }
+
+    // A(t) * B(t) = C(t) for the finite evaluation points, and
+    // a_{n-1} * b_{n-1} = c_{2n-2} at infinity.
+    const size_t num_points = 2 * n - 1;
+    for (size_t i = 0; i < num_points; ++i) {
+        const bool infinity = (i == num_points - 1);
+        const FieldT t = infinity ? FieldT::zero() : evaluation_point(i);
+        const libsnark::Fp2_variable<Fp2T> A_t =
+            infinity ? _A[n - 1] : fp2_polynomial_evaluate(_A, t);
+        const libsnark::Fp2_variable<Fp2T> C_t =
+            infinity ? _C[2 * n - 2] : fp2_polynomial_evaluate(_C, t);
+        if (square) {
+            _sqr_gadgets.emplace_back(new libsnark::Fp2_sqr_gadget<Fp2T>(
+                pb,
+                A_t,
+                C_t,
+                FMT(annotation_prefix, " _sqr_gadgets[%zu]", i)));
+        } else {
+            const libsnark::Fp2_variable<Fp2T> B_t =
+                infinity ? _B[n - 1] : fp2_polynomial_evaluate(_B, t);
+            _mul_gadgets.emplace_back(new libsnark::Fp2_mul_gadget<Fp2T>(
+                pb,
+                A_t,
+                B_t,
+                C_t,
+                FMT(annotation_prefix, " _mul_gadgets[%zu]", i)));
+        }
+    }
+}
+
+template<typename Fp2T>
+void Fp2_polynomial_mul_gadget<Fp2T>::generate_r1cs_constraints()
+{
+    for (const auto &gadget : _mul_gadgets) {
+        gadget->generate_r1cs_constraints();
+    }
+    for (const auto &gadget : _sqr_gadgets) {
+        gadget->generate_r1cs_constraints();
+    }
+}
+
+template<typename Fp2T>
+void Fp2_polynomial_mul_gadget<Fp2T>::generate_r1cs_witness()
+{
+    const size_t n = _A.size();
+    std::vector<Fp2T> a(n);
+    std::vector<Fp2T> b(n);
+    for (size_t i = 0; i < n; ++i) {
+        _A[i].evaluate();
+        _B[i].evaluate();
+        a[i] = _A[i].get_element();
+        b[i] = _B[i].get_element();
+    }
+    assign_product(a, b);
+
+    for (const auto &gadget : _mul_gadgets) {
+        gadget->A.evaluate();
+        gadget->B.evaluate();
+        gadget->result.evaluate();
+        gadget->generate_r1cs_witness();
+    }
+    for (const auto &gadget : _sqr_gadgets) {
+        gadget->A.evaluate();
+        gadget->result.evaluate();
+        gadget->generate_r1cs_witness();
+    }
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> Fp2_polynomial_mul_gadget<Fp2T>::generate_r1cs_witness_native(
+    const std::vector<Fp2T> &a, const std::vector<Fp2T> &b)
+{
+    const size_t n = _A.size();
+    assert(a.size() == n);
+    const std::vector<Fp2T> result =
+        assign_product(a, _sqr_gadgets.empty() ? b : a);
+
+    // The values of A(t), B(t) and C(t) are computed directly from the
+    // coefficients, rather than by evaluating the linear combinations, and
+    // the products at all the points are computed as a batch.
+    const size_t num_points = 2 * n - 1;
+    std::vector<Fp2T> a_t(num_points);
+    std::vector<Fp2T> b_t(num_points);
+    for (size_t i = 0; i < num_points; ++i) {
+        const bool infinity = (i == num_points - 1);
+        const FieldT t = infinity ? FieldT::zero() : evaluation_point(i);
+        a_t[i] = infinity ? a[n - 1] : evaluate_native(a, t);
+        if (_sqr_gadgets.empty()) {
+            b_t[i] = infinity ? b[n - 1] : evaluate_native(b, t);
+        }
+    }
+
+    if (!_sqr_gadgets.empty()) {
+        std::vector<libsnark::Fp2_sqr_gadget<Fp2T> *> gadgets;
+        for (const auto &gadget : _sqr_gadgets) {
+            gadgets.push_back(gadget.get());
+        }
+        fp2_sqr_native_witness_batch(gadgets, a_t);
+    } else {
+        std::vector<libsnark::Fp2_mul_gadget<Fp2T> *> gadgets;
+        for (const auto &gadget : _mul_gadgets) {
+            gadgets.push_back(gadget.get());
+        }
+        fp2_mul_native_witness_batch(this->pb, gadgets, a_t, b_t);
+    }
+
+    return result;
+}
+
+template<typename Fp2T>
+std::vector<Fp2T> Fp2_polynomial_mul_gadget<Fp2T>::assign_product(
+    const std::vector<Fp2T> &a, const std::vector<Fp2T> &b)
+{
+    const size_t n = _A.size();
+    const bool square = !_sqr_gadgets.empty();
+
+    // Unreduced product (schoolbook), where the products of coefficients are
+    // computed as a batch. When squaring, only the products a_i * a_j for
+    // i <= j are computed.
+    std::vector<Fp2T> lhs;
+    std::vector<Fp2T> rhs;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = square ? i : 0; j < n; ++j) {
+            lhs.push_back(a[i]);
+            rhs.push_back(b[j]);
+        }
+    }
+    const std::vector<Fp2T> products = fp2_batch_mul(lhs, rhs);
+
+    std::vector<Fp2T> c(2 * n - 1, Fp2T::zero());
+    size_t product_idx = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = square ? i : 0; j < n; ++j) {
+            const Fp2T &product = products[product_idx++];
+            c[i + j] = c[i + j] + product;
+            if (square && j != i) {
+                c[i + j] = c[i + j] + product;
+            }
+        }
+    }
+
+    // Reduce modulo X^n - non_residue
+    std::vector<Fp2T> result(n);
+    for (size_t i = 0; i < n - 1; ++i) {
+        result[i] = c[i] + _non_residue * c[n + i];
+        _high[i].generate_r1cs_witness(c[n + i]);
+        _result[i].generate_r1cs_witness(result[i]);
+    }
+    result[n - 1] = c[n - 1];
+    _result[n - 1].generate_r1cs_witness(result[n - 1]);
+
+    return result;
+}
+
+template<typename Fp2T>
+Fp2T Fp2_polynomial_mul_gadget<Fp2T>::evaluate_native(
+    const std::vector<Fp2T> &coeffs, const FieldT &t)
+{
+    // Horner's rule
+    Fp2T result = coeffs.back();
+    for (size_t i = coeffs.size() - 1; i-- > 0;) {
+        result = coeffs[i] + t * result;
+    }
+    return result;
+}
+
+template<typename Fp2T>
+typename Fp2T::my_Fp Fp2_polynomial_mul_gadget<Fp2T>::evaluation_point(
+    size_t i)
+{
+    // 0, 1, -1, 2, -2, ...
+    const FieldT magnitude((long)((i + 1) / 2));
+    return (i % 2) ? magnitude : -magnitude;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_FIELDS_FP2_POLYNOMIAL_GADGETS_TCC__
@@ -5,6 +5,9 @@
 #ifndef __ZECALE_CIRCUITS_FIELDS_FP6_3OVER2_GADGETS_HPP__
 #define __ZECALE_CIRCUITS_FIELDS_FP6_3OVER2_GADGETS_HPP__
 
+#include "libzecale/circuits/fields/fp2_native_witness.hpp"
+#include "libzecale/circuits/fields/fp2_polynomial_gadgets.hpp"
+
 #include <libff/algebra/curves/public_params.hpp>
 #include <libsnark/gadgetlib1/gadget.hpp>
 #include <libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.hpp>
@@ -108,8 +111,73 @@ public:
 
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the values a and b of A
+    /// and B (which are not read from the protoboard), and return the value
+    /// of the result.
+    Fp6T generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b);
+};
+
+/// Multiplication in Fp6 = Fp2[v] / (v^3 - non_residue) by interpolation
+/// (Toom-3), using 5 multiplications in Fp2 (15 constraints) instead of the 6
+/// of Fp6_3over2_mul_gadget (see Fp2_polynomial_mul_gadget).
+template<typename Fp6T>
+class Fp6_3over2_toom3_mul_gadget
+    : public libsnark::gadget<typename Fp6T::my_Fp>
+{
+public:
+    using FieldT = typename Fp6T::my_Fp;
+    using Fp2T = typename Fp6T::my_Fp2;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp6_3over2_variable<Fp6T> _B;
+    Fp6_3over2_variable<Fp6T> _result;
+    Fp2_polynomial_mul_gadget<Fp2T> _compute_product;
+
+    Fp6_3over2_toom3_mul_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &B,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fp6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp6T generate_r1cs_witness_native(const Fp6T &a, const Fp6T &b);
 };
 
+/// Squaring in Fp6 by interpolation, using 5 squarings in Fp2 (10
+/// constraints).
+template<typename Fp6T>
+class Fp6_3over2_toom3_square_gadget
+    : public libsnark::gadget<typename Fp6T::my_Fp>
+{
+public:
+    using FieldT = typename Fp6T::my_Fp;
+    using Fp2T = typename Fp6T::my_Fp2;
+
+    Fp6_3over2_variable<Fp6T> _A;
+    Fp6_3over2_variable<Fp6T> _result;
+    Fp2_polynomial_mul_gadget<Fp2T> _compute_square;
+
+    Fp6_3over2_toom3_square_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fp6T> &A,
+        const Fp6_3over2_variable<Fp6T> &result,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fp6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fp6T generate_r1cs_witness_native(const Fp6T &a);
+};
+
+/// The coefficients (c0, c1, c2) of an Fp6 variable, as a vector.
+template<typename Fp6T>
+std::vector<libsnark::Fp2_variable<typename Fp6T::my_Fp2>> fp6_coefficients(
+    const Fp6_3over2_variable<Fp6T> &el);
+
 } // namespace libzecale
 
 #include "libzecale/circuits/fields/fp6_3over2_gadgets.tcc"
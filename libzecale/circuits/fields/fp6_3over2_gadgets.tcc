@@ -278,6 +278,152 @@ void Fp6_3over2_mul_gadget<Fp6T>::generate_r1cs_witness()
     _compute_a0a2_times_b0b2.generate_r1cs_witness();
 }
 
+template<typename Fp6T>
+Fp6T Fp6_3over2_mul_gadget<Fp6T>::generate_r1cs_witness_native(
+    const Fp6T &a, const Fp6T &b)
+{
+    const Fp2T &a0 = a.coeffs[0];
+    const Fp2T &a1 = a.coeffs[1];
+    const Fp2T &a2 = a.coeffs[2];
+    const Fp2T &b0 = b.coeffs[0];
+    const Fp2T &b1 = b.coeffs[1];
+    const Fp2T &b2 = b.coeffs[2];
+
+    // The 6 products are independent, and computed as a batch.
+    const std::vector<Fp2T> products = fp2_mul_native_witness_batch<Fp2T>(
+        this->pb,
+        {&_compute_v1,
+         &_compute_v2,
+         &_compute_a1a2_times_b1b2,
+         &_compute_v0,
+         &_compute_a0a1_times_b0b1,
+         &_compute_a0a2_times_b0b2},
+        {a1, a2, a1 + a2, a0, a0 + a1, a0 + a2},
+        {b1, b2, b1 + b2, b0, b0 + b1, b0 + b2});
+    const Fp2T &v1 = products[0];
+    const Fp2T &v2 = products[1];
+    const Fp2T &a1a2_times_b1b2 = products[2];
+    const Fp2T &v0 = products[3];
+    const Fp2T &a0a1_times_b0b1 = products[4];
+    const Fp2T &a0a2_times_b0b2 = products[5];
+
+    const Fp6T result(
+        v0 + Fp6T::mul_by_non_residue(a1a2_times_b1b2 - v1 - v2),
+        a0a1_times_b0b1 - v0 - v1 + Fp6T::mul_by_non_residue(v2),
+        a0a2_times_b0b2 - v0 - v2 + v1);
+    _result.generate_r1cs_witness(result);
+    return result;
+}
+
+template<typename Fp6T>
+std::vector<libsnark::Fp2_variable<typename Fp6T::my_Fp2>> fp6_coefficients(
+    const Fp6_3over2_variable<Fp6T> &el)
+{
+    return {el._c0, el._c1, el._c2};
+}
+
+// Fp6_3over2_toom3_mul_gadget methods
+
+template<typename Fp6T>
+Fp6_3over2_toom3_mul_gadget<Fp6T>::Fp6_3over2_toom3_mul_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const Fp6_3over2_variable<Fp6T> &A,
+    const Fp6_3over2_variable<Fp6T> &B,
+    const Fp6_3over2_variable<Fp6T> &result,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _B(B)
+    , _result(result)
+    , _compute_product(
+          pb,
+          fp6_coefficients(A),
+          fp6_coefficients(B),
+          fp6_coefficients(result),
+          Fp6T::non_residue,
+          FMT(annotation_prefix, " _compute_product"))
+{
+}
+
+template<typename Fp6T>
+const Fp6_3over2_variable<Fp6T> &Fp6_3over2_toom3_mul_gadget<Fp6T>::result()
+    const
+{
+    return _result;
+}
+
+template<typename Fp6T>
+void Fp6_3over2_toom3_mul_gadget<Fp6T>::generate_r1cs_constraints()
+{
+    _compute_product.generate_r1cs_constraints();
+}
+
+template<typename Fp6T>
+void Fp6_3over2_toom3_mul_gadget<Fp6T>::generate_r1cs_witness()
+{
+    _compute_product.generate_r1cs_witness();
+}
+
+template<typename Fp6T>
+Fp6T Fp6_3over2_toom3_mul_gadget<Fp6T>::generate_r1cs_witness_native(
+    const Fp6T &a, const Fp6T &b)
+{
+    const std::vector<Fp2T> a_coeffs{a.coeffs[0], a.coeffs[1], a.coeffs[2]};
+    const std::vector<Fp2T> b_coeffs{b.coeffs[0], b.coeffs[1], b.coeffs[2]};
+    const std::vector<Fp2T> result =
+        _compute_product.generate_r1cs_witness_native(a_coeffs, b_coeffs);
+    return Fp6T(result[0], result[1], result[2]);
+}
+
+// Fp6_3over2_toom3_square_gadget methods
+
+template<typename Fp6T>
+Fp6_3over2_toom3_square_gadget<Fp6T>::Fp6_3over2_toom3_square_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const Fp6_3over2_variable<Fp6T> &A,
+    const Fp6_3over2_variable<Fp6T> &result,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _A(A)
+    , _result(result)
+    , _compute_square(
+          pb,
+          fp6_coefficients(A),
+          fp6_coefficients(result),
+          Fp6T::non_residue,
+          FMT(annotation_prefix, " _compute_square"))
+{
+}
+
+template<typename Fp6T>
+const Fp6_3over2_variable<Fp6T> &Fp6_3over2_toom3_square_gadget<
+    Fp6T>::result() const
+{
+    return _result;
+}
+
+template<typename Fp6T>
+void Fp6_3over2_toom3_square_gadget<Fp6T>::generate_r1cs_constraints()
+{
+    _compute_square.generate_r1cs_constraints();
+}
+
+template<typename Fp6T>
+void Fp6_3over2_toom3_square_gadget<Fp6T>::generate_r1cs_witness()
+{
+    _compute_square.generate_r1cs_witness();
+}
+
+template<typename Fp6T>
+Fp6T Fp6_3over2_toom3_square_gadget<Fp6T>::generate_r1cs_witness_native(
+    const Fp6T &a)
+{
+    const std::vector<Fp2T> a_coeffs{a.coeffs[0], a.coeffs[1], a.coeffs[2]};
+    const std::vector<Fp2T> result =
+        _compute_square.generate_r1cs_witness_native(a_coeffs, a_coeffs);
+    return Fp6T(result[0], result[1], result[2]);
+}
+
 } // namespace libzecale
 
 #endif // __ZECALE_CIRCUITS_FIELDS_FP6_3OVER2_GADGETS_TCC__
@@ -12,13 +12,19 @@
 namespace libzecale
 {
 
-/// Type definitions to use the groth16 verifier circuit.
-template<typename ppT> class groth16_verifier_parameters
+/// Type definitions to use the groth16 verifier circuit. `pairingCheckT`
+/// selects the gadget used for the pairing check of the verifier (see
+/// r1cs_gg_ppzksnark_online_verifier_gadget).
+template<
+    typename ppT,
+    typename pairingCheckT = check_e_equals_eee_gadget<ppT>>
+class groth16_verifier_parameters
 {
 public:
     using snark = libzeth::groth16_snark<ppT>;
 
-    using verifier_gadget = r1cs_gg_ppzksnark_verifier_gadget<ppT>;
+    using verifier_gadget =
+        r1cs_gg_ppzksnark_verifier_gadget<ppT, pairingCheckT>;
     using proof_variable_gadget = r1cs_gg_ppzksnark_proof_variable<ppT>;
     using verification_key_variable_gadget =
         r1cs_gg_ppzksnark_verification_key_variable<ppT>;
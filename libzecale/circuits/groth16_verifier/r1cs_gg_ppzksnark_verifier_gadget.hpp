@@ -13,6 +13,7 @@
 
 #include "libzecale/circuits/pairing/pairing_checks.hpp"
 #include "libzecale/circuits/pairing/pairing_params.hpp"
+#include "libzecale/core/logger.hpp"
 
 #include <libsnark/gadgetlib1/gadgets/basic_gadgets.hpp>
 #include <libsnark/gadgetlib1/gadgets/curves/weierstrass_g1_gadget.hpp>
@@ -24,6 +25,9 @@ namespace libzecale
 
 template<typename ppT> class pairing_selector;
 
+/// The proof points are enforced to be on the curve, and in the subgroups G1
+/// and G2 (see G1_membership_check_gadget and G2_membership_check_gadget in
+/// pairing_params.hpp).
 template<typename ppT>
 class r1cs_gg_ppzksnark_proof_variable : public libsnark::gadget<libff::Fr<ppT>>
 {
@@ -41,6 +45,10 @@ public:
         all_G1_checkers;
     std::shared_ptr<libsnark::G2_checker_gadget<ppT>> G2_checker;
 
+    std::vector<std::shared_ptr<G1_membership_check_gadget<ppT>>>
+        all_G1_membership_checks;
+    std::shared_ptr<G2_membership_check_gadget<ppT>> G2_membership_check;
+
     libsnark::pb_variable_array<FieldT> proof_contents;
 
     r1cs_gg_ppzksnark_proof_variable(
@@ -151,7 +159,11 @@ public:
     void generate_r1cs_witness();
 };
 
-template<typename ppT>
+/// `pairingCheckT` is the gadget used to check the QAP equation, which must
+/// have the interface of check_e_equals_eee_gadget (e.g.
+/// bls12_377_residue_check_e_equals_eee_gadget when verifying BLS12-377
+/// proofs).
+template<typename ppT, typename pairingCheckT = check_e_equals_eee_gadget<ppT>>
 class r1cs_gg_ppzksnark_online_verifier_gadget
     : public libsnark::gadget<libff::Fr<ppT>>
 {
@@ -182,7 +194,7 @@ public:
     std::shared_ptr<G1_precompute_gadget<ppT>> compute_proof_g_C_precomp;
     std::shared_ptr<G1_precompute_gadget<ppT>> compute_acc_precomp;
 
-    std::shared_ptr<check_e_equals_eee_gadget<ppT>> check_QAP_valid;
+    std::shared_ptr<pairingCheckT> check_QAP_valid;
 
     r1cs_gg_ppzksnark_online_verifier_gadget(
         libsnark::protoboard<FieldT> &pb,
@@ -197,7 +209,7 @@ public:
     void generate_r1cs_witness();
 };
 
-template<typename ppT>
+template<typename ppT, typename pairingCheckT = check_e_equals_eee_gadget<ppT>>
 class r1cs_gg_ppzksnark_verifier_gadget
     : public libsnark::gadget<libff::Fr<ppT>>
 {
@@ -210,7 +222,8 @@ public:
         pvk;
     std::shared_ptr<r1cs_gg_ppzksnark_verifier_process_vk_gadget<ppT>>
         compute_pvk;
-    std::shared_ptr<r1cs_gg_ppzksnark_online_verifier_gadget<ppT>>
+    std::shared_ptr<
+        r1cs_gg_ppzksnark_online_verifier_gadget<ppT, pairingCheckT>>
         online_verifier;
 
     r1cs_gg_ppzksnark_verifier_gadget(
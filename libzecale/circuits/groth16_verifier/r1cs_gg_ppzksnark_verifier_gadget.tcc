@@ -44,6 +44,18 @@ r1cs_gg_ppzksnark_proof_variable<ppT>::r1cs_gg_ppzksnark_proof_variable(
     G2_checker.reset(new libsnark::G2_checker_gadget<ppT>(
         pb, *g_B, FMT(annotation_prefix, " G2_checker")));
 
+    all_G1_membership_checks.resize(all_G1_vars.size());
+
+    for (size_t i = 0; i < all_G1_vars.size(); ++i) {
+        all_G1_membership_checks[i].reset(new G1_membership_check_gadget<ppT>(
+            pb,
+            *all_G1_vars[i],
+            FMT(annotation_prefix, " all_G1_membership_checks_%zu", i)));
+    }
+
+    G2_membership_check.reset(new G2_membership_check_gadget<ppT>(
+        pb, *g_B, FMT(annotation_prefix, " G2_membership_check")));
+
     assert(all_G1_vars.size() == num_G1);
     assert(all_G2_vars.size() == num_G2);
 }
@@ -56,6 +68,12 @@ void r1cs_gg_ppzksnark_proof_variable<ppT>::generate_r1cs_constraints()
     }
 
     G2_checker->generate_r1cs_constraints();
+
+    for (auto &G1_membership_check : all_G1_membership_checks) {
+        G1_membership_check->generate_r1cs_constraints();
+    }
+
+    G2_membership_check->generate_r1cs_constraints();
 }
 
 template<typename ppT>
@@ -84,6 +102,12 @@ void r1cs_gg_ppzksnark_proof_variable<ppT>::generate_r1cs_witness(
     }
 
     G2_checker->generate_r1cs_witness();
+
+    for (auto &G1_membership_check : all_G1_membership_checks) {
+        G1_membership_check->generate_r1cs_witness();
+    }
+
+    G2_membership_check->generate_r1cs_witness();
 }
 
 template<typename ppT> size_t r1cs_gg_ppzksnark_proof_variable<ppT>::size()
@@ -225,15 +249,11 @@ size_t r1cs_gg_ppzksnark_verification_key_variable<ppT>::size_in_bits(
     const size_t num_G2 = 2;
     const size_t result = libsnark::G1_variable<ppT>::size_in_bits() * num_G1 +
                           libsnark::G2_variable<ppT>::size_in_bits() * num_G2;
-    printf(
-        "G1_size_in_bits = %zu, G2_size_in_bits = %zu\n",
-        libsnark::G1_variable<ppT>::size_in_bits(),
-        libsnark::G2_variable<ppT>::size_in_bits());
-    printf(
-        "r1cs_gg_ppzksnark_verification_key_variable<ppT>::size_in_bits(%zu) = "
-        "%zu\n",
-        input_size,
-        result);
+    log_stream(log_level::debug)
+        << "G1_size_in_bits = " << libsnark::G1_variable<ppT>::size_in_bits()
+        << ", G2_size_in_bits = " << libsnark::G2_variable<ppT>::size_in_bits()
+        << ", r1cs_gg_ppzksnark_verification_key_variable<ppT>::size_in_bits("
+        << input_size << ") = " << result;
     return result;
 }
 
@@ -361,8 +381,8 @@ void r1cs_gg_ppzksnark_verifier_process_vk_gadget<ppT>::generate_r1cs_witness()
     compute_vk_delta_g2_precomp->generate_r1cs_witness();
 }
 
-template<typename ppT>
-r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::
+template<typename ppT, typename pairingCheckT>
+r1cs_gg_ppzksnark_online_verifier_gadget<ppT, pairingCheckT>::
     r1cs_gg_ppzksnark_online_verifier_gadget(
         libsnark::protoboard<FieldT> &pb,
         const r1cs_gg_ppzksnark_preprocessed_r1cs_gg_ppzksnark_verification_key_variable<
@@ -430,7 +450,7 @@ r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::
         FMT(annotation_prefix, " compute_acc_precomp")));
 
     // 3. Carry out the pairing checks to check QAP equation
-    check_QAP_valid.reset(new check_e_equals_eee_gadget<ppT>(
+    check_QAP_valid.reset(new pairingCheckT(
         pb,
         // LHS
         *proof_g_A_precomp,
@@ -447,18 +467,18 @@ r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::
         FMT(annotation_prefix, " check_QAP_valid")));
 }
 
-template<typename ppT>
-void r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::generate_r1cs_constraints()
+template<typename ppT, typename pairingCheckT>
+void r1cs_gg_ppzksnark_online_verifier_gadget<ppT, pairingCheckT>::
+    generate_r1cs_constraints()
 {
     // For the macros below
     using namespace libsnark;
 
     PROFILE_CONSTRAINTS(this->pb, "accumulate verifier input")
     {
-        libff::print_indent();
-        printf(
-            "* Number of bits as an input to verifier gadget: %zu\n",
-            input.size());
+        log_stream(log_level::debug)
+            << "Number of bits as an input to verifier gadget: "
+            << input.size();
         accumulate_input->generate_r1cs_constraints();
     }
 
@@ -473,8 +493,9 @@ void r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::generate_r1cs_constraints()
     }
 }
 
-template<typename ppT>
-void r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::generate_r1cs_witness()
+template<typename ppT, typename pairingCheckT>
+void r1cs_gg_ppzksnark_online_verifier_gadget<ppT, pairingCheckT>::
+    generate_r1cs_witness()
 {
     accumulate_input->generate_r1cs_witness();
 
@@ -486,15 +507,16 @@ void r1cs_gg_ppzksnark_online_verifier_gadget<ppT>::generate_r1cs_witness()
     check_QAP_valid->generate_r1cs_witness();
 }
 
-template<typename ppT>
-r1cs_gg_ppzksnark_verifier_gadget<ppT>::r1cs_gg_ppzksnark_verifier_gadget(
-    libsnark::protoboard<FieldT> &pb,
-    const r1cs_gg_ppzksnark_verification_key_variable<ppT> &vk,
-    const libsnark::pb_variable_array<FieldT> &input,
-    const size_t elt_size,
-    const r1cs_gg_ppzksnark_proof_variable<ppT> &proof,
-    const libsnark::pb_variable<FieldT> &result,
-    const std::string &annotation_prefix)
+template<typename ppT, typename pairingCheckT>
+r1cs_gg_ppzksnark_verifier_gadget<ppT, pairingCheckT>::
+    r1cs_gg_ppzksnark_verifier_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const r1cs_gg_ppzksnark_verification_key_variable<ppT> &vk,
+        const libsnark::pb_variable_array<FieldT> &input,
+        const size_t elt_size,
+        const r1cs_gg_ppzksnark_proof_variable<ppT> &proof,
+        const libsnark::pb_variable<FieldT> &result,
+        const std::string &annotation_prefix)
     : libsnark::gadget<FieldT>(pb, annotation_prefix)
 {
     pvk.reset(
@@ -502,18 +524,20 @@ r1cs_gg_ppzksnark_verifier_gadget<ppT>::r1cs_gg_ppzksnark_verifier_gadget(
             ppT>());
     compute_pvk.reset(new r1cs_gg_ppzksnark_verifier_process_vk_gadget<ppT>(
         pb, vk, *pvk, FMT(annotation_prefix, " compute_pvk")));
-    online_verifier.reset(new r1cs_gg_ppzksnark_online_verifier_gadget<ppT>(
-        pb,
-        *pvk,
-        input,
-        elt_size,
-        proof,
-        result,
-        FMT(annotation_prefix, " online_verifier")));
+    online_verifier.reset(
+        new r1cs_gg_ppzksnark_online_verifier_gadget<ppT, pairingCheckT>(
+            pb,
+            *pvk,
+            input,
+            elt_size,
+            proof,
+            result,
+            FMT(annotation_prefix, " online_verifier")));
 }
 
-template<typename ppT>
-void r1cs_gg_ppzksnark_verifier_gadget<ppT>::generate_r1cs_constraints()
+template<typename ppT, typename pairingCheckT>
+void r1cs_gg_ppzksnark_verifier_gadget<ppT, pairingCheckT>::
+    generate_r1cs_constraints()
 {
     // For the macros below
     using namespace libsnark;
@@ -529,8 +553,9 @@ void r1cs_gg_ppzksnark_verifier_gadget<ppT>::generate_r1cs_constraints()
     }
 }
 
-template<typename ppT>
-void r1cs_gg_ppzksnark_verifier_gadget<ppT>::generate_r1cs_witness()
+template<typename ppT, typename pairingCheckT>
+void r1cs_gg_ppzksnark_verifier_gadget<ppT, pairingCheckT>::
+    generate_r1cs_witness()
 {
     compute_pvk->generate_r1cs_witness();
     online_verifier->generate_r1cs_witness();
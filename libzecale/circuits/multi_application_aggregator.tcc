@@ -0,0 +1,314 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_MULTI_APPLICATION_AGGREGATOR_TCC__
+#define __ZECALE_CIRCUITS_MULTI_APPLICATION_AGGREGATOR_TCC__
+
+#include "libzecale/circuits/verification_key_hash.tcc"
+
+#include <libff/algebra/fields/field_utils.hpp>
+#include <libsnark/gadgetlib1/gadgets/basic_gadgets.hpp>
+#include <libzeth/core/extended_proof.hpp>
+
+namespace libzecale
+{
+
+/// Variant of the `aggregator_gadget` in which the `NumProofs` nested proofs
+/// may be verified against `NumVKs` different verification keys, i.e. the
+/// nested proofs may belong to several registered applications. This allows
+/// applications with low traffic to share the cost of a single wrapping proof.
+///
+/// The digest of each of the `NumVKs` VKs (computed as for the
+/// `nested_vk_hash` of the `aggregator_gadget`) is a primary input, so that
+/// the verifier can check that the VKs are those registered for the
+/// applications. Each proof slot `i` is assigned a VK index `vk_indices[i]`
+/// in [0, NumVKs), which is also a primary input of the circuit (so that the
+/// verifier knows which application each slot belongs to). In the circuit,
+/// the index is
+/// represented by a one-hot vector of boolean selectors, and the (packed)
+/// variables of the VK used to verify slot `i` are constrained to be equal to
+/// those of the selected VK:
+///
+///   for all k, j:
+///     selector[i][k] * (slot_vk[i].all_vars[j] - vk[k].all_vars[j]) = 0
+///
+/// The selection is done on the packed VK variables rather than on the bits,
+/// which keeps the cost of the selection to
+/// `NumProofs * NumVKs * num_packed_vk_vars` constraints, negligible compared
+/// to the cost of the verifiers.
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+class multi_application_aggregator_gadget : libsnark::gadget<libff::Fr<wppT>>
+{
+private:
+    using FieldT = libff::Fr<wppT>;
+    using verifier_gadget = typename wverifierT::verifier_gadget;
+    using proof_variable_gadget = typename wverifierT::proof_variable_gadget;
+    using verification_key_variable_gadget =
+        typename wverifierT::verification_key_variable_gadget;
+    using vk_hash_gadget =
+        verification_key_hash_gadget<FieldT, verification_key_variable_gadget>;
+
+    // See `aggregator_gadget`
+    static const size_t nb_zeth_inputs = 9;
+
+    std::array<std::shared_ptr<verifier_gadget>, NumProofs> verifiers;
+
+    libsnark::pb_variable<FieldT> wZero;
+
+    /// ---- Primary inputs (public) ---- //
+
+    /// Digest of each of the `nested_vks` (see `compute_nested_vk_hash`)
+    std::array<libsnark::pb_variable<FieldT>, NumVKs> nested_vk_hashes;
+
+    /// Index of the VK used to verify each nested proof
+    libsnark::pb_variable_array<FieldT> vk_indices;
+
+    /// The nested primary inputs (see `aggregator_gadget`)
+    std::array<libsnark::pb_variable_array<FieldT>, NumProofs>
+        nested_primary_inputs;
+
+    /// The array of the results of the verifiers
+    std::array<libsnark::pb_variable<FieldT>, NumProofs> nested_proofs_results;
+
+    /// ---- Auxiliary inputs (private) ---- //
+
+    /// The `NumVKs` (nested) verification keys
+    std::array<std::shared_ptr<verification_key_variable_gadget>, NumVKs>
+        nested_vks;
+
+    /// Compute the digests of the `nested_vks` into `nested_vk_hashes`
+    std::array<std::shared_ptr<vk_hash_gadget>, NumVKs> nested_vk_hashers;
+
+    /// One-hot encoding of `vk_indices`
+    std::array<libsnark::pb_variable_array<FieldT>, NumProofs> vk_selectors;
+
+    /// The VK used to verify each nested proof, constrained to be equal to
+    /// one of the `nested_vks`
+    std::array<std::shared_ptr<verification_key_variable_gadget>, NumProofs>
+        slot_vks;
+
+    /// The `NumProofs` proofs to verify
+    std::array<std::shared_ptr<proof_variable_gadget>, NumProofs> nested_proofs;
+
+public:
+    explicit multi_application_aggregator_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const std::string &annotation_prefix =
+            "multi_application_aggregator_gadget")
+        : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    {
+        // The primary inputs are:
+        // - The digest of each nested VK
+        // - The VK index of each proof slot
+        // - The nested primary inputs and verification results, laid out as
+        //   in `aggregator_gadget`
+        for (size_t k = 0; k < NumVKs; k++) {
+            nested_vk_hashes[k].allocate(
+                pb, FMT(this->annotation_prefix, " nested_vk_hashes[%zu]", k));
+        }
+        vk_indices.allocate(
+            pb, NumProofs, FMT(this->annotation_prefix, " vk_indices"));
+
+        const size_t nb_zeth_inputs_in_bits =
+            nb_zeth_inputs * libff::Fr<nppT>::size_in_bits();
+        for (size_t i = 0; i < NumProofs; i++) {
+            nested_primary_inputs[i].allocate(
+                pb,
+                nb_zeth_inputs_in_bits,
+                FMT(this->annotation_prefix,
+                    " nested_primary_inputs[%zu]-(in bits)",
+                    i));
+            nested_proofs_results[i].allocate(
+                pb,
+                FMT(this->annotation_prefix, " nested_proofs_results[%zu]", i));
+        }
+
+        const size_t primary_input_size =
+            NumVKs + NumProofs + NumProofs * (nb_zeth_inputs + 1);
+        pb.set_input_sizes(primary_input_size);
+
+        wZero.allocate(pb, FMT(this->annotation_prefix, " wZero"));
+
+        // The nested VKs, each interpreted as an array of bits
+        const size_t vk_size_in_bits =
+            verification_key_variable_gadget::size_in_bits(nb_zeth_inputs);
+        for (size_t k = 0; k < NumVKs; k++) {
+            libsnark::pb_variable_array<FieldT> nested_vk_bits;
+            nested_vk_bits.allocate(
+                pb,
+                vk_size_in_bits,
+                FMT(this->annotation_prefix, " nested_vk_bits[%zu]", k));
+            nested_vks[k].reset(new verification_key_variable_gadget(
+                pb,
+                nested_vk_bits,
+                nb_zeth_inputs,
+                FMT(this->annotation_prefix, " nested_vks[%zu]", k)));
+            nested_vk_hashers[k].reset(new vk_hash_gadget(
+                pb,
+                *nested_vks[k],
+                wZero,
+                nested_vk_hashes[k],
+                FMT(this->annotation_prefix, " nested_vk_hashers[%zu]", k)));
+        }
+
+        for (size_t i = 0; i < NumProofs; i++) {
+            vk_selectors[i].allocate(
+                pb,
+                NumVKs,
+                FMT(this->annotation_prefix, " vk_selectors[%zu]", i));
+
+            libsnark::pb_variable_array<FieldT> slot_vk_bits;
+            slot_vk_bits.allocate(
+                pb,
+                vk_size_in_bits,
+                FMT(this->annotation_prefix, " slot_vk_bits[%zu]", i));
+            slot_vks[i].reset(new verification_key_variable_gadget(
+                pb,
+                slot_vk_bits,
+                nb_zeth_inputs,
+                FMT(this->annotation_prefix, " slot_vks[%zu]", i)));
+
+            nested_proofs[i].reset(new proof_variable_gadget(
+                pb, FMT(this->annotation_prefix, " nested_proofs[%zu]", i)));
+        }
+
+        // Initialize the verifier gadgets
+        for (size_t i = 0; i < NumProofs; i++) {
+            verifiers[i].reset(new verifier_gadget(
+                pb,
+                *slot_vks[i],
+                nested_primary_inputs[i],
+                libff::Fr<nppT>::size_in_bits(),
+                *nested_proofs[i],
+                nested_proofs_results[i],
+                FMT(this->annotation_prefix, " verifiers[%zu]", i)));
+        }
+    }
+
+    void generate_r1cs_constraints()
+    {
+        libsnark::generate_r1cs_equals_const_constraint<FieldT>(
+            this->pb,
+            wZero,
+            FieldT::zero(),
+            FMT(this->annotation_prefix, " wZero"));
+
+        for (size_t k = 0; k < NumVKs; k++) {
+            nested_vks[k]->generate_r1cs_constraints(true); // ensure bitness
+            nested_vk_hashers[k]->generate_r1cs_constraints();
+        }
+
+        for (size_t i = 0; i < NumProofs; i++) {
+            // The selectors are a one-hot encoding of vk_indices[i]
+            libsnark::linear_combination<FieldT> selectors_sum;
+            libsnark::linear_combination<FieldT> selected_index;
+            for (size_t k = 0; k < NumVKs; k++) {
+                libsnark::generate_boolean_r1cs_constraint<FieldT>(
+                    this->pb,
+                    vk_selectors[i][k],
+                    FMT(this->annotation_prefix,
+                        " vk_selectors[%zu][%zu]_is_boolean",
+                        i,
+                        k));
+                selectors_sum = selectors_sum + vk_selectors[i][k];
+                selected_index =
+                    selected_index + FieldT(k) * vk_selectors[i][k];
+            }
+            this->pb.add_r1cs_constraint(
+                libsnark::r1cs_constraint<FieldT>(
+                    FieldT::one(), selectors_sum, FieldT::one()),
+                FMT(this->annotation_prefix, " vk_selectors[%zu]_one_hot", i));
+            this->pb.add_r1cs_constraint(
+                libsnark::r1cs_constraint<FieldT>(
+                    FieldT::one(), selected_index, vk_indices[i]),
+                FMT(this->annotation_prefix, " vk_indices[%zu]", i));
+
+            // The slot VK is equal to the selected VK
+            slot_vks[i]->generate_r1cs_constraints(true);
+            const size_t num_vk_vars = slot_vks[i]->all_vars.size();
+            for (size_t k = 0; k < NumVKs; k++) {
+                assert(nested_vks[k]->all_vars.size() == num_vk_vars);
+                for (size_t j = 0; j < num_vk_vars; j++) {
+                    this->pb.add_r1cs_constraint(
+                        libsnark::r1cs_constraint<FieldT>(
+                            vk_selectors[i][k],
+                            slot_vks[i]->all_vars[j] -
+                                nested_vks[k]->all_vars[j],
+                            FieldT::zero()),
+                        FMT(this->annotation_prefix,
+                            " slot_vks[%zu]_select_vk[%zu]_var[%zu]",
+                            i,
+                            k,
+                            j));
+                }
+            }
+
+            nested_proofs[i]->generate_r1cs_constraints();
+            verifiers[i]->generate_r1cs_constraints();
+        }
+    }
+
+    void generate_r1cs_witness(
+        const std::array<const typename nsnarkT::verification_key *, NumVKs>
+            &in_nested_vks,
+        const std::array<size_t, NumProofs> &in_vk_indices,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &in_extended_proofs)
+    {
+        this->pb.val(wZero) = FieldT::zero();
+
+        for (size_t k = 0; k < NumVKs; k++) {
+            nested_vks[k]->generate_r1cs_witness(*in_nested_vks[k]);
+            nested_vk_hashers[k]->generate_r1cs_witness();
+        }
+
+        for (size_t i = 0; i < NumProofs; i++) {
+            const size_t vk_idx = in_vk_indices[i];
+            if (vk_idx >= NumVKs) {
+                throw std::invalid_argument("invalid vk index");
+            }
+
+            this->pb.val(vk_indices[i]) = FieldT(vk_idx);
+            for (size_t k = 0; k < NumVKs; k++) {
+                this->pb.val(vk_selectors[i][k]) =
+                    (k == vk_idx) ? FieldT::one() : FieldT::zero();
+            }
+            slot_vks[i]->generate_r1cs_witness(*in_nested_vks[vk_idx]);
+
+            nested_proofs[i]->generate_r1cs_witness(
+                in_extended_proofs[i]->get_proof());
+
+            // See `aggregator_gadget::generate_r1cs_witness`
+            const libsnark::r1cs_primary_input<libff::Fr<nppT>>
+                &other_curve_primary_inputs =
+                    in_extended_proofs[i]->get_primary_inputs();
+            const libff::bit_vector input_bits =
+                libff::convert_field_element_vector_to_bit_vector<
+                    libff::Fr<nppT>>(other_curve_primary_inputs);
+            nested_primary_inputs[i].fill_with_bits(this->pb, input_bits);
+
+            verifiers[i]->generate_r1cs_witness();
+        }
+    }
+
+    /// Compute (natively) the digest of a nested VK, i.e. the value of the
+    /// corresponding `nested_vk_hashes` primary input.
+    static FieldT compute_nested_vk_hash(
+        const typename nsnarkT::verification_key &vk)
+    {
+        return vk_hash_gadget::compute_hash(
+            verification_key_variable_gadget::get_verification_key_bits(vk));
+    }
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_MULTI_APPLICATION_AGGREGATOR_TCC__
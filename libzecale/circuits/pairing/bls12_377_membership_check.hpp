@@ -0,0 +1,230 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+/// Reference
+/// \[Sco21]:
+///  "A note on group membership tests for G1, G2 and GT on BLS
+///  pairing-friendly curves" Michael Scott, IACR Cryptology ePrint Archive
+///  2021, <https://eprint.iacr.org/2021/1130>
+
+#ifndef __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_HPP__
+#define __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_HPP__
+
+#include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
+
+#include <libsnark/gadgetlib1/gadgets/curves/weierstrass_g1_gadget.hpp>
+#include <libsnark/gadgetlib1/gadgets/curves/weierstrass_g2_gadget.hpp>
+#include <memory>
+#include <vector>
+
+namespace libzecale
+{
+
+/// Computes [z]P for a point P of BLS12-377 E(Fq), where z is the curve
+/// parameter (libff::bls12_377_final_exponent_z, ignoring its sign), by
+/// double-and-add over the bits of z. The affine formulas of
+/// libsnark::G1_dbl_gadget and libsnark::G1_add_gadget only hold when no
+/// intermediate point is the point at infinity, and the latter enforces that
+/// the added points are distinct. This is always the case for P in G1, and
+/// otherwise the constraints can be unsatisfiable (but never satisfied by an
+/// incorrect result).
+template<typename ppT>
+class bls12_377_G1_mul_by_z_gadget : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    libsnark::G1_variable<ppT> _P;
+    std::vector<std::shared_ptr<libsnark::G1_variable<ppT>>> _R;
+    std::vector<std::shared_ptr<libsnark::G1_dbl_gadget<ppT>>> _dbls;
+    std::vector<std::shared_ptr<libsnark::G1_add_gadget<ppT>>> _adds;
+
+    bls12_377_G1_mul_by_z_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G1_variable<ppT> &P,
+        const std::string &annotation_prefix);
+
+    const libsnark::G1_variable<ppT> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Doubling of a point R of the BLS12-377 twist E'(Fq2), in affine
+/// coordinates (see bls12_377_ate_dbl_affine_gadget, which also computes the
+/// coefficients of the tangent):
+///
+///   lambda * 2 * R.Y = 3 * R.X^2
+///   out_R.X = lambda^2 - 2 * R.X
+///   out_R.Y = lambda * (R.X - out_R.X) - R.Y
+template<typename ppT>
+class bls12_377_G2_dbl_gadget : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+    typedef libff::Fqe<other_curve<ppT>> FqeT;
+
+    libsnark::G2_variable<ppT> _in_R;
+    libsnark::G2_variable<ppT> _out_R;
+    Fqe_variable<ppT> _lambda;
+
+    // R.X^2
+    Fqe_sqr_gadget<ppT> _compute_Rx_squared;
+    // lambda * 2 * R.Y = 3 * R.X^2
+    Fqe_mul_gadget<ppT> _check_lambda;
+    // lambda^2 = out_R.X + 2 * R.X
+    Fqe_sqr_gadget<ppT> _check_out_Rx;
+    // lambda * (R.X - out_R.X) = out_R.Y + R.Y
+    Fqe_mul_gadget<ppT> _check_out_Ry;
+
+    bls12_377_G2_dbl_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &R,
+        const libsnark::G2_variable<ppT> &out_R,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Addition of two points Q and R of the BLS12-377 twist E'(Fq2), in affine
+/// coordinates:
+///
+///   lambda * (Q.X - R.X) = Q.Y - R.Y
+///   out_R.X = lambda^2 - R.X - Q.X
+///   out_R.Y = lambda * (R.X - out_R.X) - R.Y
+///
+/// Q.X - R.X is also constrained to be invertible (i.e. R != +/-Q), without
+/// which lambda would be unconstrained for R = Q.
+template<typename ppT>
+class bls12_377_G2_add_gadget : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+    typedef libff::Fqe<other_curve<ppT>> FqeT;
+
+    libsnark::G2_variable<ppT> _Q;
+    libsnark::G2_variable<ppT> _in_R;
+    libsnark::G2_variable<ppT> _out_R;
+    Fqe_variable<ppT> _lambda;
+    Fqe_variable<ppT> _inv;
+
+    // lambda * (Q.X - R.X) = Q.Y - R.Y
+    Fqe_mul_gadget<ppT> _check_lambda;
+    // inv * (Q.X - R.X) = 1
+    Fqe_mul_gadget<ppT> _check_no_special_cases;
+    // lambda^2 = out_R.X + R.X + Q.X
+    Fqe_sqr_gadget<ppT> _check_out_Rx;
+    // lambda * (R.X - out_R.X) = out_R.Y + R.Y
+    Fqe_mul_gadget<ppT> _check_out_Ry;
+
+    bls12_377_G2_add_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        const libsnark::G2_variable<ppT> &R,
+        const libsnark::G2_variable<ppT> &out_R,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Computes [z]Q for a point Q of the BLS12-377 twist E'(Fq2), as
+/// bls12_377_G1_mul_by_z_gadget does in E(Fq).
+template<typename ppT>
+class bls12_377_G2_mul_by_z_gadget : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    libsnark::G2_variable<ppT> _Q;
+    std::vector<std::shared_ptr<libsnark::G2_variable<ppT>>> _R;
+    std::vector<std::shared_ptr<bls12_377_G2_dbl_gadget<ppT>>> _dbls;
+    std::vector<std::shared_ptr<bls12_377_G2_add_gadget<ppT>>> _adds;
+
+    bls12_377_G2_mul_by_z_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        const std::string &annotation_prefix);
+
+    const libsnark::G2_variable<ppT> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Enforces that a point P of BLS12-377 E(Fq) (already constrained to be on
+/// the curve, e.g. by libsnark::G1_checker_gadget) is in the subgroup G1 of
+/// order r. The endomorphism phi(x, y) = (omega * x, y), where omega is a
+/// primitive cube root of unity in Fq, acts on G1 as the multiplication by
+/// -z^2, and [Sco21]:
+///
+///   P in G1 <=> phi(P) = [-z^2]P
+///
+/// which only requires [z]([z]P) (two multiplications by the 64-bit, low
+/// Hamming weight z), instead of a multiplication by the 253-bit r.
+template<typename ppT>
+class bls12_377_G1_membership_check_gadget
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+
+    libsnark::G1_variable<ppT> _P;
+    bls12_377_G1_mul_by_z_gadget<ppT> _compute_z_P;
+    bls12_377_G1_mul_by_z_gadget<ppT> _compute_z_squared_P;
+
+    bls12_377_G1_membership_check_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G1_variable<ppT> &P,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+    /// The cube root of unity omega such that phi acts as -z^2 on G1.
+    static FqT endomorphism_omega();
+};
+
+/// Enforces that a point Q of the BLS12-377 twist E'(Fq2) (already
+/// constrained to be on the curve, e.g. by libsnark::G2_checker_gadget) is in
+/// the subgroup G2 of order r. The endomorphism
+///
+///   psi(x, y) = (conj(x) * twist_mul_by_q_X, conj(y) * twist_mul_by_q_Y)
+///
+/// (untwist-Frobenius-twist, see libff::bls12_377_G2::mul_by_q) acts on G2 as
+/// the multiplication by q = z mod r, and [Sco21]:
+///
+///   Q in G2 <=> psi(Q) = [z]Q
+///
+/// Since psi is linear in the coordinates, the check costs a single
+/// multiplication by z.
+template<typename ppT>
+class bls12_377_G2_membership_check_gadget
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+    typedef libff::Fqe<other_curve<ppT>> FqeT;
+
+    libsnark::G2_variable<ppT> _Q;
+    bls12_377_G2_mul_by_z_gadget<ppT> _compute_z_Q;
+
+    bls12_377_G2_membership_check_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+private:
+    /// Enforces conj(a) * c = sign * b.
+    void generate_conjugate_times_constant_constraints(
+        const Fqe_variable<ppT> &a,
+        const FqeT &c,
+        const Fqe_variable<ppT> &b,
+        const FqT &sign,
+        const std::string &annotation);
+};
+
+} // namespace libzecale
+
+#include "libzecale/circuits/pairing/bls12_377_membership_check.tcc"
+
+#endif // __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_HPP__
@@ -0,0 +1,462 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_TCC__
+#define __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_TCC__
+
+#include "libzecale/circuits/pairing/bls12_377_membership_check.hpp"
+
+namespace libzecale
+{
+
+// bls12_377_G1_mul_by_z_gadget methods
+
+template<typename ppT>
+bls12_377_G1_mul_by_z_gadget<ppT>::bls12_377_G1_mul_by_z_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const libsnark::G1_variable<ppT> &P,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix), _P(P)
+{
+    const libsnark::G1_variable<ppT> *res = &_P;
+
+    // Iterate through the bits of z, skipping the most significant one.
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        // res <- 2 * res
+        _R.push_back(std::shared_ptr<libsnark::G1_variable<ppT>>(
+            new libsnark::G1_variable<ppT>(
+                pb, FMT(annotation_prefix, " R%zu", _R.size()))));
+        _dbls.push_back(std::shared_ptr<libsnark::G1_dbl_gadget<ppT>>(
+            new libsnark::G1_dbl_gadget<ppT>(
+                pb,
+                *res,
+                *_R.back(),
+                FMT(annotation_prefix, " _dbls[%zu]", _dbls.size()))));
+        res = &(*_R.back());
+
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            // res <- res + P
+            _R.push_back(std::shared_ptr<libsnark::G1_variable<ppT>>(
+                new libsnark::G1_variable<ppT>(
+                    pb, FMT(annotation_prefix, " R%zu", _R.size()))));
+            _adds.push_back(std::shared_ptr<libsnark::G1_add_gadget<ppT>>(
+                new libsnark::G1_add_gadget<ppT>(
+                    pb,
+                    *res,
+                    _P,
+                    *_R.back(),
+                    FMT(annotation_prefix, " _adds[%zu]", _adds.size()))));
+            res = &(*_R.back());
+        }
+    }
+}
+
+template<typename ppT>
+const libsnark::G1_variable<ppT> &bls12_377_G1_mul_by_z_gadget<ppT>::result()
+    const
+{
+    return *_R.back();
+}
+
+template<typename ppT>
+void bls12_377_G1_mul_by_z_gadget<ppT>::generate_r1cs_constraints()
+{
+    for (const auto &dbl : _dbls) {
+        dbl->generate_r1cs_constraints();
+    }
+    for (const auto &add : _adds) {
+        add->generate_r1cs_constraints();
+    }
+}
+
+template<typename ppT>
+void bls12_377_G1_mul_by_z_gadget<ppT>::generate_r1cs_witness()
+{
+    // Each step depends on the result of the previous one, so the witness
+    // must be generated in the order of the bits.
+    size_t add_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        _dbls[num_bits - 1 - bit_idx]->generate_r1cs_witness();
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            _adds[add_idx++]->generate_r1cs_witness();
+        }
+    }
+}
+
+// bls12_377_G2_dbl_gadget methods
+
+template<typename ppT>
+bls12_377_G2_dbl_gadget<ppT>::bls12_377_G2_dbl_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const libsnark::G2_variable<ppT> &R,
+    const libsnark::G2_variable<ppT> &out_R,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _in_R(R)
+    , _out_R(out_R)
+    , _lambda(pb, FMT(annotation_prefix, " lambda"))
+
+    // Rx^2
+    , _compute_Rx_squared(
+          pb,
+          *_in_R.X,
+          Fqe_variable<ppT>(pb, FMT(annotation_prefix, " Rx_squared")),
+          FMT(annotation_prefix, " _compute_Rx_squared"))
+
+    // lambda * 2 * Ry = 3 * Rx^2
+    , _check_lambda(
+          pb,
+          _lambda,
+          *_in_R.Y * FqT(2),
+          _compute_Rx_squared.result * FqT(3),
+          FMT(annotation_prefix, " _check_lambda"))
+
+    // lambda^2 = outRx + 2 * Rx
+    , _check_out_Rx(
+          pb,
+          _lambda,
+          *_out_R.X + *_in_R.X * FqT(2),
+          FMT(annotation_prefix, " _check_out_Rx"))
+
+    // lambda * (Rx - outRx) = outRy + Ry
+    , _check_out_Ry(
+          pb,
+          _lambda,
+          *_in_R.X - *_out_R.X,
+          *_out_R.Y + *_in_R.Y,
+          FMT(annotation_prefix, " _check_out_Ry"))
+{
+}
+
+template<typename ppT>
+void bls12_377_G2_dbl_gadget<ppT>::generate_r1cs_constraints()
+{
+    _compute_Rx_squared.generate_r1cs_constraints();
+    _check_lambda.generate_r1cs_constraints();
+    _check_out_Rx.generate_r1cs_constraints();
+    _check_out_Ry.generate_r1cs_constraints();
+}
+
+template<typename ppT>
+void bls12_377_G2_dbl_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqeT Rx = _in_R.X->get_element();
+    const FqeT Ry = _in_R.Y->get_element();
+
+    // lambda = 3 * Rx^2 / (2 * Ry)
+    _compute_Rx_squared.generate_r1cs_witness();
+    const FqeT lambda = (FqT(3) * _compute_Rx_squared.result.get_element()) *
+                        (FqT(2) * Ry).inverse();
+    _lambda.generate_r1cs_witness(lambda);
+    _check_lambda.B.evaluate();
+    _check_lambda.result.evaluate();
+    _check_lambda.generate_r1cs_witness();
+
+    // outRx = lambda^2 - 2 * Rx
+    const FqeT out_Rx = lambda.squared() - FqT(2) * Rx;
+    _out_R.X->generate_r1cs_witness(out_Rx);
+    _check_out_Rx.result.evaluate();
+    _check_out_Rx.generate_r1cs_witness();
+
+    // outRy = lambda * (Rx - outRx) - Ry
+    _out_R.Y->generate_r1cs_witness(lambda * (Rx - out_Rx) - Ry);
+    _check_out_Ry.B.evaluate();
+    _check_out_Ry.result.evaluate();
+    _check_out_Ry.generate_r1cs_witness();
+}
+
+// bls12_377_G2_add_gadget methods
+
+template<typename ppT>
+bls12_377_G2_add_gadget<ppT>::bls12_377_G2_add_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const libsnark::G2_variable<ppT> &Q,
+    const libsnark::G2_variable<ppT> &R,
+    const libsnark::G2_variable<ppT> &out_R,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _Q(Q)
+    , _in_R(R)
+    , _out_R(out_R)
+    , _lambda(pb, FMT(annotation_prefix, " lambda"))
+    , _inv(pb, FMT(annotation_prefix, " inv"))
+
+    // lambda * (Qx - Rx) = Qy - Ry
+    , _check_lambda(
+          pb,
+          _lambda,
+          *_Q.X - *_in_R.X,
+          *_Q.Y - *_in_R.Y,
+          FMT(annotation_prefix, " _check_lambda"))
+
+    // inv * (Qx - Rx) = 1
+    , _check_no_special_cases(
+          pb,
+          _inv,
+          *_Q.X - *_in_R.X,
+          Fqe_variable<ppT>(pb, FqeT::one(), FMT(annotation_prefix, " one")),
+          FMT(annotation_prefix, " _check_no_special_cases"))
+
+    // lambda^2 = outRx + Rx + Qx
+    , _check_out_Rx(
+          pb,
+          _lambda,
+          *_out_R.X + *_in_R.X + *_Q.X,
+          FMT(annotation_prefix, " _check_out_Rx"))
+
+    // lambda * (Rx - outRx) = outRy + Ry
+    , _check_out_Ry(
+          pb,
+          _lambda,
+          *_in_R.X - *_out_R.X,
+          *_out_R.Y + *_in_R.Y,
+          FMT(annotation_prefix, " _check_out_Ry"))
+{
+}
+
+template<typename ppT>
+void bls12_377_G2_add_gadget<ppT>::generate_r1cs_constraints()
+{
+    _check_lambda.generate_r1cs_constraints();
+    _check_no_special_cases.generate_r1cs_constraints();
+    _check_out_Rx.generate_r1cs_constraints();
+    _check_out_Ry.generate_r1cs_constraints();
+}
+
+template<typename ppT>
+void bls12_377_G2_add_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqeT Qx = _Q.X->get_element();
+    const FqeT Qy = _Q.Y->get_element();
+    const FqeT Rx = _in_R.X->get_element();
+    const FqeT Ry = _in_R.Y->get_element();
+
+    // inv = 1 / (Qx - Rx)
+    const FqeT inv = (Qx - Rx).inverse();
+    _inv.generate_r1cs_witness(inv);
+    _check_no_special_cases.B.evaluate();
+    _check_no_special_cases.generate_r1cs_witness();
+
+    // lambda = (Qy - Ry) / (Qx - Rx)
+    const FqeT lambda = (Qy - Ry) * inv;
+    _lambda.generate_r1cs_witness(lambda);
+    _check_lambda.B.evaluate();
+    _check_lambda.result.evaluate();
+    _check_lambda.generate_r1cs_witness();
+
+    // outRx = lambda^2 - Rx - Qx
+    const FqeT out_Rx = lambda.squared() - Rx - Qx;
+    _out_R.X->generate_r1cs_witness(out_Rx);
+    _check_out_Rx.result.evaluate();
+    _check_out_Rx.generate_r1cs_witness();
+
+    // outRy = lambda * (Rx - outRx) - Ry
+    _out_R.Y->generate_r1cs_witness(lambda * (Rx - out_Rx) - Ry);
+    _check_out_Ry.B.evaluate();
+    _check_out_Ry.result.evaluate();
+    _check_out_Ry.generate_r1cs_witness();
+}
+
+// bls12_377_G2_mul_by_z_gadget methods
+
+template<typename ppT>
+bls12_377_G2_mul_by_z_gadget<ppT>::bls12_377_G2_mul_by_z_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const libsnark::G2_variable<ppT> &Q,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix), _Q(Q)
+{
+    const libsnark::G2_variable<ppT> *res = &_Q;
+
+    // Iterate through the bits of z, skipping the most significant one.
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        // res <- 2 * res
+        _R.push_back(std::shared_ptr<libsnark::G2_variable<ppT>>(
+            new libsnark::G2_variable<ppT>(
+                pb, FMT(annotation_prefix, " R%zu", _R.size()))));
+        _dbls.push_back(std::shared_ptr<bls12_377_G2_dbl_gadget<ppT>>(
+            new bls12_377_G2_dbl_gadget<ppT>(
+                pb,
+                *res,
+                *_R.back(),
+                FMT(annotation_prefix, " _dbls[%zu]", _dbls.size()))));
+        res = &(*_R.back());
+
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            // res <- res + Q
+            _R.push_back(std::shared_ptr<libsnark::G2_variable<ppT>>(
+                new libsnark::G2_variable<ppT>(
+                    pb, FMT(annotation_prefix, " R%zu", _R.size()))));
+            _adds.push_back(std::shared_ptr<bls12_377_G2_add_gadget<ppT>>(
+                new bls12_377_G2_add_gadget<ppT>(
+                    pb,
+                    _Q,
+                    *res,
+                    *_R.back(),
+                    FMT(annotation_prefix, " _adds[%zu]", _adds.size()))));
+            res = &(*_R.back());
+        }
+    }
+}
+
+template<typename ppT>
+const libsnark::G2_variable<ppT> &bls12_377_G2_mul_by_z_gadget<ppT>::result()
+    const
+{
+    return *_R.back();
+}
+
+template<typename ppT>
+void bls12_377_G2_mul_by_z_gadget<ppT>::generate_r1cs_constraints()
+{
+    for (const auto &dbl : _dbls) {
+        dbl->generate_r1cs_constraints();
+    }
+    for (const auto &add : _adds) {
+        add->generate_r1cs_constraints();
+    }
+}
+
+template<typename ppT>
+void bls12_377_G2_mul_by_z_gadget<ppT>::generate_r1cs_witness()
+{
+    size_t add_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        _dbls[num_bits - 1 - bit_idx]->generate_r1cs_witness();
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            _adds[add_idx++]->generate_r1cs_witness();
+        }
+    }
+}
+
+// bls12_377_G1_membership_check_gadget methods
+
+template<typename ppT>
+bls12_377_G1_membership_check_gadget<ppT>::
+    bls12_377_G1_membership_check_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G1_variable<ppT> &P,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _P(P)
+    , _compute_z_P(pb, _P, FMT(annotation_prefix, " _compute_z_P"))
+    , _compute_z_squared_P(
+          pb,
+          _compute_z_P.result(),
+          FMT(annotation_prefix, " _compute_z_squared_P"))
+{
+}
+
+template<typename ppT>
+void bls12_377_G1_membership_check_gadget<ppT>::generate_r1cs_constraints()
+{
+    _compute_z_P.generate_r1cs_constraints();
+    _compute_z_squared_P.generate_r1cs_constraints();
+
+    // phi(P) = -[z^2]P, i.e.
+    //   omega * P.X = R.X
+    //   P.Y = -R.Y
+    const libsnark::G1_variable<ppT> &R = _compute_z_squared_P.result();
+    this->pb.add_r1cs_constraint(
+        libsnark::r1cs_constraint<FqT>(1, endomorphism_omega() * _P.X, R.X),
+        FMT(this->annotation_prefix, " check_X"));
+    this->pb.add_r1cs_constraint(
+        libsnark::r1cs_constraint<FqT>(1, _P.Y + R.Y, 0),
+        FMT(this->annotation_prefix, " check_Y"));
+}
+
+template<typename ppT>
+void bls12_377_G1_membership_check_gadget<ppT>::generate_r1cs_witness()
+{
+    _compute_z_P.generate_r1cs_witness();
+    _compute_z_squared_P.generate_r1cs_witness();
+}
+
+template<typename ppT>
+typename bls12_377_G1_membership_check_gadget<ppT>::FqT
+bls12_377_G1_membership_check_gadget<ppT>::endomorphism_omega()
+{
+    // The root of x^2 + x + 1 for which phi(P) = [-z^2]P in G1 (the other
+    // root, omega^2, gives phi(P) = [z^2 - 1]P).
+    static const FqT omega(
+        "2586644260129690939297030854299808141278351496142771832750389679"
+        "46009968870203535512256352201271898244626862047231");
+    return omega;
+}
+
+// bls12_377_G2_membership_check_gadget methods
+
+template<typename ppT>
+bls12_377_G2_membership_check_gadget<ppT>::
+    bls12_377_G2_membership_check_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _Q(Q)
+    , _compute_z_Q(pb, _Q, FMT(annotation_prefix, " _compute_z_Q"))
+{
+}
+
+template<typename ppT>
+void bls12_377_G2_membership_check_gadget<ppT>::generate_r1cs_constraints()
+{
+    _compute_z_Q.generate_r1cs_constraints();
+
+    // psi(Q) = [z]Q. If z is negative, [|z|]Q has been computed, so that:
+    //   conj(Q.X) * twist_mul_by_q_X = R.X
+    //   conj(Q.Y) * twist_mul_by_q_Y = -R.Y
+    const libsnark::G2_variable<ppT> &R = _compute_z_Q.result();
+    const FqT y_sign =
+        libff::bls12_377_final_exponent_is_z_neg ? -FqT::one() : FqT::one();
+    generate_conjugate_times_constant_constraints(
+        *_Q.X,
+        libff::bls12_377_twist_mul_by_q_X,
+        *R.X,
+        FqT::one(),
+        FMT(this->annotation_prefix, " check_X"));
+    generate_conjugate_times_constant_constraints(
+        *_Q.Y,
+        libff::bls12_377_twist_mul_by_q_Y,
+        *R.Y,
+        y_sign,
+        FMT(this->annotation_prefix, " check_Y"));
+}
+
+template<typename ppT>
+void bls12_377_G2_membership_check_gadget<ppT>::generate_r1cs_witness()
+{
+    _compute_z_Q.generate_r1cs_witness();
+}
+
+template<typename ppT>
+void bls12_377_G2_membership_check_gadget<ppT>::
+    generate_conjugate_times_constant_constraints(
+        const Fqe_variable<ppT> &a,
+        const FqeT &c,
+        const Fqe_variable<ppT> &b,
+        const FqT &sign,
+        const std::string &annotation)
+{
+    // (a0 - a1 * u) * (c0 + c1 * u) =
+    //   (a0 * c0 - non_residue * a1 * c1) + (a0 * c1 - a1 * c0) * u
+    this->pb.add_r1cs_constraint(
+        libsnark::r1cs_constraint<FqT>(
+            1,
+            c.c0 * a.c0 - (FqeT::non_residue * c.c1) * a.c1,
+            sign * b.c0),
+        FMT(annotation, " c0"));
+    this->pb.add_r1cs_constraint(
+        libsnark::r1cs_constraint<FqT>(
+            1, c.c1 * a.c0 - c.c0 * a.c1, sign * b.c1),
+        FMT(annotation, " c1"));
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_PAIRING_BLS12_377_MEMBERSHIP_CHECK_TCC__
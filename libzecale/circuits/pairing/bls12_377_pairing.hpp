@@ -6,6 +6,8 @@
 #define __ZECALE_CIRCUITS_PAIRING_BLS12_377_PAIRING_HPP__
 
 #include "libzecale/circuits/fields/fp12_2over3over2_gadgets.hpp"
+#include "libzecale/circuits/fields/fp12_2over3over2_torus_gadgets.hpp"
+#include "libzecale/circuits/fields/fp2_lean_gadgets.hpp"
 #include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
 #include "libzecale/circuits/pairing/pairing_params.hpp"
 
@@ -77,6 +79,12 @@ public:
         const libff::Fqe<other_curve<ppT>> ell_vw_val,
         const libff::Fqe<other_curve<ppT>> ell_vv_val,
         const std::string &annotation_prefix);
+
+    // Create from existing variables
+    bls12_377_ate_ell_coeffs(
+        const Fqe_variable<ppT> &ell_0_var,
+        const Fqe_variable<ppT> &ell_vw_var,
+        const Fqe_variable<ppT> &ell_vv_var);
 };
 
 template<typename ppT> class bls12_377_G2_precomputation
@@ -130,10 +138,11 @@ public:
     bls12_377_G2_proj<ppT> _out_R;
     bls12_377_ate_ell_coeffs<ppT> _out_coeffs;
 
-    // TODO: Many of these intermediate Fqe_variables are only for clarity and
-    // replicate the references held by other gadgets (e.g. `A` refers to the
-    // same variable as `check_A.result`. Do an optimization pass and remove
-    // some of the redundancy.
+    // Only A, B and E^2 (and the v1 variable of each Fqe_mul_gadget) are
+    // allocated here, all other intermediate values being linear combinations
+    // of these, the inputs and the outputs. Every allocated variable is
+    // constrained: 21 variables (including _out_R and _out_coeffs) for 21
+    // constraints per step.
 
     // A = R.X * R.Y / 2
     Fqe_mul_gadget<ppT> _compute_A;
@@ -185,6 +194,12 @@ public:
 
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the value R of _in_R
+    /// (which is not read from the protoboard), and return the value of
+    /// _out_R.
+    libff::bls12_377_G2 generate_r1cs_witness_native(
+        const libff::bls12_377_G2 &R);
 };
 
 template<typename ppT>
@@ -256,6 +271,11 @@ public:
 
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the values of Q (_Q_X,
+    /// _Q_Y) and of _in_R, and return the value of _out_R.
+    libff::bls12_377_G2 generate_r1cs_witness_native(
+        const FqeT &Qx, const FqeT &Qy, const libff::bls12_377_G2 &R);
 };
 
 /// Holds the relationship between an (affine) pairing parameter Q in G2, and
@@ -276,6 +296,146 @@ public:
         bls12_377_G2_precomputation<ppT> &Q_prec,
         const std::string &annotation_prefix);
 
+    void generate_r1cs_constraints();
+
+    /// Computes the witness natively (see
+    /// bls12_377_ate_dbl_gadget::generate_r1cs_witness_native), reading only
+    /// Q from the protoboard.
+    void generate_r1cs_witness();
+
+    /// Computes the witness gadget by gadget, evaluating all intermediate
+    /// linear combinations. Assigns the same values as
+    /// generate_r1cs_witness(), and is kept as a reference for it.
+    void generate_r1cs_witness_per_gadget();
+};
+
+/// Affine variant of bls12_377_ate_dbl_gadget. R and out_R are affine points,
+/// and the slope lambda of the tangent at R is a witness, constrained by:
+///
+///   lambda * 2 * R.Y = 3 * R.X^2
+///
+/// which costs the same as a multiplication (instead of an inversion). The
+/// coefficients of the tangent (normalized so that ell_vw = -1) are then:
+///
+///   ell_vv = lambda, ell_vw = -1, ell_0 = xi * (R.Y - lambda * R.X)
+///
+/// which differ from those of the projective formulas by a factor in Fqe,
+/// eliminated by the final exponentiation (or by the residue check). The
+/// `coeffs` passed in must have ell_vw set to the constant -1, and ell_0 and
+/// ell_vv allocated.
+template<typename ppT>
+class bls12_377_ate_dbl_affine_gadget : libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+    typedef libff::Fqe<other_curve<ppT>> FqeT;
+
+    libsnark::G2_variable<ppT> _in_R;
+    libsnark::G2_variable<ppT> _out_R;
+    bls12_377_ate_ell_coeffs<ppT> _out_coeffs;
+
+    // R.X^2
+    Fqe_sqr_gadget<ppT> _compute_Rx_squared;
+    // lambda * 2 * R.Y = 3 * R.X^2
+    Fqe_mul_gadget<ppT> _check_lambda;
+    // out_R.X = lambda^2 - 2 * R.X
+    // <=> lambda^2 = out_R.X + 2 * R.X
+    Fqe_sqr_gadget<ppT> _check_out_Rx;
+    // out_R.Y = lambda * (R.X - out_R.X) - R.Y
+    // <=> lambda * (R.X - out_R.X) = out_R.Y + R.Y
+    Fqe_mul_gadget<ppT> _check_out_Ry;
+    // ell_0 = xi * (R.Y - lambda * R.X)
+    // <=> lambda * R.X = R.Y - ell_0 * xi^{-1}
+    Fqe_mul_gadget<ppT> _check_ell_0;
+
+    bls12_377_ate_dbl_affine_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &R,
+        const libsnark::G2_variable<ppT> &out_R,
+        const bls12_377_ate_ell_coeffs<ppT> &coeffs,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Affine variant of bls12_377_ate_add_gadget. The slope lambda of the line
+/// through R and Q is a witness, constrained by:
+///
+///   lambda * (Q.X - R.X) = Q.Y - R.Y
+///
+/// and the coefficients are as in bls12_377_ate_dbl_affine_gadget. As in
+/// bls12_377_G2_add_gadget, Q.X - R.X is also constrained to be invertible
+/// (i.e. R != +/-Q), without which lambda would be unconstrained for R = Q.
+template<typename ppT>
+class bls12_377_ate_add_affine_gadget : libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    typedef libff::Fq<other_curve<ppT>> FqT;
+    typedef libff::Fqe<other_curve<ppT>> FqeT;
+
+    Fqe_variable<ppT> _Q_X;
+    Fqe_variable<ppT> _Q_Y;
+    libsnark::G2_variable<ppT> _in_R;
+    libsnark::G2_variable<ppT> _out_R;
+    bls12_377_ate_ell_coeffs<ppT> _out_coeffs;
+    Fqe_variable<ppT> _inv;
+
+    // lambda * (Q.X - R.X) = Q.Y - R.Y
+    Fqe_mul_gadget<ppT> _check_lambda;
+    // inv * (Q.X - R.X) = 1
+    Fqe_mul_gadget<ppT> _check_no_special_cases;
+    // out_R.X = lambda^2 - R.X - Q.X
+    // <=> lambda^2 = out_R.X + R.X + Q.X
+    Fqe_sqr_gadget<ppT> _check_out_Rx;
+    // out_R.Y = lambda * (R.X - out_R.X) - R.Y
+    // <=> lambda * (R.X - out_R.X) = out_R.Y + R.Y
+    Fqe_mul_gadget<ppT> _check_out_Ry;
+    // ell_0 = xi * (R.Y - lambda * R.X)
+    // <=> lambda * R.X = R.Y - ell_0 * xi^{-1}
+    Fqe_mul_gadget<ppT> _check_ell_0;
+
+    bls12_377_ate_add_affine_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const Fqe_variable<ppT> &Q_X,
+        const Fqe_variable<ppT> &Q_Y,
+        const libsnark::G2_variable<ppT> &R,
+        const libsnark::G2_variable<ppT> &out_R,
+        const bls12_377_ate_ell_coeffs<ppT> &coeffs,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+};
+
+/// Variant of bls12_377_G2_precompute_gadget in which R is kept in affine
+/// form (see bls12_377_ate_dbl_affine_gadget and
+/// bls12_377_ate_add_affine_gadget). The resulting Q_prec can be used in
+/// place of that of bls12_377_G2_precompute_gadget by all consumers. Q must
+/// be in the prime-order subgroup (as is the case for any point checked by
+/// the verifiers), so that no intermediate value of R is the point at
+/// infinity or equal to +/-Q.
+template<typename ppT>
+class bls12_377_G2_affine_precompute_gadget
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    using FqeT = libff::Fqe<other_curve<ppT>>;
+
+    // ell_vw == -1 for all affine coefficients
+    Fqe_variable<ppT> _ell_vw;
+    std::vector<std::shared_ptr<libsnark::G2_variable<ppT>>> _R;
+    std::vector<std::shared_ptr<bls12_377_ate_dbl_affine_gadget<ppT>>>
+        _ate_dbls;
+    std::vector<std::shared_ptr<bls12_377_ate_add_affine_gadget<ppT>>>
+        _ate_adds;
+
+    bls12_377_G2_affine_precompute_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        bls12_377_G2_precomputation<ppT> &Q_prec,
+        const std::string &annotation_prefix);
+
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
 };
@@ -291,10 +451,13 @@ class bls12_377_ate_compute_f_ell_P : public libsnark::gadget<libff::Fr<ppT>>
 {
 public:
     using FieldT = libff::Fr<ppT>;
+    using FqeT = libff::Fqe<other_curve<ppT>>;
     using FqkT = libff::Fqk<other_curve<ppT>>;
 
-    Fqe_mul_by_lc_gadget<ppT> _compute_ell_vv_times_Px;
-    Fqe_mul_by_lc_gadget<ppT> _compute_ell_vw_times_Py;
+    // The products are linear combinations (no variable or constraint) when
+    // the line coefficients are constant.
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell_vv_times_Px;
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell_vw_times_Py;
     Fp12_2over3over2_mul_by_024_gadget<FqkT> _compute_f_mul_ell_P;
 
     bls12_377_ate_compute_f_ell_P(
@@ -311,6 +474,51 @@ public:
     void generate_r1cs_witness();
 };
 
+/// Given some current f in Fqk, two pairing parameters P1, P2 in G1, and the
+/// precomputed coefficients for two line functions ell1(), ell2(), compute:
+///   f * ell1(P1) * ell2(P2)
+/// The two (sparse) line evaluations are first multiplied together (see
+/// Fp12_2over3over2_mul_024_by_024_gadget), and the product is then
+/// multiplied into f, which is cheaper than two applications of
+/// bls12_377_ate_compute_f_ell_P.
+template<typename ppT>
+class bls12_377_ate_compute_f_ell_P_ell_P
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    using FieldT = libff::Fr<ppT>;
+    using FqeT = libff::Fqe<other_curve<ppT>>;
+    using FqkT = libff::Fqk<other_curve<ppT>>;
+
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell1_vv_times_P1x;
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell1_vw_times_P1y;
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell2_vv_times_P2x;
+    Fp2_lean_mul_by_lc_gadget<FqeT> _compute_ell2_vw_times_P2y;
+    Fp12_2over3over2_mul_024_by_024_gadget<FqkT> _compute_ell1_P1_ell2_P2;
+    Fp12_2over3over2_mul_gadget<FqkT> _compute_f_mul_ell_P_ell_P;
+
+    bls12_377_ate_compute_f_ell_P_ell_P(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::pb_linear_combination<FieldT> &P1x,
+        const libsnark::pb_linear_combination<FieldT> &P1y,
+        const bls12_377_ate_ell_coeffs<ppT> &ell1_coeffs,
+        const libsnark::pb_linear_combination<FieldT> &P2x,
+        const libsnark::pb_linear_combination<FieldT> &P2y,
+        const bls12_377_ate_ell_coeffs<ppT> &ell2_coeffs,
+        const Fp12_2over3over2_variable<FqkT> &f,
+        const Fp12_2over3over2_variable<FqkT> &f_out,
+        const std::string &annotation_prefix);
+
+    const Fp12_2over3over2_variable<FqkT> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the value of f, and return
+    /// the value of the result. The points and line coefficients (inputs of
+    /// the Miller loop) are read from the protoboard.
+    FqkT generate_r1cs_witness_native(const FqkT &f);
+};
+
 template<typename ppT>
 class bls12_377_miller_loop_gadget : public libsnark::gadget<libff::Fr<ppT>>
 {
@@ -361,10 +569,10 @@ public:
     // B = elt^(-1)
     Fp12_2over3over2_inv_gadget<FqkT> _compute_B;
     // C = A * B = elt^(q^6 - 1)
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_C;
+    Fp12_2over3over2_toom6_mul_gadget<FqkT> _compute_C;
     // D = C^(q^2) = elt^((q^6 - 1) * (q^2))
     // result = D * C = elt^((q^6 - 1) * (q^2 + 1))
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_D_times_C;
+    Fp12_2over3over2_toom6_mul_gadget<FqkT> _compute_D_times_C;
 
     bls12_377_final_exp_first_part_gadget(
         libsnark::protoboard<FieldT> &pb,
@@ -375,6 +583,11 @@ public:
     const Fp12_2over3over2_variable<FqkT> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+
+    /// Native fast path: assign the witness given the value of `in`, and
+    /// return the value of the result. The same holds for the
+    /// generate_r1cs_witness_native() methods of the gadgets below.
+    FqkT generate_r1cs_witness_native(const FqkT &in);
 };
 
 template<typename ppT>
@@ -384,7 +597,7 @@ public:
     using FieldT = libff::Fr<ppT>;
     using FqkT = libff::Fqk<other_curve<ppT>>;
     using cyclotomic_square = Fp12_2over3over2_cyclotomic_square_gadget<FqkT>;
-    using multiply = Fp12_2over3over2_mul_gadget<FqkT>;
+    using multiply = Fp12_2over3over2_toom6_mul_gadget<FqkT>;
     using unitary_inverse = Fp12_2over3over2_cyclotomic_square_gadget<FqkT>;
 
     Fp12_2over3over2_variable<FqkT> _result;
@@ -401,6 +614,7 @@ public:
     const Fp12_2over3over2_variable<FqkT> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+    FqkT generate_r1cs_witness_native(const FqkT &in);
 
 private:
     void initialize_z_neg(
@@ -413,6 +627,36 @@ private:
         const std::string &annotation_prefix);
 };
 
+/// Exponentiation by z of a compressed element of the torus T2(Fq6) (see
+/// fp12_2over3over2_torus_gadgets.hpp). Squarings and multiplications cost 15
+/// and 30 constraints, against 18 and 33 for bls12_377_exp_by_z_gadget, and
+/// the unitary inverse (if z is negative) is a negation.
+template<typename ppT>
+class bls12_377_torus_exp_by_z_gadget
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    using FieldT = libff::Fr<ppT>;
+    using FqkT = libff::Fqk<other_curve<ppT>>;
+    using Fq6T = typename FqkT::my_Fp6;
+    using square = Fp12_2over3over2_torus_square_gadget<FqkT>;
+    using multiply = Fp12_2over3over2_torus_mul_gadget<FqkT>;
+
+    std::vector<std::shared_ptr<square>> _squares;
+    std::vector<std::shared_ptr<multiply>> _multiplies;
+    std::shared_ptr<Fp6_3over2_variable<Fq6T>> _result;
+
+    bls12_377_torus_exp_by_z_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const Fp6_3over2_variable<Fq6T> &in,
+        const std::string &annotation_prefix);
+
+    const Fp6_3over2_variable<Fq6T> &result() const;
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+    Fq6T generate_r1cs_witness_native(const Fq6T &in);
+};
+
 template<typename ppT>
 class bls12_377_final_exp_last_part_gadget
     : public libsnark::gadget<libff::Fr<ppT>>
@@ -420,32 +664,41 @@ class bls12_377_final_exp_last_part_gadget
 public:
     using FieldT = libff::Fr<ppT>;
     using FqkT = libff::Fqk<other_curve<ppT>>;
+    using Fq6T = typename FqkT::my_Fp6;
+    using torus_square = Fp12_2over3over2_torus_square_gadget<FqkT>;
+    using torus_mul = Fp12_2over3over2_torus_mul_gadget<FqkT>;
 
     // Based on the implementation of
     // libff::bls12_377_final_exponentiation_last_chunk() (see
     // clearmatics/libff/libff/algebra/curves/bls12_377/bls12_377_pairing.cpp),
     // which follows Algorithm 1 described in Table 1 of
     // https://eprint.iacr.org/2016/130.pdf
+    //
+    // The input (the output of the first part of the final exponentiation,
+    // in the cyclotomic subgroup) is compressed to T2(Fq6), all intermediate
+    // values are computed in compressed form, and the last multiplication
+    // decompresses the result (see fp12_2over3over2_torus_gadgets.hpp).
 
     Fp12_2over3over2_variable<FqkT> _result;
 
-    Fp12_2over3over2_cyclotomic_square_gadget<FqkT> _compute_in_squared;
-    bls12_377_exp_by_z_gadget<ppT> _compute_B;
-    Fp12_2over3over2_square_gadget<FqkT> _compute_C;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_D;
-    bls12_377_exp_by_z_gadget<ppT> _compute_E;
-    bls12_377_exp_by_z_gadget<ppT> _compute_F;
-    bls12_377_exp_by_z_gadget<ppT> _compute_G;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_H;
-    bls12_377_exp_by_z_gadget<ppT> _compute_I;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_K;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_L;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_N;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_P;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_R;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_T;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_U;
-    Fp12_2over3over2_mul_gadget<FqkT> _compute_U_times_L;
+    Fp12_2over3over2_torus_compress_gadget<FqkT> _compress_in;
+    torus_square _compute_in_squared;
+    bls12_377_torus_exp_by_z_gadget<ppT> _compute_B;
+    torus_square _compute_C;
+    torus_mul _compute_D;
+    bls12_377_torus_exp_by_z_gadget<ppT> _compute_E;
+    bls12_377_torus_exp_by_z_gadget<ppT> _compute_F;
+    bls12_377_torus_exp_by_z_gadget<ppT> _compute_G;
+    torus_mul _compute_H;
+    bls12_377_torus_exp_by_z_gadget<ppT> _compute_I;
+    torus_mul _compute_K;
+    torus_mul _compute_L;
+    torus_mul _compute_N;
+    torus_mul _compute_P;
+    torus_mul _compute_R;
+    torus_mul _compute_T;
+    torus_mul _compute_U;
+    Fp12_2over3over2_torus_mul_decompress_gadget<FqkT> _compute_U_times_L;
 
     bls12_377_final_exp_last_part_gadget(
         libsnark::protoboard<FieldT> &pb,
@@ -456,6 +709,7 @@ public:
     const Fp12_2over3over2_variable<FqkT> &result() const;
     void generate_r1cs_constraints();
     void generate_r1cs_witness();
+    FqkT generate_r1cs_witness_native(const FqkT &in);
 };
 
 // Wrapper around final_exp gadgets with interface expected by the groth16
@@ -486,7 +740,13 @@ public:
         const libsnark::pb_variable<FieldT> &result_is_one,
         const std::string &annotation_prefix);
     void generate_r1cs_constraints();
+
+    /// Computes the witness natively, reading only `el` from the protoboard.
     void generate_r1cs_witness();
+
+    /// Computes the witness gadget by gadget (reference for
+    /// generate_r1cs_witness()).
+    void generate_r1cs_witness_per_gadget();
 };
 
 template<typename ppT>
@@ -504,9 +764,33 @@ public:
     std::vector<std::shared_ptr<Fp12_2over3over2_square_gadget<FqkT>>>
         _f_squared;
 
-    // f * ell(P) (for both double and add steps)
-    std::vector<std::shared_ptr<bls12_377_ate_compute_f_ell_P<ppT>>> _f_ell_P;
+    // f * ell1(P1) * ell2(P2), f * ell3(P3) * ell4(P4) (for both double and
+    // add steps)
+    std::vector<std::shared_ptr<bls12_377_ate_compute_f_ell_P_ell_P<ppT>>>
+        _f_ell_P_ell_P;
+
+    // f * c (for the add steps), only when a residue witness c is given
+    std::vector<std::shared_ptr<Fp12_2over3over2_mul_gadget<FqkT>>>
+        _f_times_c;
+
+    bls12_377_e_times_e_times_e_over_e_miller_loop_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const bls12_377_G1_precomputation<ppT> &P1_prec,
+        const bls12_377_G2_precomputation<ppT> &Q1_prec,
+        const bls12_377_G1_precomputation<ppT> &P2_prec,
+        const bls12_377_G2_precomputation<ppT> &Q2_prec,
+        const bls12_377_G1_precomputation<ppT> &P3_prec,
+        const bls12_377_G2_precomputation<ppT> &Q3_prec,
+        const bls12_377_G1_precomputation<ppT> &P4_prec,
+        const bls12_377_G2_precomputation<ppT> &Q4_prec,
+        const Fp12_2over3over2_variable<FqkT> &result,
+        const std::string &annotation_prefix);
 
+    /// Variant in which the accumulator is initialized to `c`, and multiplied
+    /// by `c` at each add step, so that `result` is f * c^x, where f is the
+    /// output of the Miller loop and x the loop count. Used to fold the c^x
+    /// term of the residue check (see bls12_377_residue_witness) into the
+    /// squarings of the Miller loop.
     bls12_377_e_times_e_times_e_over_e_miller_loop_gadget(
         libsnark::protoboard<libff::Fr<ppT>> &pb,
         const bls12_377_G1_precomputation<ppT> &P1_prec,
@@ -517,10 +801,34 @@ public:
         const bls12_377_G2_precomputation<ppT> &Q3_prec,
         const bls12_377_G1_precomputation<ppT> &P4_prec,
         const bls12_377_G2_precomputation<ppT> &Q4_prec,
+        const Fp12_2over3over2_variable<FqkT> &c,
         const Fp12_2over3over2_variable<FqkT> &result,
         const std::string &annotation_prefix);
+
     void generate_r1cs_constraints();
+
+    /// Computes the witness natively, reading only the inputs (the G1 points,
+    /// line coefficients and c) from the protoboard.
     void generate_r1cs_witness();
+
+    /// Computes the witness gadget by gadget (reference for
+    /// generate_r1cs_witness()).
+    void generate_r1cs_witness_per_gadget();
+
+private:
+    void initialize(
+        libsnark::protoboard<FieldT> &pb,
+        const bls12_377_G1_precomputation<ppT> &P1_prec,
+        const bls12_377_G2_precomputation<ppT> &Q1_prec,
+        const bls12_377_G1_precomputation<ppT> &P2_prec,
+        const bls12_377_G2_precomputation<ppT> &Q2_prec,
+        const bls12_377_G1_precomputation<ppT> &P3_prec,
+        const bls12_377_G2_precomputation<ppT> &Q3_prec,
+        const bls12_377_G1_precomputation<ppT> &P4_prec,
+        const bls12_377_G2_precomputation<ppT> &Q4_prec,
+        bool multiply_by_f0,
+        const Fp12_2over3over2_variable<FqkT> &result,
+        const std::string &annotation_prefix);
 };
 
 } // namespace libzecale
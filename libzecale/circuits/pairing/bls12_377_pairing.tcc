@@ -125,6 +125,15 @@ bls12_377_ate_ell_coeffs<ppT>::bls12_377_ate_ell_coeffs(
 {
 }
 
+template<typename ppT>
+bls12_377_ate_ell_coeffs<ppT>::bls12_377_ate_ell_coeffs(
+    const Fqe_variable<ppT> &ell_0_var,
+    const Fqe_variable<ppT> &ell_vw_var,
+    const Fqe_variable<ppT> &ell_vv_var)
+    : ell_0(ell_0_var), ell_vw(ell_vw_var), ell_vv(ell_vv_var)
+{
+}
+
 // bls12_377_G2_precomputation methods
 
 template<typename ppT>
@@ -403,6 +412,41 @@ void bls12_377_ate_dbl_gadget<ppT>::generate_r1cs_witness()
         B * (Ry_plus_Rz_squared - B - C) == _check_out_Rz.result.get_element());
 }
 
+template<typename ppT>
+libff::bls12_377_G2 bls12_377_ate_dbl_gadget<ppT>::generate_r1cs_witness_native(
+    const libff::bls12_377_G2 &R)
+{
+    const FqeT &Rx = R.X;
+    const FqeT &Ry = R.Y;
+    const FqeT &Rz = R.Z;
+
+    // See generate_r1cs_witness for the formulae.
+    const FqeT A = fp2_mul_native_witness(
+        this->pb, _compute_A, Rx, FqT(2).inverse() * Ry);
+    const FqeT B = fp2_sqr_native_witness(_compute_B, Ry);
+    const FqeT C = fp2_sqr_native_witness(_compute_C, Rz);
+    const FqeT E = libff::bls12_377_twist_coeff_b * (FqT(3) * C);
+    const FqeT F = FqT(3) * E;
+    const FqeT G = FqT(2).inverse() * (B + F);
+    const FqeT Ry_plus_Rz_squared =
+        fp2_sqr_native_witness(_compute_Y_plus_Z_squared, Ry + Rz);
+    const FqeT H = Ry_plus_Rz_squared - B - C;
+    const FqeT J = fp2_sqr_native_witness(_compute_J, Rx);
+    _out_coeffs.ell_0.generate_r1cs_witness(libff::bls12_377_twist * (E - B));
+    _out_coeffs.ell_vw.generate_r1cs_witness(-H);
+    _out_coeffs.ell_vv.generate_r1cs_witness(FqT(3) * J);
+
+    const FqeT out_Rx =
+        fp2_mul_native_witness(this->pb, _check_out_Rx, A, B - F);
+    const FqeT E_squared = fp2_sqr_native_witness(_compute_E_squared, E);
+    const FqeT G_squared = fp2_sqr_native_witness(_compute_G_squared, G);
+    const FqeT out_Ry = G_squared - FqT(3) * E_squared;
+    _out_R.Y.generate_r1cs_witness(out_Ry);
+    const FqeT out_Rz = fp2_mul_native_witness(this->pb, _check_out_Rz, B, H);
+
+    return libff::bls12_377_G2(out_Rx, out_Ry, out_Rz);
+}
+
 // bls12_377_ate_add_gadget methods
 
 template<typename ppT>
@@ -617,6 +661,47 @@ void bls12_377_ate_add_gadget<ppT>::generate_r1cs_witness()
     _check_out_Rz.generate_r1cs_witness();
 }
 
+template<typename ppT>
+libff::bls12_377_G2 bls12_377_ate_add_gadget<ppT>::generate_r1cs_witness_native(
+    const FqeT &Qx, const FqeT &Qy, const libff::bls12_377_G2 &R)
+{
+    const FqeT &Rx = R.X;
+    const FqeT &Ry = R.Y;
+    const FqeT &Rz = R.Z;
+
+    // See generate_r1cs_witness for the formulae.
+    const FqeT A = fp2_mul_native_witness(this->pb, _compute_A, Qy, Rz);
+    const FqeT theta = Ry - A;
+    const FqeT B = fp2_mul_native_witness(this->pb, _compute_B, Qx, Rz);
+    const FqeT lambda = Rx - B;
+    _out_coeffs.ell_vv.generate_r1cs_witness(-theta);
+    _out_coeffs.ell_vw.generate_r1cs_witness(lambda);
+
+    const FqeT C = fp2_sqr_native_witness(_compute_C, -theta);
+    const FqeT D = fp2_sqr_native_witness(_compute_D, lambda);
+    const FqeT E = fp2_mul_native_witness(this->pb, _compute_E, D, lambda);
+    const FqeT F = fp2_mul_native_witness(this->pb, _compute_F, Rz, C);
+    const FqeT G = fp2_mul_native_witness(this->pb, _compute_G, Rx, D);
+    const FqeT H = E + F - (G + G);
+    const FqeT I = fp2_mul_native_witness(this->pb, _compute_I, Ry, E);
+
+    const FqeT theta_times_Qx =
+        fp2_mul_native_witness(this->pb, _compute_theta_times_Qx, theta, Qx);
+    const FqeT lambda_times_Qy = fp2_mul_native_witness(
+        this->pb, _compute_lambda_times_Qy, lambda, Qy);
+    _out_coeffs.ell_0.generate_r1cs_witness(
+        libff::bls12_377_twist * (theta_times_Qx - lambda_times_Qy));
+
+    const FqeT out_Rx =
+        fp2_mul_native_witness(this->pb, _check_out_Rx, lambda, H);
+    const FqeT out_Ry = theta * (G - H) - I;
+    _out_R.Y.generate_r1cs_witness(out_Ry);
+    fp2_mul_native_witness(this->pb, _check_out_Ry, -theta, H - G);
+    const FqeT out_Rz = fp2_mul_native_witness(this->pb, _check_out_Rz, Rz, E);
+
+    return libff::bls12_377_G2(out_Rx, out_Ry, out_Rz);
+}
+
 // bls12_377_G2_precompute methods
 
 template<typename ppT>
@@ -698,6 +783,337 @@ void bls12_377_G2_precompute_gadget<ppT>::generate_r1cs_constraints()
 
 template<typename ppT>
 void bls12_377_G2_precompute_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqeT Qx = _R0.X.get_element();
+    const FqeT Qy = _R0.Y.get_element();
+    libff::bls12_377_G2 R(Qx, Qy, FqeT::one());
+
+    size_t dbl_idx = 0;
+    size_t add_idx = 0;
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        R = _ate_dbls[dbl_idx++]->generate_r1cs_witness_native(R);
+        if (bits.current()) {
+            R = _ate_adds[add_idx++]->generate_r1cs_witness_native(Qx, Qy, R);
+        }
+    }
+}
+
+template<typename ppT>
+void bls12_377_G2_precompute_gadget<ppT>::generate_r1cs_witness_per_gadget()
+{
+    size_t dbl_idx = 0;
+    size_t add_idx = 0;
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        _ate_dbls[dbl_idx++]->generate_r1cs_witness();
+        if (bits.current()) {
+            _ate_adds[add_idx++]->generate_r1cs_witness();
+        }
+    }
+}
+
+// bls12_377_ate_dbl_affine_gadget methods
+
+template<typename ppT>
+bls12_377_ate_dbl_affine_gadget<ppT>::bls12_377_ate_dbl_affine_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const libsnark::G2_variable<ppT> &R,
+    const libsnark::G2_variable<ppT> &out_R,
+    const bls12_377_ate_ell_coeffs<ppT> &coeffs,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _in_R(R)
+    , _out_R(out_R)
+    , _out_coeffs(coeffs)
+
+    // Rx^2
+    , _compute_Rx_squared(
+          pb,
+          *_in_R.X,
+          Fqe_variable<ppT>(pb, FMT(annotation_prefix, " Rx_squared")),
+          FMT(annotation_prefix, " _compute_Rx_squared"))
+
+    // lambda [ell_vv] * 2 * Ry = 3 * Rx^2
+    , _check_lambda(
+          pb,
+          _out_coeffs.ell_vv,
+          *_in_R.Y * FqT(2),
+          _compute_Rx_squared.result * FqT(3),
+          FMT(annotation_prefix, " _check_lambda"))
+
+    // lambda^2 = outRx + 2 * Rx
+    , _check_out_Rx(
+          pb,
+          _out_coeffs.ell_vv,
+          *_out_R.X + *_in_R.X * FqT(2),
+          FMT(annotation_prefix, " _check_out_Rx"))
+
+    // lambda * (Rx - outRx) = outRy + Ry
+    , _check_out_Ry(
+          pb,
+          _out_coeffs.ell_vv,
+          *_in_R.X - *_out_R.X,
+          *_out_R.Y + *_in_R.Y,
+          FMT(annotation_prefix, " _check_out_Ry"))
+
+    // lambda * Rx = Ry - ell_0 * xi^{-1}
+    , _check_ell_0(
+          pb,
+          _out_coeffs.ell_vv,
+          *_in_R.X,
+          *_in_R.Y - _out_coeffs.ell_0 * libff::bls12_377_twist.inverse(),
+          FMT(annotation_prefix, " _check_ell_0"))
+{
+}
+
+template<typename ppT>
+void bls12_377_ate_dbl_affine_gadget<ppT>::generate_r1cs_constraints()
+{
+    _compute_Rx_squared.generate_r1cs_constraints();
+    _check_lambda.generate_r1cs_constraints();
+    _check_out_Rx.generate_r1cs_constraints();
+    _check_out_Ry.generate_r1cs_constraints();
+    _check_ell_0.generate_r1cs_constraints();
+}
+
+template<typename ppT>
+void bls12_377_ate_dbl_affine_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqeT Rx = _in_R.X->get_element();
+    const FqeT Ry = _in_R.Y->get_element();
+
+    // lambda = 3 * Rx^2 / (2 * Ry)
+    _compute_Rx_squared.generate_r1cs_witness();
+    const FqeT lambda = (FqT(3) * _compute_Rx_squared.result.get_element()) *
+                        (FqT(2) * Ry).inverse();
+    _out_coeffs.ell_vv.generate_r1cs_witness(lambda);
+    _check_lambda.B.evaluate();
+    _check_lambda.result.evaluate();
+    _check_lambda.generate_r1cs_witness();
+
+    // outRx = lambda^2 - 2 * Rx
+    const FqeT out_Rx = lambda.squared() - FqT(2) * Rx;
+    _out_R.X->generate_r1cs_witness(out_Rx);
+    _check_out_Rx.result.evaluate();
+    _check_out_Rx.generate_r1cs_witness();
+
+    // outRy = lambda * (Rx - outRx) - Ry
+    _out_R.Y->generate_r1cs_witness(lambda * (Rx - out_Rx) - Ry);
+    _check_out_Ry.B.evaluate();
+    _check_out_Ry.result.evaluate();
+    _check_out_Ry.generate_r1cs_witness();
+
+    // ell_0 = xi * (Ry - lambda * Rx)
+    _out_coeffs.ell_0.generate_r1cs_witness(
+        libff::bls12_377_twist * (Ry - lambda * Rx));
+    _check_ell_0.result.evaluate();
+    _check_ell_0.generate_r1cs_witness();
+}
+
+// bls12_377_ate_add_affine_gadget methods
+
+template<typename ppT>
+bls12_377_ate_add_affine_gadget<ppT>::bls12_377_ate_add_affine_gadget(
+    libsnark::protoboard<libff::Fr<ppT>> &pb,
+    const Fqe_variable<ppT> &Q_X,
+    const Fqe_variable<ppT> &Q_Y,
+    const libsnark::G2_variable<ppT> &R,
+    const libsnark::G2_variable<ppT> &out_R,
+    const bls12_377_ate_ell_coeffs<ppT> &coeffs,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _Q_X(Q_X)
+    , _Q_Y(Q_Y)
+    , _in_R(R)
+    , _out_R(out_R)
+    , _out_coeffs(coeffs)
+    , _inv(pb, FMT(annotation_prefix, " inv"))
+
+    // lambda [ell_vv] * (Qx - Rx) = Qy - Ry
+    , _check_lambda(
+          pb,
+          _out_coeffs.ell_vv,
+          _Q_X - *_in_R.X,
+          _Q_Y - *_in_R.Y,
+          FMT(annotation_prefix, " _check_lambda"))
+
+    // inv * (Qx - Rx) = 1
+    , _check_no_special_cases(
+          pb,
+          _inv,
+          _Q_X - *_in_R.X,
+          Fqe_variable<ppT>(pb, FqeT::one(), FMT(annotation_prefix, " one")),
+          FMT(annotation_prefix, " _check_no_special_cases"))
+
+    // lambda^2 = outRx + Rx + Qx
+    , _check_out_Rx(
+          pb,
+          _out_coeffs.ell_vv,
+          *_out_R.X + *_in_R.X + _Q_X,
+          FMT(annotation_prefix, " _check_out_Rx"))
+
+    // lambda * (Rx - outRx) = outRy + Ry
+    , _check_out_Ry(
+          pb,
+          _out_coeffs.ell_vv,
+          *_in_R.X - *_out_R.X,
+          *_out_R.Y + *_in_R.Y,
+          FMT(annotation_prefix, " _check_out_Ry"))
+
+    // lambda * Rx = Ry - ell_0 * xi^{-1}
+    , _check_ell_0(
+          pb,
+          _out_coeffs.ell_vv,
+          *_in_R.X,
+          *_in_R.Y - _out_coeffs.ell_0 * libff::bls12_377_twist.inverse(),
+          FMT(annotation_prefix, " _check_ell_0"))
+{
+}
+
+template<typename ppT>
+void bls12_377_ate_add_affine_gadget<ppT>::generate_r1cs_constraints()
+{
+    _check_lambda.generate_r1cs_constraints();
+    _check_no_special_cases.generate_r1cs_constraints();
+    _check_out_Rx.generate_r1cs_constraints();
+    _check_out_Ry.generate_r1cs_constraints();
+    _check_ell_0.generate_r1cs_constraints();
+}
+
+template<typename ppT>
+void bls12_377_ate_add_affine_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqeT Qx = _Q_X.get_element();
+    const FqeT Qy = _Q_Y.get_element();
+    const FqeT Rx = _in_R.X->get_element();
+    const FqeT Ry = _in_R.Y->get_element();
+
+    // inv = 1 / (Qx - Rx)
+    const FqeT inv = (Qx - Rx).inverse();
+    _inv.generate_r1cs_witness(inv);
+    _check_no_special_cases.B.evaluate();
+    _check_no_special_cases.generate_r1cs_witness();
+
+    // lambda = (Qy - Ry) / (Qx - Rx)
+    const FqeT lambda = (Qy - Ry) * inv;
+    _out_coeffs.ell_vv.generate_r1cs_witness(lambda);
+    _check_lambda.B.evaluate();
+    _check_lambda.result.evaluate();
+    _check_lambda.generate_r1cs_witness();
+
+    // outRx = lambda^2 - Rx - Qx
+    const FqeT out_Rx = lambda.squared() - Rx - Qx;
+    _out_R.X->generate_r1cs_witness(out_Rx);
+    _check_out_Rx.result.evaluate();
+    _check_out_Rx.generate_r1cs_witness();
+
+    // outRy = lambda * (Rx - outRx) - Ry
+    _out_R.Y->generate_r1cs_witness(lambda * (Rx - out_Rx) - Ry);
+    _check_out_Ry.B.evaluate();
+    _check_out_Ry.result.evaluate();
+    _check_out_Ry.generate_r1cs_witness();
+
+    // ell_0 = xi * (Ry - lambda * Rx)
+    _out_coeffs.ell_0.generate_r1cs_witness(
+        libff::bls12_377_twist * (Ry - lambda * Rx));
+    _check_ell_0.result.evaluate();
+    _check_ell_0.generate_r1cs_witness();
+}
+
+// bls12_377_G2_affine_precompute_gadget methods
+
+template<typename ppT>
+bls12_377_G2_affine_precompute_gadget<ppT>::
+    bls12_377_G2_affine_precompute_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const libsnark::G2_variable<ppT> &Q,
+        bls12_377_G2_precomputation<ppT> &Q_prec,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    , _ell_vw(pb, -FqeT::one(), FMT(annotation_prefix, " ell_vw"))
+{
+    // Track the R variable at each step. Initially it is Q.
+    const libsnark::G2_variable<ppT> *currentR = &Q;
+    size_t num_dbl = 0;
+    size_t num_add = 0;
+    size_t num_Rs = 0;
+
+    // Iterate through bits of loop_count
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        _R.push_back(std::shared_ptr<libsnark::G2_variable<ppT>>(
+            new libsnark::G2_variable<ppT>(
+                pb, FMT(annotation_prefix, " R%zu", num_Rs++))));
+        Q_prec._coeffs.push_back(std::shared_ptr<bls12_377_ate_ell_coeffs<ppT>>(
+            new bls12_377_ate_ell_coeffs<ppT>(
+                Fqe_variable<ppT>(
+                    pb, FMT(annotation_prefix, " Q_prec_dbl_%zu_0", num_dbl)),
+                _ell_vw,
+                Fqe_variable<ppT>(
+                    pb,
+                    FMT(annotation_prefix, " Q_prec_dbl_%zu_vv", num_dbl)))));
+        ++num_dbl;
+        _ate_dbls.push_back(
+            std::shared_ptr<bls12_377_ate_dbl_affine_gadget<ppT>>(
+                new bls12_377_ate_dbl_affine_gadget<ppT>(
+                    pb,
+                    *currentR,
+                    *_R.back(),
+                    *Q_prec._coeffs.back(),
+                    FMT(annotation_prefix, " dbls[%zu]", bits.index()))));
+        currentR = &(*_R.back());
+
+        if (bits.current()) {
+            _R.push_back(std::shared_ptr<libsnark::G2_variable<ppT>>(
+                new libsnark::G2_variable<ppT>(
+                    pb, FMT(annotation_prefix, " R%zu", num_Rs++))));
+            Q_prec._coeffs.push_back(
+                std::shared_ptr<bls12_377_ate_ell_coeffs<ppT>>(
+                    new bls12_377_ate_ell_coeffs<ppT>(
+                        Fqe_variable<ppT>(
+                            pb,
+                            FMT(annotation_prefix,
+                                " Q_prec_add_%zu_0",
+                                num_add)),
+                        _ell_vw,
+                        Fqe_variable<ppT>(
+                            pb,
+                            FMT(annotation_prefix,
+                                " Q_prec_add_%zu_vv",
+                                num_add)))));
+            ++num_add;
+            _ate_adds.push_back(
+                std::shared_ptr<bls12_377_ate_add_affine_gadget<ppT>>(
+                    new bls12_377_ate_add_affine_gadget<ppT>(
+                        pb,
+                        *Q.X,
+                        *Q.Y,
+                        *currentR,
+                        *_R.back(),
+                        *Q_prec._coeffs.back(),
+                        FMT(annotation_prefix, " adds[%zu]", bits.index()))));
+            currentR = &(*_R.back());
+        }
+    }
+}
+
+template<typename ppT>
+void bls12_377_G2_affine_precompute_gadget<ppT>::generate_r1cs_constraints()
+{
+    size_t dbl_idx = 0;
+    size_t add_idx = 0;
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        _ate_dbls[dbl_idx++]->generate_r1cs_constraints();
+        if (bits.current()) {
+            _ate_adds[add_idx++]->generate_r1cs_constraints();
+        }
+    }
+}
+
+template<typename ppT>
+void bls12_377_G2_affine_precompute_gadget<ppT>::generate_r1cs_witness()
 {
     size_t dbl_idx = 0;
     size_t add_idx = 0;
@@ -726,13 +1142,11 @@ bls12_377_ate_compute_f_ell_P<ppT>::bls12_377_ate_compute_f_ell_P(
           pb,
           ell_coeffs.ell_vv,
           Px,
-          Fqe_variable<ppT>(pb, FMT(annotation_prefix, " ell_vv_times_Px")),
           FMT(annotation_prefix, " _compute_ell_vv_times_Px"))
     , _compute_ell_vw_times_Py(
           pb,
           ell_coeffs.ell_vw,
           Py,
-          Fqe_variable<ppT>(pb, FMT(annotation_prefix, " ell_vw_times_Py")),
           FMT(annotation_prefix, " _compute_ell_vw_times_Py"))
     , _compute_f_mul_ell_P(
           pb,
@@ -768,6 +1182,120 @@ void bls12_377_ate_compute_f_ell_P<ppT>::generate_r1cs_witness()
     _compute_f_mul_ell_P.generate_r1cs_witness();
 }
 
+// bls12_377_ate_compute_f_ell_P_ell_P methods
+
+template<typename ppT>
+bls12_377_ate_compute_f_ell_P_ell_P<ppT>::bls12_377_ate_compute_f_ell_P_ell_P(
+    libsnark::protoboard<FieldT> &pb,
+    const libsnark::pb_linear_combination<FieldT> &P1x,
+    const libsnark::pb_linear_combination<FieldT> &P1y,
+    const bls12_377_ate_ell_coeffs<ppT> &ell1_coeffs,
+    const libsnark::pb_linear_combination<FieldT> &P2x,
+    const libsnark::pb_linear_combination<FieldT> &P2y,
+    const bls12_377_ate_ell_coeffs<ppT> &ell2_coeffs,
+    const Fp12_2over3over2_variable<FqkT> &f,
+    const Fp12_2over3over2_variable<FqkT> &f_out,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _compute_ell1_vv_times_P1x(
+          pb,
+          ell1_coeffs.ell_vv,
+          P1x,
+          FMT(annotation_prefix, " _compute_ell1_vv_times_P1x"))
+    , _compute_ell1_vw_times_P1y(
+          pb,
+          ell1_coeffs.ell_vw,
+          P1y,
+          FMT(annotation_prefix, " _compute_ell1_vw_times_P1y"))
+    , _compute_ell2_vv_times_P2x(
+          pb,
+          ell2_coeffs.ell_vv,
+          P2x,
+          FMT(annotation_prefix, " _compute_ell2_vv_times_P2x"))
+    , _compute_ell2_vw_times_P2y(
+          pb,
+          ell2_coeffs.ell_vw,
+          P2y,
+          FMT(annotation_prefix, " _compute_ell2_vw_times_P2y"))
+    , _compute_ell1_P1_ell2_P2(
+          pb,
+          ell1_coeffs.ell_0,
+          _compute_ell1_vv_times_P1x.result,
+          _compute_ell1_vw_times_P1y.result,
+          ell2_coeffs.ell_0,
+          _compute_ell2_vv_times_P2x.result,
+          _compute_ell2_vw_times_P2y.result,
+          FMT(annotation_prefix, " _compute_ell1_P1_ell2_P2"))
+    , _compute_f_mul_ell_P_ell_P(
+          pb,
+          f,
+          _compute_ell1_P1_ell2_P2.result(),
+          f_out,
+          FMT(annotation_prefix, " _compute_f_mul_ell_P_ell_P"))
+{
+}
+
+template<typename ppT>
+const Fp12_2over3over2_variable<libff::Fqk<other_curve<ppT>>>
+    &bls12_377_ate_compute_f_ell_P_ell_P<ppT>::result() const
+{
+    return _compute_f_mul_ell_P_ell_P.result();
+}
+
+template<typename ppT>
+void bls12_377_ate_compute_f_ell_P_ell_P<ppT>::generate_r1cs_constraints()
+{
+    _compute_ell1_vv_times_P1x.generate_r1cs_constraints();
+    _compute_ell1_vw_times_P1y.generate_r1cs_constraints();
+    _compute_ell2_vv_times_P2x.generate_r1cs_constraints();
+    _compute_ell2_vw_times_P2y.generate_r1cs_constraints();
+    _compute_ell1_P1_ell2_P2.generate_r1cs_constraints();
+    _compute_f_mul_ell_P_ell_P.generate_r1cs_constraints();
+}
+
+template<typename ppT>
+void bls12_377_ate_compute_f_ell_P_ell_P<ppT>::generate_r1cs_witness()
+{
+    _compute_ell1_vv_times_P1x.generate_r1cs_witness();
+    _compute_ell1_vw_times_P1y.generate_r1cs_witness();
+    _compute_ell2_vv_times_P2x.generate_r1cs_witness();
+    _compute_ell2_vw_times_P2y.generate_r1cs_witness();
+    _compute_ell1_P1_ell2_P2.generate_r1cs_witness();
+    _compute_f_mul_ell_P_ell_P.generate_r1cs_witness();
+}
+
+template<typename ppT>
+libff::Fqk<other_curve<ppT>> bls12_377_ate_compute_f_ell_P_ell_P<
+    ppT>::generate_r1cs_witness_native(const FqkT &f)
+{
+    const FqeT ell1_vv_times_P1x =
+        _compute_ell1_vv_times_P1x.generate_r1cs_witness_native(
+            _compute_ell1_vv_times_P1x.A.get_element(),
+            this->pb.lc_val(_compute_ell1_vv_times_P1x.lc));
+    const FqeT ell1_vw_times_P1y =
+        _compute_ell1_vw_times_P1y.generate_r1cs_witness_native(
+            _compute_ell1_vw_times_P1y.A.get_element(),
+            this->pb.lc_val(_compute_ell1_vw_times_P1y.lc));
+    const FqeT ell2_vv_times_P2x =
+        _compute_ell2_vv_times_P2x.generate_r1cs_witness_native(
+            _compute_ell2_vv_times_P2x.A.get_element(),
+            this->pb.lc_val(_compute_ell2_vv_times_P2x.lc));
+    const FqeT ell2_vw_times_P2y =
+        _compute_ell2_vw_times_P2y.generate_r1cs_witness_native(
+            _compute_ell2_vw_times_P2y.A.get_element(),
+            this->pb.lc_val(_compute_ell2_vw_times_P2y.lc));
+    const FqkT ell1_P1_ell2_P2 =
+        _compute_ell1_P1_ell2_P2.generate_r1cs_witness_native(
+            _compute_ell1_P1_ell2_P2._X_0.get_element(),
+            ell1_vv_times_P1x,
+            ell1_vw_times_P1y,
+            _compute_ell1_P1_ell2_P2._Y_0.get_element(),
+            ell2_vv_times_P2x,
+            ell2_vw_times_P2y);
+    return _compute_f_mul_ell_P_ell_P.generate_r1cs_witness_native(
+        f, ell1_P1_ell2_P2);
+}
+
 // bls12_377_miller_loop_gadget methods
 
 template<typename ppT>
@@ -946,6 +1474,17 @@ void bls12_377_final_exp_first_part_gadget<ppT>::generate_r1cs_witness()
     _compute_D_times_C.generate_r1cs_witness();
 }
 
+template<typename ppT>
+libff::Fqk<other_curve<ppT>> bls12_377_final_exp_first_part_gadget<
+    ppT>::generate_r1cs_witness_native(const FqkT &in)
+{
+    const FqkT B = _compute_B.generate_r1cs_witness_native(in);
+    const FqkT C =
+        _compute_C.generate_r1cs_witness_native(in.Frobenius_map(6), B);
+    return _compute_D_times_C.generate_r1cs_witness_native(
+        C.Frobenius_map(2), C);
+}
+
 // bls12_377_exp_by_z_gadget methods
 
 template<typename ppT>
@@ -1106,6 +1645,126 @@ void bls12_377_exp_by_z_gadget<ppT>::generate_r1cs_witness()
     }
 }
 
+template<typename ppT>
+libff::Fqk<other_curve<ppT>> bls12_377_exp_by_z_gadget<
+    ppT>::generate_r1cs_witness_native(const FqkT &in)
+{
+    FqkT res = in;
+    size_t sqr_idx = 0;
+    size_t mul_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        res = _squares[sqr_idx++]->generate_r1cs_witness_native(res);
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            res = _multiplies[mul_idx++]->generate_r1cs_witness_native(res, in);
+        }
+    }
+
+    if (_inverse) {
+        res = _inverse->generate_r1cs_witness_native(res);
+    }
+
+    return res;
+}
+
+// bls12_377_torus_exp_by_z_gadget methods
+
+template<typename ppT>
+bls12_377_torus_exp_by_z_gadget<ppT>::bls12_377_torus_exp_by_z_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const Fp6_3over2_variable<Fq6T> &in,
+    const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+{
+    const Fp6_3over2_variable<Fq6T> *res = &in;
+
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        // result <- result^2
+        _squares.push_back(std::shared_ptr<square>(new square(
+            pb,
+            *res,
+            Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " res^2")),
+            FMT(annotation_prefix, " _squares[%zu]", _squares.size()))));
+        res = &(_squares.back()->result());
+
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            // result <- result * elt
+            _multiplies.push_back(std::shared_ptr<multiply>(new multiply(
+                pb,
+                *res,
+                in,
+                Fp6_3over2_variable<Fq6T>(
+                    pb, FMT(annotation_prefix, " res*in")),
+                FMT(annotation_prefix,
+                    " _multiplies[%zu]",
+                    _multiplies.size()))));
+            res = &(_multiplies.back()->result());
+        }
+    }
+
+    // The unitary inverse of a compressed element is its negation, so no
+    // further variables are required for a negative z.
+    if (libff::bls12_377_final_exponent_is_z_neg) {
+        _result.reset(new Fp6_3over2_variable<Fq6T>(-*res));
+    } else {
+        _result.reset(new Fp6_3over2_variable<Fq6T>(*res));
+    }
+}
+
+template<typename ppT>
+const Fp6_3over2_variable<typename libff::Fqk<other_curve<ppT>>::my_Fp6>
+    &bls12_377_torus_exp_by_z_gadget<ppT>::result() const
+{
+    return *_result;
+}
+
+template<typename ppT>
+void bls12_377_torus_exp_by_z_gadget<ppT>::generate_r1cs_constraints()
+{
+    size_t sqr_idx = 0;
+    size_t mul_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        _squares[sqr_idx++]->generate_r1cs_constraints();
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            _multiplies[mul_idx++]->generate_r1cs_constraints();
+        }
+    }
+}
+
+template<typename ppT>
+void bls12_377_torus_exp_by_z_gadget<ppT>::generate_r1cs_witness()
+{
+    size_t sqr_idx = 0;
+    size_t mul_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        _squares[sqr_idx++]->generate_r1cs_witness();
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            _multiplies[mul_idx++]->generate_r1cs_witness();
+        }
+    }
+}
+
+template<typename ppT>
+typename libff::Fqk<other_curve<ppT>>::my_Fp6 bls12_377_torus_exp_by_z_gadget<
+    ppT>::generate_r1cs_witness_native(const Fq6T &in)
+{
+    Fq6T res = in;
+    size_t sqr_idx = 0;
+    size_t mul_idx = 0;
+    const size_t num_bits = libff::bls12_377_final_exponent_z.num_bits();
+    for (size_t bit_idx = num_bits - 1; bit_idx > 0; --bit_idx) {
+        res = _squares[sqr_idx++]->generate_r1cs_witness_native(res);
+        if (libff::bls12_377_final_exponent_z.test_bit(bit_idx - 1)) {
+            res = _multiplies[mul_idx++]->generate_r1cs_witness_native(res, in);
+        }
+    }
+
+    return libff::bls12_377_final_exponent_is_z_neg ? -res : res;
+}
+
 // bls12_377_final_exp_last_part_gadget methods
 
 template<typename ppT>
@@ -1116,93 +1775,83 @@ bls12_377_final_exp_last_part_gadget<ppT>::bls12_377_final_exp_last_part_gadget(
     const std::string &annotation_prefix)
     : libsnark::gadget<FieldT>(pb, annotation_prefix)
     , _result(result)
+    // c_in = compressed in
+    , _compress_in(
+          pb,
+          in,
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " c_in")),
+          FMT(annotation_prefix, " _compress_in"))
     // A = [-2]
     , _compute_in_squared(
           pb,
-          in,
-          Fp12_2over3over2_variable<FqkT>(
-              pb, FMT(annotation_prefix, " in_squared")),
+          _compress_in.result(),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " in_squared")),
           FMT(annotation_prefix, " _compute_in_squared"))
     // B = [z]
     , _compute_B(
-          pb,
-          in,
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " B")),
-          FMT(annotation_prefix, " _compute_B"))
+          pb, _compress_in.result(), FMT(annotation_prefix, " _compute_B"))
     // C = [2z]
     , _compute_C(
           pb,
           _compute_B.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " C")),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " C")),
           FMT(annotation_prefix, " _compute_C"))
     // D = [z-2]
     , _compute_D(
           pb,
-          _compute_in_squared.result().unitary_inverse(), // _A
+          -_compute_in_squared.result(), // _A
           _compute_B.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " D")),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " D")),
           FMT(annotation_prefix, " _compute_D"))
     // E = [z^2-2z]
     , _compute_E(
-          pb,
-          _compute_D.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " E")),
-          FMT(annotation_prefix, " _compute_E"))
+          pb, _compute_D.result(), FMT(annotation_prefix, " _compute_E"))
     // F = [z^3-2z^2]
     , _compute_F(
-          pb,
-          _compute_E.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " F")),
-          FMT(annotation_prefix, " _compute_F"))
+          pb, _compute_E.result(), FMT(annotation_prefix, " _compute_F"))
     // G = [z^4-2z^3]
     , _compute_G(
-          pb,
-          _compute_F.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " G")),
-          FMT(annotation_prefix, " _compute_G"))
+          pb, _compute_F.result(), FMT(annotation_prefix, " _compute_G"))
     // H = [z^4-2z^3+2z]
     , _compute_H(
           pb,
           _compute_G.result(),
           _compute_C.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " H")),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " H")),
           FMT(annotation_prefix, " _comptue_H"))
     // I = [z^5-2z^4+2z^2]
     , _compute_I(
-          pb,
-          _compute_H.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " I")),
-          FMT(annotation_prefix, " _compute_I"))
+          pb, _compute_H.result(), FMT(annotation_prefix, " _compute_I"))
     // J = [-z+2]
     // K = [z^5-2z^4+2z^2-z+2]
     , _compute_K(
           pb,
           _compute_I.result(),
-          _compute_D.result().unitary_inverse(), // _J
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " K")),
+          -_compute_D.result(), // _J
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " K")),
           FMT(annotation_prefix, " _compute_K"))
     // L = [z^5-2z^4+2z^2-z+3] = [\lambda_0]
     , _compute_L(
           pb,
           _compute_K.result(),
-          in,
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " L")),
+          _compress_in.result(),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " L")),
           FMT(annotation_prefix, " _compute_L"))
     // M = [-1]
     // N = [z^2-2z+1] = [\lambda_3]
     , _compute_N(
           pb,
           _compute_E.result(),
-          in,
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " N")),
+          _compress_in.result(),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " N")),
           FMT(annotation_prefix, " _compute_N"))
     // O = [(z^2-2z+1) * (q^3)]
     // P = [z^4-2z^3+2z-1] = [\lambda_1]
     , _compute_P(
           pb,
           _compute_H.result(),
-          in.unitary_inverse(), // _M
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " P")),
+          -_compress_in.result(), // _M
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " P")),
           FMT(annotation_prefix, " _compute_P"))
     // Q = [(z^4-2z^3+2z-1) * q]
     // R = [z^3-2z^2+z] = [\lambda_2]
@@ -1210,22 +1859,22 @@ bls12_377_final_exp_last_part_gadget<ppT>::bls12_377_final_exp_last_part_gadget(
           pb,
           _compute_F.result(),
           _compute_B.result(),
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " R")),
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " R")),
           FMT(annotation_prefix, " _compute_R"))
     // S = [(z^3-2z^2+z) * (q^2)]
     // T = [(z^2-2z+1) * (q^3) + (z^3-2z^2+z) * (q^2)]
     , _compute_T(
           pb,
-          _compute_N.result().frobenius_map(3), // _O
-          _compute_R.result().frobenius_map(2), // _S
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " T")),
+          fp12_torus_frobenius_map<FqkT>(_compute_N.result(), 3), // _O
+          fp12_torus_frobenius_map<FqkT>(_compute_R.result(), 2), // _S
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " T")),
           FMT(annotation_prefix, " _compute_T"))
     // U = [(z^2-2z+1) * (q^3) + (z^3-2z^2+z) * (q^2) + (z^4-2z^3+2z-1) * q]
     , _compute_U(
           pb,
           _compute_T.result(),
-          _compute_P.result().frobenius_map(1), // _Q
-          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " U")),
+          fp12_torus_frobenius_map<FqkT>(_compute_P.result(), 1), // _Q
+          Fp6_3over2_variable<Fq6T>(pb, FMT(annotation_prefix, " U")),
           FMT(annotation_prefix, " _compute_U"))
     // result = [(z^2-2z+1) * (q^3) + (z^3-2z^2+z) * (q^2) + (z^4-2z^3+2z-1) * q
     //          + z^5-2z^4+2z^2-z+3]
@@ -1249,6 +1898,7 @@ const Fp12_2over3over2_variable<libff::Fqk<other_curve<ppT>>>
 template<typename ppT>
 void bls12_377_final_exp_last_part_gadget<ppT>::generate_r1cs_constraints()
 {
+    _compress_in.generate_r1cs_constraints();
     _compute_in_squared.generate_r1cs_constraints();
     _compute_B.generate_r1cs_constraints();
     _compute_C.generate_r1cs_constraints();
@@ -1271,32 +1921,55 @@ void bls12_377_final_exp_last_part_gadget<ppT>::generate_r1cs_constraints()
 template<typename ppT>
 void bls12_377_final_exp_last_part_gadget<ppT>::generate_r1cs_witness()
 {
+    // The torus gadgets evaluate their (linear combination) inputs.
+    _compress_in.generate_r1cs_witness();
     _compute_in_squared.generate_r1cs_witness();
     _compute_B.generate_r1cs_witness();
     _compute_C.generate_r1cs_witness();
-    _compute_D._A.evaluate();
     _compute_D.generate_r1cs_witness();
     _compute_E.generate_r1cs_witness();
     _compute_F.generate_r1cs_witness();
     _compute_G.generate_r1cs_witness();
     _compute_H.generate_r1cs_witness();
     _compute_I.generate_r1cs_witness();
-    _compute_K._B.evaluate();
     _compute_K.generate_r1cs_witness();
     _compute_L.generate_r1cs_witness();
-    _compute_N._A.evaluate();
     _compute_N.generate_r1cs_witness();
-    _compute_P._B.evaluate();
     _compute_P.generate_r1cs_witness();
     _compute_R.generate_r1cs_witness();
-    _compute_T._A.evaluate();
-    _compute_T._B.evaluate();
     _compute_T.generate_r1cs_witness();
-    _compute_U._B.evaluate();
     _compute_U.generate_r1cs_witness();
     _compute_U_times_L.generate_r1cs_witness();
 }
 
+template<typename ppT>
+libff::Fqk<other_curve<ppT>> bls12_377_final_exp_last_part_gadget<
+    ppT>::generate_r1cs_witness_native(const FqkT &in)
+{
+    const Fq6T c_in = _compress_in.generate_r1cs_witness_native(in);
+    const Fq6T in_squared =
+        _compute_in_squared.generate_r1cs_witness_native(c_in);
+    const Fq6T B = _compute_B.generate_r1cs_witness_native(c_in);
+    const Fq6T C = _compute_C.generate_r1cs_witness_native(B);
+    const Fq6T D = _compute_D.generate_r1cs_witness_native(-in_squared, B);
+    const Fq6T E = _compute_E.generate_r1cs_witness_native(D);
+    const Fq6T F = _compute_F.generate_r1cs_witness_native(E);
+    const Fq6T G = _compute_G.generate_r1cs_witness_native(F);
+    const Fq6T H = _compute_H.generate_r1cs_witness_native(G, C);
+    const Fq6T I = _compute_I.generate_r1cs_witness_native(H);
+    const Fq6T K = _compute_K.generate_r1cs_witness_native(I, -D);
+    const Fq6T L = _compute_L.generate_r1cs_witness_native(K, c_in);
+    const Fq6T N = _compute_N.generate_r1cs_witness_native(E, c_in);
+    const Fq6T P = _compute_P.generate_r1cs_witness_native(H, -c_in);
+    const Fq6T R = _compute_R.generate_r1cs_witness_native(F, B);
+    const Fq6T T = _compute_T.generate_r1cs_witness_native(
+        fp12_torus_frobenius_map<FqkT>(N, 3),
+        fp12_torus_frobenius_map<FqkT>(R, 2));
+    const Fq6T U = _compute_U.generate_r1cs_witness_native(
+        T, fp12_torus_frobenius_map<FqkT>(P, 1));
+    return _compute_U_times_L.generate_r1cs_witness_native(U, L);
+}
+
 // bls12_377_final_exp_gadget methods
 
 template<typename ppT>
@@ -1376,6 +2049,16 @@ void bls12_377_final_exp_gadget<ppT>::generate_r1cs_constraints()
 
 template<typename ppT>
 void bls12_377_final_exp_gadget<ppT>::generate_r1cs_witness()
+{
+    const FqkT el = _compute_first_part._compute_B._A.get_element();
+    const FqkT result_val = _compute_last_part.generate_r1cs_witness_native(
+        _compute_first_part.generate_r1cs_witness_native(el));
+    this->pb.val(_result_is_one) =
+        (result_val == FqkT::one()) ? FieldT::one() : FieldT::zero();
+}
+
+template<typename ppT>
+void bls12_377_final_exp_gadget<ppT>::generate_r1cs_witness_per_gadget()
 {
     _compute_first_part.generate_r1cs_witness();
     _compute_last_part.generate_r1cs_witness();
@@ -1402,6 +2085,68 @@ bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
     : libsnark::gadget<FieldT>(pb, annotation_prefix)
     , _f0(pb, FqkT::one(), FMT(annotation_prefix, " f0"))
     , _minus_P4_Y()
+{
+    initialize(
+        pb,
+        P1_prec,
+        Q1_prec,
+        P2_prec,
+        Q2_prec,
+        P3_prec,
+        Q3_prec,
+        P4_prec,
+        Q4_prec,
+        false,
+        result,
+        annotation_prefix);
+}
+
+template<typename ppT>
+bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
+    bls12_377_e_times_e_times_e_over_e_miller_loop_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const bls12_377_G1_precomputation<ppT> &P1_prec,
+        const bls12_377_G2_precomputation<ppT> &Q1_prec,
+        const bls12_377_G1_precomputation<ppT> &P2_prec,
+        const bls12_377_G2_precomputation<ppT> &Q2_prec,
+        const bls12_377_G1_precomputation<ppT> &P3_prec,
+        const bls12_377_G2_precomputation<ppT> &Q3_prec,
+        const bls12_377_G1_precomputation<ppT> &P4_prec,
+        const bls12_377_G2_precomputation<ppT> &Q4_prec,
+        const Fp12_2over3over2_variable<FqkT> &c,
+        const Fp12_2over3over2_variable<FqkT> &result,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix), _f0(c), _minus_P4_Y()
+{
+    initialize(
+        pb,
+        P1_prec,
+        Q1_prec,
+        P2_prec,
+        Q2_prec,
+        P3_prec,
+        Q3_prec,
+        P4_prec,
+        Q4_prec,
+        true,
+        result,
+        annotation_prefix);
+}
+
+template<typename ppT>
+void bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::initialize(
+    libsnark::protoboard<FieldT> &pb,
+    const bls12_377_G1_precomputation<ppT> &P1_prec,
+    const bls12_377_G2_precomputation<ppT> &Q1_prec,
+    const bls12_377_G1_precomputation<ppT> &P2_prec,
+    const bls12_377_G2_precomputation<ppT> &Q2_prec,
+    const bls12_377_G1_precomputation<ppT> &P3_prec,
+    const bls12_377_G2_precomputation<ppT> &Q3_prec,
+    const bls12_377_G1_precomputation<ppT> &P4_prec,
+    const bls12_377_G2_precomputation<ppT> &Q4_prec,
+    bool multiply_by_f0,
+    const Fp12_2over3over2_variable<FqkT> &result,
+    const std::string &annotation_prefix)
 {
     _minus_P4_Y.assign(pb, -(*P4_prec._Py));
     size_t coeff_idx = 0;
@@ -1417,123 +2162,103 @@ bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
             FMT(annotation_prefix, " _f_squared[%zu]", _f_squared.size())));
         f = &_f_squared.back()->result();
 
-        // f <- f^2 * ell_Q1(P1)
-        _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
-            pb,
-            *P1_prec._Px,
-            *P1_prec._Py,
-            *Q1_prec._coeffs[coeff_idx],
-            *f,
-            Fp12_2over3over2_variable<FqkT>(
-                pb, FMT(annotation_prefix, " f^2*ell_Q1(P1)")),
-            FMT(annotation_prefix, " _f_ell_P1[%zu]", _f_ell_P.size())));
-        f = &_f_ell_P.back()->result();
-
-        // f <- f^2 * ell_Q2(P2)
-        _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
-            pb,
-            *P2_prec._Px,
-            *P2_prec._Py,
-            *Q2_prec._coeffs[coeff_idx],
-            *f,
-            Fp12_2over3over2_variable<FqkT>(
-                pb, FMT(annotation_prefix, " f^2*ell_Q2(P2)")),
-            FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-        f = &_f_ell_P.back()->result();
-
-        // f <- f^2 * ell_Q3(P3)
-        _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
-            pb,
-            *P3_prec._Px,
-            *P3_prec._Py,
-            *Q3_prec._coeffs[coeff_idx],
-            *f,
-            Fp12_2over3over2_variable<FqkT>(
-                pb, FMT(annotation_prefix, " f^2*ell_Q3(P3)")),
-            FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-        f = &_f_ell_P.back()->result();
-
-        // f <- f^2 * ell_Q1(P1)
-        _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
-            pb,
-            *P4_prec._Px,
-            _minus_P4_Y,
-            *Q4_prec._coeffs[coeff_idx],
-            *f,
-            Fp12_2over3over2_variable<FqkT>(
-                pb, FMT(annotation_prefix, " f^2*ell_Q4(P4)")),
-            FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-        f = &_f_ell_P.back()->result();
-
-        assert(0 == _f_ell_P.size() % 4);
-
-        ++coeff_idx;
-
-        if (bits.current()) {
-            // f <- f * ell_Q1(P1)
-            _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
+        // f <- f^2 * ell_Q1(P1) * ell_Q2(P2)
+        _f_ell_P_ell_P.emplace_back(
+            new bls12_377_ate_compute_f_ell_P_ell_P<ppT>(
                 pb,
                 *P1_prec._Px,
                 *P1_prec._Py,
                 *Q1_prec._coeffs[coeff_idx],
-                *f,
-                Fp12_2over3over2_variable<FqkT>(
-                    pb, FMT(annotation_prefix, " f*ell_Q1(P2)")),
-                FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-            f = &_f_ell_P.back()->result();
-
-            // f <- f * ell_Q2(P2)
-            _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
-                pb,
                 *P2_prec._Px,
                 *P2_prec._Py,
                 *Q2_prec._coeffs[coeff_idx],
                 *f,
                 Fp12_2over3over2_variable<FqkT>(
-                    pb, FMT(annotation_prefix, " f*ell_Q2(P2)")),
-                FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-            f = &_f_ell_P.back()->result();
+                    pb, FMT(annotation_prefix, " f^2*ell_Q1(P1)*ell_Q2(P2)")),
+                FMT(annotation_prefix,
+                    " _f_ell_P_ell_P[%zu]",
+                    _f_ell_P_ell_P.size())));
+        f = &_f_ell_P_ell_P.back()->result();
 
-            // f <- f * ell_Q3(P3)
-            _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
+        // f <- f^2 * ell_Q3(P3) * ell_Q4(P4)
+        _f_ell_P_ell_P.emplace_back(
+            new bls12_377_ate_compute_f_ell_P_ell_P<ppT>(
                 pb,
                 *P3_prec._Px,
                 *P3_prec._Py,
                 *Q3_prec._coeffs[coeff_idx],
+                *P4_prec._Px,
+                _minus_P4_Y,
+                *Q4_prec._coeffs[coeff_idx],
                 *f,
                 Fp12_2over3over2_variable<FqkT>(
-                    pb, FMT(annotation_prefix, " f*ell_Q3(P3)")),
-                FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
-            f = &_f_ell_P.back()->result();
+                    pb, FMT(annotation_prefix, " f^2*ell_Q3(P3)*ell_Q4(P4)")),
+                FMT(annotation_prefix,
+                    " _f_ell_P_ell_P[%zu]",
+                    _f_ell_P_ell_P.size())));
+        f = &_f_ell_P_ell_P.back()->result();
 
-            // f <- f * ell_Q4(P4)
-            if (bits.last()) {
-                _f_ell_P.emplace_back(
-                    std::shared_ptr<bls12_377_ate_compute_f_ell_P<ppT>>(
-                        new bls12_377_ate_compute_f_ell_P<ppT>(
-                            pb,
-                            *P4_prec._Px,
-                            _minus_P4_Y,
-                            *Q4_prec._coeffs[coeff_idx],
-                            *f,
-                            result,
-                            FMT(annotation_prefix,
-                                " _f_ell_P[%zu]",
-                                _f_ell_P.size()))));
-            } else {
-                _f_ell_P.emplace_back(new bls12_377_ate_compute_f_ell_P<ppT>(
+        assert(0 == _f_ell_P_ell_P.size() % 2);
+
+        ++coeff_idx;
+
+        if (bits.current()) {
+            // f <- f * ell_Q1(P1) * ell_Q2(P2)
+            _f_ell_P_ell_P.emplace_back(
+                new bls12_377_ate_compute_f_ell_P_ell_P<ppT>(
+                    pb,
+                    *P1_prec._Px,
+                    *P1_prec._Py,
+                    *Q1_prec._coeffs[coeff_idx],
+                    *P2_prec._Px,
+                    *P2_prec._Py,
+                    *Q2_prec._coeffs[coeff_idx],
+                    *f,
+                    Fp12_2over3over2_variable<FqkT>(
+                        pb, FMT(annotation_prefix, " f*ell_Q1(P1)*ell_Q2(P2)")),
+                    FMT(annotation_prefix,
+                        " _f_ell_P_ell_P[%zu]",
+                        _f_ell_P_ell_P.size())));
+            f = &_f_ell_P_ell_P.back()->result();
+
+            // f <- f * ell_Q3(P3) * ell_Q4(P4)
+            _f_ell_P_ell_P.emplace_back(
+                new bls12_377_ate_compute_f_ell_P_ell_P<ppT>(
                     pb,
+                    *P3_prec._Px,
+                    *P3_prec._Py,
+                    *Q3_prec._coeffs[coeff_idx],
                     *P4_prec._Px,
                     _minus_P4_Y,
                     *Q4_prec._coeffs[coeff_idx],
                     *f,
-                    Fp12_2over3over2_variable<FqkT>(
-                        pb, FMT(annotation_prefix, " f*ell_Q4(P4)")),
-                    FMT(annotation_prefix, " _f_ell_P[%zu]", _f_ell_P.size())));
+                    (bits.last() && !multiply_by_f0)
+                        ? result
+                        : Fp12_2over3over2_variable<FqkT>(
+                              pb,
+                              FMT(annotation_prefix,
+                                  " f*ell_Q3(P3)*ell_Q4(P4)")),
+                    FMT(annotation_prefix,
+                        " _f_ell_P_ell_P[%zu]",
+                        _f_ell_P_ell_P.size())));
+            f = &_f_ell_P_ell_P.back()->result();
+
+            // f <- f * c
+            if (multiply_by_f0) {
+                _f_times_c.emplace_back(new Fp12_2over3over2_mul_gadget<FqkT>(
+                    pb,
+                    *f,
+                    _f0,
+                    bits.last() ? result
+                                : Fp12_2over3over2_variable<FqkT>(
+                                      pb, FMT(annotation_prefix, " f*c")),
+                    FMT(annotation_prefix,
+                        " _f_times_c[%zu]",
+                        _f_times_c.size())));
+                f = &_f_times_c.back()->result();
             }
-            f = &_f_ell_P.back()->result();
 
-            assert(0 == _f_ell_P.size() % 4);
+            assert(0 == _f_ell_P_ell_P.size() % 2);
 
             ++coeff_idx;
         }
@@ -1546,23 +2271,24 @@ void bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<
 {
     size_t sqr_idx = 0;
     size_t f_ell_P_idx = 0;
+    size_t mul_idx = 0;
     bls12_377_miller_loop_bits bits;
     while (bits.next()) {
         _f_squared[sqr_idx++]->generate_r1cs_constraints();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
+        _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
+        _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
         if (bits.current()) {
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
+            _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
+            _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_constraints();
+            if (!_f_times_c.empty()) {
+                _f_times_c[mul_idx++]->generate_r1cs_constraints();
+            }
         }
     }
 
     assert(sqr_idx == _f_squared.size());
-    assert(f_ell_P_idx == _f_ell_P.size());
+    assert(f_ell_P_idx == _f_ell_P_ell_P.size());
+    assert(mul_idx == _f_times_c.size());
 }
 
 template<typename ppT>
@@ -1570,25 +2296,55 @@ void bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<
     ppT>::generate_r1cs_witness()
 {
     _minus_P4_Y.evaluate(this->pb);
+    const FqkT c = _f0.get_element();
+    FqkT f = c;
     size_t sqr_idx = 0;
     size_t f_ell_P_idx = 0;
+    size_t mul_idx = 0;
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        f = _f_squared[sqr_idx++]->generate_r1cs_witness_native(f);
+        f = _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness_native(f);
+        f = _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness_native(f);
+        if (bits.current()) {
+            f = _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness_native(f);
+            f = _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness_native(f);
+            if (!_f_times_c.empty()) {
+                f = _f_times_c[mul_idx++]->generate_r1cs_witness_native(f, c);
+            }
+        }
+    }
+
+    assert(sqr_idx == _f_squared.size());
+    assert(f_ell_P_idx == _f_ell_P_ell_P.size());
+    assert(mul_idx == _f_times_c.size());
+}
+
+template<typename ppT>
+void bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<
+    ppT>::generate_r1cs_witness_per_gadget()
+{
+    _minus_P4_Y.evaluate(this->pb);
+    size_t sqr_idx = 0;
+    size_t f_ell_P_idx = 0;
+    size_t mul_idx = 0;
     bls12_377_miller_loop_bits bits;
     while (bits.next()) {
         _f_squared[sqr_idx++]->generate_r1cs_witness();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-        _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
+        _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
+        _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
         if (bits.current()) {
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
-            _f_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
+            _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
+            _f_ell_P_ell_P[f_ell_P_idx++]->generate_r1cs_witness();
+            if (!_f_times_c.empty()) {
+                _f_times_c[mul_idx++]->generate_r1cs_witness();
+            }
         }
     }
 
     assert(sqr_idx == _f_squared.size());
-    assert(f_ell_P_idx == _f_ell_P.size());
+    assert(f_ell_P_idx == _f_ell_P_ell_P.size());
+    assert(mul_idx == _f_times_c.size());
 }
 
 } // namespace libzecale
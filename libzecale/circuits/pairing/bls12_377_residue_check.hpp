@@ -0,0 +1,93 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_HPP__
+#define __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_HPP__
+
+#include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
+#include "libzecale/circuits/pairing/bls12_377_residue_witness.hpp"
+
+namespace libzecale
+{
+
+/// Alternative to check_e_equals_eee_gadget for BLS12-377 (i.e. for ppT =
+/// bw6_761_pp), with the same interface, in which the final exponentiation
+/// is replaced by a check that the Miller loop output f is an r-th residue
+/// (see bls12_377_residue_witness). Given witnesses c, w6 and w4, the
+/// circuit computes f * c^x in the Miller loop (see the corresponding
+/// constructor of bls12_377_e_times_e_times_e_over_e_miller_loop_gadget) and
+/// enforces:
+///
+///   result_is_one * (f * c^x * w6 * w4 - c^q) = 0
+///
+/// with c constrained to be invertible. As for bls12_377_final_exp_gadget,
+/// it is infeasible to set `result_is_one` to 1 if the pairing check does
+/// not hold, but it is possible to set it to 0 for a valid pairing check.
+template<typename ppT>
+class bls12_377_residue_check_e_equals_eee_gadget
+    : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    using FieldT = libff::Fr<ppT>;
+    using FqkT = libff::Fqk<other_curve<ppT>>;
+    using Fq6T = typename FqkT::my_Fp6;
+    using Fq2T = typename FqkT::my_Fp2;
+
+    bls12_377_G1_precomputation<ppT> _lhs_G1;
+    bls12_377_G2_precomputation<ppT> _lhs_G2;
+    bls12_377_G1_precomputation<ppT> _rhs1_G1;
+    bls12_377_G2_precomputation<ppT> _rhs1_G2;
+    bls12_377_G1_precomputation<ppT> _rhs2_G1;
+    bls12_377_G2_precomputation<ppT> _rhs2_G2;
+    bls12_377_G1_precomputation<ppT> _rhs3_G1;
+    bls12_377_G2_precomputation<ppT> _rhs3_G2;
+
+    // Residue witness and scaling factor
+    Fp12_2over3over2_variable<FqkT> _c;
+    Fp6_3over2_variable<Fq6T> _w6;
+    libsnark::Fp2_variable<Fq2T> _w4_0;
+    libsnark::Fp2_variable<Fq2T> _w4_1;
+
+    // f * c^x
+    Fp12_2over3over2_variable<FqkT> _f_times_c_x;
+    bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<ppT>
+        _compute_f_times_c_x;
+
+    // f * c^x * w6 * w4
+    Fp12_2over3over2_mul_gadget<FqkT> _compute_times_w6;
+    Fp12_2over3over2_mul_gadget<FqkT> _compute_times_w4;
+
+    // c^q, and c * c^{-1} = 1
+    Fp12_2over3over2_variable<FqkT> _c_to_q;
+    Fp12_2over3over2_inv_gadget<FqkT> _compute_c_inv;
+
+    libsnark::pb_variable<FieldT> _result_is_one;
+
+    bls12_377_residue_check_e_equals_eee_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const bls12_377_G1_precomputation<ppT> &lhs_G1,
+        const bls12_377_G2_precomputation<ppT> &lhs_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs1_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs1_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs2_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs2_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs3_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs3_G2,
+        const libsnark::pb_variable<FieldT> &result_is_one,
+        const std::string &annotation_prefix);
+
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+private:
+    /// Native value of the Miller loop output f, computed from the values
+    /// of the precomputations.
+    FqkT miller_loop_value() const;
+};
+
+} // namespace libzecale
+
+#include "libzecale/circuits/pairing/bls12_377_residue_check.tcc"
+
+#endif // __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_HPP__
@@ -0,0 +1,223 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_TCC__
+#define __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_TCC__
+
+#include "libzecale/circuits/pairing/bls12_377_residue_check.hpp"
+
+#include <libsnark/gadgetlib1/gadgets/basic_gadgets.hpp>
+
+namespace libzecale
+{
+
+template<typename ppT>
+bls12_377_residue_check_e_equals_eee_gadget<ppT>::
+    bls12_377_residue_check_e_equals_eee_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const bls12_377_G1_precomputation<ppT> &lhs_G1,
+        const bls12_377_G2_precomputation<ppT> &lhs_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs1_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs1_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs2_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs2_G2,
+        const bls12_377_G1_precomputation<ppT> &rhs3_G1,
+        const bls12_377_G2_precomputation<ppT> &rhs3_G2,
+        const libsnark::pb_variable<FieldT> &result_is_one,
+        const std::string &annotation_prefix)
+    : libsnark::gadget<FieldT>(pb, annotation_prefix)
+    , _lhs_G1(lhs_G1)
+    , _lhs_G2(lhs_G2)
+    , _rhs1_G1(rhs1_G1)
+    , _rhs1_G2(rhs1_G2)
+    , _rhs2_G1(rhs2_G1)
+    , _rhs2_G2(rhs2_G2)
+    , _rhs3_G1(rhs3_G1)
+    , _rhs3_G2(rhs3_G2)
+    , _c(pb, FMT(annotation_prefix, " c"))
+    , _w6(pb, FMT(annotation_prefix, " w6"))
+    , _w4_0(pb, FMT(annotation_prefix, " w4_0"))
+    , _w4_1(pb, FMT(annotation_prefix, " w4_1"))
+    , _f_times_c_x(pb, FMT(annotation_prefix, " f*c^x"))
+    // As in check_e_equals_eee_gadget, the lhs pairing is the one inverted
+    // by the miller loop.
+    , _compute_f_times_c_x(
+          pb,
+          rhs1_G1,
+          rhs1_G2,
+          rhs2_G1,
+          rhs2_G2,
+          rhs3_G1,
+          rhs3_G2,
+          lhs_G1,
+          lhs_G2,
+          _c,
+          _f_times_c_x,
+          FMT(annotation_prefix, " _compute_f_times_c_x"))
+    , _compute_times_w6(
+          pb,
+          _f_times_c_x,
+          Fp12_2over3over2_variable<FqkT>(
+              pb,
+              _w6,
+              Fp6_3over2_variable<Fq6T>(
+                  pb, Fq6T::zero(), FMT(annotation_prefix, " w6.c1")),
+              FMT(annotation_prefix, " w6")),
+          Fp12_2over3over2_variable<FqkT>(
+              pb, FMT(annotation_prefix, " f*c^x*w6")),
+          FMT(annotation_prefix, " _compute_times_w6"))
+    , _compute_times_w4(
+          pb,
+          _compute_times_w6.result(),
+          Fp12_2over3over2_variable<FqkT>(
+              pb,
+              Fp6_3over2_variable<Fq6T>(
+                  pb,
+                  _w4_0,
+                  libsnark::Fp2_variable<Fq2T>(
+                      pb, Fq2T::zero(), FMT(annotation_prefix, " w4.c0.c1")),
+                  libsnark::Fp2_variable<Fq2T>(
+                      pb, Fq2T::zero(), FMT(annotation_prefix, " w4.c0.c2")),
+                  FMT(annotation_prefix, " w4.c0")),
+              Fp6_3over2_variable<Fq6T>(
+                  pb,
+                  libsnark::Fp2_variable<Fq2T>(
+                      pb, Fq2T::zero(), FMT(annotation_prefix, " w4.c1.c0")),
+                  _w4_1,
+                  libsnark::Fp2_variable<Fq2T>(
+                      pb, Fq2T::zero(), FMT(annotation_prefix, " w4.c1.c2")),
+                  FMT(annotation_prefix, " w4.c1")),
+              FMT(annotation_prefix, " w4")),
+          Fp12_2over3over2_variable<FqkT>(
+              pb, FMT(annotation_prefix, " f*c^x*w")),
+          FMT(annotation_prefix, " _compute_times_w4"))
+    , _c_to_q(_c.frobenius_map(1))
+    , _compute_c_inv(
+          pb,
+          _c,
+          Fp12_2over3over2_variable<FqkT>(pb, FMT(annotation_prefix, " c_inv")),
+          FMT(annotation_prefix, " _compute_c_inv"))
+    , _result_is_one(result_is_one)
+{
+}
+
+template<typename ppT>
+void bls12_377_residue_check_e_equals_eee_gadget<
+    ppT>::generate_r1cs_constraints()
+{
+    _compute_f_times_c_x.generate_r1cs_constraints();
+    _compute_times_w6.generate_r1cs_constraints();
+    _compute_times_w4.generate_r1cs_constraints();
+    _compute_c_inv.generate_r1cs_constraints();
+
+    libsnark::generate_boolean_r1cs_constraint<FieldT>(
+        this->pb,
+        _result_is_one,
+        FMT(this->annotation_prefix, " result_is_one_boolean"));
+
+    // result_is_one * (f * c^x * w - c^q) = 0, for each coefficient
+    const Fp12_2over3over2_variable<FqkT> &lhs = _compute_times_w4.result();
+    const libsnark::Fp2_variable<Fq2T> *lhs_coeffs[6] = {
+        &lhs._c0._c0,
+        &lhs._c0._c1,
+        &lhs._c0._c2,
+        &lhs._c1._c0,
+        &lhs._c1._c1,
+        &lhs._c1._c2};
+    const libsnark::Fp2_variable<Fq2T> *rhs_coeffs[6] = {
+        &_c_to_q._c0._c0,
+        &_c_to_q._c0._c1,
+        &_c_to_q._c0._c2,
+        &_c_to_q._c1._c0,
+        &_c_to_q._c1._c1,
+        &_c_to_q._c1._c2};
+    for (size_t i = 0; i < 6; ++i) {
+        this->pb.add_r1cs_constraint(
+            libsnark::r1cs_constraint<FieldT>(
+                _result_is_one, lhs_coeffs[i]->c0 - rhs_coeffs[i]->c0, 0),
+            FMT(this->annotation_prefix, " check_coeff[%zu].c0", i));
+        this->pb.add_r1cs_constraint(
+            libsnark::r1cs_constraint<FieldT>(
+                _result_is_one, lhs_coeffs[i]->c1 - rhs_coeffs[i]->c1, 0),
+            FMT(this->annotation_prefix, " check_coeff[%zu].c1", i));
+    }
+}
+
+template<typename ppT>
+void bls12_377_residue_check_e_equals_eee_gadget<ppT>::generate_r1cs_witness()
+{
+    // If no witness exists, the trivial witness is used, satisfying all
+    // constraints when result_is_one == 0.
+    bls12_377_residue_witness witness;
+    const bool is_one = witness.compute(miller_loop_value());
+
+    _c.generate_r1cs_witness(witness.c);
+    _w6.generate_r1cs_witness(witness.w6);
+    _w4_0.generate_r1cs_witness(witness.w4_0);
+    _w4_1.generate_r1cs_witness(witness.w4_1);
+
+    _compute_f_times_c_x.generate_r1cs_witness();
+    _compute_times_w6.generate_r1cs_witness();
+    _compute_times_w4.generate_r1cs_witness();
+    _compute_c_inv.generate_r1cs_witness();
+
+    this->pb.val(_result_is_one) = is_one ? FieldT::one() : FieldT::zero();
+}
+
+template<typename ppT>
+libff::Fqk<other_curve<ppT>> bls12_377_residue_check_e_equals_eee_gadget<
+    ppT>::miller_loop_value() const
+{
+    using FqeT = libff::Fqe<other_curve<ppT>>;
+
+    // Same order as in _compute_f_times_c_x, where the lhs Y coordinate is
+    // negated.
+    const bls12_377_G1_precomputation<ppT> *P_precs[4] = {
+        &_rhs1_G1, &_rhs2_G1, &_rhs3_G1, &_lhs_G1};
+    const bls12_377_G2_precomputation<ppT> *Q_precs[4] = {
+        &_rhs1_G2, &_rhs2_G2, &_rhs3_G2, &_lhs_G2};
+    FieldT Px[4];
+    FieldT Py[4];
+    for (size_t i = 0; i < 4; ++i) {
+        Px[i] = this->pb.lc_val(*P_precs[i]->_Px);
+        Py[i] = this->pb.lc_val(*P_precs[i]->_Py);
+    }
+    Py[3] = -Py[3];
+
+    // f <- f * ell_Q(P), where ell_Q(P) is the sparse element
+    // ((ell_0, 0, ell_vv * Px), (0, ell_vw * Py, 0)) (see
+    // bls12_377_ate_compute_f_ell_P).
+    FqkT f = FqkT::one();
+    size_t coeff_idx = 0;
+    const auto mul_by_lines = [&](size_t idx) {
+        for (size_t i = 0; i < 4; ++i) {
+            const bls12_377_ate_ell_coeffs<ppT> &coeffs =
+                *Q_precs[i]->_coeffs[idx];
+            f = f * FqkT(
+                        Fq6T(
+                            coeffs.ell_0.get_element(),
+                            FqeT::zero(),
+                            Px[i] * coeffs.ell_vv.get_element()),
+                        Fq6T(
+                            FqeT::zero(),
+                            Py[i] * coeffs.ell_vw.get_element(),
+                            FqeT::zero()));
+        }
+    };
+
+    bls12_377_miller_loop_bits bits;
+    while (bits.next()) {
+        f = f.squared();
+        mul_by_lines(coeff_idx++);
+        if (bits.current()) {
+            mul_by_lines(coeff_idx++);
+        }
+    }
+
+    return f;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_CHECK_TCC__
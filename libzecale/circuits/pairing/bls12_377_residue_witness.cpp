@@ -0,0 +1,310 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/circuits/pairing/bls12_377_residue_witness.hpp"
+
+#include <cassert>
+#include <gmp.h>
+#include <stdexcept>
+#include <vector>
+
+namespace libzecale
+{
+
+namespace
+{
+
+using Fq = libff::bls12_377_Fq;
+using Fq2 = libff::bls12_377_Fq2;
+using Fq6 = libff::bls12_377_Fq6;
+using Fq12 = libff::bls12_377_Fq12;
+
+/// Minimal RAII wrapper around mpz_t.
+class mpz_integer
+{
+public:
+    mpz_integer() { mpz_init(_value); }
+    explicit mpz_integer(unsigned long value)
+    {
+        mpz_init_set_ui(_value, value);
+    }
+    mpz_integer(const mpz_integer &other)
+    {
+        mpz_init_set(_value, other._value);
+    }
+    template<mp_size_t n> explicit mpz_integer(const libff::bigint<n> &value)
+    {
+        mpz_init(_value);
+        value.to_mpz(_value);
+    }
+    ~mpz_integer() { mpz_clear(_value); }
+
+    mpz_integer &operator=(const mpz_integer &other)
+    {
+        mpz_set(_value, other._value);
+        return *this;
+    }
+
+    mpz_ptr get() { return _value; }
+    mpz_srcptr get() const { return _value; }
+
+private:
+    mpz_t _value;
+};
+
+Fq12 fq12_pow(const Fq12 &base, const mpz_integer &exponent)
+{
+    Fq12 result = Fq12::one();
+    for (size_t i = mpz_sizeinbase(exponent.get(), 2); i > 0; --i) {
+        result = result.squared();
+        if (mpz_tstbit(exponent.get(), i - 1)) {
+            result = result * base;
+        }
+    }
+    return result;
+}
+
+Fq12 fq12_from_fq4(const Fq2 &w4_0, const Fq2 &w4_1)
+{
+    return Fq12(
+        Fq6(w4_0, Fq2::zero(), Fq2::zero()),
+        Fq6(Fq2::zero(), w4_1, Fq2::zero()));
+}
+
+/// Deterministic candidate generators of (subgroups of) Fq4^* and Fq6^*.
+Fq12 candidate_generator(unsigned long i, bool in_fq4)
+{
+    const Fq2 a(Fq(i), Fq::one());
+    if (in_fq4) {
+        return fq12_from_fq4(a, Fq2::one());
+    }
+    return Fq12(Fq6(a, Fq2::one(), Fq2::zero()), Fq6::zero());
+}
+
+/// Data used to solve for the p-primary part of the scaling factor, where
+/// p^k exactly divides the order n of the subgroup to be killed.
+class prime_power_component
+{
+public:
+    unsigned long p;
+    unsigned long k;
+    mpz_integer p_to_k;
+    /// Exponent projecting an element of order dividing n onto its p-primary
+    /// part: cof * (cof^{-1} mod p^k), where cof = n / p^k.
+    mpz_integer projection;
+    /// Is `generator` in Fq4 (otherwise it is in Fq6)?
+    bool in_fq4;
+    /// Element such that `generator^e` has order exactly p^k.
+    Fq12 generator;
+    Fq12 generator_e;
+    /// Powers gamma^i, i in [0, p), where gamma = generator_e^(p^(k-1)).
+    std::vector<Fq12> roots;
+
+    /// Solve generator_e^z == target (target of order dividing p^k) using
+    /// Pohlig-Hellman, recovering z one base-p digit at a time. Returns false
+    /// if no solution exists.
+    bool dlog(const Fq12 &target, mpz_integer &z) const
+    {
+        mpz_set_ui(z.get(), 0);
+        mpz_integer p_to_j(1);
+        mpz_integer exponent;
+        for (unsigned long j = 0; j < k; ++j) {
+            // h_j = (generator_e^(-z) * target)^(p^(k-1-j))
+            mpz_sub(exponent.get(), p_to_k.get(), z.get());
+            const Fq12 reduced = fq12_pow(generator_e, exponent) * target;
+            mpz_ui_pow_ui(exponent.get(), p, k - 1 - j);
+            const Fq12 h_j = fq12_pow(reduced, exponent);
+
+            size_t digit = 0;
+            while (digit < roots.size() && roots[digit] != h_j) {
+                ++digit;
+            }
+            if (digit == roots.size()) {
+                return false;
+            }
+
+            mpz_addmul_ui(z.get(), p_to_j.get(), digit);
+            mpz_mul_ui(p_to_j.get(), p_to_j.get(), p);
+        }
+        return true;
+    }
+};
+
+/// Parameters of the residue check, derived once from the curve parameters.
+class residue_parameters
+{
+public:
+    mpz_integer x;
+    /// Cofactor h of the r-th roots, divided by n
+    mpz_integer e;
+    /// lambda^{-1} mod (q^12 - 1) / (r * n)
+    mpz_integer lambda_inv;
+    std::vector<prime_power_component> components;
+
+    residue_parameters();
+
+    static const residue_parameters &get()
+    {
+        static const residue_parameters params;
+        return params;
+    }
+};
+
+residue_parameters::residue_parameters()
+    : x(libff::bls12_377_ate_loop_count)
+{
+    if (libff::bls12_377_ate_is_loop_count_neg) {
+        throw std::runtime_error("residue check requires a positive x");
+    }
+
+    const mpz_integer q(Fq::mod);
+    const mpz_integer r(libff::bls12_377_Fr::mod);
+
+    // N = q^12 - 1, h = N / r, lambda = q - x
+    mpz_integer N;
+    mpz_pow_ui(N.get(), q.get(), 12);
+    mpz_sub_ui(N.get(), N.get(), 1);
+    mpz_integer h;
+    mpz_divexact(h.get(), N.get(), r.get());
+    mpz_integer lambda;
+    mpz_sub(lambda.get(), q.get(), x.get());
+    assert(mpz_divisible_p(lambda.get(), r.get()));
+
+    // Find the smallest n such that gcd(lambda, N / (r * n)) == 1. The
+    // scaling factor must cancel the component of f of order n.
+    mpz_integer n(1);
+    mpz_integer M(h);
+    mpz_integer d;
+    for (;;) {
+        mpz_gcd(d.get(), lambda.get(), M.get());
+        if (0 == mpz_cmp_ui(d.get(), 1)) {
+            break;
+        }
+        mpz_mul(n.get(), n.get(), d.get());
+        mpz_divexact(M.get(), M.get(), d.get());
+    }
+    assert(mpz_divisible_p(h.get(), n.get()));
+    mpz_divexact(e.get(), h.get(), n.get());
+    if (0 == mpz_invert(lambda_inv.get(), lambda.get(), M.get())) {
+        throw std::runtime_error("lambda is not invertible");
+    }
+
+    // Factor n (which only has small prime factors).
+    mpz_integer remaining(n);
+    for (unsigned long p = 2; mpz_cmp_ui(remaining.get(), 1) > 0; ++p) {
+        if (p > (1ul << 20)) {
+            throw std::runtime_error("unexpected residue subgroup order");
+        }
+        if (!mpz_divisible_ui_p(remaining.get(), p)) {
+            continue;
+        }
+
+        prime_power_component component;
+        component.p = p;
+        component.k = 0;
+        mpz_set_ui(component.p_to_k.get(), 1);
+        while (mpz_divisible_ui_p(remaining.get(), p)) {
+            mpz_divexact_ui(remaining.get(), remaining.get(), p);
+            mpz_mul_ui(component.p_to_k.get(), component.p_to_k.get(), p);
+            ++component.k;
+        }
+
+        mpz_integer cof;
+        mpz_divexact(cof.get(), n.get(), component.p_to_k.get());
+        mpz_invert(
+            component.projection.get(), cof.get(), component.p_to_k.get());
+        mpz_mul(
+            component.projection.get(), component.projection.get(), cof.get());
+
+        // Find a generator of the p-primary part, alternating between Fq4
+        // and Fq6 candidates. gamma must be non-trivial for generator_e to
+        // have order exactly p^k.
+        mpz_integer p_to_k_minus_1;
+        mpz_divexact_ui(
+            p_to_k_minus_1.get(), component.p_to_k.get(), component.p);
+        bool found = false;
+        for (size_t attempt = 0; attempt < 128 && !found; ++attempt) {
+            component.in_fq4 = (0 == attempt % 2);
+            component.generator = fq12_pow(
+                candidate_generator(1 + attempt / 2, component.in_fq4), cof);
+            component.generator_e = fq12_pow(component.generator, e);
+            const Fq12 gamma =
+                fq12_pow(component.generator_e, p_to_k_minus_1);
+            found = (gamma != Fq12::one());
+            if (found) {
+                component.roots.reserve(p);
+                component.roots.push_back(Fq12::one());
+                for (unsigned long i = 1; i < p; ++i) {
+                    component.roots.push_back(component.roots.back() * gamma);
+                }
+            }
+        }
+        if (!found) {
+            throw std::runtime_error("no generator for residue subgroup");
+        }
+
+        components.push_back(component);
+    }
+}
+
+} // namespace
+
+bls12_377_residue_witness::bls12_377_residue_witness()
+    : c(Fq12::one()), w6(Fq6::one()), w4_0(Fq2::one()), w4_1(Fq2::zero())
+{
+}
+
+libff::bls12_377_Fq12 bls12_377_residue_witness::scaling_factor() const
+{
+    return Fq12(w6, Fq6::zero()) * fq12_from_fq4(w4_0, w4_1);
+}
+
+bool bls12_377_residue_witness::check(const libff::bls12_377_Fq12 &f) const
+{
+    const residue_parameters &params = residue_parameters::get();
+    return (c != Fq12::zero()) &&
+           (c.Frobenius_map(1) ==
+            f * scaling_factor() * fq12_pow(c, params.x));
+}
+
+bool bls12_377_residue_witness::compute(const libff::bls12_377_Fq12 &f)
+{
+    const residue_parameters &params = residue_parameters::get();
+
+    // t = f^e has order dividing n (if f^h == 1). Find w4, w6 such that
+    // (w4 * w6)^e == t^{-1}, one prime power at a time.
+    const Fq12 t = fq12_pow(f, params.e);
+    Fq12 w6_acc = Fq12::one();
+    Fq12 w4_acc = Fq12::one();
+    mpz_integer z;
+    for (const prime_power_component &component : params.components) {
+        const Fq12 t_p = fq12_pow(t, component.projection);
+        if (!component.dlog(t_p.inverse(), z)) {
+            *this = bls12_377_residue_witness();
+            return false;
+        }
+
+        const Fq12 w_p = fq12_pow(component.generator, z);
+        if (component.in_fq4) {
+            w4_acc = w4_acc * w_p;
+        } else {
+            w6_acc = w6_acc * w_p;
+        }
+    }
+
+    w6 = w6_acc.coeffs[0];
+    w4_0 = w4_acc.coeffs[0].coeffs[0];
+    w4_1 = w4_acc.coeffs[1].coeffs[1];
+
+    // f * w is now a lambda-th power, with root y^(lambda^{-1}).
+    c = fq12_pow(f * scaling_factor(), params.lambda_inv);
+    if (!check(f)) {
+        *this = bls12_377_residue_witness();
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace libzecale
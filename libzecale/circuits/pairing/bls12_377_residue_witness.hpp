@@ -0,0 +1,67 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+/// Reference
+/// \[NE24]
+///  "On Proving Pairings"
+///  Andrija Novakovic and Liam Eagen,
+///  IACR Cryptology ePrint Archive 2024, <https://eprint.iacr.org/2024/640>
+
+#ifndef __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_WITNESS_HPP__
+#define __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_WITNESS_HPP__
+
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+
+namespace libzecale
+{
+
+/// Native computation of the witness used to check that the output `f` of a
+/// BLS12-377 Miller loop is mapped to 1 by the final exponentiation, without
+/// computing the final exponentiation (see Section 4 of [NE24]).
+///
+/// Let `x` be the (positive) ate loop count, `q` the base field modulus, `r`
+/// the group order and `h = (q^12 - 1) / r`. Then `lambda = q - x` is a
+/// multiple of `r` and `f^h == 1` iff `f` is an r-th residue, which is shown
+/// by exhibiting `c` such that:
+///
+///   c^lambda == f * w, i.e. c^q == f * w * c^x
+///
+/// where `w` is a "scaling factor" compensating for the fact that
+/// `gcd(lambda, q^12 - 1)` is not `r`. Since `c^x` can be folded into the
+/// Miller loop (using `c` as the initial value of the accumulator) and `c^q`
+/// is a Frobenius map, the check replaces the final exponentiation by a
+/// handful of Fq12 multiplications.
+///
+/// `w` is taken to be `w6 * w4`, where `w6` is in Fq6 and `w4` is in Fq4
+/// (i.e. only the coefficients of 1 and `v * w` are non-zero). Every element
+/// of these subfields satisfies `w^h == 1` (since `r` divides neither
+/// `q^6 - 1` nor `q^4 - 1`), so that `c^lambda == f * w` with `c != 0`
+/// implies `f^h == 1` for any choice of `w6` and `w4`.
+class bls12_377_residue_witness
+{
+public:
+    libff::bls12_377_Fq12 c;
+    libff::bls12_377_Fq6 w6;
+    libff::bls12_377_Fq2 w4_0;
+    libff::bls12_377_Fq2 w4_1;
+
+    /// Trivial witness (c = w = 1), which satisfies the check only for
+    /// f == 1.
+    bls12_377_residue_witness();
+
+    /// The scaling factor w = w6 * w4, as an element of Fq12.
+    libff::bls12_377_Fq12 scaling_factor() const;
+
+    /// Returns true if c^q == f * w * c^x (and c != 0).
+    bool check(const libff::bls12_377_Fq12 &f) const;
+
+    /// Compute the witness for the Miller loop output `f`. Returns false (and
+    /// sets the trivial witness) if `f` is not mapped to 1 by the final
+    /// exponentiation. Requires bls12_377_pp::init_public_params().
+    bool compute(const libff::bls12_377_Fq12 &f);
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_PAIRING_BLS12_377_RESIDUE_WITNESS_HPP__
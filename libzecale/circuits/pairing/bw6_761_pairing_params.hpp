@@ -6,6 +6,7 @@
 #define __ZECALE_CIRCUITS_PAIRING_BW6_761_PAIRING_PARAMS_HPP__
 
 #include "libzecale/circuits/fields/fp12_2over3over2_gadgets.hpp"
+#include "libzecale/circuits/pairing/bls12_377_membership_check.hpp"
 #include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
 #include "libzecale/circuits/pairing/pairing_params.hpp"
 
@@ -24,6 +25,8 @@ template<typename ppT> class bls12_377_G2_precompute_gadget;
 template<typename ppT>
 class bls12_377_e_times_e_times_e_over_e_miller_loop_gadget;
 template<typename ppT> class bls12_377_final_exp_gadget;
+template<typename ppT> class bls12_377_G1_membership_check_gadget;
+template<typename ppT> class bls12_377_G2_membership_check_gadget;
 
 // Parameters for creating BW6-761 proofs that include statements about
 // BLS12_377 pairings.
@@ -73,6 +76,11 @@ public:
 
     typedef bls12_377_final_exp_gadget<libff::bw6_761_pp> final_exp_gadget_type;
 
+    typedef bls12_377_G1_membership_check_gadget<libff::bw6_761_pp>
+        G1_membership_check_gadget_type;
+    typedef bls12_377_G2_membership_check_gadget<libff::bw6_761_pp>
+        G2_membership_check_gadget_type;
+
     static const constexpr libff::bigint<libff::bw6_761_Fr::num_limbs>
         &pairing_loop_count = libff::bls12_377_ate_loop_count;
 };
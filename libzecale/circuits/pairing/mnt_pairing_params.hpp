@@ -10,6 +10,8 @@
 
 #include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
 #include <libff/algebra/curves/mnt/mnt6/mnt6_pp.hpp>
+#include <libsnark/gadgetlib1/gadgets/curves/weierstrass_g1_gadget.hpp>
+#include <libsnark/gadgetlib1/gadgets/curves/weierstrass_g2_gadget.hpp>
 #include <libsnark/gadgetlib1/gadgets/fields/fp2_gadgets.hpp>
 #include <libsnark/gadgetlib1/gadgets/fields/fp3_gadgets.hpp>
 #include <libsnark/gadgetlib1/gadgets/fields/fp4_gadgets.hpp>
@@ -20,6 +22,26 @@
 namespace libzecale
 {
 
+/// Subgroup membership check which enforces nothing. G1 of MNT4 and MNT6 is
+/// the full group of points of the curve (of prime order), so that the
+/// on-curve check (libsnark::G1_checker_gadget) is sufficient. G2 points are
+/// not checked.
+template<typename ppT, typename pointVariableT>
+class mnt_no_membership_check_gadget : public libsnark::gadget<libff::Fr<ppT>>
+{
+public:
+    mnt_no_membership_check_gadget(
+        libsnark::protoboard<libff::Fr<ppT>> &pb,
+        const pointVariableT &,
+        const std::string &annotation_prefix)
+        : libsnark::gadget<libff::Fr<ppT>>(pb, annotation_prefix)
+    {
+    }
+
+    void generate_r1cs_constraints() {}
+    void generate_r1cs_witness() {}
+};
+
 // Specialization for MNT4.
 //
 template<> class pairing_selector<libff::mnt4_pp>
@@ -56,6 +78,14 @@ public:
     // Add typedef for the `e_times_e_times_e_over_e_miller_loop_gadget` gadget
     typedef mnt_e_times_e_times_e_over_e_miller_loop_gadget<libff::mnt4_pp>
         e_times_e_times_e_over_e_miller_loop_gadget_type;
+    typedef mnt_no_membership_check_gadget<
+        libff::mnt4_pp,
+        libsnark::G1_variable<libff::mnt4_pp>>
+        G1_membership_check_gadget_type;
+    typedef mnt_no_membership_check_gadget<
+        libff::mnt4_pp,
+        libsnark::G2_variable<libff::mnt4_pp>>
+        G2_membership_check_gadget_type;
     typedef libsnark::mnt4_final_exp_gadget<libff::mnt4_pp>
         final_exp_gadget_type;
 
@@ -100,6 +130,14 @@ public:
     // Add typedef for the `e_times_e_times_e_over_e_miller_loop_gadget` gadget
     typedef mnt_e_times_e_times_e_over_e_miller_loop_gadget<libff::mnt6_pp>
         e_times_e_times_e_over_e_miller_loop_gadget_type;
+    typedef mnt_no_membership_check_gadget<
+        libff::mnt6_pp,
+        libsnark::G1_variable<libff::mnt6_pp>>
+        G1_membership_check_gadget_type;
+    typedef mnt_no_membership_check_gadget<
+        libff::mnt6_pp,
+        libsnark::G2_variable<libff::mnt6_pp>>
+        G2_membership_check_gadget_type;
     typedef libsnark::mnt6_final_exp_gadget<libff::mnt6_pp>
         final_exp_gadget_type;
 
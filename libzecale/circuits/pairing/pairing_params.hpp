@@ -35,6 +35,8 @@ namespace libzecale
  * - e_times_e_over_e_miller_loop_gadget_type
  * - e_times_e_times_e_over_e_miller_loop_gadget_type
  * - final_exp_gadget_type
+ * - G1_membership_check_gadget_type
+ * - G2_membership_check_gadget_type
  * and also containing a static constant
  * - const constexpr libff::bigint<m> pairing_loop_count
  *
@@ -69,6 +71,10 @@ namespace libzecale
  *       typedef my_e_times_e_over_e_miller_loop_gadget_type
  *           e_times_e_over_e_miller_loop_gadget_type;
  *       typedef my_final_exp_gadget_type final_exp_gadget_type;
+ *       typedef my_G1_membership_check_gadget_type
+ *           G1_membership_check_gadget_type;
+ *       typedef my_G2_membership_check_gadget_type
+ *           G2_membership_check_gadget_type;
  *       static const constexpr libff::bigint<...> &pairing_loop_count = ...;
  *   };
  * Having done the above, my_ec_pp can be used as a template parameter. See
@@ -136,6 +142,12 @@ using e_times_e_times_e_over_e_miller_loop_gadget = typename pairing_selector<
     ppT>::e_times_e_times_e_over_e_miller_loop_gadget_type;
 template<typename ppT>
 using final_exp_gadget = typename pairing_selector<ppT>::final_exp_gadget_type;
+template<typename ppT>
+using G1_membership_check_gadget =
+    typename pairing_selector<ppT>::G1_membership_check_gadget_type;
+template<typename ppT>
+using G2_membership_check_gadget =
+    typename pairing_selector<ppT>::G2_membership_check_gadget_type;
 
 } // namespace libzecale
 
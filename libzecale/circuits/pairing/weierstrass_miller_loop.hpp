@@ -11,75 +11,104 @@
 #include <libsnark/gadgetlib1/gadgets/pairing/weierstrass_miller_loop.hpp>
 #include <libsnark/gadgetlib1/gadgets/pairing/weierstrass_precomputation.hpp>
 #include <memory>
+#include <vector>
 
 namespace libzecale
 {
 
-/// Gadget for verifying a quadruple Miller loop (where the fourth is inverted).
-/// This gadget is necessary to implement the Groth16 verifier, and carry out
-/// the check: e(\pi.A, \pi.B) = e(vk.\alpha, vk.\beta) * e (acc, g2) * e(\pi.C,
-/// vk.\delta) where, g2 is the generator we use for encoding in G2, and where *
-/// denotes the group operation in GT.
+/// Gadget computing the product of the Miller loops of k pairs (P_j, Q_j),
+/// where some of the pairs may be inverted:
+///   result = \prod_j ML(P_j, Q_j)^{e_j}, e_j = -1 if inverted[j], 1 otherwise
+///
+/// The k Miller loops share the same accumulator, and so a single chain of
+/// squarings (`dbl_sqrs`). Each pair only costs its line evaluations and the
+/// multiplications of the accumulator by these lines.
+///
+/// TODO: Use this gadget to check the N nested proofs of an MNT aggregation
+/// with one Miller loop and a single final exponentiation. This is only
+/// sound if the G1 inputs of the i-th check are first multiplied by a scalar
+/// r_i derived in-circuit from the inputs of the whole batch (e.g. from a
+/// digest of their primary inputs), so that the ratios of two invalid checks
+/// cannot cancel out. It also gives one validity bit for the whole batch,
+/// whereas the aggregator statement currently has one bit per nested proof.
 template<typename ppT>
-class mnt_e_times_e_times_e_over_e_miller_loop_gadget
-    : public libsnark::gadget<libff::Fr<ppT>>
+class mnt_multi_miller_loop_gadget : public libsnark::gadget<libff::Fr<ppT>>
 {
 public:
     typedef libff::Fr<ppT> FieldT;
     typedef libff::Fqe<other_curve<ppT>> FqeT;
     typedef libff::Fqk<other_curve<ppT>> FqkT;
 
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RR_at_P1s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RQ_at_P1s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RR_at_P2s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RQ_at_P2s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RR_at_P3s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RQ_at_P3s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RR_at_P4s;
-    std::vector<std::shared_ptr<Fqk_variable<ppT>>> g_RQ_at_P4s;
+    /// g_RR_at_Ps[j] (resp. g_RQ_at_Ps[j]) are the evaluations of the lines
+    /// of the doubling (resp. addition) steps for the j-th pair.
+    std::vector<std::vector<std::shared_ptr<Fqk_variable<ppT>>>> g_RR_at_Ps;
+    std::vector<std::vector<std::shared_ptr<Fqk_variable<ppT>>>> g_RQ_at_Ps;
     std::vector<std::shared_ptr<Fqk_variable<ppT>>> fs;
 
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_add_line_eval<ppT>>>
-        addition_steps1;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_dbl_line_eval<ppT>>>
-        doubling_steps1;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_add_line_eval<ppT>>>
-        addition_steps2;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_dbl_line_eval<ppT>>>
-        doubling_steps2;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_add_line_eval<ppT>>>
-        addition_steps3;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_dbl_line_eval<ppT>>>
-        doubling_steps3;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_add_line_eval<ppT>>>
-        addition_steps4;
-    std::vector<std::shared_ptr<libsnark::mnt_miller_loop_dbl_line_eval<ppT>>>
-        doubling_steps4;
+    std::vector<std::vector<
+        std::shared_ptr<libsnark::mnt_miller_loop_add_line_eval<ppT>>>>
+        addition_steps;
+    std::vector<std::vector<
+        std::shared_ptr<libsnark::mnt_miller_loop_dbl_line_eval<ppT>>>>
+        doubling_steps;
 
     std::vector<std::shared_ptr<Fqk_sqr_gadget<ppT>>> dbl_sqrs;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> dbl_muls1;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> add_muls1;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> dbl_muls2;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> add_muls2;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> dbl_muls3;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> add_muls3;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> dbl_muls4;
-    std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>> add_muls4;
+    std::vector<std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>>>
+        dbl_muls;
+    std::vector<std::vector<std::shared_ptr<Fqk_special_mul_gadget<ppT>>>>
+        add_muls;
 
     size_t f_count;
     size_t add_count;
     size_t dbl_count;
 
-    libsnark::G1_precomputation<ppT> prec_P1;
-    libsnark::G2_precomputation<ppT> prec_Q1;
-    libsnark::G1_precomputation<ppT> prec_P2;
-    libsnark::G2_precomputation<ppT> prec_Q2;
-    libsnark::G1_precomputation<ppT> prec_P3;
-    libsnark::G2_precomputation<ppT> prec_Q3;
-    libsnark::G1_precomputation<ppT> prec_P4;
-    libsnark::G2_precomputation<ppT> prec_Q4;
+    std::vector<libsnark::G1_precomputation<ppT>> prec_Ps;
+    std::vector<libsnark::G2_precomputation<ppT>> prec_Qs;
+    std::vector<bool> inverted;
     Fqk_variable<ppT> result;
 
+    /// `prec_Ps`, `prec_Qs` and `inverted` must have the same (non-zero)
+    /// size.
+    mnt_multi_miller_loop_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const std::vector<libsnark::G1_precomputation<ppT>> &prec_Ps,
+        const std::vector<libsnark::G2_precomputation<ppT>> &prec_Qs,
+        const std::vector<bool> &inverted,
+        const Fqk_variable<ppT> &result,
+        const std::string &annotation_prefix);
+    void generate_r1cs_constraints();
+    void generate_r1cs_witness();
+
+private:
+    /// The i-th value of the accumulator (`result` for i == f_count).
+    Fqk_variable<ppT> &f_variable(size_t i);
+
+    /// Multiplication of the accumulator fs[f_id] by the line `g` of the
+    /// pair `pair_id`, into f_variable(f_id + 1).
+    Fqk_special_mul_gadget<ppT> *create_mul(
+        size_t pair_id,
+        size_t f_id,
+        const Fqk_variable<ppT> &g,
+        const std::string &annotation);
+    void generate_mul_witness(
+        size_t pair_id,
+        size_t f_id,
+        const Fqk_variable<ppT> &g,
+        Fqk_special_mul_gadget<ppT> &mul);
+};
+
+/// Gadget for verifying a quadruple Miller loop (where the fourth is inverted).
+/// This gadget is necessary to implement the Groth16 verifier, and carry out
+/// the check: e(\pi.A, \pi.B) = e(vk.\alpha, vk.\beta) * e (acc, g2) * e(\pi.C,
+/// vk.\delta) where, g2 is the generator we use for encoding in G2, and where *
+/// denotes the group operation in GT.
+template<typename ppT>
+class mnt_e_times_e_times_e_over_e_miller_loop_gadget
+    : public mnt_multi_miller_loop_gadget<ppT>
+{
+public:
+    typedef libff::Fr<ppT> FieldT;
+
     mnt_e_times_e_times_e_over_e_miller_loop_gadget(
         libsnark::protoboard<FieldT> &pb,
         const libsnark::G1_precomputation<ppT> &prec_P1,
@@ -92,8 +121,6 @@ public:
         const libsnark::G2_precomputation<ppT> &prec_Q4,
         const Fqk_variable<ppT> &result,
         const std::string &annotation_prefix);
-    void generate_r1cs_constraints();
-    void generate_r1cs_witness();
 };
 
 template<typename ppT>
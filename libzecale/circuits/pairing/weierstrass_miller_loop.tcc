@@ -5,6 +5,9 @@
 #ifndef __ZECALE_CIRCUITS_PAIRING_WEIERSTRASS_MILLER_LOOP_TCC__
 #define __ZECALE_CIRCUITS_PAIRING_WEIERSTRASS_MILLER_LOOP_TCC__
 
+#include "libzecale/core/logger.hpp"
+
+#include <cassert>
 #include <libff/algebra/scalar_multiplication/wnaf.hpp>
 #include <libsnark/gadgetlib1/constraint_profiling.hpp>
 #include <libsnark/gadgetlib1/gadgets/basic_gadgets.hpp>
@@ -13,30 +16,24 @@ namespace libzecale
 {
 
 template<typename ppT>
-mnt_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
-    mnt_e_times_e_times_e_over_e_miller_loop_gadget(
-        libsnark::protoboard<FieldT> &pb,
-        const libsnark::G1_precomputation<ppT> &prec_P1,
-        const libsnark::G2_precomputation<ppT> &prec_Q1,
-        const libsnark::G1_precomputation<ppT> &prec_P2,
-        const libsnark::G2_precomputation<ppT> &prec_Q2,
-        const libsnark::G1_precomputation<ppT> &prec_P3,
-        const libsnark::G2_precomputation<ppT> &prec_Q3,
-        const libsnark::G1_precomputation<ppT> &prec_P4,
-        const libsnark::G2_precomputation<ppT> &prec_Q4,
-        const Fqk_variable<ppT> &result,
-        const std::string &annotation_prefix)
+mnt_multi_miller_loop_gadget<ppT>::mnt_multi_miller_loop_gadget(
+    libsnark::protoboard<FieldT> &pb,
+    const std::vector<libsnark::G1_precomputation<ppT>> &prec_Ps,
+    const std::vector<libsnark::G2_precomputation<ppT>> &prec_Qs,
+    const std::vector<bool> &inverted,
+    const Fqk_variable<ppT> &result,
+    const std::string &annotation_prefix)
     : libsnark::gadget<FieldT>(pb, annotation_prefix)
-    , prec_P1(prec_P1)
-    , prec_Q1(prec_Q1)
-    , prec_P2(prec_P2)
-    , prec_Q2(prec_Q2)
-    , prec_P3(prec_P3)
-    , prec_Q3(prec_Q3)
-    , prec_P4(prec_P4)
-    , prec_Q4(prec_Q4)
+    , prec_Ps(prec_Ps)
+    , prec_Qs(prec_Qs)
+    , inverted(inverted)
     , result(result)
 {
+    const size_t num_pairs = prec_Ps.size();
+    assert(num_pairs > 0);
+    assert(prec_Qs.size() == num_pairs);
+    assert(inverted.size() == num_pairs);
+
     const auto &loop_count = pairing_selector<ppT>::pairing_loop_count;
 
     f_count = add_count = dbl_count = 0;
@@ -50,47 +47,40 @@ mnt_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
             continue;
         }
 
+        // One squaring, and one multiplication per pair
         ++dbl_count;
-        f_count += 5;
+        f_count += 1 + num_pairs;
 
         if (NAF[i] != 0) {
             ++add_count;
-            f_count += 4;
+            f_count += num_pairs;
         }
     }
 
     fs.resize(f_count);
-    doubling_steps1.resize(dbl_count);
-    addition_steps1.resize(add_count);
-    doubling_steps2.resize(dbl_count);
-    addition_steps2.resize(add_count);
-    doubling_steps3.resize(dbl_count);
-    addition_steps3.resize(add_count);
-    doubling_steps4.resize(dbl_count);
-    addition_steps4.resize(add_count);
-    g_RR_at_P1s.resize(dbl_count);
-    g_RQ_at_P1s.resize(add_count);
-    g_RR_at_P2s.resize(dbl_count);
-    g_RQ_at_P2s.resize(add_count);
-    g_RR_at_P3s.resize(dbl_count);
-    g_RQ_at_P3s.resize(add_count);
-    g_RR_at_P4s.resize(dbl_count);
-    g_RQ_at_P4s.resize(add_count);
-
     for (size_t i = 0; i < f_count; ++i) {
         fs[i].reset(
             new Fqk_variable<ppT>(pb, FMT(annotation_prefix, " fs_%zu", i)));
     }
 
+    // The line evaluation gadgets hold references to the entries of
+    // `g_RR_at_Ps` and `g_RQ_at_Ps`, which must therefore not be resized
+    // once the steps are created.
+    g_RR_at_Ps.resize(num_pairs);
+    g_RQ_at_Ps.resize(num_pairs);
+    doubling_steps.resize(num_pairs);
+    addition_steps.resize(num_pairs);
+    dbl_muls.resize(num_pairs);
+    add_muls.resize(num_pairs);
+    for (size_t j = 0; j < num_pairs; ++j) {
+        g_RR_at_Ps[j].resize(dbl_count);
+        g_RQ_at_Ps[j].resize(add_count);
+        doubling_steps[j].resize(dbl_count);
+        addition_steps[j].resize(add_count);
+        dbl_muls[j].resize(dbl_count);
+        add_muls[j].resize(add_count);
+    }
     dbl_sqrs.resize(dbl_count);
-    dbl_muls1.resize(dbl_count);
-    add_muls1.resize(add_count);
-    dbl_muls2.resize(dbl_count);
-    add_muls2.resize(add_count);
-    dbl_muls3.resize(dbl_count);
-    add_muls3.resize(add_count);
-    dbl_muls4.resize(dbl_count);
-    add_muls4.resize(add_count);
 
     size_t add_id = 0;
     size_t dbl_id = 0;
@@ -105,34 +95,18 @@ mnt_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
             continue;
         }
 
-        doubling_steps1[dbl_id].reset(
-            new libsnark::mnt_miller_loop_dbl_line_eval<ppT>(
-                pb,
-                prec_P1,
-                *prec_Q1.coeffs[prec_id],
-                g_RR_at_P1s[dbl_id],
-                FMT(annotation_prefix, " doubling_steps1_%zu", dbl_id)));
-        doubling_steps2[dbl_id].reset(
-            new libsnark::mnt_miller_loop_dbl_line_eval<ppT>(
-                pb,
-                prec_P2,
-                *prec_Q2.coeffs[prec_id],
-                g_RR_at_P2s[dbl_id],
-                FMT(annotation_prefix, " doubling_steps2_%zu", dbl_id)));
-        doubling_steps3[dbl_id].reset(
-            new libsnark::mnt_miller_loop_dbl_line_eval<ppT>(
-                pb,
-                prec_P3,
-                *prec_Q3.coeffs[prec_id],
-                g_RR_at_P3s[dbl_id],
-                FMT(annotation_prefix, " doubling_steps3_%zu", dbl_id)));
-        doubling_steps4[dbl_id].reset(
-            new libsnark::mnt_miller_loop_dbl_line_eval<ppT>(
-                pb,
-                prec_P4,
-                *prec_Q4.coeffs[prec_id],
-                g_RR_at_P4s[dbl_id],
-                FMT(annotation_prefix, " doubling_steps4_%zu", dbl_id)));
+        for (size_t j = 0; j < num_pairs; ++j) {
+            doubling_steps[j][dbl_id].reset(
+                new libsnark::mnt_miller_loop_dbl_line_eval<ppT>(
+                    pb,
+                    prec_Ps[j],
+                    *prec_Qs[j].coeffs[prec_id],
+                    g_RR_at_Ps[j][dbl_id],
+                    FMT(annotation_prefix,
+                        " doubling_steps_%zu_%zu",
+                        j,
+                        dbl_id)));
+        }
         ++prec_id;
 
         dbl_sqrs[dbl_id].reset(new Fqk_sqr_gadget<ppT>(
@@ -141,141 +115,78 @@ mnt_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
             *fs[f_id + 1],
             FMT(annotation_prefix, " dbl_sqrs_%zu", dbl_id)));
         ++f_id;
-        dbl_muls1[dbl_id].reset(new Fqk_special_mul_gadget<ppT>(
-            pb,
-            *fs[f_id],
-            *g_RR_at_P1s[dbl_id],
-            *fs[f_id + 1],
-            FMT(annotation_prefix, " dbl_muls1_%zu", dbl_id)));
-        ++f_id;
-        dbl_muls2[dbl_id].reset(new Fqk_special_mul_gadget<ppT>(
-            pb,
-            *fs[f_id],
-            *g_RR_at_P2s[dbl_id],
-            *fs[f_id + 1],
-            FMT(annotation_prefix, " dbl_muls2_%zu", dbl_id)));
-        ++f_id;
-        dbl_muls3[dbl_id].reset(new Fqk_special_mul_gadget<ppT>(
-            pb,
-            *fs[f_id],
-            *g_RR_at_P3s[dbl_id],
-            *fs[f_id + 1],
-            FMT(annotation_prefix, " dbl_muls3_%zu", dbl_id)));
-        ++f_id;
-        dbl_muls4[dbl_id].reset(new Fqk_special_mul_gadget<ppT>(
-            pb,
-            (f_id + 1 == f_count ? result : *fs[f_id + 1]),
-            *g_RR_at_P4s[dbl_id],
-            *fs[f_id],
-            FMT(annotation_prefix, " dbl_muls4_%zu", dbl_id)));
-        ++f_id;
+        for (size_t j = 0; j < num_pairs; ++j) {
+            dbl_muls[j][dbl_id].reset(create_mul(
+                j,
+                f_id,
+                *g_RR_at_Ps[j][dbl_id],
+                FMT(annotation_prefix, " dbl_muls_%zu_%zu", j, dbl_id)));
+            ++f_id;
+        }
         ++dbl_id;
 
         if (NAF[i] != 0) {
-            addition_steps1[add_id].reset(
-                new libsnark::mnt_miller_loop_add_line_eval<ppT>(
-                    pb,
-                    NAF[i] < 0,
-                    prec_P1,
-                    *prec_Q1.coeffs[prec_id],
-                    *prec_Q1.Q,
-                    g_RQ_at_P1s[add_id],
-                    FMT(annotation_prefix, " addition_steps1_%zu", add_id)));
-            addition_steps2[add_id].reset(
-                new libsnark::mnt_miller_loop_add_line_eval<ppT>(
-                    pb,
-                    NAF[i] < 0,
-                    prec_P2,
-                    *prec_Q2.coeffs[prec_id],
-                    *prec_Q2.Q,
-                    g_RQ_at_P2s[add_id],
-                    FMT(annotation_prefix, " addition_steps2_%zu", add_id)));
-            addition_steps3[add_id].reset(
-                new libsnark::mnt_miller_loop_add_line_eval<ppT>(
-                    pb,
-                    NAF[i] < 0,
-                    prec_P3,
-                    *prec_Q3.coeffs[prec_id],
-                    *prec_Q3.Q,
-                    g_RQ_at_P3s[add_id],
-                    FMT(annotation_prefix, " addition_steps3_%zu", add_id)));
-            addition_steps4[add_id].reset(
-                new libsnark::mnt_miller_loop_add_line_eval<ppT>(
-                    pb,
-                    NAF[i] < 0,
-                    prec_P4,
-                    *prec_Q4.coeffs[prec_id],
-                    *prec_Q4.Q,
-                    g_RQ_at_P4s[add_id],
-                    FMT(annotation_prefix, " addition_steps4_%zu", add_id)));
+            for (size_t j = 0; j < num_pairs; ++j) {
+                addition_steps[j][add_id].reset(
+                    new libsnark::mnt_miller_loop_add_line_eval<ppT>(
+                        pb,
+                        NAF[i] < 0,
+                        prec_Ps[j],
+                        *prec_Qs[j].coeffs[prec_id],
+                        *prec_Qs[j].Q,
+                        g_RQ_at_Ps[j][add_id],
+                        FMT(annotation_prefix,
+                            " addition_steps_%zu_%zu",
+                            j,
+                            add_id)));
+            }
             ++prec_id;
-            add_muls1[add_id].reset(new libsnark::Fqk_special_mul_gadget<ppT>(
-                pb,
-                *fs[f_id],
-                *g_RQ_at_P1s[add_id],
-                *fs[f_id + 1],
-                FMT(annotation_prefix, " add_muls1_%zu", add_id)));
-            ++f_id;
-            add_muls2[add_id].reset(new libsnark::Fqk_special_mul_gadget<ppT>(
-                pb,
-                *fs[f_id],
-                *g_RQ_at_P2s[add_id],
-                *fs[f_id + 1],
-                FMT(annotation_prefix, " add_muls2_%zu", add_id)));
-            ++f_id;
-            add_muls3[add_id].reset(new libsnark::Fqk_special_mul_gadget<ppT>(
-                pb,
-                *fs[f_id],
-                *g_RQ_at_P3s[add_id],
-                *fs[f_id + 1],
-                FMT(annotation_prefix, " add_muls3_%zu", add_id)));
-            ++f_id;
-            add_muls4[add_id].reset(new libsnark::Fqk_special_mul_gadget<ppT>(
-                pb,
-                (f_id + 1 == f_count ? result : *fs[f_id + 1]),
-                *g_RQ_at_P4s[add_id],
-                *fs[f_id],
-                FMT(annotation_prefix, " add_muls4_%zu", add_id)));
-            ++f_id;
+
+            for (size_t j = 0; j < num_pairs; ++j) {
+                add_muls[j][add_id].reset(create_mul(
+                    j,
+                    f_id,
+                    *g_RQ_at_Ps[j][add_id],
+                    FMT(annotation_prefix, " add_muls_%zu_%zu", j, add_id)));
+                ++f_id;
+            }
             ++add_id;
         }
     }
 }
 
 template<typename ppT>
-void mnt_e_times_e_times_e_over_e_miller_loop_gadget<
-    ppT>::generate_r1cs_constraints()
+void mnt_multi_miller_loop_gadget<ppT>::generate_r1cs_constraints()
 {
+    const size_t num_pairs = prec_Ps.size();
+
     fs[0]->generate_r1cs_equals_const_constraints(FqkT::one());
 
     for (size_t i = 0; i < dbl_count; ++i) {
-        doubling_steps1[i]->generate_r1cs_constraints();
-        doubling_steps2[i]->generate_r1cs_constraints();
-        doubling_steps3[i]->generate_r1cs_constraints();
-        doubling_steps4[i]->generate_r1cs_constraints();
+        for (size_t j = 0; j < num_pairs; ++j) {
+            doubling_steps[j][i]->generate_r1cs_constraints();
+        }
         dbl_sqrs[i]->generate_r1cs_constraints();
-        dbl_muls1[i]->generate_r1cs_constraints();
-        dbl_muls2[i]->generate_r1cs_constraints();
-        dbl_muls3[i]->generate_r1cs_constraints();
-        dbl_muls4[i]->generate_r1cs_constraints();
+        for (size_t j = 0; j < num_pairs; ++j) {
+            dbl_muls[j][i]->generate_r1cs_constraints();
+        }
     }
 
     for (size_t i = 0; i < add_count; ++i) {
-        addition_steps1[i]->generate_r1cs_constraints();
-        addition_steps2[i]->generate_r1cs_constraints();
-        addition_steps3[i]->generate_r1cs_constraints();
-        addition_steps4[i]->generate_r1cs_constraints();
-        add_muls1[i]->generate_r1cs_constraints();
-        add_muls2[i]->generate_r1cs_constraints();
-        add_muls3[i]->generate_r1cs_constraints();
-        add_muls4[i]->generate_r1cs_constraints();
+        for (size_t j = 0; j < num_pairs; ++j) {
+            addition_steps[j][i]->generate_r1cs_constraints();
+        }
+        for (size_t j = 0; j < num_pairs; ++j) {
+            add_muls[j][i]->generate_r1cs_constraints();
+        }
     }
 }
 
 template<typename ppT>
-void mnt_e_times_e_times_e_over_e_miller_loop_gadget<
-    ppT>::generate_r1cs_witness()
+void mnt_multi_miller_loop_gadget<ppT>::generate_r1cs_witness()
 {
+    const size_t num_pairs = prec_Ps.size();
+
     fs[0]->generate_r1cs_witness(FqkT::one());
 
     size_t add_id = 0;
@@ -293,48 +204,93 @@ void mnt_e_times_e_times_e_over_e_miller_loop_gadget<
             continue;
         }
 
-        doubling_steps1[dbl_id]->generate_r1cs_witness();
-        doubling_steps2[dbl_id]->generate_r1cs_witness();
-        doubling_steps3[dbl_id]->generate_r1cs_witness();
-        doubling_steps4[dbl_id]->generate_r1cs_witness();
+        for (size_t j = 0; j < num_pairs; ++j) {
+            doubling_steps[j][dbl_id]->generate_r1cs_witness();
+        }
         dbl_sqrs[dbl_id]->generate_r1cs_witness();
         ++f_id;
-        dbl_muls1[dbl_id]->generate_r1cs_witness();
-        ++f_id;
-        dbl_muls2[dbl_id]->generate_r1cs_witness();
-        ++f_id;
-        dbl_muls3[dbl_id]->generate_r1cs_witness();
-        ++f_id;
-        (f_id + 1 == f_count ? result : *fs[f_id + 1])
-            .generate_r1cs_witness(
-                fs[f_id]->get_element() *
-                g_RR_at_P4s[dbl_id]->get_element().inverse());
-        dbl_muls4[dbl_id]->generate_r1cs_witness();
-        ++f_id;
+        for (size_t j = 0; j < num_pairs; ++j) {
+            generate_mul_witness(
+                j, f_id, *g_RR_at_Ps[j][dbl_id], *dbl_muls[j][dbl_id]);
+            ++f_id;
+        }
         ++dbl_id;
 
         if (NAF[i] != 0) {
-            addition_steps1[add_id]->generate_r1cs_witness();
-            addition_steps2[add_id]->generate_r1cs_witness();
-            addition_steps3[add_id]->generate_r1cs_witness();
-            addition_steps4[add_id]->generate_r1cs_witness();
-            add_muls1[add_id]->generate_r1cs_witness();
-            ++f_id;
-            add_muls2[add_id]->generate_r1cs_witness();
-            ++f_id;
-            add_muls3[add_id]->generate_r1cs_witness();
-            ++f_id;
-            (f_id + 1 == f_count ? result : *fs[f_id + 1])
-                .generate_r1cs_witness(
-                    fs[f_id]->get_element() *
-                    g_RQ_at_P4s[add_id]->get_element().inverse());
-            add_muls4[add_id]->generate_r1cs_witness();
-            ++f_id;
+            for (size_t j = 0; j < num_pairs; ++j) {
+                addition_steps[j][add_id]->generate_r1cs_witness();
+            }
+            for (size_t j = 0; j < num_pairs; ++j) {
+                generate_mul_witness(
+                    j, f_id, *g_RQ_at_Ps[j][add_id], *add_muls[j][add_id]);
+                ++f_id;
+            }
             ++add_id;
         }
     }
 }
 
+template<typename ppT>
+Fqk_variable<ppT> &mnt_multi_miller_loop_gadget<ppT>::f_variable(size_t i)
+{
+    return (i == f_count) ? result : *fs[i];
+}
+
+template<typename ppT>
+Fqk_special_mul_gadget<ppT> *mnt_multi_miller_loop_gadget<ppT>::create_mul(
+    size_t pair_id,
+    size_t f_id,
+    const Fqk_variable<ppT> &g,
+    const std::string &annotation)
+{
+    // For inverted pairs, the gadget checks f_{i+1} * g = f_i.
+    if (inverted[pair_id]) {
+        return new Fqk_special_mul_gadget<ppT>(
+            this->pb, f_variable(f_id + 1), g, *fs[f_id], annotation);
+    }
+
+    return new Fqk_special_mul_gadget<ppT>(
+        this->pb, *fs[f_id], g, f_variable(f_id + 1), annotation);
+}
+
+template<typename ppT>
+void mnt_multi_miller_loop_gadget<ppT>::generate_mul_witness(
+    size_t pair_id,
+    size_t f_id,
+    const Fqk_variable<ppT> &g,
+    Fqk_special_mul_gadget<ppT> &mul)
+{
+    if (inverted[pair_id]) {
+        f_variable(f_id + 1).generate_r1cs_witness(
+            fs[f_id]->get_element() * g.get_element().inverse());
+    }
+    mul.generate_r1cs_witness();
+}
+
+template<typename ppT>
+mnt_e_times_e_times_e_over_e_miller_loop_gadget<ppT>::
+    mnt_e_times_e_times_e_over_e_miller_loop_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const libsnark::G1_precomputation<ppT> &prec_P1,
+        const libsnark::G2_precomputation<ppT> &prec_Q1,
+        const libsnark::G1_precomputation<ppT> &prec_P2,
+        const libsnark::G2_precomputation<ppT> &prec_Q2,
+        const libsnark::G1_precomputation<ppT> &prec_P3,
+        const libsnark::G2_precomputation<ppT> &prec_Q3,
+        const libsnark::G1_precomputation<ppT> &prec_P4,
+        const libsnark::G2_precomputation<ppT> &prec_Q4,
+        const Fqk_variable<ppT> &result,
+        const std::string &annotation_prefix)
+    : mnt_multi_miller_loop_gadget<ppT>(
+          pb,
+          {prec_P1, prec_P2, prec_P3, prec_P4},
+          {prec_Q1, prec_Q2, prec_Q3, prec_Q4},
+          {false, false, false, true},
+          result,
+          annotation_prefix)
+{
+}
+
 template<typename ppT>
 bool test_mnt_e_times_e_times_e_over_e_miller_loop(
     const std::string &annotation)
@@ -489,11 +445,9 @@ bool test_mnt_e_times_e_times_e_over_e_miller_loop(
              native_prec_P4, native_prec_Q4)
              .inverse());
 
-    printf(
-        "number of constraints for e times e times e over e Miller loop (Fr is "
-        "%s)  = %zu\n",
-        annotation.c_str(),
-        pb.num_constraints());
+    log_stream(log_level::debug)
+        << "number of constraints for e times e times e over e Miller loop "
+        << "(Fr is " << annotation << ") = " << pb.num_constraints();
 
     return result.get_element() == native_result;
 }
@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CIRCUITS_VERIFICATION_KEY_HASH_TCC__
+#define __ZECALE_CIRCUITS_VERIFICATION_KEY_HASH_TCC__
+
+#include <libff/algebra/fields/field_utils.hpp>
+#include <libzeth/circuits/circuit_types.hpp>
+
+namespace libzecale
+{
+
+/// Computes the digest of a (nested) verification key variable, and
+/// constrains it to be equal to `result` (typically a primary input, which
+/// binds the aggregator proof to a known VK). The digest is a chain of MiMC
+/// compressions over the packed variables of the VK:
+///
+///   h_0 = H(vk_packed[0], 0), h_i = H(vk_packed[i], h_{i-1})
+template<typename FieldT, typename verification_key_variable_gadget>
+class verification_key_hash_gadget : libsnark::gadget<FieldT>
+{
+private:
+    using hash_gadget = libzeth::MiMC_mp_gadget<FieldT>;
+
+    const verification_key_variable_gadget &vk;
+    libsnark::pb_variable_array<FieldT> vk_packed;
+    std::vector<std::shared_ptr<hash_gadget>> hashers;
+    const libsnark::pb_variable<FieldT> result;
+
+public:
+    /// `zero` must be constrained to be 0 by the caller.
+    verification_key_hash_gadget(
+        libsnark::protoboard<FieldT> &pb,
+        const verification_key_variable_gadget &vk,
+        const libsnark::pb_variable<FieldT> &zero,
+        const libsnark::pb_variable<FieldT> &result,
+        const std::string &annotation_prefix = "verification_key_hash_gadget")
+        : libsnark::gadget<FieldT>(pb, annotation_prefix)
+        , vk(vk)
+        , result(result)
+    {
+        const size_t num_vk_packed = vk.all_vars.size();
+        vk_packed.allocate(
+            pb, num_vk_packed, FMT(this->annotation_prefix, " vk_packed"));
+        hashers.resize(num_vk_packed);
+        for (size_t i = 0; i < num_vk_packed; i++) {
+            const libsnark::pb_variable<FieldT> &chaining_value =
+                (i == 0) ? zero : hashers[i - 1]->result();
+            hashers[i].reset(new hash_gadget(
+                pb,
+                vk_packed[i],
+                chaining_value,
+                FMT(this->annotation_prefix, " hashers[%zu]", i)));
+        }
+    }
+
+    void generate_r1cs_constraints()
+    {
+        for (size_t i = 0; i < vk_packed.size(); i++) {
+            this->pb.add_r1cs_constraint(
+                libsnark::r1cs_constraint<FieldT>(
+                    1, vk.all_vars[i], vk_packed[i]),
+                FMT(this->annotation_prefix, " vk_packed[%zu]", i));
+            hashers[i]->generate_r1cs_constraints();
+        }
+        this->pb.add_r1cs_constraint(
+            libsnark::r1cs_constraint<FieldT>(
+                1, hashers.back()->result(), result),
+            FMT(this->annotation_prefix, " result"));
+    }
+
+    /// The VK must have been witnessed.
+    void generate_r1cs_witness()
+    {
+        for (size_t i = 0; i < vk_packed.size(); i++) {
+            vk.all_vars[i].evaluate(this->pb);
+            this->pb.val(vk_packed[i]) = this->pb.lc_val(vk.all_vars[i]);
+            hashers[i]->generate_r1cs_witness();
+        }
+        this->pb.val(result) = this->pb.val(hashers.back()->result());
+    }
+
+    /// Compute (natively) the digest of a VK given as bits (see
+    /// `verification_key_variable_gadget::get_verification_key_bits`).
+    static FieldT compute_hash(const libff::bit_vector &vk_bits)
+    {
+        // Pack in the same way as the `multipacking_gadget` of the VK
+        // variable gadget.
+        const std::vector<FieldT> packed =
+            libff::pack_bit_vector_into_field_element_vector<FieldT>(
+                vk_bits, FieldT::size_in_bits());
+        FieldT hash = FieldT::zero();
+        for (const FieldT &element : packed) {
+            hash = hash_gadget::get_hash(element, hash);
+        }
+        return hash;
+    }
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CIRCUITS_VERIFICATION_KEY_HASH_TCC__
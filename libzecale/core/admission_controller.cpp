@@ -0,0 +1,146 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/admission_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace libzecale
+{
+
+namespace
+{
+
+// Weight of the last observation in the moving average of the proving time.
+const double proving_time_smoothing = 0.2;
+
+} // namespace
+
+const char *admission_decision_name(admission_decision decision)
+{
+    switch (decision) {
+    case admission_decision::admit:
+        return "admit";
+    case admission_decision::fee_too_low:
+        return "fee-too-low";
+    case admission_decision::over_quota:
+        return "over-quota";
+    case admission_decision::overloaded:
+        return "overloaded";
+    }
+    return "unknown";
+}
+
+admission_result::admission_result()
+    : decision(admission_decision::admit)
+    , time_to_proof_seconds(0.0)
+    , retry_after_seconds(0.0)
+    , min_fee_wei(0)
+{
+}
+
+admission_controller::admission_controller(
+    const server_config &config, size_t batch_size, size_t num_prover_workers)
+    : _target_time_to_proof_seconds(config.target_time_to_proof_seconds)
+    , _congested_min_fee_wei(config.congested_min_fee_wei)
+    , _max_application_share(config.max_application_share)
+    , _max_time_to_proof_seconds(config.max_time_to_proof_seconds)
+    , _batch_size(std::max<size_t>(batch_size, 1))
+    , _num_prover_workers(std::max<size_t>(num_prover_workers, 1))
+    , _tx_seconds(0.0)
+{
+}
+
+void admission_controller::on_batch_proved(
+    size_t batch_capacity, double seconds)
+{
+    if (batch_capacity == 0 || seconds <= 0.0) {
+        return;
+    }
+    const double tx_seconds = seconds / (double)batch_capacity;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_tx_seconds == 0.0) {
+        _tx_seconds = tx_seconds;
+    } else {
+        _tx_seconds += proving_time_smoothing * (tx_seconds - _tx_seconds);
+    }
+}
+
+double admission_controller::estimate_time_to_proof(
+    size_t app_pending, size_t total_pending, size_t num_active_apps) const
+{
+    const double tx_seconds = this->tx_seconds();
+    if (tx_seconds == 0.0) {
+        return 0.0;
+    }
+
+    // Fair share of the prover, but no longer than the time to aggregate
+    // all the pending transactions.
+    return std::min(
+        proving_seconds(
+            app_pending + 1, std::max<size_t>(num_active_apps, 1), tx_seconds),
+        proving_seconds(
+            std::max(total_pending, app_pending) + 1, 1, tx_seconds));
+}
+
+admission_result admission_controller::admit(
+    size_t app_pending,
+    size_t total_pending,
+    size_t num_active_apps,
+    uint32_t fee_wei) const
+{
+    admission_result result;
+    result.time_to_proof_seconds =
+        estimate_time_to_proof(app_pending, total_pending, num_active_apps);
+    const double time = result.time_to_proof_seconds;
+
+    if (_max_time_to_proof_seconds != 0.0 &&
+        time > _max_time_to_proof_seconds) {
+        result.decision = admission_decision::overloaded;
+        result.retry_after_seconds = time - _max_time_to_proof_seconds;
+        return result;
+    }
+
+    if (_target_time_to_proof_seconds == 0.0 ||
+        time <= _target_time_to_proof_seconds) {
+        return result;
+    }
+
+    // Congested. The quota only applies if other applications are waiting
+    // for the prover.
+    const size_t quota = (size_t)std::floor(
+        _max_application_share * (double)(total_pending + 1));
+    if (num_active_apps > 1 && app_pending + 1 > quota) {
+        result.decision = admission_decision::over_quota;
+        result.retry_after_seconds = proving_seconds(
+            app_pending + 1 - quota, num_active_apps, tx_seconds());
+        return result;
+    }
+    if (fee_wei < _congested_min_fee_wei) {
+        result.decision = admission_decision::fee_too_low;
+        result.min_fee_wei = _congested_min_fee_wei;
+        result.retry_after_seconds = time - _target_time_to_proof_seconds;
+        return result;
+    }
+
+    return result;
+}
+
+double admission_controller::proving_seconds(
+    size_t num_txs, size_t num_active_apps, double tx_seconds) const
+{
+    // Batches are proved whole, `_num_prover_workers` at a time.
+    const size_t num_batches = (num_txs + _batch_size - 1) / _batch_size;
+    return (double)(num_batches * _batch_size * num_active_apps) * tx_seconds /
+           (double)_num_prover_workers;
+}
+
+double admission_controller::tx_seconds() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tx_seconds;
+}
+
+} // namespace libzecale
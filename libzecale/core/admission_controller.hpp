@@ -0,0 +1,109 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_ADMISSION_CONTROLLER_HPP__
+#define __ZECALE_CORE_ADMISSION_CONTROLLER_HPP__
+
+#include "libzecale/core/server_config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace libzecale
+{
+
+enum class admission_decision {
+    admit,
+    /// The prover is congested and the fee is below the minimum
+    fee_too_low,
+    /// The prover is congested and the application holds more than its
+    /// share of the pending transactions
+    over_quota,
+    /// The estimated time-to-proof exceeds the maximum
+    overloaded,
+};
+
+/// Name of the decision, for the logs ("admit", "fee-too-low", ...).
+const char *admission_decision_name(admission_decision decision);
+
+/// Outcome of the admission control for a transaction.
+class admission_result
+{
+public:
+    admission_decision decision;
+    /// Estimated time until the transaction is aggregated, in seconds (0 if
+    /// the proving throughput has not been measured yet)
+    double time_to_proof_seconds;
+    /// Estimated time after which the transaction would be admitted (if not
+    /// admitted)
+    double retry_after_seconds;
+    /// Minimum fee required while congested (if `fee_too_low`)
+    uint32_t min_fee_wei;
+
+    admission_result();
+};
+
+/// Admission control of the submitted transactions, based on the capacity of
+/// the prover. The time-to-proof of a transaction is estimated from:
+///
+/// - the number of batches ahead of it in the pool of its application,
+/// - the number of applications with pending transactions, assuming that
+///   the prover is shared equally between them (and bounded by the time to
+///   aggregate all pending transactions),
+/// - the measured proving time of a batch (moving average), and the number
+///   of batches proved concurrently.
+///
+/// The thresholds are set in `server_config`. Until a batch has been proved,
+/// the throughput is unknown and all transactions are admitted. Thread-safe.
+class admission_controller
+{
+public:
+    /// `batch_size` is the number of transactions aggregated by a proof, and
+    /// `num_prover_workers` the number of proofs generated concurrently.
+    admission_controller(
+        const server_config &config,
+        size_t batch_size,
+        size_t num_prover_workers);
+
+    /// Record the time taken to prove a batch of `batch_capacity`
+    /// transactions.
+    void on_batch_proved(size_t batch_capacity, double seconds);
+
+    /// Estimated time to aggregate a transaction submitted to a pool holding
+    /// `app_pending` transactions, while `total_pending` transactions are
+    /// pending in the `num_active_apps` pools holding transactions
+    /// (including this application).
+    double estimate_time_to_proof(
+        size_t app_pending, size_t total_pending, size_t num_active_apps) const;
+
+    /// Decide whether a transaction paying `fee_wei` is admitted (see
+    /// `estimate_time_to_proof` for the other arguments).
+    admission_result admit(
+        size_t app_pending,
+        size_t total_pending,
+        size_t num_active_apps,
+        uint32_t fee_wei) const;
+
+private:
+    double proving_seconds(
+        size_t num_txs, size_t num_active_apps, double tx_seconds) const;
+    double tx_seconds() const;
+
+    const double _target_time_to_proof_seconds;
+    const uint32_t _congested_min_fee_wei;
+    const double _max_application_share;
+    const double _max_time_to_proof_seconds;
+    const size_t _batch_size;
+    const size_t _num_prover_workers;
+
+    mutable std::mutex _mutex;
+    /// Moving average of the proving time per transaction slot of a batch
+    /// (0 until a batch has been proved)
+    double _tx_seconds;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_ADMISSION_CONTROLLER_HPP__
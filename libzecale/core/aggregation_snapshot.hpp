@@ -0,0 +1,88 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_AGGREGATION_SNAPSHOT_HPP__
+#define __ZECALE_CORE_AGGREGATION_SNAPSHOT_HPP__
+
+#include <array>
+#include <iostream>
+#include <libsnark/gadgetlib1/protoboard.hpp>
+#include <libzeth/core/extended_proof.hpp>
+#include <memory>
+
+namespace libzecale
+{
+
+/// Summary of the aggregation circuit, used to check that a snapshot is
+/// replayed against the circuit it has been taken for.
+class circuit_fingerprint
+{
+public:
+    size_t wrapping_field_bits;
+    size_t nested_field_bits;
+    size_t num_proofs;
+    size_t num_constraints;
+    size_t num_variables;
+    size_t num_inputs;
+
+    circuit_fingerprint();
+
+    template<typename nppT, typename wppT>
+    static circuit_fingerprint from_constraint_system(
+        const libsnark::protoboard<libff::Fr<wppT>> &pb, size_t num_proofs);
+
+    bool operator==(const circuit_fingerprint &other) const;
+    bool operator!=(const circuit_fingerprint &other) const;
+
+    void write(std::ostream &out) const;
+    void read(std::istream &in);
+    std::ostream &write_json(std::ostream &os) const;
+};
+
+/// The exact inputs of a call to `aggregator_circuit_wrapper::prove()`: the
+/// nested verification key and the batch of extended proofs. A snapshot is
+/// written in a compact binary format:
+///
+///   magic (8 bytes) | version | fingerprint | nested VK | NumProofs |
+///   NumProofs x (proof | primary inputs)
+///
+/// where integers are written as 64-bit host-endian values, and the VK, the
+/// proofs and the primary inputs use the libsnark / libff stream operators
+/// (binary when BINARY_OUTPUT is set). It allows a batch to
+/// be replayed, e.g. to reproduce a failure or profile the prover.
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+class aggregation_snapshot
+{
+public:
+    circuit_fingerprint fingerprint;
+    typename nsnarkT::verification_key nested_vk;
+    std::array<
+        std::shared_ptr<libzeth::extended_proof<nppT, nsnarkT>>,
+        NumProofs>
+        extended_proofs;
+
+    /// Pointers to the extended proofs, as expected by `prove()`
+    std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+    extended_proof_ptrs() const;
+
+    /// Write the snapshot of the given inputs of `prove()` (the proofs are
+    /// not copied).
+    static void write(
+        std::ostream &out,
+        const circuit_fingerprint &fingerprint,
+        const typename nsnarkT::verification_key &nested_vk,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs);
+
+    /// Read a snapshot. Throws if the stream does not contain a valid
+    /// snapshot for NumProofs proofs.
+    static aggregation_snapshot read(std::istream &in);
+};
+
+} // namespace libzecale
+
+#include "libzecale/core/aggregation_snapshot.tcc"
+
+#endif // __ZECALE_CORE_AGGREGATION_SNAPSHOT_HPP__
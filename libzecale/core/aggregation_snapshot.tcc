@@ -0,0 +1,186 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_AGGREGATION_SNAPSHOT_TCC__
+#define __ZECALE_CORE_AGGREGATION_SNAPSHOT_TCC__
+
+#include <cstring>
+#include <libff/common/serialization.hpp>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+namespace internal
+{
+
+static const char snapshot_magic[8] = {'Z', 'E', 'C', 'S', 'N', 'A', 'P', 0};
+static const uint32_t snapshot_version = 1;
+
+template<typename T> void snapshot_write_int(std::ostream &out, T value)
+{
+    const uint64_t v = (uint64_t)value;
+    out.write((const char *)&v, sizeof(v));
+}
+
+template<typename T> T snapshot_read_int(std::istream &in)
+{
+    uint64_t v;
+    in.read((char *)&v, sizeof(v));
+    if (!in.good()) {
+        throw std::runtime_error("truncated snapshot");
+    }
+    return (T)v;
+}
+
+} // namespace internal
+
+inline circuit_fingerprint::circuit_fingerprint()
+    : wrapping_field_bits(0)
+    , nested_field_bits(0)
+    , num_proofs(0)
+    , num_constraints(0)
+    , num_variables(0)
+    , num_inputs(0)
+{
+}
+
+template<typename nppT, typename wppT>
+circuit_fingerprint circuit_fingerprint::from_constraint_system(
+    const libsnark::protoboard<libff::Fr<wppT>> &pb, size_t num_proofs)
+{
+    circuit_fingerprint fingerprint;
+    fingerprint.wrapping_field_bits = libff::Fr<wppT>::num_bits;
+    fingerprint.nested_field_bits = libff::Fr<nppT>::num_bits;
+    fingerprint.num_proofs = num_proofs;
+    fingerprint.num_constraints = pb.num_constraints();
+    fingerprint.num_variables = pb.num_variables();
+    fingerprint.num_inputs = pb.num_inputs();
+    return fingerprint;
+}
+
+inline bool circuit_fingerprint::operator==(
+    const circuit_fingerprint &other) const
+{
+    return wrapping_field_bits == other.wrapping_field_bits &&
+           nested_field_bits == other.nested_field_bits &&
+           num_proofs == other.num_proofs &&
+           num_constraints == other.num_constraints &&
+           num_variables == other.num_variables &&
+           num_inputs == other.num_inputs;
+}
+
+inline bool circuit_fingerprint::operator!=(
+    const circuit_fingerprint &other) const
+{
+    return !(*this == other);
+}
+
+inline void circuit_fingerprint::write(std::ostream &out) const
+{
+    internal::snapshot_write_int(out, wrapping_field_bits);
+    internal::snapshot_write_int(out, nested_field_bits);
+    internal::snapshot_write_int(out, num_proofs);
+    internal::snapshot_write_int(out, num_constraints);
+    internal::snapshot_write_int(out, num_variables);
+    internal::snapshot_write_int(out, num_inputs);
+}
+
+inline void circuit_fingerprint::read(std::istream &in)
+{
+    wrapping_field_bits = internal::snapshot_read_int<size_t>(in);
+    nested_field_bits = internal::snapshot_read_int<size_t>(in);
+    num_proofs = internal::snapshot_read_int<size_t>(in);
+    num_constraints = internal::snapshot_read_int<size_t>(in);
+    num_variables = internal::snapshot_read_int<size_t>(in);
+    num_inputs = internal::snapshot_read_int<size_t>(in);
+}
+
+inline std::ostream &circuit_fingerprint::write_json(std::ostream &os) const
+{
+    os << "{\n"
+       << "\t\"wrapping_field_bits\": " << wrapping_field_bits << ",\n"
+       << "\t\"nested_field_bits\": " << nested_field_bits << ",\n"
+       << "\t\"num_proofs\": " << num_proofs << ",\n"
+       << "\t\"num_constraints\": " << num_constraints << ",\n"
+       << "\t\"num_variables\": " << num_variables << ",\n"
+       << "\t\"num_inputs\": " << num_inputs << "\n"
+       << "}\n";
+    return os;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+aggregation_snapshot<nppT, nsnarkT, NumProofs>::extended_proof_ptrs() const
+{
+    std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+        ptrs;
+    for (size_t i = 0; i < NumProofs; ++i) {
+        ptrs[i] = extended_proofs[i].get();
+    }
+    return ptrs;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+void aggregation_snapshot<nppT, nsnarkT, NumProofs>::write(
+    std::ostream &out,
+    const circuit_fingerprint &fingerprint,
+    const typename nsnarkT::verification_key &nested_vk,
+    const std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+        &extended_proofs)
+{
+    out.write(internal::snapshot_magic, sizeof(internal::snapshot_magic));
+    internal::snapshot_write_int(out, internal::snapshot_version);
+    fingerprint.write(out);
+    out << nested_vk;
+    internal::snapshot_write_int(out, NumProofs);
+    for (const libzeth::extended_proof<nppT, nsnarkT> *ext_proof :
+         extended_proofs) {
+        out << ext_proof->get_proof();
+        out << ext_proof->get_primary_inputs();
+    }
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+aggregation_snapshot<nppT, nsnarkT, NumProofs> aggregation_snapshot<
+    nppT,
+    nsnarkT,
+    NumProofs>::read(std::istream &in)
+{
+    char magic[sizeof(internal::snapshot_magic)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || memcmp(magic, internal::snapshot_magic, sizeof(magic))) {
+        throw std::runtime_error("invalid snapshot");
+    }
+    if (internal::snapshot_read_int<uint32_t>(in) !=
+        internal::snapshot_version) {
+        throw std::runtime_error("unsupported snapshot version");
+    }
+
+    aggregation_snapshot snapshot;
+    snapshot.fingerprint.read(in);
+    in >> snapshot.nested_vk;
+    if (internal::snapshot_read_int<size_t>(in) != NumProofs) {
+        throw std::runtime_error("invalid number of proofs in snapshot");
+    }
+
+    for (size_t i = 0; i < NumProofs; ++i) {
+        typename nsnarkT::proof proof;
+        libsnark::r1cs_primary_input<libff::Fr<nppT>> primary_inputs;
+        in >> proof;
+        in >> primary_inputs;
+        if (!in.good()) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        snapshot.extended_proofs[i] =
+            std::make_shared<libzeth::extended_proof<nppT, nsnarkT>>(
+                std::move(proof), std::move(primary_inputs));
+    }
+
+    return snapshot;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_AGGREGATION_SNAPSHOT_TCC__
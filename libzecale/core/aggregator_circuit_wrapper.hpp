@@ -6,6 +6,9 @@
 #define __ZECALE_CORE_AGGREGATOR_CIRCUIT_WRAPPER_HPP__
 
 #include "libzecale/circuits/aggregator.tcc"
+#include "libzecale/core/logger.hpp"
+#include "libzecale/core/prove_timings.hpp"
+#include "libzecale/core/satisfiability_check.hpp"
 
 #include <libzeth/core/extended_proof.hpp>
 
@@ -14,6 +17,18 @@ using namespace libzeth;
 namespace libzecale
 {
 
+/// Data derived from a nested verification key. It does not depend on the
+/// batch of proofs being aggregated, and can therefore be computed once per
+/// registered application, rather than for every batch.
+template<typename wppT> class processed_nested_verification_key
+{
+public:
+    /// Bit representation of the VK, as used to witness the circuit
+    libff::bit_vector bits;
+    /// Digest of the VK, i.e. the first primary input of the aggregator proof
+    libff::Fr<wppT> hash;
+};
+
 template<
     typename nppT,
     typename wppT,
@@ -29,19 +44,66 @@ private:
         aggregator_gadget<nppT, wppT, nsnarkT, wverifierT, NumProofs>>
         aggregator_g;
 
+    // Batches whose witness is checked before proving
+    std::shared_ptr<satisfiability_check_policy> check_policy;
+
 public:
-    aggregator_circuit_wrapper(){};
+    aggregator_circuit_wrapper()
+        : check_policy(std::make_shared<satisfiability_check_policy>())
+    {
+    }
+
+    /// Set the batches whose witness is checked (by default, all of them).
+    /// The policy may be shared with other wrappers.
+    void set_satisfiability_check_policy(
+        std::shared_ptr<satisfiability_check_policy> policy)
+    {
+        this->check_policy = policy;
+    }
 
     typename wsnark::keypair generate_trusted_setup() const;
     libsnark::protoboard<libff::Fr<wppT>> get_constraint_system() const;
 
-    /// Generate a proof and returns an extended proof
+    /// Compute the data required to aggregate proofs for the given nested
+    /// verification key.
+    processed_nested_verification_key<wppT> process_nested_verification_key(
+        const typename nsnarkT::verification_key &nested_vk) const;
+
+    /// Generate a proof and returns an extended proof. The nested proofs are
+    /// passed by pointer so that callers can hand over the proofs held by
+    /// the batch without copying them. If `timings` is not null, it receives
+    /// the time spent in each phase.
     extended_proof<wppT, wsnark> prove(
-        typename nsnarkT::verification_key nested_vk,
+        const typename nsnarkT::verification_key &nested_vk,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings = nullptr) const;
+
+    /// Same as above, using the output of `process_nested_verification_key`.
+    /// Throws `std::invalid_argument` if the digest of `nested_vk` does not
+    /// match its bits.
+    extended_proof<wppT, wsnark> prove(
+        const processed_nested_verification_key<wppT> &nested_vk,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings = nullptr) const;
+
+private:
+    /// Common implementation of the `prove` functions, from the bits of the
+    /// nested VK. If `expected_vk_hash` is not null, the digest of the VK
+    /// computed by the circuit must be equal to it.
+    extended_proof<wppT, wsnark> prove_with_vk_bits(
+        const libff::bit_vector &nested_vk_bits,
+        const libff::Fr<wppT> *expected_vk_hash,
         const std::array<
             const libzeth::extended_proof<nppT, nsnarkT> *,
             NumProofs> &extended_proofs,
-        const typename wsnark::proving_key &aggregator_proving_key) const;
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const;
 };
 
 } // namespace libzecale
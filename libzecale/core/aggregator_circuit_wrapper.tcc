@@ -6,6 +6,7 @@
 #define __ZECALE_CORE_AGGREGATOR_CIRCUIT_WRAPPER_TCC__
 
 #include <libzeth/zeth_constants.hpp>
+#include <stdexcept>
 
 using namespace libzeth;
 
@@ -54,6 +55,30 @@ libsnark::protoboard<libff::Fr<wppT>> aggregator_circuit_wrapper<
     return pb;
 }
 
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs>
+processed_nested_verification_key<wppT> aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs>::
+    process_nested_verification_key(
+        const typename nsnarkT::verification_key &nested_vk) const
+{
+    using gadget =
+        aggregator_gadget<nppT, wppT, nsnarkT, wverifierT, NumProofs>;
+
+    processed_nested_verification_key<wppT> processed_vk;
+    processed_vk.bits = gadget::get_nested_vk_bits(nested_vk);
+    processed_vk.hash = gadget::compute_nested_vk_hash(processed_vk.bits);
+    return processed_vk;
+}
+
 template<
     typename nppT,
     typename wppT,
@@ -67,37 +92,111 @@ libzeth::extended_proof<wppT, typename wverifierT::snark> aggregator_circuit_wra
     wverifierT,
     NumProofs>::
     prove(
-        typename nsnarkT::verification_key nested_vk,
+        const typename nsnarkT::verification_key &nested_vk,
         const std::array<
             const libzeth::extended_proof<nppT, nsnarkT> *,
             NumProofs> &extended_proofs,
-        const typename wsnark::proving_key &aggregator_proving_key) const
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const
 {
-    libsnark::protoboard<libff::Fr<wppT>> pb;
+    using gadget =
+        aggregator_gadget<nppT, wppT, nsnarkT, wverifierT, NumProofs>;
 
-    aggregator_gadget<nppT, wppT, nsnarkT, wverifierT, NumProofs> g(pb);
-    g.generate_r1cs_constraints();
     // We pass to the witness generation function the elements defined
     // over the "other curve". See:
     // https://github.com/scipr-lab/libsnark/blob/master/libsnark/gadgetlib1/gadgets/verifiers/r1cs_ppzksnark_verifier_gadget.hpp#L98
-    g.generate_r1cs_witness(nested_vk, extended_proofs);
+    return prove_with_vk_bits(
+        gadget::get_nested_vk_bits(nested_vk),
+        nullptr,
+        extended_proofs,
+        aggregator_proving_key,
+        timings);
+}
 
-    bool is_valid_witness = pb.is_satisfied();
-    std::cout << "*** [DEBUG] Satisfiability result: " << is_valid_witness
-              << " ***" << std::endl;
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs>
+libzeth::extended_proof<wppT, typename wverifierT::snark> aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs>::
+    prove(
+        const processed_nested_verification_key<wppT> &nested_vk,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const
+{
+    return prove_with_vk_bits(
+        nested_vk.bits,
+        &nested_vk.hash,
+        extended_proofs,
+        aggregator_proving_key,
+        timings);
+}
+
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs>
+libzeth::extended_proof<wppT, typename wverifierT::snark> aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs>::
+    prove_with_vk_bits(
+        const libff::bit_vector &nested_vk_bits,
+        const libff::Fr<wppT> *expected_vk_hash,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const
+{
+    prove_phase_timer timer(timings);
+    libsnark::protoboard<libff::Fr<wppT>> pb;
+
+    aggregator_gadget<nppT, wppT, nsnarkT, wverifierT, NumProofs> g(pb);
+    g.generate_r1cs_constraints();
+    timer.end_phase(&prove_timings::constraint_generation);
+
+    g.generate_r1cs_witness(nested_vk_bits, extended_proofs);
+    // The digest of the VK is the first primary input
+    if (expected_vk_hash != nullptr &&
+        pb.primary_input()[0] != *expected_vk_hash) {
+        throw std::invalid_argument(
+            "digest of the nested verification key does not match its bits");
+    }
+    timer.end_phase(&prove_timings::witness_generation);
+
+    check_witness(
+        *this->check_policy, pb, aggregator_proving_key.constraint_system);
+    timer.end_phase(&prove_timings::satisfiability_check);
 
     typename wsnark::proof proof =
         wsnark::generate_proof(pb, aggregator_proving_key);
+    timer.end_phase(&prove_timings::proof_generation);
     libsnark::r1cs_primary_input<libff::Fr<wppT>> primary_input =
         pb.primary_input();
+    timer.end_phase(&prove_timings::primary_input_extraction);
+    if (timings != nullptr) {
+        timings->num_constraints = pb.num_constraints();
+        timings->num_variables = pb.num_variables();
+    }
 
     // Instantiate an extended_proof from the proof we generated and the given
     // primary_input
-    libzeth::extended_proof<wppT, wsnark> ext_proof =
-        extended_proof<wppT, wsnark>(
-            std::move(proof), std::move(primary_input));
-
-    return ext_proof;
+    return libzeth::extended_proof<wppT, wsnark>(
+        std::move(proof), std::move(primary_input));
 }
 
 } // namespace libzecale
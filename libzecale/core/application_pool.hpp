@@ -8,7 +8,6 @@
 #include "transaction_to_aggregate.hpp"
 
 #include <libsnark/zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp>
-#include <queue>
 #include <vector>
 
 namespace libzecale
@@ -28,11 +27,11 @@ private:
     std::string _name;
     /// Verification key used to verify the nested proofs
     std::shared_ptr<typename nsnarkT::verification_key> _verification_key;
-    /// Pool of transactions to aggregate
-    std::priority_queue<
-        transaction_to_aggregate<nppT, nsnarkT>,
-        std::vector<transaction_to_aggregate<nppT, nsnarkT>>>
-        _tx_pool;
+    /// Pool of transactions to aggregate, maintained as a max-heap (on the
+    /// fee) using the std heap algorithms. We do not use std::priority_queue
+    /// since it only exposes a const reference to its top element, which
+    /// forces a copy of every transaction leaving the pool.
+    std::vector<transaction_to_aggregate<nppT, nsnarkT>> _tx_pool;
 
 public:
     application_pool() = default;
@@ -45,27 +44,76 @@ public:
     /// Function that returns the verification key associated with this
     /// application. This constitutes part of the witness of the aggregator
     /// circuit.
-    inline typename nsnarkT::verification_key verification_key() const
+    inline const typename nsnarkT::verification_key &verification_key() const
     {
         return *(this->_verification_key);
     };
 
+    /// Shared ownership of the verification key, which remains valid if the
+    /// pool is replaced (e.g. when the application is registered again).
+    inline std::shared_ptr<const typename nsnarkT::verification_key>
+    shared_verification_key() const
+    {
+        return this->_verification_key;
+    }
+
+    /// Whether the pool has a verification key (a default-constructed pool
+    /// has none).
+    inline bool has_verification_key() const
+    {
+        return this->_verification_key != nullptr;
+    }
+
     /// Function that returns the next batch of proofs to aggregate.
     /// This constitutes part of the witness of the aggregator circuit.
     ///
+    /// Transactions are moved out of the pool into the batch (no copy of the
+    /// nested proofs is made).
+    ///
     /// TODO: Harden this function to pad the batch with dummy inputs if there
     /// are less proofs in the queue than the batch size.
     std::array<transaction_to_aggregate<nppT, nsnarkT>, NumProofs> get_next_batch();
 
-    /// Returns the number of transactions in the _tx_pool
-    inline size_t tx_pool_size() { return this->_tx_pool.size(); }
+    /// Returns the highest fee transaction in the pool (or nullptr if the pool
+    /// is empty), without removing it.
+    inline const transaction_to_aggregate<nppT, nsnarkT> *top_tx() const
+    {
+        return this->_tx_pool.empty() ? nullptr : &this->_tx_pool.front();
+    }
 
-    /// Add transaction to the pool
-    inline void add_tx(transaction_to_aggregate<nppT, nsnarkT> tx)
+    /// Remove the highest fee transaction from the pool, and return it. The
+    /// pool must not be empty.
+    transaction_to_aggregate<nppT, nsnarkT> pop_tx();
+
+    /// Returns the lowest fee transaction in the pool (or nullptr if the pool
+    /// is empty), without removing it. Linear in the size of the pool.
+    const transaction_to_aggregate<nppT, nsnarkT> *lowest_fee_tx() const;
+
+    /// Remove the lowest fee transaction from the pool, and return it (e.g.
+    /// to make room for a higher fee transaction). The pool must not be
+    /// empty. Linear in the size of the pool.
+    transaction_to_aggregate<nppT, nsnarkT> pop_lowest_fee_tx();
+
+    /// The transactions of the pool, in no particular order (e.g. to persist
+    /// the pool).
+    inline const std::vector<transaction_to_aggregate<nppT, nsnarkT>> &
+    transactions() const
     {
-        this->_tx_pool.push(tx);
-        return;
+        return this->_tx_pool;
     }
+
+    /// Returns the number of transactions in the _tx_pool
+    inline size_t tx_pool_size() const { return this->_tx_pool.size(); }
+
+    /// Reserve space for `num_txs` transactions in the pool, so that
+    /// subsequent insertions do not reallocate the underlying storage.
+    inline void reserve(size_t num_txs) { this->_tx_pool.reserve(num_txs); }
+
+    /// Add transaction to the pool
+    void add_tx(const transaction_to_aggregate<nppT, nsnarkT> &tx);
+
+    /// Add transaction to the pool, taking ownership of it
+    void add_tx(transaction_to_aggregate<nppT, nsnarkT> &&tx);
 };
 
 } // namespace libzecale
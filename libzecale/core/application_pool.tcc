@@ -5,10 +5,11 @@
 #ifndef __ZECALE_CORE_APPLICATION_POOL_TCC__
 #define __ZECALE_CORE_APPLICATION_POOL_TCC__
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <libsnark/zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp>
 #include <libzeth/core/extended_proof.hpp>
-#include <queue>
 
 namespace libzecale
 {
@@ -29,19 +30,86 @@ std::array<transaction_to_aggregate<nppT, nsnarkT>, NumProofs> application_pool<
     NumProofs>::get_next_batch()
 {
     std::array<transaction_to_aggregate<nppT, nsnarkT>, NumProofs> batch;
-    if (this->_tx_pool.size() < NumProofs) {
-        for (size_t i = 0; i < this->_tx_pool.size(); i++) {
-            batch[i] = this->_tx_pool.top();
-            _tx_pool.pop();
-        }
-        return batch;
+    const size_t batch_size = std::min(this->_tx_pool.size(), NumProofs);
+    for (size_t i = 0; i < batch_size; i++) {
+        batch[i] = pop_tx();
     }
+    return batch;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+transaction_to_aggregate<nppT, nsnarkT> application_pool<
+    nppT,
+    nsnarkT,
+    NumProofs>::pop_tx()
+{
+    assert(!this->_tx_pool.empty());
+    // Move the highest fee transaction to the back of the vector, and then
+    // move it out of the pool.
+    std::pop_heap(this->_tx_pool.begin(), this->_tx_pool.end());
+    transaction_to_aggregate<nppT, nsnarkT> tx =
+        std::move(this->_tx_pool.back());
+    this->_tx_pool.pop_back();
+    return tx;
+}
 
-    for (size_t i = 0; i < NumProofs; i++) {
-        batch[i] = this->_tx_pool.top();
-        _tx_pool.pop();
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+const transaction_to_aggregate<nppT, nsnarkT> *application_pool<
+    nppT,
+    nsnarkT,
+    NumProofs>::lowest_fee_tx() const
+{
+    if (this->_tx_pool.empty()) {
+        return nullptr;
     }
-    return batch;
+
+    // In a max-heap, the minimum is one of the leaves, i.e. one of the
+    // elements of the second half of the vector.
+    return &*std::min_element(
+        this->_tx_pool.begin() + this->_tx_pool.size() / 2,
+        this->_tx_pool.end());
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+transaction_to_aggregate<nppT, nsnarkT> application_pool<
+    nppT,
+    nsnarkT,
+    NumProofs>::pop_lowest_fee_tx()
+{
+    assert(!this->_tx_pool.empty());
+    const size_t idx = lowest_fee_tx() - &this->_tx_pool.front();
+    transaction_to_aggregate<nppT, nsnarkT> tx =
+        std::move(this->_tx_pool[idx]);
+
+    // Replace the removed leaf by the last element. The prefix of the heap
+    // up to (and excluding) `idx` is still a heap, and the leaf has no
+    // children: sifting the element up restores the heap property.
+    const size_t last_idx = this->_tx_pool.size() - 1;
+    if (idx != last_idx) {
+        this->_tx_pool[idx] = std::move(this->_tx_pool[last_idx]);
+    }
+    this->_tx_pool.pop_back();
+    if (idx != last_idx) {
+        std::push_heap(
+            this->_tx_pool.begin(), this->_tx_pool.begin() + idx + 1);
+    }
+    return tx;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+void application_pool<nppT, nsnarkT, NumProofs>::add_tx(
+    const transaction_to_aggregate<nppT, nsnarkT> &tx)
+{
+    this->_tx_pool.push_back(tx);
+    std::push_heap(this->_tx_pool.begin(), this->_tx_pool.end());
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs>
+void application_pool<nppT, nsnarkT, NumProofs>::add_tx(
+    transaction_to_aggregate<nppT, nsnarkT> &&tx)
+{
+    this->_tx_pool.push_back(std::move(tx));
+    std::push_heap(this->_tx_pool.begin(), this->_tx_pool.end());
 }
 
 } // namespace libzecale
@@ -0,0 +1,296 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/logger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+namespace
+{
+
+// Interval at which the background thread polls the buffer when it is idle.
+// Producers never signal the thread, so that logging does not take a lock.
+const std::chrono::milliseconds flusher_poll_interval(10);
+
+// Size above which the formatted records are written out without waiting for
+// the buffer to be drained.
+const size_t flusher_max_pending_bytes = 64 * 1024;
+
+size_t round_up_to_power_of_2(size_t n)
+{
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+const char *log_level_name(log_level level)
+{
+    switch (level) {
+    case log_level::debug:
+        return "DEBUG";
+    case log_level::info:
+        return "INFO";
+    case log_level::warning:
+        return "WARNING";
+    case log_level::error:
+        return "ERROR";
+    }
+    return "UNKNOWN";
+}
+
+log_level log_level_from_string(const std::string &name)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) {
+        return (char)std::tolower((unsigned char)c);
+    });
+    if (lower == "debug") {
+        return log_level::debug;
+    }
+    if (lower == "info") {
+        return log_level::info;
+    }
+    if (lower == "warning") {
+        return log_level::warning;
+    }
+    if (lower == "error") {
+        return log_level::error;
+    }
+    throw std::invalid_argument("invalid log level: " + name);
+}
+
+log_fields::log_fields(
+    const std::string &application, uint64_t tx_id, uint64_t job_id)
+    : application(application), tx_id(tx_id), job_id(job_id)
+{
+}
+
+logger::logger(std::ostream &out, log_level level, size_t capacity)
+    : _out(out)
+    , _level(level)
+    , _slots(new slot[round_up_to_power_of_2(std::max<size_t>(capacity, 2))])
+    , _mask(round_up_to_power_of_2(std::max<size_t>(capacity, 2)) - 1)
+    , _push_pos(0)
+    , _pop_pos(0)
+    , _num_popped(0)
+    , _num_dropped(0)
+    , _num_dropped_reported(0)
+    , _stopping(false)
+{
+    for (size_t i = 0; i <= _mask; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _flusher = std::thread(&logger::flusher_loop, this);
+}
+
+logger::~logger()
+{
+    {
+        std::lock_guard<std::mutex> lock(_flusher_mutex);
+        _stopping = true;
+    }
+    _flusher_cv.notify_all();
+    _flusher.join();
+}
+
+void logger::log(log_level level, const log_fields &fields, std::string message)
+{
+    if (!enabled(level)) {
+        return;
+    }
+
+    record r;
+    r.level = level;
+    r.time = clock::now();
+    r.fields = fields;
+    r.message = std::move(message);
+    if (!try_push(std::move(r))) {
+        _num_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void logger::flush()
+{
+    const size_t target = _push_pos.load(std::memory_order_acquire);
+    while (_num_popped.load(std::memory_order_acquire) < target) {
+        _flusher_cv.notify_all();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+logger &logger::global()
+{
+    static logger global_logger(std::cout);
+    return global_logger;
+}
+
+bool logger::try_push(record &&r)
+{
+    size_t pos = _push_pos.load(std::memory_order_relaxed);
+    slot *s;
+    while (true) {
+        s = &_slots[pos & _mask];
+        const size_t sequence = s->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            // The slot is free: claim the position.
+            if (_push_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The slot still holds the record pushed one lap ago: full.
+            return false;
+        } else {
+            // Another producer claimed the position.
+            pos = _push_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    s->value = std::move(r);
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool logger::try_pop(record &r)
+{
+    slot &s = _slots[_pop_pos & _mask];
+    if (s.sequence.load(std::memory_order_acquire) != _pop_pos + 1) {
+        return false;
+    }
+
+    r = std::move(s.value);
+    // Make the slot available to the producers on the next lap.
+    s.sequence.store(_pop_pos + _mask + 1, std::memory_order_release);
+    ++_pop_pos;
+    return true;
+}
+
+void logger::write_record(const record &r, std::string &out) const
+{
+    const std::time_t seconds = clock::to_time_t(r.time);
+    const long millis =
+        (long)(std::chrono::duration_cast<std::chrono::milliseconds>(
+                   r.time.time_since_epoch())
+                   .count() %
+               1000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char time_str[32];
+    const size_t time_len =
+        std::strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%S", &utc);
+    char millis_str[8];
+    std::snprintf(millis_str, sizeof(millis_str), ".%03ldZ", millis);
+
+    out.append(time_str, time_len);
+    out += millis_str;
+    out += " [";
+    out += log_level_name(r.level);
+    out += "]";
+
+    const log_fields &fields = r.fields;
+    if (!fields.application.empty() || fields.tx_id != 0 ||
+        fields.job_id != 0) {
+        std::string separator;
+        out += " [";
+        if (!fields.application.empty()) {
+            out += "app=" + fields.application;
+            separator = " ";
+        }
+        if (fields.tx_id != 0) {
+            out += separator + "tx=" + std::to_string(fields.tx_id);
+            separator = " ";
+        }
+        if (fields.job_id != 0) {
+            out += separator + "job=" + std::to_string(fields.job_id);
+        }
+        out += "]";
+    }
+
+    out += " ";
+    out += r.message;
+    out += "\n";
+}
+
+void logger::flusher_loop()
+{
+    std::string pending;
+    record r;
+    while (true) {
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> lock(_flusher_mutex);
+            stopping = _stopping;
+        }
+
+        // Drain the buffer, writing the records in large chunks. The number
+        // of records popped is published once they have been written, for
+        // `flush()`.
+        size_t num_popped = 0;
+        while (try_pop(r)) {
+            write_record(r, pending);
+            ++num_popped;
+            if (pending.size() >= flusher_max_pending_bytes) {
+                _out.write(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+
+        const uint64_t num_dropped = _num_dropped.load();
+        if (num_dropped != _num_dropped_reported) {
+            record dropped;
+            dropped.level = log_level::warning;
+            dropped.time = clock::now();
+            dropped.message =
+                std::to_string(num_dropped - _num_dropped_reported) +
+                " log record(s) dropped (buffer full)";
+            write_record(dropped, pending);
+            _num_dropped_reported = num_dropped;
+        }
+
+        if (!pending.empty()) {
+            _out.write(pending.data(), pending.size());
+            _out.flush();
+            pending.clear();
+        }
+        if (num_popped != 0) {
+            _num_popped.fetch_add(num_popped, std::memory_order_release);
+            continue;
+        }
+
+        if (stopping) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(_flusher_mutex);
+        if (!_stopping) {
+            _flusher_cv.wait_for(lock, flusher_poll_interval);
+        }
+    }
+}
+
+log_stream::log_stream(log_level level, const log_fields &fields, logger &log)
+    : _logger(log), _level(level), _fields(fields), _enabled(log.enabled(level))
+{
+}
+
+log_stream::~log_stream()
+{
+    if (_enabled) {
+        _logger.log(_level, _fields, _message.str());
+    }
+}
+
+} // namespace libzecale
@@ -0,0 +1,174 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_LOGGER_HPP__
+#define __ZECALE_CORE_LOGGER_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libzecale
+{
+
+enum class log_level : int { debug = 0, info = 1, warning = 2, error = 3 };
+
+/// Name of the level as written in the log ("DEBUG", "INFO", ...).
+const char *log_level_name(log_level level);
+
+/// Parse a level name (case-insensitive, e.g. "debug"). Throws
+/// `std::invalid_argument` if the name is not recognised.
+log_level log_level_from_string(const std::string &name);
+
+/// Structured fields attached to a log record. Empty or zero fields are
+/// omitted from the output.
+class log_fields
+{
+public:
+    std::string application;
+    /// Identifier assigned to a transaction when it is received
+    uint64_t tx_id;
+    /// Identifier of a proving job
+    uint64_t job_id;
+
+    log_fields(
+        const std::string &application = "",
+        uint64_t tx_id = 0,
+        uint64_t job_id = 0);
+};
+
+/// Asynchronous leveled logger. Records are pushed into a bounded lock-free
+/// ring buffer (several producers, a single consumer) and written by a
+/// background thread, so that logging never blocks the caller on the output
+/// stream. Records are formatted as:
+///
+///   <UTC time> [<LEVEL>] [app=<name> tx=<id> job=<id>] <message>
+///
+/// When the buffer is full, records are dropped (and counted) rather than
+/// blocking the caller.
+class logger
+{
+public:
+    using clock = std::chrono::system_clock;
+
+    /// `capacity` is rounded up to a power of 2. The logger writes to `out`,
+    /// which must outlive it.
+    explicit logger(
+        std::ostream &out,
+        log_level level = log_level::info,
+        size_t capacity = 8192);
+    logger(const logger &) = delete;
+    logger &operator=(const logger &) = delete;
+
+    /// Writes the pending records and stops the background thread.
+    ~logger();
+
+    inline log_level level() const { return this->_level.load(); }
+    inline void set_level(log_level level) { this->_level.store(level); }
+
+    /// Callers can check this before building an expensive message.
+    inline bool enabled(log_level level) const
+    {
+        return (int)level >= (int)this->_level.load(std::memory_order_relaxed);
+    }
+
+    void log(log_level level, const log_fields &fields, std::string message);
+
+    /// Block until all records logged before the call have been written.
+    void flush();
+
+    /// Number of records dropped because the buffer was full.
+    inline uint64_t num_dropped() const { return this->_num_dropped.load(); }
+
+    /// Logger writing to stdout, used by the library and the server.
+    static logger &global();
+
+private:
+    class record
+    {
+    public:
+        log_level level;
+        clock::time_point time;
+        log_fields fields;
+        std::string message;
+    };
+
+    class slot
+    {
+    public:
+        std::atomic<size_t> sequence;
+        record value;
+    };
+
+    bool try_push(record &&r);
+    bool try_pop(record &r);
+    void write_record(const record &r, std::string &out) const;
+    void flusher_loop();
+
+    std::ostream &_out;
+    std::atomic<log_level> _level;
+
+    // Bounded MPSC queue: each slot holds the position at which it can next
+    // be written (`sequence == pos`) or read (`sequence == pos + 1`).
+    std::unique_ptr<slot[]> _slots;
+    const size_t _mask;
+    std::atomic<size_t> _push_pos;
+    size_t _pop_pos;
+    std::atomic<size_t> _num_popped;
+    std::atomic<uint64_t> _num_dropped;
+    uint64_t _num_dropped_reported;
+
+    std::mutex _flusher_mutex;
+    std::condition_variable _flusher_cv;
+    bool _stopping;
+    std::thread _flusher;
+};
+
+/// Accumulates a message with `operator<<` and logs it on destruction. The
+/// message is not formatted if the level is disabled. For example:
+///
+///   log_stream(log_level::info, log_fields(app_name)) << "batch of " << n;
+class log_stream
+{
+public:
+    log_stream(
+        log_level level,
+        const log_fields &fields = log_fields(),
+        logger &log = logger::global());
+    log_stream(const log_stream &) = delete;
+    log_stream &operator=(const log_stream &) = delete;
+    ~log_stream();
+
+    template<typename T> log_stream &operator<<(const T &value)
+    {
+        if (this->_enabled) {
+            this->_message << value;
+        }
+        return *this;
+    }
+
+    /// Stream used to build the message, e.g. to pass to `write_json`
+    /// functions. Only use it if `enabled()`.
+    inline std::ostream &stream() { return this->_message; }
+    inline bool enabled() const { return this->_enabled; }
+
+private:
+    logger &_logger;
+    const log_level _level;
+    const log_fields _fields;
+    const bool _enabled;
+    std::ostringstream _message;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_LOGGER_HPP__
@@ -0,0 +1,512 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/metrics.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace libzecale
+{
+
+namespace
+{
+
+const size_t num_latency_bounds = 24;
+
+std::string escape_label_value(const std::string &value)
+{
+    std::string escaped;
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void write_header(
+    std::ostream &out,
+    const std::string &name,
+    const std::string &type,
+    const std::string &help)
+{
+    out << "# HELP zecale_" << name << " " << help << "\n";
+    out << "# TYPE zecale_" << name << " " << type << "\n";
+}
+
+template<typename ValueT>
+void write_metric(
+    std::ostream &out,
+    const std::string &name,
+    const std::string &type,
+    const std::string &help,
+    ValueT value)
+{
+    write_header(out, name, type, help);
+    out << "zecale_" << name << " " << value << "\n";
+}
+
+/// Write one sample per application, for the value selected by `get`.
+template<typename GetValueT>
+void write_application_metric(
+    std::ostream &out,
+    const metrics_snapshot &snapshot,
+    const std::string &name,
+    const std::string &type,
+    const std::string &help,
+    const GetValueT &get)
+{
+    write_header(out, name, type, help);
+    for (const metrics_snapshot::application &app : snapshot.applications) {
+        out << "zecale_" << name << "{application=\""
+            << escape_label_value(app.name) << "\"} " << get(app) << "\n";
+    }
+}
+
+/// Write the samples of a histogram, with the labels `labels` (e.g.
+/// `phase="x"`, or empty for none).
+void write_histogram_samples(
+    std::ostream &out,
+    const std::string &name,
+    const std::string &labels,
+    const histogram &h)
+{
+    const std::string bucket_labels = labels.empty() ? "" : labels + ",";
+    const std::string label_set = labels.empty() ? "" : "{" + labels + "}";
+    uint64_t cumulative_count = 0;
+    for (size_t i = 0; i < h.upper_bounds().size(); ++i) {
+        cumulative_count += h.bucket_counts()[i];
+        out << "zecale_" << name << "_bucket{" << bucket_labels << "le=\""
+            << h.upper_bounds()[i] << "\"} " << cumulative_count << "\n";
+    }
+    out << "zecale_" << name << "_bucket{" << bucket_labels << "le=\"+Inf\"} "
+        << h.count() << "\n";
+    out << "zecale_" << name << "_sum" << label_set << " " << h.sum() << "\n";
+    out << "zecale_" << name << "_count" << label_set << " " << h.count()
+        << "\n";
+}
+
+void write_histogram(
+    std::ostream &out,
+    const std::string &name,
+    const std::string &help,
+    const histogram &h)
+{
+    write_header(out, name, "histogram", help);
+    write_histogram_samples(out, name, "", h);
+}
+
+std::string phase_label(const metrics_snapshot::prove_phase &phase)
+{
+    return "phase=\"" + escape_label_value(phase.name) + "\"";
+}
+
+} // namespace
+
+// histogram
+
+histogram::histogram(const std::vector<double> &upper_bounds)
+    : _upper_bounds(upper_bounds)
+    , _bucket_counts(upper_bounds.size() + 1, 0)
+    , _count(0)
+    , _sum(0.0)
+{
+    assert(std::is_sorted(upper_bounds.begin(), upper_bounds.end()));
+}
+
+void histogram::observe(double value)
+{
+    const size_t bucket_idx =
+        std::lower_bound(_upper_bounds.begin(), _upper_bounds.end(), value) -
+        _upper_bounds.begin();
+    ++_bucket_counts[bucket_idx];
+    ++_count;
+    _sum += value;
+}
+
+double histogram::quantile(double q) const
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    const double rank = std::min(std::max(q, 0.0), 1.0) * (double)_count;
+    uint64_t cumulative_count = 0;
+    for (size_t i = 0; i < _upper_bounds.size(); ++i) {
+        const uint64_t bucket_count = _bucket_counts[i];
+        if (bucket_count != 0 &&
+            (double)(cumulative_count + bucket_count) >= rank) {
+            const double lower = (i == 0) ? 0.0 : _upper_bounds[i - 1];
+            const double upper = _upper_bounds[i];
+            return lower + (upper - lower) *
+                               (rank - (double)cumulative_count) /
+                               (double)bucket_count;
+        }
+        cumulative_count += bucket_count;
+    }
+
+    return _upper_bounds.empty() ? 0.0 : _upper_bounds.back();
+}
+
+std::vector<double> histogram::latency_bounds()
+{
+    std::vector<double> bounds;
+    double bound = 0.001;
+    for (size_t i = 0; i < num_latency_bounds; ++i) {
+        bounds.push_back(bound);
+        bound *= 2.0;
+    }
+    return bounds;
+}
+
+// rate_meter
+
+rate_meter::rate_meter(size_t window_seconds)
+    : _origin(clock::now())
+    , _first_second(-1)
+    , _slot_events(window_seconds, 0)
+    , _slot_seconds(window_seconds, -1)
+{
+    assert(window_seconds > 0);
+}
+
+void rate_meter::record(uint64_t num_events, clock::time_point now)
+{
+    const int64_t s = second(now);
+    const size_t slot_idx = (size_t)s % _slot_events.size();
+    if (_slot_seconds[slot_idx] != s) {
+        _slot_seconds[slot_idx] = s;
+        _slot_events[slot_idx] = 0;
+    }
+    _slot_events[slot_idx] += num_events;
+    if (_first_second < 0) {
+        _first_second = s;
+    }
+}
+
+double rate_meter::rate(clock::time_point now) const
+{
+    if (_first_second < 0) {
+        return 0.0;
+    }
+
+    const int64_t s = second(now);
+    const int64_t window = (int64_t)_slot_events.size();
+    uint64_t num_events = 0;
+    for (size_t i = 0; i < _slot_events.size(); ++i) {
+        if (_slot_seconds[i] > s - window && _slot_seconds[i] <= s) {
+            num_events += _slot_events[i];
+        }
+    }
+
+    const int64_t elapsed = std::min(window, s - _first_second + 1);
+    return (double)num_events / (double)std::max<int64_t>(elapsed, 1);
+}
+
+int64_t rate_meter::second(clock::time_point t) const
+{
+    const int64_t elapsed =
+        std::chrono::duration_cast<std::chrono::seconds>(t - _origin).count();
+    return std::max<int64_t>(0, elapsed);
+}
+
+// process_resource_usage
+
+process_resource_usage process_resource_usage::read()
+{
+    process_resource_usage usage{0.0, 0, 0};
+#ifdef __linux__
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage.cpu_seconds =
+            (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec * 1e-6 +
+            (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec * 1e-6;
+        // ru_maxrss is in kilobytes on Linux
+        usage.peak_rss_bytes = (uint64_t)ru.ru_maxrss * 1024;
+    }
+    // The second field of statm is the resident set size, in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0;
+    uint64_t resident_pages = 0;
+    if (statm >> size_pages >> resident_pages) {
+        usage.rss_bytes = resident_pages * (uint64_t)sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return usage;
+}
+
+// metrics_snapshot
+
+metrics_snapshot::prove_phase::prove_phase(const std::string &name)
+    : name(name), wall_seconds(histogram::latency_bounds()), cpu_seconds(0.0)
+{
+}
+
+metrics_snapshot::metrics_snapshot()
+    : uptime_seconds(0.0)
+    , witness_generation_seconds(histogram::latency_bounds())
+    , proof_generation_seconds(histogram::latency_bounds())
+    , end_to_end_seconds(histogram::latency_bounds())
+    , prove_peak_rss_bytes(0)
+    , cpu_seconds(0.0)
+    , prover_cpu_utilisation(0.0)
+    , peak_rss_bytes(0)
+{
+}
+
+// aggregator_metrics
+
+aggregator_metrics::application_metrics::application_metrics()
+    : pool_size(0)
+    , transactions_received(0)
+    , ingest()
+    , batches(0)
+    , batched_transactions(0)
+    , batch_slots(0)
+{
+}
+
+aggregator_metrics::aggregator_metrics(size_t num_prover_cpus)
+    : _num_prover_cpus(std::max<size_t>(num_prover_cpus, 1))
+    , _start_time(clock::now())
+    , _start_cpu_seconds(process_resource_usage::read().cpu_seconds)
+    , _witness_generation_seconds(histogram::latency_bounds())
+    , _proof_generation_seconds(histogram::latency_bounds())
+    , _end_to_end_seconds(histogram::latency_bounds())
+    , _prove_peak_rss_bytes(0)
+{
+    for (const auto &name_timing : prove_timings().phases()) {
+        _prove_phases.emplace_back(name_timing.first);
+    }
+}
+
+void aggregator_metrics::set_pool_size(
+    const std::string &application, size_t pool_size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _applications[application].pool_size = pool_size;
+}
+
+void aggregator_metrics::on_transaction_received(const std::string &application)
+{
+    const clock::time_point now = clock::now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    application_metrics &app = _applications[application];
+    ++app.transactions_received;
+    app.ingest.record(1, now);
+}
+
+void aggregator_metrics::on_batch(
+    const std::string &application, size_t num_txs, size_t batch_size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    application_metrics &app = _applications[application];
+    ++app.batches;
+    app.batched_transactions += num_txs;
+    app.batch_slots += batch_size;
+}
+
+void aggregator_metrics::observe_witness_generation(double seconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _witness_generation_seconds.observe(seconds);
+}
+
+void aggregator_metrics::observe_proof_generation(double seconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _proof_generation_seconds.observe(seconds);
+}
+
+void aggregator_metrics::observe_end_to_end(double seconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _end_to_end_seconds.observe(seconds);
+}
+
+void aggregator_metrics::observe_prove_phases(const prove_timings &timings)
+{
+    const std::vector<std::pair<std::string, phase_timing>> phases =
+        timings.phases();
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < phases.size(); ++i) {
+        _prove_phases[i].wall_seconds.observe(phases[i].second.wall_seconds);
+        _prove_phases[i].cpu_seconds += phases[i].second.cpu_seconds;
+    }
+    _prove_peak_rss_bytes =
+        std::max(_prove_peak_rss_bytes, timings.peak_rss_bytes);
+}
+
+metrics_snapshot aggregator_metrics::snapshot() const
+{
+    const process_resource_usage usage = process_resource_usage::read();
+    const clock::time_point now = clock::now();
+
+    metrics_snapshot snapshot;
+    snapshot.uptime_seconds = seconds_since(_start_time);
+    snapshot.cpu_seconds = usage.cpu_seconds;
+    snapshot.peak_rss_bytes = usage.peak_rss_bytes;
+    if (snapshot.uptime_seconds > 0.0) {
+        snapshot.prover_cpu_utilisation =
+            (usage.cpu_seconds - _start_cpu_seconds) /
+            (snapshot.uptime_seconds * (double)_num_prover_cpus);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto &name_app : _applications) {
+        const application_metrics &app = name_app.second;
+        metrics_snapshot::application app_snapshot;
+        app_snapshot.name = name_app.first;
+        app_snapshot.pool_size = app.pool_size;
+        app_snapshot.transactions_received = app.transactions_received;
+        app_snapshot.ingest_rate = app.ingest.rate(now);
+        app_snapshot.batches = app.batches;
+        app_snapshot.batch_fill_ratio =
+            (app.batch_slots == 0)
+                ? 0.0
+                : (double)app.batched_transactions / (double)app.batch_slots;
+        snapshot.applications.push_back(app_snapshot);
+    }
+    snapshot.witness_generation_seconds = _witness_generation_seconds;
+    snapshot.proof_generation_seconds = _proof_generation_seconds;
+    snapshot.end_to_end_seconds = _end_to_end_seconds;
+    snapshot.prove_phases = _prove_phases;
+    snapshot.prove_peak_rss_bytes = _prove_peak_rss_bytes;
+    return snapshot;
+}
+
+void write_metrics_text(const metrics_snapshot &snapshot, std::ostream &out)
+{
+    // Enough digits for the bucket bounds to be written exactly
+    const std::streamsize precision = out.precision(12);
+
+    write_metric(
+        out,
+        "uptime_seconds",
+        "gauge",
+        "Time since the server started.",
+        snapshot.uptime_seconds);
+
+    using app = metrics_snapshot::application;
+    write_application_metric(
+        out,
+        snapshot,
+        "pool_size",
+        "gauge",
+        "Transactions waiting to be aggregated.",
+        [](const app &a) { return a.pool_size; });
+    write_application_metric(
+        out,
+        snapshot,
+        "transactions_received_total",
+        "counter",
+        "Transactions submitted.",
+        [](const app &a) { return a.transactions_received; });
+    write_application_metric(
+        out,
+        snapshot,
+        "ingest_rate",
+        "gauge",
+        "Transactions submitted per second, over the last minute.",
+        [](const app &a) { return a.ingest_rate; });
+    write_application_metric(
+        out,
+        snapshot,
+        "batches_total",
+        "counter",
+        "Batches aggregated.",
+        [](const app &a) { return a.batches; });
+    write_application_metric(
+        out,
+        snapshot,
+        "batch_fill_ratio",
+        "gauge",
+        "Ratio of the transactions aggregated to the capacity of the batches.",
+        [](const app &a) { return a.batch_fill_ratio; });
+
+    write_histogram(
+        out,
+        "witness_generation_seconds",
+        "Time to generate the witness of an aggregation circuit.",
+        snapshot.witness_generation_seconds);
+    write_histogram(
+        out,
+        "proof_generation_seconds",
+        "Time to generate an aggregate proof, given the witness.",
+        snapshot.proof_generation_seconds);
+    write_histogram(
+        out,
+        "end_to_end_seconds",
+        "Time from the submission of a transaction to its aggregate proof.",
+        snapshot.end_to_end_seconds);
+
+    write_header(
+        out,
+        "prove_phase_seconds",
+        "histogram",
+        "Time spent in each phase of the generation of an aggregate proof.");
+    for (const metrics_snapshot::prove_phase &phase : snapshot.prove_phases) {
+        write_histogram_samples(
+            out, "prove_phase_seconds", phase_label(phase), phase.wall_seconds);
+    }
+    write_header(
+        out,
+        "prove_phase_cpu_seconds_total",
+        "counter",
+        "CPU time of the server during each phase of the generation of the "
+        "aggregate proofs.");
+    for (const metrics_snapshot::prove_phase &phase : snapshot.prove_phases) {
+        out << "zecale_prove_phase_cpu_seconds_total{" << phase_label(phase)
+            << "} " << phase.cpu_seconds << "\n";
+    }
+    write_metric(
+        out,
+        "prove_peak_rss_bytes",
+        "gauge",
+        "Largest resident set size of the server while generating a proof.",
+        snapshot.prove_peak_rss_bytes);
+
+    write_metric(
+        out,
+        "process_cpu_seconds_total",
+        "counter",
+        "User and system CPU time of the server.",
+        snapshot.cpu_seconds);
+    write_metric(
+        out,
+        "prover_cpu_utilisation",
+        "gauge",
+        "Average utilisation of the prover CPUs since the start (0 to 1).",
+        snapshot.prover_cpu_utilisation);
+    write_metric(
+        out,
+        "process_peak_rss_bytes",
+        "gauge",
+        "Peak resident set size of the server.",
+        snapshot.peak_rss_bytes);
+
+    out.precision(precision);
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+} // namespace libzecale
@@ -0,0 +1,221 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_METRICS_HPP__
+#define __ZECALE_CORE_METRICS_HPP__
+
+#include "libzecale/core/prove_timings.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace libzecale
+{
+
+/// A histogram of observed values (typically latencies in seconds), with
+/// fixed bucket upper bounds. Not thread-safe (see `aggregator_metrics`).
+class histogram
+{
+public:
+    /// `upper_bounds` must be sorted in increasing order. An implicit last
+    /// bucket holds the values greater than the last bound.
+    explicit histogram(const std::vector<double> &upper_bounds);
+
+    void observe(double value);
+
+    inline const std::vector<double> &upper_bounds() const
+    {
+        return this->_upper_bounds;
+    }
+
+    /// Number of observations in each bucket (not cumulative), including the
+    /// last (unbounded) bucket.
+    inline const std::vector<uint64_t> &bucket_counts() const
+    {
+        return this->_bucket_counts;
+    }
+
+    inline uint64_t count() const { return this->_count; }
+    inline double sum() const { return this->_sum; }
+
+    /// Estimate of the q-quantile (0 <= q <= 1), interpolated linearly
+    /// within the bucket containing it. Values in the last bucket are
+    /// reported as the last bound. Returns 0 if there is no observation.
+    double quantile(double q) const;
+
+    /// Bounds suited to the latencies of the aggregator (1ms to ~2.3h, in
+    /// seconds), in a geometric progression of ratio 2.
+    static std::vector<double> latency_bounds();
+
+private:
+    std::vector<double> _upper_bounds;
+    std::vector<uint64_t> _bucket_counts;
+    uint64_t _count;
+    double _sum;
+};
+
+/// Number of events per second, over a sliding window of `window_seconds`
+/// seconds (with a resolution of one second). Not thread-safe.
+class rate_meter
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit rate_meter(size_t window_seconds = 60);
+
+    void record(uint64_t num_events, clock::time_point now);
+
+    /// The rate over the window ending at `now`. Until a full window has
+    /// elapsed since the first event, the rate is averaged over the elapsed
+    /// time only.
+    double rate(clock::time_point now) const;
+
+private:
+    int64_t second(clock::time_point t) const;
+
+    clock::time_point _origin;
+    int64_t _first_second;
+    // Ring buffer of the number of events in each second, indexed by the
+    // second (since `_origin`) modulo the window size, along with the second
+    // each slot currently holds.
+    std::vector<uint64_t> _slot_events;
+    std::vector<int64_t> _slot_seconds;
+};
+
+/// Resource usage of the current process.
+class process_resource_usage
+{
+public:
+    /// User and system CPU time consumed by all threads
+    double cpu_seconds;
+    /// Peak resident set size
+    uint64_t peak_rss_bytes;
+    /// Current resident set size
+    uint64_t rss_bytes;
+
+    /// Read the usage from getrusage() and /proc/self/statm (zero if it is
+    /// not available).
+    static process_resource_usage read();
+};
+
+/// The values of `aggregator_metrics` at a point in time.
+class metrics_snapshot
+{
+public:
+    class application
+    {
+    public:
+        std::string name;
+        uint64_t pool_size;
+        uint64_t transactions_received;
+        /// Transactions received per second (see `rate_meter`)
+        double ingest_rate;
+        uint64_t batches;
+        /// Ratio of the transactions aggregated to the capacity of the
+        /// batches (1 if all batches were full)
+        double batch_fill_ratio;
+    };
+
+    /// A phase of the generation of the aggregate proofs (see
+    /// `prove_timings`)
+    class prove_phase
+    {
+    public:
+        std::string name;
+        histogram wall_seconds;
+        /// Total CPU time of the process during the phase
+        double cpu_seconds;
+
+        explicit prove_phase(const std::string &name);
+    };
+
+    double uptime_seconds;
+    std::vector<application> applications;
+    histogram witness_generation_seconds;
+    histogram proof_generation_seconds;
+    /// From the submission of a transaction to the proof aggregating it
+    histogram end_to_end_seconds;
+    std::vector<prove_phase> prove_phases;
+    /// Largest resident set size observed while generating a proof
+    uint64_t prove_peak_rss_bytes;
+    double cpu_seconds;
+    /// Average utilisation (0 to 1) of the prover CPUs since the start, i.e.
+    /// the CPU time of the process over the elapsed time multiplied by the
+    /// number of prover CPUs.
+    double prover_cpu_utilisation;
+    uint64_t peak_rss_bytes;
+
+    metrics_snapshot();
+};
+
+/// Thread-safe registry of the metrics of the aggregator server, recorded by
+/// the gRPC handlers and the prover jobs.
+class aggregator_metrics
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit aggregator_metrics(size_t num_prover_cpus);
+    aggregator_metrics(const aggregator_metrics &) = delete;
+    aggregator_metrics &operator=(const aggregator_metrics &) = delete;
+
+    void set_pool_size(const std::string &application, size_t pool_size);
+    void on_transaction_received(const std::string &application);
+
+    /// Record a batch of `num_txs` transactions of an application, out of
+    /// `batch_size` slots.
+    void on_batch(
+        const std::string &application, size_t num_txs, size_t batch_size);
+
+    void observe_witness_generation(double seconds);
+    void observe_proof_generation(double seconds);
+    void observe_end_to_end(double seconds);
+
+    /// Record the time spent in each phase of the generation of a proof.
+    void observe_prove_phases(const prove_timings &timings);
+
+    metrics_snapshot snapshot() const;
+
+private:
+    class application_metrics
+    {
+    public:
+        uint64_t pool_size;
+        uint64_t transactions_received;
+        rate_meter ingest;
+        uint64_t batches;
+        uint64_t batched_transactions;
+        uint64_t batch_slots;
+
+        application_metrics();
+    };
+
+    const size_t _num_prover_cpus;
+    const clock::time_point _start_time;
+    const double _start_cpu_seconds;
+
+    mutable std::mutex _mutex;
+    std::map<std::string, application_metrics> _applications;
+    histogram _witness_generation_seconds;
+    histogram _proof_generation_seconds;
+    histogram _end_to_end_seconds;
+    std::vector<metrics_snapshot::prove_phase> _prove_phases;
+    uint64_t _prove_peak_rss_bytes;
+};
+
+/// Write the snapshot in the Prometheus text exposition format (version
+/// 0.0.4), with metric names prefixed by "zecale_".
+void write_metrics_text(const metrics_snapshot &snapshot, std::ostream &out);
+
+/// Elapsed time since `start`, in seconds.
+double seconds_since(std::chrono::steady_clock::time_point start);
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_METRICS_HPP__
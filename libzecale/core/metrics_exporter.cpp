@@ -0,0 +1,202 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/metrics_exporter.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace libzecale
+{
+
+namespace
+{
+
+// Interval at which the HTTP thread checks whether it must stop.
+const int http_poll_timeout_ms = 200;
+
+// Maximum size of the request read before responding. Requests are not
+// parsed: all paths serve the metrics.
+const size_t http_max_request_size = 4096;
+
+void write_all(int fd, const std::string &data)
+{
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n =
+            ::send(fd, data.data() + written, data.size() - written, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        written += (size_t)n;
+    }
+}
+
+} // namespace
+
+metrics_exporter::metrics_exporter(
+    const aggregator_metrics &metrics,
+    const std::string &file,
+    uint16_t http_port,
+    std::chrono::milliseconds file_interval)
+    : _metrics(metrics)
+    , _file(file)
+    , _file_interval(file_interval)
+    , _http_port(0)
+    , _listen_fd(-1)
+    , _stopping(false)
+{
+    if (http_port != 0) {
+        _listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (_listen_fd < 0) {
+            throw std::runtime_error(
+                std::string("metrics socket: ") + std::strerror(errno));
+        }
+        const int reuse = 1;
+        ::setsockopt(
+            _listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(http_port);
+        if (::bind(_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            ::listen(_listen_fd, 16) != 0) {
+            const std::string error = std::strerror(errno);
+            ::close(_listen_fd);
+            throw std::runtime_error(
+                "metrics port " + std::to_string(http_port) + ": " + error);
+        }
+        _http_port = http_port;
+        _http_thread = std::thread(&metrics_exporter::http_loop, this);
+    }
+
+    if (!_file.empty()) {
+        _file_thread = std::thread(&metrics_exporter::file_loop, this);
+    }
+}
+
+metrics_exporter::~metrics_exporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _cv.notify_all();
+    if (_file_thread.joinable()) {
+        _file_thread.join();
+    }
+    if (_http_thread.joinable()) {
+        _http_thread.join();
+    }
+    if (_listen_fd >= 0) {
+        ::close(_listen_fd);
+    }
+}
+
+void metrics_exporter::write_file() const
+{
+    // Write to a temporary file, then rename it over the previous one, so
+    // that readers never see a partially written file.
+    const std::string tmp_file = _file + ".tmp";
+    {
+        std::ofstream out(tmp_file.c_str());
+        write_metrics_text(_metrics.snapshot(), out);
+        if (!out.good()) {
+            return;
+        }
+    }
+    std::rename(tmp_file.c_str(), _file.c_str());
+}
+
+void metrics_exporter::file_loop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        lock.unlock();
+        write_file();
+        lock.lock();
+        if (_stopping) {
+            return;
+        }
+        _cv.wait_for(lock, _file_interval, [this]() { return _stopping; });
+    }
+}
+
+void metrics_exporter::http_loop()
+{
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping) {
+                return;
+            }
+        }
+
+        struct pollfd pfd;
+        pfd.fd = _listen_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, http_poll_timeout_ms) <= 0) {
+            continue;
+        }
+
+        const int connection_fd = ::accept(_listen_fd, nullptr, nullptr);
+        if (connection_fd < 0) {
+            continue;
+        }
+        serve_http_connection(connection_fd);
+        ::close(connection_fd);
+    }
+}
+
+void metrics_exporter::serve_http_connection(int connection_fd) const
+{
+    // Read (and discard) the request headers, up to the empty line.
+    std::string request;
+    char buffer[512];
+    while (request.size() < http_max_request_size &&
+           request.find("\r\n\r\n") == std::string::npos) {
+        struct pollfd pfd;
+        pfd.fd = connection_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, http_poll_timeout_ms) <= 0) {
+            break;
+        }
+        const ssize_t n = ::recv(connection_fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, (size_t)n);
+    }
+
+    std::ostringstream body;
+    write_metrics_text(_metrics.snapshot(), body);
+    const std::string body_str = body.str();
+
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body_str.size() << "\r\n"
+             << "Connection: close\r\n"
+             << "\r\n"
+             << body_str;
+    write_all(connection_fd, response.str());
+}
+
+} // namespace libzecale
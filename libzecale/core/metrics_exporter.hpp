@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_METRICS_EXPORTER_HPP__
+#define __ZECALE_CORE_METRICS_EXPORTER_HPP__
+
+#include "libzecale/core/metrics.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace libzecale
+{
+
+/// Exposes the metrics of an `aggregator_metrics` in the text format of
+/// `write_metrics_text`, from background threads:
+///
+/// - written to a file every `file_interval` (if `file` is not empty). The
+///   file is replaced atomically, so that it can be read at any time (e.g. by
+///   the textfile collector of the Prometheus node exporter).
+/// - served over HTTP on 127.0.0.1:`http_port` (if `http_port` is not 0), in
+///   response to any request (e.g. `GET /metrics`).
+class metrics_exporter
+{
+public:
+    /// Throws `std::runtime_error` if the HTTP port cannot be bound.
+    metrics_exporter(
+        const aggregator_metrics &metrics,
+        const std::string &file,
+        uint16_t http_port,
+        std::chrono::milliseconds file_interval = std::chrono::seconds(10));
+    metrics_exporter(const metrics_exporter &) = delete;
+    metrics_exporter &operator=(const metrics_exporter &) = delete;
+
+    /// Stops the threads (writing the file a last time).
+    ~metrics_exporter();
+
+    /// Write the metrics to the file now.
+    void write_file() const;
+
+    /// The port the HTTP server is listening on (0 if disabled).
+    inline uint16_t http_port() const { return this->_http_port; }
+
+private:
+    void file_loop();
+    void http_loop();
+    void serve_http_connection(int connection_fd) const;
+
+    const aggregator_metrics &_metrics;
+    const std::string _file;
+    const std::chrono::milliseconds _file_interval;
+    uint16_t _http_port;
+    int _listen_fd;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stopping;
+    std::thread _file_thread;
+    std::thread _http_thread;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_METRICS_EXPORTER_HPP__
@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_MIXED_BATCH_HPP__
+#define __ZECALE_CORE_MIXED_BATCH_HPP__
+
+#include "libzecale/core/application_pool.hpp"
+#include "libzecale/core/transaction_to_aggregate.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace libzecale
+{
+
+/// A batch of (up to) `NumProofs` transactions, taken from (up to) `NumVKs`
+/// application pools, to be aggregated by the
+/// `multi_application_aggregator_gadget`.
+///
+/// The batch shares ownership of the verification keys of the application
+/// pools, so that a pool may be replaced (e.g. when its application is
+/// registered again) while the batch is being proved.
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+class mixed_batch
+{
+private:
+    std::array<std::string, NumVKs> _application_names;
+    std::array<
+        std::shared_ptr<const typename nsnarkT::verification_key>,
+        NumVKs>
+        _nested_vks;
+    size_t _num_applications;
+
+    std::array<transaction_to_aggregate<nppT, nsnarkT>, NumProofs> _txs;
+    std::array<size_t, NumProofs> _vk_indices;
+    size_t _num_txs;
+
+public:
+    mixed_batch();
+
+    inline size_t num_applications() const { return _num_applications; }
+    inline size_t num_txs() const { return _num_txs; }
+
+    inline const std::string &application_name(size_t vk_index) const
+    {
+        return _application_names[vk_index];
+    }
+
+    inline const transaction_to_aggregate<nppT, nsnarkT> &tx(size_t i) const
+    {
+        return _txs[i];
+    }
+
+    /// Index of the verification key used for each slot of the batch.
+    inline const std::array<size_t, NumProofs> &vk_indices() const
+    {
+        return _vk_indices;
+    }
+
+    /// The verification keys used by the batch. Unused entries are set to the
+    /// first key, so that the circuit witness is always well-defined.
+    std::array<const typename nsnarkT::verification_key *, NumVKs> nested_vks()
+        const;
+
+    /// Pointers to the nested proofs held by the batch (nullptr for unfilled
+    /// slots).
+    std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+    extended_proofs() const;
+
+    /// Returns the index of the given application in the batch, adding it if
+    /// necessary. Returns NumVKs if the application is not in the batch and
+    /// the batch already refers to `NumVKs` applications.
+    size_t get_or_add_application(
+        const std::string &application_name,
+        std::shared_ptr<const typename nsnarkT::verification_key> vk);
+
+    /// Append a transaction, verified by the key at `vk_index`.
+    void add_tx(transaction_to_aggregate<nppT, nsnarkT> &&tx, size_t vk_index);
+
+    /// Remove the last transaction of the batch, and return it. The batch
+    /// must not be empty.
+    transaction_to_aggregate<nppT, nsnarkT> pop_tx();
+};
+
+/// Build the next batch mixing transactions from several application pools.
+/// Transactions are selected greedily by fee across all pools, skipping the
+/// pools without a verification key, and those which cannot be added because
+/// the batch already refers to `NumVKs` distinct applications.
+///
+/// If less than `NumProofs` transactions can be selected, they are returned
+/// to their pools, and an empty batch is returned.
+///
+/// TODO: As for `application_pool::get_next_batch`, pad the batch with dummy
+/// inputs if there are less than `NumProofs` transactions in the pools.
+template<
+    typename nppT,
+    typename nsnarkT,
+    size_t PoolBatchSize,
+    size_t NumProofs,
+    size_t NumVKs>
+mixed_batch<nppT, nsnarkT, NumProofs, NumVKs> get_next_mixed_batch(
+    const std::vector<application_pool<nppT, nsnarkT, PoolBatchSize> *>
+        &pools);
+
+} // namespace libzecale
+
+#include "libzecale/core/mixed_batch.tcc"
+
+#endif // __ZECALE_CORE_MIXED_BATCH_HPP__
@@ -0,0 +1,158 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_MIXED_BATCH_TCC__
+#define __ZECALE_CORE_MIXED_BATCH_TCC__
+
+#include <cassert>
+
+namespace libzecale
+{
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+mixed_batch<nppT, nsnarkT, NumProofs, NumVKs>::mixed_batch()
+    : _num_applications(0), _num_txs(0)
+{
+    _vk_indices.fill(0);
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+std::array<const typename nsnarkT::verification_key *, NumVKs> mixed_batch<
+    nppT,
+    nsnarkT,
+    NumProofs,
+    NumVKs>::nested_vks() const
+{
+    std::array<const typename nsnarkT::verification_key *, NumVKs> vks;
+    for (size_t k = 0; k < NumVKs; k++) {
+        vks[k] = (k < _num_applications) ? _nested_vks[k].get()
+                                         : _nested_vks[0].get();
+    }
+    return vks;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+mixed_batch<nppT, nsnarkT, NumProofs, NumVKs>::extended_proofs() const
+{
+    std::array<const libzeth::extended_proof<nppT, nsnarkT> *, NumProofs>
+        proofs{nullptr};
+    for (size_t i = 0; i < _num_txs; i++) {
+        proofs[i] = &_txs[i].extended_proof();
+    }
+    return proofs;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+size_t mixed_batch<nppT, nsnarkT, NumProofs, NumVKs>::get_or_add_application(
+    const std::string &application_name,
+    std::shared_ptr<const typename nsnarkT::verification_key> vk)
+{
+    for (size_t k = 0; k < _num_applications; k++) {
+        if (_application_names[k] == application_name) {
+            return k;
+        }
+    }
+
+    if (_num_applications == NumVKs) {
+        return NumVKs;
+    }
+
+    _application_names[_num_applications] = application_name;
+    _nested_vks[_num_applications] = std::move(vk);
+    return _num_applications++;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+void mixed_batch<nppT, nsnarkT, NumProofs, NumVKs>::add_tx(
+    transaction_to_aggregate<nppT, nsnarkT> &&tx, size_t vk_index)
+{
+    assert(_num_txs < NumProofs);
+    assert(vk_index < _num_applications);
+    _txs[_num_txs] = std::move(tx);
+    _vk_indices[_num_txs] = vk_index;
+    ++_num_txs;
+}
+
+template<typename nppT, typename nsnarkT, size_t NumProofs, size_t NumVKs>
+transaction_to_aggregate<nppT, nsnarkT> mixed_batch<
+    nppT,
+    nsnarkT,
+    NumProofs,
+    NumVKs>::pop_tx()
+{
+    assert(_num_txs > 0);
+    --_num_txs;
+    return std::move(_txs[_num_txs]);
+}
+
+template<
+    typename nppT,
+    typename nsnarkT,
+    size_t PoolBatchSize,
+    size_t NumProofs,
+    size_t NumVKs>
+mixed_batch<nppT, nsnarkT, NumProofs, NumVKs> get_next_mixed_batch(
+    const std::vector<application_pool<nppT, nsnarkT, PoolBatchSize> *> &pools)
+{
+    mixed_batch<nppT, nsnarkT, NumProofs, NumVKs> batch;
+    // Pools which cannot contribute to this batch, because the batch is
+    // already full of other applications.
+    std::vector<bool> excluded(pools.size(), false);
+    // Pool from which each transaction of the batch is taken
+    std::array<size_t, NumProofs> tx_pools;
+
+    while (batch.num_txs() < NumProofs) {
+        // Find the pool holding the highest fee transaction
+        size_t best_pool = pools.size();
+        for (size_t p = 0; p < pools.size(); p++) {
+            if (excluded[p] || !pools[p]->has_verification_key()) {
+                continue;
+            }
+
+            const transaction_to_aggregate<nppT, nsnarkT> *top =
+                pools[p]->top_tx();
+            if (top == nullptr) {
+                continue;
+            }
+
+            if (best_pool == pools.size() ||
+                pools[best_pool]->top_tx()->fee_wei() < top->fee_wei()) {
+                best_pool = p;
+            }
+        }
+
+        if (best_pool == pools.size()) {
+            break;
+        }
+
+        application_pool<nppT, nsnarkT, PoolBatchSize> &pool =
+            *pools[best_pool];
+        const size_t vk_index = batch.get_or_add_application(
+            pool.name(), pool.shared_verification_key());
+        if (vk_index == NumVKs) {
+            excluded[best_pool] = true;
+            continue;
+        }
+
+        tx_pools[batch.num_txs()] = best_pool;
+        batch.add_tx(pool.pop_tx(), vk_index);
+    }
+
+    // Return the transactions to their pools, rather than leaving the
+    // caller with a batch which cannot be proved
+    if (batch.num_txs() < NumProofs) {
+        while (batch.num_txs() != 0) {
+            const size_t pool_idx = tx_pools[batch.num_txs() - 1];
+            pools[pool_idx]->add_tx(batch.pop_tx());
+        }
+        return mixed_batch<nppT, nsnarkT, NumProofs, NumVKs>();
+    }
+
+    return batch;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_MIXED_BATCH_TCC__
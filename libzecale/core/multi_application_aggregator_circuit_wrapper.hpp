@@ -0,0 +1,94 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_HPP__
+#define __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_HPP__
+
+#include "libzecale/circuits/multi_application_aggregator.tcc"
+#include "libzecale/core/logger.hpp"
+#include "libzecale/core/mixed_batch.hpp"
+#include "libzecale/core/prove_timings.hpp"
+#include "libzecale/core/satisfiability_check.hpp"
+
+#include <libzeth/core/extended_proof.hpp>
+
+namespace libzecale
+{
+
+/// Wrapper around the `multi_application_aggregator_gadget`, which aggregates
+/// `NumProofs` nested proofs verified against up to `NumVKs` distinct
+/// verification keys.
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+class multi_application_aggregator_circuit_wrapper
+{
+private:
+    using wsnark = typename wverifierT::snark;
+    using gadget = multi_application_aggregator_gadget<
+        nppT,
+        wppT,
+        nsnarkT,
+        wverifierT,
+        NumProofs,
+        NumVKs>;
+
+    // Batches whose witness is checked before proving
+    std::shared_ptr<satisfiability_check_policy> check_policy;
+
+public:
+    multi_application_aggregator_circuit_wrapper()
+        : check_policy(std::make_shared<satisfiability_check_policy>())
+    {
+    }
+
+    /// Set the batches whose witness is checked (by default, all of them).
+    /// The policy may be shared with other wrappers.
+    void set_satisfiability_check_policy(
+        std::shared_ptr<satisfiability_check_policy> policy)
+    {
+        this->check_policy = policy;
+    }
+
+    typename wsnark::keypair generate_trusted_setup() const;
+    libsnark::protoboard<libff::Fr<wppT>> get_constraint_system() const;
+
+    /// Digest of a nested verification key, as exposed in the primary input
+    /// of the aggregator proof (see `multi_application_aggregator_gadget`).
+    static libff::Fr<wppT> compute_nested_vk_hash(
+        const typename nsnarkT::verification_key &nested_vk)
+    {
+        return gadget::compute_nested_vk_hash(nested_vk);
+    }
+
+    /// Generate a proof and returns an extended proof. `vk_indices[i]` is the
+    /// index in `nested_vks` of the key used to verify `extended_proofs[i]`.
+    /// If `timings` is not null, it receives the time spent in each phase.
+    libzeth::extended_proof<wppT, wsnark> prove(
+        const std::array<const typename nsnarkT::verification_key *, NumVKs>
+            &nested_vks,
+        const std::array<size_t, NumProofs> &vk_indices,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings = nullptr) const;
+
+    /// Generate a proof for a batch of transactions built by
+    /// `get_next_mixed_batch`.
+    libzeth::extended_proof<wppT, wsnark> prove(
+        const mixed_batch<nppT, nsnarkT, NumProofs, NumVKs> &batch,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings = nullptr) const;
+};
+
+} // namespace libzecale
+
+#include "multi_application_aggregator_circuit_wrapper.tcc"
+
+#endif // __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_HPP__
@@ -0,0 +1,143 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_TCC__
+#define __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_TCC__
+
+namespace libzecale
+{
+
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+typename wverifierT::snark::keypair multi_application_aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs,
+    NumVKs>::generate_trusted_setup() const
+{
+    libsnark::protoboard<libff::Fr<wppT>> pb;
+    gadget g(pb);
+    g.generate_r1cs_constraints();
+
+    // Generate a verification and proving key (trusted setup)
+    return wsnark::generate_setup(pb);
+}
+
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+libsnark::protoboard<libff::Fr<wppT>> multi_application_aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs,
+    NumVKs>::get_constraint_system() const
+{
+    libsnark::protoboard<libff::Fr<wppT>> pb;
+    gadget g(pb);
+    g.generate_r1cs_constraints();
+    return pb;
+}
+
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+libzeth::extended_proof<wppT, typename wverifierT::snark>
+multi_application_aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs,
+    NumVKs>::
+    prove(
+        const std::array<const typename nsnarkT::verification_key *, NumVKs>
+            &nested_vks,
+        const std::array<size_t, NumProofs> &vk_indices,
+        const std::array<
+            const libzeth::extended_proof<nppT, nsnarkT> *,
+            NumProofs> &extended_proofs,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const
+{
+    prove_phase_timer timer(timings);
+    libsnark::protoboard<libff::Fr<wppT>> pb;
+
+    gadget g(pb);
+    g.generate_r1cs_constraints();
+    timer.end_phase(&prove_timings::constraint_generation);
+
+    g.generate_r1cs_witness(nested_vks, vk_indices, extended_proofs);
+    timer.end_phase(&prove_timings::witness_generation);
+
+    check_witness(
+        *this->check_policy, pb, aggregator_proving_key.constraint_system);
+    timer.end_phase(&prove_timings::satisfiability_check);
+
+    typename wsnark::proof proof =
+        wsnark::generate_proof(pb, aggregator_proving_key);
+    timer.end_phase(&prove_timings::proof_generation);
+    libsnark::r1cs_primary_input<libff::Fr<wppT>> primary_input =
+        pb.primary_input();
+    timer.end_phase(&prove_timings::primary_input_extraction);
+    if (timings != nullptr) {
+        timings->num_constraints = pb.num_constraints();
+        timings->num_variables = pb.num_variables();
+    }
+
+    return libzeth::extended_proof<wppT, wsnark>(
+        std::move(proof), std::move(primary_input));
+}
+
+template<
+    typename nppT,
+    typename wppT,
+    typename nsnarkT,
+    typename wverifierT,
+    size_t NumProofs,
+    size_t NumVKs>
+libzeth::extended_proof<wppT, typename wverifierT::snark>
+multi_application_aggregator_circuit_wrapper<
+    nppT,
+    wppT,
+    nsnarkT,
+    wverifierT,
+    NumProofs,
+    NumVKs>::
+    prove(
+        const mixed_batch<nppT, nsnarkT, NumProofs, NumVKs> &batch,
+        const typename wsnark::proving_key &aggregator_proving_key,
+        prove_timings *timings) const
+{
+    if (batch.num_txs() != NumProofs) {
+        throw std::invalid_argument("incomplete batch");
+    }
+
+    return prove(
+        batch.nested_vks(),
+        batch.vk_indices(),
+        batch.extended_proofs(),
+        aggregator_proving_key,
+        timings);
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_MULTI_APPLICATION_AGGREGATOR_CIRCUIT_WRAPPER_TCC__
@@ -0,0 +1,55 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_POOL_SNAPSHOT_HPP__
+#define __ZECALE_CORE_POOL_SNAPSHOT_HPP__
+
+#include "libzecale/core/transaction_to_aggregate.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace libzecale
+{
+
+/// The registered applications and their pending transactions, written by
+/// the aggregator server when it shuts down and reloaded when it starts, so
+/// that a restart does not lose the content of the pools. The format is:
+///
+///   magic (8 bytes) | version | NumApplications |
+///   NumApplications x (name | nested VK | NumTxs |
+///     NumTxs x (id | fee | proof | primary inputs))
+///
+/// with the same conventions as `aggregation_snapshot` (names are written as
+/// their length followed by their characters). The time at which the
+/// transactions were received is not persisted.
+template<typename nppT, typename nsnarkT> class pool_snapshot
+{
+public:
+    class application
+    {
+    public:
+        std::string name;
+        typename nsnarkT::verification_key nested_vk;
+        std::vector<transaction_to_aggregate<nppT, nsnarkT>> transactions;
+    };
+
+    std::vector<application> applications;
+
+    /// Number of transactions of all the applications
+    size_t num_transactions() const;
+
+    void write(std::ostream &out) const;
+
+    /// Read a snapshot. Throws if the stream does not contain a valid pool
+    /// snapshot.
+    static pool_snapshot read(std::istream &in);
+};
+
+} // namespace libzecale
+
+#include "libzecale/core/pool_snapshot.tcc"
+
+#endif // __ZECALE_CORE_POOL_SNAPSHOT_HPP__
@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_POOL_SNAPSHOT_TCC__
+#define __ZECALE_CORE_POOL_SNAPSHOT_TCC__
+
+#include "libzecale/core/aggregation_snapshot.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+namespace internal
+{
+
+static const char pool_snapshot_magic[8] = {
+    'Z', 'E', 'C', 'P', 'O', 'O', 'L', 0};
+static const uint32_t pool_snapshot_version = 1;
+
+// Upper bound on the length of an application name, to reject corrupted
+// snapshots before allocating.
+static const size_t pool_snapshot_max_name_length = 1024;
+
+inline void snapshot_write_string(std::ostream &out, const std::string &str)
+{
+    snapshot_write_int(out, str.size());
+    out.write(str.data(), str.size());
+}
+
+inline std::string snapshot_read_string(std::istream &in)
+{
+    const size_t length = snapshot_read_int<size_t>(in);
+    if (length > pool_snapshot_max_name_length) {
+        throw std::runtime_error("invalid string in snapshot");
+    }
+    std::string str(length, '\0');
+    in.read(&str[0], length);
+    if (!in.good()) {
+        throw std::runtime_error("truncated snapshot");
+    }
+    return str;
+}
+
+} // namespace internal
+
+template<typename nppT, typename nsnarkT>
+size_t pool_snapshot<nppT, nsnarkT>::num_transactions() const
+{
+    size_t num_txs = 0;
+    for (const application &app : applications) {
+        num_txs += app.transactions.size();
+    }
+    return num_txs;
+}
+
+template<typename nppT, typename nsnarkT>
+void pool_snapshot<nppT, nsnarkT>::write(std::ostream &out) const
+{
+    out.write(
+        internal::pool_snapshot_magic, sizeof(internal::pool_snapshot_magic));
+    internal::snapshot_write_int(out, internal::pool_snapshot_version);
+    internal::snapshot_write_int(out, applications.size());
+    for (const application &app : applications) {
+        internal::snapshot_write_string(out, app.name);
+        out << app.nested_vk;
+        internal::snapshot_write_int(out, app.transactions.size());
+        for (const transaction_to_aggregate<nppT, nsnarkT> &tx :
+             app.transactions) {
+            internal::snapshot_write_int(out, tx.id());
+            internal::snapshot_write_int(out, tx.fee_wei());
+            out << tx.extended_proof().get_proof();
+            out << tx.extended_proof().get_primary_inputs();
+        }
+    }
+}
+
+template<typename nppT, typename nsnarkT>
+pool_snapshot<nppT, nsnarkT> pool_snapshot<nppT, nsnarkT>::read(
+    std::istream &in)
+{
+    char magic[sizeof(internal::pool_snapshot_magic)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() ||
+        memcmp(magic, internal::pool_snapshot_magic, sizeof(magic))) {
+        throw std::runtime_error("invalid pool snapshot");
+    }
+    if (internal::snapshot_read_int<uint32_t>(in) !=
+        internal::pool_snapshot_version) {
+        throw std::runtime_error("unsupported pool snapshot version");
+    }
+
+    pool_snapshot snapshot;
+    const size_t num_applications = internal::snapshot_read_int<size_t>(in);
+    for (size_t i = 0; i < num_applications; ++i) {
+        application app;
+        app.name = internal::snapshot_read_string(in);
+        in >> app.nested_vk;
+        const size_t num_txs = internal::snapshot_read_int<size_t>(in);
+        for (size_t j = 0; j < num_txs; ++j) {
+            const uint64_t id = internal::snapshot_read_int<uint64_t>(in);
+            const uint32_t fee_wei = internal::snapshot_read_int<uint32_t>(in);
+            typename nsnarkT::proof proof;
+            libsnark::r1cs_primary_input<libff::Fr<nppT>> primary_inputs;
+            in >> proof;
+            in >> primary_inputs;
+            if (!in.good()) {
+                throw std::runtime_error("truncated snapshot");
+            }
+            transaction_to_aggregate<nppT, nsnarkT> tx(
+                std::string(app.name),
+                libzeth::extended_proof<nppT, nsnarkT>(
+                    std::move(proof), std::move(primary_inputs)),
+                fee_wei);
+            tx.set_id(id);
+            app.transactions.push_back(std::move(tx));
+        }
+        snapshot.applications.push_back(std::move(app));
+    }
+
+    return snapshot;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_POOL_SNAPSHOT_TCC__
@@ -0,0 +1,390 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/proof_store.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+namespace
+{
+
+const char proof_magic[8] = {'Z', 'E', 'C', 'P', 'R', 'O', 'O', 'F'};
+// Version 1 files have no timings, version 2 files have no VK fingerprint
+const uint64_t proof_version = 3;
+
+// Upper bound on the size of the strings and vectors of a proof file, to
+// reject corrupted files before allocating.
+const uint64_t max_length = 1 << 28;
+
+const std::string batch_file_prefix = "batch_";
+const std::string batch_file_suffix = ".proof";
+
+void write_int(std::ostream &out, uint64_t value)
+{
+    out.write((const char *)&value, sizeof(value));
+}
+
+uint64_t read_int(std::istream &in)
+{
+    uint64_t value;
+    in.read((char *)&value, sizeof(value));
+    if (!in.good()) {
+        throw std::runtime_error("truncated proof");
+    }
+    return value;
+}
+
+uint64_t read_length(std::istream &in)
+{
+    const uint64_t length = read_int(in);
+    if (length > max_length) {
+        throw std::runtime_error("invalid proof");
+    }
+    return length;
+}
+
+void write_string(std::ostream &out, const std::string &str)
+{
+    write_int(out, str.size());
+    out.write(str.data(), str.size());
+}
+
+std::string read_string(std::istream &in)
+{
+    std::string str(read_length(in), '\0');
+    in.read(&str[0], str.size());
+    if (!in.good()) {
+        throw std::runtime_error("truncated proof");
+    }
+    return str;
+}
+
+// Parse "batch_<id>.proof". Returns false for other file names.
+bool parse_batch_file_name(const std::string &name, uint64_t &batch_id)
+{
+    if (name.size() <= batch_file_prefix.size() + batch_file_suffix.size() ||
+        name.compare(0, batch_file_prefix.size(), batch_file_prefix) != 0 ||
+        name.compare(
+            name.size() - batch_file_suffix.size(),
+            batch_file_suffix.size(),
+            batch_file_suffix) != 0) {
+        return false;
+    }
+    const std::string id = name.substr(
+        batch_file_prefix.size(),
+        name.size() - batch_file_prefix.size() - batch_file_suffix.size());
+    if (id.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    batch_id = std::stoull(id);
+    return true;
+}
+
+} // namespace
+
+stored_proof::stored_proof() : batch_id(0) {}
+
+std::string verification_key_fingerprint(const std::string &vk_bytes)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : vk_bytes) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ULL;
+    }
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << hash;
+    return ss.str();
+}
+
+proof_store::proof_store(
+    size_t cache_size,
+    const boost::filesystem::path &dir,
+    size_t max_stored,
+    const std::set<std::string> &vk_fingerprints)
+    : _cache_size(cache_size)
+    , _dir(dir)
+    , _max_stored(max_stored)
+    , _max_batch_id(0)
+    , _max_tx_id(0)
+    , _num_discarded(0)
+{
+    if (_dir.empty()) {
+        return;
+    }
+    if (_max_stored == 0) {
+        throw std::invalid_argument("proof store cannot be empty");
+    }
+
+    // Load the index of the stored proofs (the proofs themselves are read
+    // when first requested).
+    boost::filesystem::create_directories(_dir);
+    std::vector<boost::filesystem::path> discarded_files;
+    for (const boost::filesystem::directory_entry &file :
+         boost::filesystem::directory_iterator(_dir)) {
+        uint64_t batch_id;
+        if (!parse_batch_file_name(
+                file.path().filename().string(), batch_id)) {
+            continue;
+        }
+        std::ifstream in(
+            file.path().c_str(), std::ios_base::in | std::ios_base::binary);
+        const stored_proof proof = read(in);
+        if (proof.batch_id != batch_id) {
+            throw std::runtime_error(
+                "invalid proof file: " + file.path().string());
+        }
+        _max_batch_id = std::max(_max_batch_id, batch_id);
+        for (const uint64_t tx_id : proof.tx_ids) {
+            _max_tx_id = std::max(_max_tx_id, tx_id);
+        }
+        if (!vk_fingerprints.empty() &&
+            vk_fingerprints.count(proof.vk_fingerprint) == 0) {
+            // Made with another keypair
+            discarded_files.push_back(file.path());
+            continue;
+        }
+
+        entry &batch_entry = _entries[batch_id];
+        batch_entry.tx_ids = proof.tx_ids;
+        for (const uint64_t tx_id : proof.tx_ids) {
+            _tx_batches[tx_id] = batch_id;
+        }
+    }
+    for (const boost::filesystem::path &file : discarded_files) {
+        boost::filesystem::remove(file);
+    }
+    _num_discarded = discarded_files.size();
+    while (_entries.size() > _max_stored) {
+        remove(_entries.begin()->first);
+    }
+}
+
+void proof_store::put(const stored_proof &proof)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_entries.count(proof.batch_id) != 0) {
+        remove(proof.batch_id);
+    }
+
+    if (!_dir.empty()) {
+        // Write to a temporary file first, so that a batch file is always
+        // complete.
+        const boost::filesystem::path file = batch_file(proof.batch_id);
+        boost::filesystem::path tmp_file = file;
+        tmp_file += ".tmp";
+        {
+            std::ofstream out(
+                tmp_file.c_str(), std::ios_base::out | std::ios_base::binary);
+            out.exceptions(
+                std::ios_base::eofbit | std::ios_base::badbit |
+                std::ios_base::failbit);
+            write(out, proof);
+        }
+        boost::filesystem::rename(tmp_file, file);
+    }
+
+    entry &batch_entry = _entries[proof.batch_id];
+    batch_entry.tx_ids = proof.tx_ids;
+    _max_batch_id = std::max(_max_batch_id, proof.batch_id);
+    for (const uint64_t tx_id : proof.tx_ids) {
+        _tx_batches[tx_id] = proof.batch_id;
+        _max_tx_id = std::max(_max_tx_id, tx_id);
+    }
+    cache(
+        proof.batch_id, batch_entry, std::make_shared<stored_proof>(proof));
+
+    if (_dir.empty()) {
+        // Not cached (cache_size is 0)
+        if (!batch_entry.cached) {
+            remove(proof.batch_id);
+        }
+    } else {
+        while (_entries.size() > _max_stored) {
+            remove(_entries.begin()->first);
+        }
+    }
+}
+
+std::shared_ptr<const stored_proof> proof_store::find_batch(uint64_t batch_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return find_batch_locked(batch_id);
+}
+
+std::shared_ptr<const stored_proof> proof_store::find_transaction(
+    uint64_t tx_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _tx_batches.find(tx_id);
+    if (it == _tx_batches.end()) {
+        return nullptr;
+    }
+    return find_batch_locked(it->second);
+}
+
+size_t proof_store::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+size_t proof_store::num_discarded() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _num_discarded;
+}
+
+uint64_t proof_store::max_batch_id() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max_batch_id;
+}
+
+uint64_t proof_store::max_tx_id() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max_tx_id;
+}
+
+void proof_store::write(std::ostream &out, const stored_proof &proof)
+{
+    out.write(proof_magic, sizeof(proof_magic));
+    write_int(out, proof_version);
+    write_int(out, proof.batch_id);
+    write_int(out, proof.application_names.size());
+    for (const std::string &name : proof.application_names) {
+        write_string(out, name);
+    }
+    write_int(out, proof.tx_ids.size());
+    for (const uint64_t tx_id : proof.tx_ids) {
+        write_int(out, tx_id);
+    }
+    write_string(out, proof.proof);
+    write_string(out, proof.timings);
+    write_string(out, proof.vk_fingerprint);
+}
+
+stored_proof proof_store::read(std::istream &in)
+{
+    char magic[sizeof(proof_magic)];
+    in.read(magic, sizeof(magic));
+    if (!in.good() || memcmp(magic, proof_magic, sizeof(magic))) {
+        throw std::runtime_error("invalid proof");
+    }
+    const uint64_t version = read_int(in);
+    if (version < 1 || version > proof_version) {
+        throw std::runtime_error("unsupported proof version");
+    }
+
+    stored_proof proof;
+    proof.batch_id = read_int(in);
+    const uint64_t num_applications = read_length(in);
+    for (uint64_t i = 0; i < num_applications; ++i) {
+        proof.application_names.push_back(read_string(in));
+    }
+    const uint64_t num_txs = read_length(in);
+    for (uint64_t i = 0; i < num_txs; ++i) {
+        proof.tx_ids.push_back(read_int(in));
+    }
+    proof.proof = read_string(in);
+    if (version >= 2) {
+        proof.timings = read_string(in);
+    }
+    if (version >= 3) {
+        proof.vk_fingerprint = read_string(in);
+    }
+    return proof;
+}
+
+boost::filesystem::path proof_store::batch_file(uint64_t batch_id) const
+{
+    return _dir /
+           (batch_file_prefix + std::to_string(batch_id) + batch_file_suffix);
+}
+
+std::shared_ptr<const stored_proof> proof_store::find_batch_locked(
+    uint64_t batch_id)
+{
+    const auto it = _entries.find(batch_id);
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+
+    entry &batch_entry = it->second;
+    if (batch_entry.cached) {
+        // Most recently used
+        _lru.splice(_lru.begin(), _lru, batch_entry.lru_position);
+        return batch_entry.cached;
+    }
+
+    // Only proofs on disk may not be cached
+    std::ifstream in(
+        batch_file(batch_id).c_str(),
+        std::ios_base::in | std::ios_base::binary);
+    std::shared_ptr<const stored_proof> proof =
+        std::make_shared<stored_proof>(read(in));
+    cache(batch_id, batch_entry, proof);
+    return proof;
+}
+
+void proof_store::cache(
+    uint64_t batch_id,
+    entry &batch_entry,
+    std::shared_ptr<const stored_proof> proof)
+{
+    if (_cache_size == 0) {
+        return;
+    }
+
+    batch_entry.cached = proof;
+    _lru.push_front(batch_id);
+    batch_entry.lru_position = _lru.begin();
+    if (_lru.size() <= _cache_size) {
+        return;
+    }
+
+    // Evict the least recently used proof from memory (and from the store,
+    // if it is not on disk).
+    const uint64_t evicted_batch_id = _lru.back();
+    if (_dir.empty()) {
+        remove(evicted_batch_id);
+    } else {
+        _entries.at(evicted_batch_id).cached.reset();
+        _lru.pop_back();
+    }
+}
+
+void proof_store::remove(uint64_t batch_id)
+{
+    const auto it = _entries.find(batch_id);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    entry &batch_entry = it->second;
+    if (batch_entry.cached) {
+        _lru.erase(batch_entry.lru_position);
+    }
+    for (const uint64_t tx_id : batch_entry.tx_ids) {
+        const auto tx_it = _tx_batches.find(tx_id);
+        if (tx_it != _tx_batches.end() && tx_it->second == batch_id) {
+            _tx_batches.erase(tx_it);
+        }
+    }
+    _entries.erase(it);
+    if (!_dir.empty()) {
+        boost::filesystem::remove(batch_file(batch_id));
+    }
+}
+
+} // namespace libzecale
@@ -0,0 +1,141 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROOF_STORE_HPP__
+#define __ZECALE_CORE_PROOF_STORE_HPP__
+
+#include <boost/filesystem.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libzecale
+{
+
+/// A completed aggregate proof, and the batch it aggregates.
+class stored_proof
+{
+public:
+    /// Identifier of the batch (i.e. of the proving job)
+    uint64_t batch_id;
+    /// Applications of the aggregated transactions
+    std::vector<std::string> application_names;
+    /// Identifiers of the aggregated transactions
+    std::vector<uint64_t> tx_ids;
+    /// The aggregate proof, as serialized by the server
+    std::string proof;
+    /// The timings of the generation of the proof, as serialized by the
+    /// server (empty if unknown)
+    std::string timings;
+    /// Fingerprint of the verification key of the proof (see
+    /// `verification_key_fingerprint`, empty if unknown)
+    std::string vk_fingerprint;
+
+    stored_proof();
+};
+
+/// Fingerprint of a serialized verification key, recorded with the proofs so
+/// that the proofs made with another keypair (e.g. the keypair of a previous
+/// run of the server, if the setup has been run again) are not served. This
+/// detects a change of keypair, it is not a cryptographic digest.
+std::string verification_key_fingerprint(const std::string &vk_bytes);
+
+/// Bounded store of the completed aggregate proofs, so that they can be
+/// fetched again (by batch or by transaction) without generating them again,
+/// e.g. if the client requesting the proof has been disconnected.
+///
+/// The last `cache_size` proofs used are kept in memory. If `dir` is set,
+/// all proofs are also written to `dir` (one file per batch), which holds at
+/// most the `max_stored` most recent batches, and is reloaded when the store
+/// is constructed. Otherwise, proofs evicted from memory are forgotten.
+///
+/// If `vk_fingerprints` is not empty, the proofs of `dir` whose VK
+/// fingerprint is not one of them (i.e. which do not verify against the
+/// current keys) are removed when the store is reloaded. Thread-safe.
+class proof_store
+{
+public:
+    proof_store(
+        size_t cache_size,
+        const boost::filesystem::path &dir = boost::filesystem::path(),
+        size_t max_stored = 0,
+        const std::set<std::string> &vk_fingerprints =
+            std::set<std::string>());
+    proof_store(const proof_store &) = delete;
+    proof_store &operator=(const proof_store &) = delete;
+
+    /// Add a proof, replacing any proof of the same batch. Throws if the
+    /// proof cannot be written to disk.
+    void put(const stored_proof &proof);
+
+    /// The proof of a batch, or null if it is not in the store.
+    std::shared_ptr<const stored_proof> find_batch(uint64_t batch_id);
+
+    /// The proof of the batch containing a transaction, or null if it is not
+    /// in the store.
+    std::shared_ptr<const stored_proof> find_transaction(uint64_t tx_id);
+
+    /// Number of proofs in the store
+    size_t size() const;
+
+    /// Number of proofs removed from `dir` when the store was reloaded,
+    /// because of their VK fingerprint
+    size_t num_discarded() const;
+
+    /// The largest batch and transaction identifiers which have been stored,
+    /// including the removed proofs (0 if none), so that identifiers are not
+    /// reused after a restart.
+    uint64_t max_batch_id() const;
+    uint64_t max_tx_id() const;
+
+    /// Write a proof to a stream, and read it back. Throws
+    /// `std::runtime_error` if the stream does not hold a valid proof.
+    static void write(std::ostream &out, const stored_proof &proof);
+    static stored_proof read(std::istream &in);
+
+private:
+    class entry
+    {
+    public:
+        std::vector<uint64_t> tx_ids;
+        /// The proof, if held in memory
+        std::shared_ptr<const stored_proof> cached;
+        /// Position in `_lru` (if cached)
+        std::list<uint64_t>::iterator lru_position;
+    };
+
+    boost::filesystem::path batch_file(uint64_t batch_id) const;
+    std::shared_ptr<const stored_proof> find_batch_locked(uint64_t batch_id);
+    void cache(
+        uint64_t batch_id,
+        entry &batch_entry,
+        std::shared_ptr<const stored_proof> proof);
+    void remove(uint64_t batch_id);
+
+    const size_t _cache_size;
+    const boost::filesystem::path _dir;
+    const size_t _max_stored;
+
+    mutable std::mutex _mutex;
+    // Ordered by batch identifier, i.e. from the oldest batch
+    std::map<uint64_t, entry> _entries;
+    // Batch of each transaction
+    std::unordered_map<uint64_t, uint64_t> _tx_batches;
+    // Cached batches, the most recently used first
+    std::list<uint64_t> _lru;
+    uint64_t _max_batch_id;
+    uint64_t _max_tx_id;
+    size_t _num_discarded;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_PROOF_STORE_HPP__
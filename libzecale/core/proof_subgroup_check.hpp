@@ -0,0 +1,36 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROOF_SUBGROUP_CHECK_HPP__
+#define __ZECALE_CORE_PROOF_SUBGROUP_CHECK_HPP__
+
+#include <libsnark/zk_proof_systems/ppzksnark/r1cs_gg_ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <libsnark/zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp>
+
+namespace libzecale
+{
+
+/// Whether a point of an elliptic curve is in the subgroup of prime order r
+/// (i.e. G1 or G2), that is [r]P = 0.
+template<typename GroupT> bool is_in_prime_order_subgroup(const GroupT &P);
+
+/// Check natively that the points of a nested proof are on their curves, and
+/// in the subgroups G1 and G2. Throws `std::invalid_argument` otherwise.
+///
+/// The aggregator circuit enforces that the nested proof points are in G1
+/// and G2 (see `bls12_377_G1_membership_check_gadget`), so a single proof
+/// with a point outside of them makes its whole batch unsatisfiable. Proofs
+/// must therefore be checked when they are submitted.
+template<typename ppT>
+void check_proof_points(const libsnark::r1cs_gg_ppzksnark_proof<ppT> &proof);
+
+/// Same as above, for PGHR13 proofs.
+template<typename ppT>
+void check_proof_points(const libsnark::r1cs_ppzksnark_proof<ppT> &proof);
+
+} // namespace libzecale
+
+#include "libzecale/core/proof_subgroup_check.tcc"
+
+#endif // __ZECALE_CORE_PROOF_SUBGROUP_CHECK_HPP__
@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROOF_SUBGROUP_CHECK_TCC__
+#define __ZECALE_CORE_PROOF_SUBGROUP_CHECK_TCC__
+
+#include <stdexcept>
+#include <string>
+
+namespace libzecale
+{
+
+namespace internal
+{
+
+template<typename GroupT>
+void check_proof_point(const GroupT &P, const char *name)
+{
+    if (!P.is_well_formed()) {
+        throw std::invalid_argument(
+            std::string("proof point not on the curve: ") + name);
+    }
+    if (!is_in_prime_order_subgroup(P)) {
+        throw std::invalid_argument(
+            std::string("proof point not in the prime order subgroup: ") +
+            name);
+    }
+}
+
+} // namespace internal
+
+template<typename GroupT> bool is_in_prime_order_subgroup(const GroupT &P)
+{
+    return (GroupT::scalar_field::mod * P).is_zero();
+}
+
+template<typename ppT>
+void check_proof_points(const libsnark::r1cs_gg_ppzksnark_proof<ppT> &proof)
+{
+    internal::check_proof_point(proof.g_A, "A");
+    internal::check_proof_point(proof.g_B, "B");
+    internal::check_proof_point(proof.g_C, "C");
+}
+
+template<typename ppT>
+void check_proof_points(const libsnark::r1cs_ppzksnark_proof<ppT> &proof)
+{
+    internal::check_proof_point(proof.g_A.g, "A");
+    internal::check_proof_point(proof.g_A.h, "A'");
+    internal::check_proof_point(proof.g_B.g, "B");
+    internal::check_proof_point(proof.g_B.h, "B'");
+    internal::check_proof_point(proof.g_C.g, "C");
+    internal::check_proof_point(proof.g_C.h, "C'");
+    internal::check_proof_point(proof.g_H, "H");
+    internal::check_proof_point(proof.g_K, "K");
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_PROOF_SUBGROUP_CHECK_TCC__
@@ -0,0 +1,72 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/prove_timings.hpp"
+
+#include "libzecale/core/metrics.hpp"
+
+#include <algorithm>
+
+namespace libzecale
+{
+
+phase_timing::phase_timing() : wall_seconds(0.0), cpu_seconds(0.0) {}
+
+prove_timings::prove_timings()
+    : peak_rss_bytes(0), num_constraints(0), num_variables(0)
+{
+}
+
+double prove_timings::witness_seconds() const
+{
+    return constraint_generation.wall_seconds +
+           witness_generation.wall_seconds + satisfiability_check.wall_seconds;
+}
+
+double prove_timings::proof_seconds() const
+{
+    return proof_generation.wall_seconds;
+}
+
+std::vector<std::pair<std::string, phase_timing>> prove_timings::phases() const
+{
+    return {
+        {"constraint_generation", constraint_generation},
+        {"witness_generation", witness_generation},
+        {"satisfiability_check", satisfiability_check},
+        {"proof_generation", proof_generation},
+        {"primary_input_extraction", primary_input_extraction},
+    };
+}
+
+prove_phase_timer::prove_phase_timer(prove_timings *timings)
+    : _timings(timings), _phase_start_cpu_seconds(0.0)
+{
+    if (_timings != nullptr) {
+        _phase_start = std::chrono::steady_clock::now();
+        _phase_start_cpu_seconds = process_resource_usage::read().cpu_seconds;
+    }
+}
+
+void prove_phase_timer::end_phase(phase_timing prove_timings::*phase)
+{
+    if (_timings == nullptr) {
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    const process_resource_usage usage = process_resource_usage::read();
+    phase_timing &timing = _timings->*phase;
+    timing.wall_seconds =
+        std::chrono::duration<double>(now - _phase_start).count();
+    timing.cpu_seconds = usage.cpu_seconds - _phase_start_cpu_seconds;
+    _timings->peak_rss_bytes =
+        std::max(_timings->peak_rss_bytes, usage.rss_bytes);
+
+    _phase_start = now;
+    _phase_start_cpu_seconds = usage.cpu_seconds;
+}
+
+} // namespace libzecale
@@ -0,0 +1,86 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROVE_TIMINGS_HPP__
+#define __ZECALE_CORE_PROVE_TIMINGS_HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace libzecale
+{
+
+/// Time spent in a phase of the `prove` functions, in seconds.
+class phase_timing
+{
+public:
+    double wall_seconds;
+    /// CPU time of the process (all threads) during the phase. If several
+    /// proofs are generated concurrently, this includes the CPU time of the
+    /// other proofs.
+    double cpu_seconds;
+
+    phase_timing();
+};
+
+/// Timings and resource usage of a call to the `prove` functions of the
+/// circuit wrappers.
+class prove_timings
+{
+public:
+    /// The phases, in the order in which they run
+    phase_timing constraint_generation;
+    phase_timing witness_generation;
+    /// Check that the witness satisfies the constraints (zero if the batch
+    /// is not checked, see `satisfiability_check_policy`)
+    phase_timing satisfiability_check;
+    phase_timing proof_generation;
+    phase_timing primary_input_extraction;
+
+    /// Largest resident set size of the process at the end of each phase
+    uint64_t peak_rss_bytes;
+
+    /// Size of the aggregation circuit
+    size_t num_constraints;
+    size_t num_variables;
+
+    prove_timings();
+
+    /// Wall-clock time from the start of the constraint generation to the
+    /// end of the satisfiability check
+    double witness_seconds() const;
+
+    /// Wall-clock time of the proof generation, from the witness
+    double proof_seconds() const;
+
+    /// The phases, with their names (e.g. "witness_generation"), in the
+    /// order in which they run
+    std::vector<std::pair<std::string, phase_timing>> phases() const;
+};
+
+/// Measures the consecutive phases of a call to `prove` into a
+/// `prove_timings` (which may be null, in which case nothing is measured).
+class prove_phase_timer
+{
+public:
+    /// Starts the first phase.
+    explicit prove_phase_timer(prove_timings *timings);
+
+    /// End the current phase, record it in the `phase` member of the timings,
+    /// and start the next phase.
+    void end_phase(phase_timing prove_timings::*phase);
+
+private:
+    prove_timings *const _timings;
+    std::chrono::steady_clock::time_point _phase_start;
+    double _phase_start_cpu_seconds;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_PROVE_TIMINGS_HPP__
@@ -0,0 +1,299 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/prover_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace libzecale
+{
+
+size_t cpu_topology::num_cpus() const
+{
+    size_t num_cpus = 0;
+    for (const std::vector<size_t> &node : nodes) {
+        num_cpus += node.size();
+    }
+    return num_cpus;
+}
+
+cpu_topology cpu_topology::detect()
+{
+    cpu_topology topology;
+#ifdef __linux__
+    for (size_t node_idx = 0;; ++node_idx) {
+        std::ifstream in(
+            "/sys/devices/system/node/node" + std::to_string(node_idx) +
+            "/cpulist");
+        if (!in.good()) {
+            break;
+        }
+        std::string cpu_list;
+        std::getline(in, cpu_list);
+        std::vector<size_t> cpus = parse_cpu_list(cpu_list);
+        if (!cpus.empty()) {
+            topology.nodes.push_back(std::move(cpus));
+        }
+    }
+#endif
+
+    if (topology.nodes.empty()) {
+        const size_t num_cpus =
+            std::max<size_t>(1, std::thread::hardware_concurrency());
+        return uniform(1, num_cpus);
+    }
+
+    return topology;
+}
+
+cpu_topology cpu_topology::uniform(size_t num_nodes, size_t cpus_per_node)
+{
+    cpu_topology topology;
+    topology.nodes.resize(num_nodes);
+    for (size_t node_idx = 0; node_idx < num_nodes; ++node_idx) {
+        for (size_t i = 0; i < cpus_per_node; ++i) {
+            topology.nodes[node_idx].push_back(node_idx * cpus_per_node + i);
+        }
+    }
+    return topology;
+}
+
+std::vector<size_t> cpu_topology::parse_cpu_list(const std::string &cpu_list)
+{
+    std::vector<size_t> cpus;
+    std::istringstream ss(cpu_list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        const size_t dash = range.find('-');
+        const size_t first = std::stoul(range.substr(0, dash));
+        const size_t last = (dash == std::string::npos)
+                                ? first
+                                : std::stoul(range.substr(dash + 1));
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+size_t prover_partition::num_workers() const { return worker_cpus.size(); }
+
+size_t prover_partition::threads_per_worker() const
+{
+    size_t threads = 0;
+    for (const std::vector<size_t> &cpus : worker_cpus) {
+        threads = (threads == 0) ? cpus.size() : std::min(threads, cpus.size());
+    }
+    return threads;
+}
+
+prover_partition prover_partition::make(
+    const cpu_topology &topology, size_t num_workers)
+{
+    const size_t num_cpus = topology.num_cpus();
+    if (num_workers == 0 || num_workers > num_cpus) {
+        throw std::invalid_argument("invalid number of prover workers");
+    }
+
+    prover_partition partition;
+    const size_t num_nodes = topology.nodes.size();
+    if (num_workers % num_nodes == 0) {
+        // Split each node between the same number of workers
+        const size_t workers_per_node = num_workers / num_nodes;
+        for (const std::vector<size_t> &node : topology.nodes) {
+            const size_t cpus_per_worker = node.size() / workers_per_node;
+            if (cpus_per_worker == 0) {
+                // Unbalanced nodes: fall back to ignoring the nodes
+                partition.worker_cpus.clear();
+                break;
+            }
+            for (size_t w = 0; w < workers_per_node; ++w) {
+                partition.worker_cpus.emplace_back(
+                    node.begin() + w * cpus_per_worker,
+                    node.begin() + (w + 1) * cpus_per_worker);
+            }
+        }
+        if (!partition.worker_cpus.empty()) {
+            return partition;
+        }
+    }
+
+    // Workers straddle nodes: split the list of all CPUs, in node order
+    std::vector<size_t> all_cpus;
+    for (const std::vector<size_t> &node : topology.nodes) {
+        all_cpus.insert(all_cpus.end(), node.begin(), node.end());
+    }
+    const size_t cpus_per_worker = num_cpus / num_workers;
+    for (size_t w = 0; w < num_workers; ++w) {
+        partition.worker_cpus.emplace_back(
+            all_cpus.begin() + w * cpus_per_worker,
+            all_cpus.begin() + (w + 1) * cpus_per_worker);
+    }
+    return partition;
+}
+
+std::vector<size_t> prover_partition::candidate_num_workers(
+    const cpu_topology &topology)
+{
+    const size_t num_cpus = topology.num_cpus();
+    const size_t num_nodes = std::max<size_t>(1, topology.nodes.size());
+    std::vector<size_t> candidates;
+    for (size_t w = 1; w <= num_cpus; w *= 2) {
+        candidates.push_back(w);
+    }
+    for (size_t w = num_nodes; w <= num_cpus; w *= 2) {
+        candidates.push_back(w);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(
+        std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+prover_partition prover_partition::select(
+    const cpu_topology &topology,
+    const std::function<double(const prover_partition &)> &measure_throughput)
+{
+    prover_partition best_partition;
+    double best_throughput = 0.0;
+    for (size_t num_workers : candidate_num_workers(topology)) {
+        prover_partition partition = make(topology, num_workers);
+        const double throughput = measure_throughput(partition);
+        if (best_partition.worker_cpus.empty() ||
+            throughput > best_throughput) {
+            best_partition = std::move(partition);
+            best_throughput = throughput;
+        }
+    }
+    return best_partition;
+}
+
+double measure_prover_throughput(
+    const prover_partition &partition,
+    const std::function<void()> &prove,
+    size_t proofs_per_worker)
+{
+    const size_t num_proofs = partition.num_workers() * proofs_per_worker;
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    {
+        prover_scheduler scheduler(partition);
+        std::vector<std::future<void>> results;
+        for (size_t i = 0; i < num_proofs; ++i) {
+            results.push_back(scheduler.submit<void>(prove));
+        }
+        for (std::future<void> &result : results) {
+            result.get();
+        }
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return 3600.0 * (double)num_proofs / elapsed.count();
+}
+
+prover_scheduler::prover_scheduler(const prover_partition &partition)
+    : _partition(partition), _num_running(0), _stopping(false)
+{
+    for (size_t w = 0; w < _partition.num_workers(); ++w) {
+        _workers.emplace_back(&prover_scheduler::worker_loop, this, w);
+    }
+}
+
+prover_scheduler::~prover_scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobs_mutex);
+        _stopping = true;
+    }
+    _jobs_cv.notify_all();
+    for (std::thread &worker : _workers) {
+        worker.join();
+    }
+}
+
+bool prover_scheduler::wait_idle(double timeout_seconds)
+{
+    std::unique_lock<std::mutex> lock(_jobs_mutex);
+    auto idle = [this]() { return _jobs.empty() && _num_running == 0; };
+    if (timeout_seconds <= 0.0) {
+        _idle_cv.wait(lock, idle);
+        return true;
+    }
+    return _idle_cv.wait_for(
+        lock, std::chrono::duration<double>(timeout_seconds), idle);
+}
+
+void prover_scheduler::enqueue(std::function<void()> &&job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobs_mutex);
+        if (_stopping) {
+            throw std::runtime_error("prover_scheduler is stopping");
+        }
+        _jobs.push_back(std::move(job));
+    }
+    _jobs_cv.notify_one();
+}
+
+void prover_scheduler::worker_loop(size_t worker_idx)
+{
+    const std::vector<size_t> &cpus = _partition.worker_cpus[worker_idx];
+
+#ifdef __linux__
+    // Pin the worker to its CPUs. The threads of the OpenMP team created by
+    // the worker inherit this affinity.
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (size_t cpu : cpus) {
+        CPU_SET(cpu, &cpu_set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+
+#ifdef MULTICORE
+    // The number of threads is an ICV of the calling thread, so this only
+    // affects the parallel regions started by this worker.
+    omp_set_num_threads((int)cpus.size());
+#endif
+
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_jobs_mutex);
+            _jobs_cv.wait(
+                lock, [this]() { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                // Stopping, and all jobs have been processed
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+            ++_num_running;
+        }
+        job();
+        {
+            std::lock_guard<std::mutex> lock(_jobs_mutex);
+            --_num_running;
+        }
+        _idle_cv.notify_all();
+    }
+}
+
+} // namespace libzecale
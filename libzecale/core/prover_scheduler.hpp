@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROVER_SCHEDULER_HPP__
+#define __ZECALE_CORE_PROVER_SCHEDULER_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libzecale
+{
+
+/// The CPUs of the machine, grouped by NUMA node.
+class cpu_topology
+{
+public:
+    /// CPU ids of each NUMA node
+    std::vector<std::vector<size_t>> nodes;
+
+    size_t num_cpus() const;
+
+    /// Read the topology of the machine from sysfs (on Linux). Falls back to a
+    /// single node of `std::thread::hardware_concurrency()` CPUs if it is not
+    /// available.
+    static cpu_topology detect();
+
+    /// A topology made of `num_nodes` nodes of `cpus_per_node` CPUs.
+    static cpu_topology uniform(size_t num_nodes, size_t cpus_per_node);
+
+    /// Parse a sysfs CPU list (e.g. "0-3,8,10-11").
+    static std::vector<size_t> parse_cpu_list(const std::string &cpu_list);
+};
+
+/// A split of the CPUs between several provers ("workers"), each running one
+/// proof at a time on its own set of CPUs, with an OpenMP team of the same
+/// size.
+class prover_partition
+{
+public:
+    /// CPU ids assigned to each worker
+    std::vector<std::vector<size_t>> worker_cpus;
+
+    size_t num_workers() const;
+
+    /// Number of threads used by each worker for a proof
+    size_t threads_per_worker() const;
+
+    /// Split the CPUs of `topology` between `num_workers` workers of equal
+    /// size. Workers are kept within a single NUMA node whenever
+    /// `num_workers` is a multiple of the number of nodes.
+    static prover_partition make(
+        const cpu_topology &topology, size_t num_workers);
+
+    /// The numbers of workers worth considering for a topology: powers of 2
+    /// (and multiples of the number of nodes), up to one worker per CPU.
+    static std::vector<size_t> candidate_num_workers(
+        const cpu_topology &topology);
+
+    /// Return the partition maximising the throughput, as measured by
+    /// `measure_throughput` (in proofs per hour) for each candidate.
+    static prover_partition select(
+        const cpu_topology &topology,
+        const std::function<double(const prover_partition &)>
+            &measure_throughput);
+};
+
+/// Runs jobs (typically calls to `prove()`) on the workers of a
+/// `prover_partition`. Each worker is a thread pinned to its CPUs, which
+/// processes the queued jobs one at a time. Jobs must not depend on each
+/// other.
+///
+/// The workers run their jobs concurrently, so the jobs must not modify
+/// unsynchronised global state. In particular, libsnark reports the steps of
+/// the setup, witness and proof generation with `libff::enter_block` and
+/// `libff::leave_block`, which update global maps without locking: the
+/// profiling of libff must be disabled (`libff::inhibit_profiling_info` and
+/// `libff::inhibit_profiling_counters`) before running provers on several
+/// workers.
+class prover_scheduler
+{
+public:
+    explicit prover_scheduler(const prover_partition &partition);
+    prover_scheduler(const prover_scheduler &) = delete;
+    prover_scheduler &operator=(const prover_scheduler &) = delete;
+
+    /// Waits for all queued jobs to complete.
+    ~prover_scheduler();
+
+    inline const prover_partition &partition() const
+    {
+        return this->_partition;
+    };
+
+    /// Queue a job, and return a future holding its result (or the exception
+    /// it has thrown).
+    template<typename ResultT>
+    std::future<ResultT> submit(std::function<ResultT()> job);
+
+    /// Wait until no job is queued or running, for at most `timeout_seconds`
+    /// (0 for no limit). Returns false on timeout.
+    bool wait_idle(double timeout_seconds = 0.0);
+
+private:
+    void enqueue(std::function<void()> &&job);
+    void worker_loop(size_t worker_idx);
+
+    prover_partition _partition;
+    std::vector<std::thread> _workers;
+
+    std::mutex _jobs_mutex;
+    std::condition_variable _jobs_cv;
+    std::deque<std::function<void()>> _jobs;
+    // Number of jobs being run by the workers
+    size_t _num_running;
+    // Notified when a job completes
+    std::condition_variable _idle_cv;
+    bool _stopping;
+};
+
+/// Measure the throughput (in proofs per hour) of a partition, by running
+/// `proofs_per_worker` jobs calling `prove` on each of its workers. The calls
+/// run concurrently (see `prover_scheduler` for the profiling of libff).
+double measure_prover_throughput(
+    const prover_partition &partition,
+    const std::function<void()> &prove,
+    size_t proofs_per_worker = 1);
+
+} // namespace libzecale
+
+#include "libzecale/core/prover_scheduler.tcc"
+
+#endif // __ZECALE_CORE_PROVER_SCHEDULER_HPP__
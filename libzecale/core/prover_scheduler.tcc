@@ -0,0 +1,26 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_PROVER_SCHEDULER_TCC__
+#define __ZECALE_CORE_PROVER_SCHEDULER_TCC__
+
+#include <memory>
+
+namespace libzecale
+{
+
+template<typename ResultT>
+std::future<ResultT> prover_scheduler::submit(std::function<ResultT()> job)
+{
+    // std::function requires a copyable callable, hence the shared_ptr.
+    std::shared_ptr<std::packaged_task<ResultT()>> task =
+        std::make_shared<std::packaged_task<ResultT()>>(std::move(job));
+    std::future<ResultT> result = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return result;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_PROVER_SCHEDULER_TCC__
@@ -0,0 +1,71 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/satisfiability_check.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+const char *satisfiability_check_mode_name(satisfiability_check_mode mode)
+{
+    switch (mode) {
+    case satisfiability_check_mode::off:
+        return "off";
+    case satisfiability_check_mode::sampled:
+        return "sampled";
+    case satisfiability_check_mode::always:
+        return "always";
+    }
+    return "unknown";
+}
+
+satisfiability_check_mode satisfiability_check_mode_from_string(
+    const std::string &name)
+{
+    if (name == "off") {
+        return satisfiability_check_mode::off;
+    }
+    if (name == "sampled") {
+        return satisfiability_check_mode::sampled;
+    }
+    if (name == "always") {
+        return satisfiability_check_mode::always;
+    }
+    throw std::invalid_argument("invalid satisfiability check mode: " + name);
+}
+
+satisfiability_check_policy::satisfiability_check_policy(
+    satisfiability_check_mode mode, size_t sample_interval, size_t num_threads)
+    : _mode(mode)
+    , _sample_interval(sample_interval)
+    , _num_threads(std::max<size_t>(num_threads, 1))
+    , _num_batches(0)
+{
+    if (_mode == satisfiability_check_mode::sampled && _sample_interval == 0) {
+        throw std::invalid_argument("sample interval must be positive");
+    }
+}
+
+bool satisfiability_check_policy::should_check()
+{
+    switch (_mode) {
+    case satisfiability_check_mode::off:
+        return false;
+    case satisfiability_check_mode::sampled:
+        return (_num_batches++ % _sample_interval) == 0;
+    case satisfiability_check_mode::always:
+        return true;
+    }
+    return true;
+}
+
+satisfiability_result::satisfiability_result()
+    : satisfied(true), first_unsatisfied_constraint(0)
+{
+}
+
+} // namespace libzecale
@@ -0,0 +1,113 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_SATISFIABILITY_CHECK_HPP__
+#define __ZECALE_CORE_SATISFIABILITY_CHECK_HPP__
+
+#include "libzecale/core/logger.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <libsnark/gadgetlib1/protoboard.hpp>
+#include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+#include <string>
+
+namespace libzecale
+{
+
+/// Batches for which the `prove` functions of the circuit wrappers check
+/// that the witness satisfies the constraints, before generating the proof.
+/// The check is only a diagnostic (an unsatisfied witness yields a proof
+/// which does not verify), but evaluates every constraint of the circuit.
+enum class satisfiability_check_mode {
+    /// No batch
+    off,
+    /// One batch out of `sample_interval`
+    sampled,
+    /// Every batch
+    always,
+};
+
+/// Name of the mode, as used in the configuration ("off", ...).
+const char *satisfiability_check_mode_name(satisfiability_check_mode mode);
+
+/// Parse a mode name. Throws `std::invalid_argument` if the name is not
+/// recognised.
+satisfiability_check_mode satisfiability_check_mode_from_string(
+    const std::string &name);
+
+/// Selects the batches whose witness is checked, and the number of threads
+/// evaluating the constraints. Thread-safe.
+class satisfiability_check_policy
+{
+public:
+    /// `sample_interval` is only used in `sampled` mode, and must then be
+    /// positive.
+    explicit satisfiability_check_policy(
+        satisfiability_check_mode mode = satisfiability_check_mode::always,
+        size_t sample_interval = 1,
+        size_t num_threads = 1);
+    satisfiability_check_policy(const satisfiability_check_policy &) = delete;
+    satisfiability_check_policy &operator=(
+        const satisfiability_check_policy &) = delete;
+
+    inline satisfiability_check_mode mode() const { return this->_mode; }
+    inline size_t num_threads() const { return this->_num_threads; }
+
+    /// Whether to check the witness of the next batch. In `sampled` mode,
+    /// the first batch is checked, and then every `sample_interval`-th.
+    bool should_check();
+
+private:
+    const satisfiability_check_mode _mode;
+    const size_t _sample_interval;
+    const size_t _num_threads;
+    std::atomic<uint64_t> _num_batches;
+};
+
+/// Result of `check_satisfiability`.
+class satisfiability_result
+{
+public:
+    bool satisfied;
+    /// Index of the first unsatisfied constraint (if not `satisfied`)
+    size_t first_unsatisfied_constraint;
+
+    satisfiability_result();
+};
+
+/// Check that a full variable assignment (primary and auxiliary inputs)
+/// satisfies a constraint system, as `r1cs_constraint_system::is_satisfied`,
+/// but evaluating the constraints on `num_threads` threads and reporting the
+/// first unsatisfied constraint. Throws `std::invalid_argument` if the
+/// assignment does not have the size of the constraint system.
+template<typename FieldT>
+satisfiability_result check_satisfiability(
+    const libsnark::r1cs_constraint_system<FieldT> &constraint_system,
+    const libsnark::r1cs_variable_assignment<FieldT> &full_assignment,
+    size_t num_threads);
+
+/// Annotation of a constraint of the protoboard (only recorded if libsnark
+/// is built with DEBUG, empty otherwise).
+template<typename FieldT>
+std::string constraint_annotation(
+    const libsnark::protoboard<FieldT> &pb, size_t constraint_index);
+
+/// If `policy` selects the current batch, check the witness of `pb` against
+/// `constraint_system` and log the result (with the first unsatisfied
+/// constraint, if any). `constraint_system` must be the constraint system of
+/// `pb`, e.g. as held by the proving key, which avoids copying it from the
+/// protoboard.
+template<typename FieldT>
+void check_witness(
+    satisfiability_check_policy &policy,
+    const libsnark::protoboard<FieldT> &pb,
+    const libsnark::r1cs_constraint_system<FieldT> &constraint_system);
+
+} // namespace libzecale
+
+#include "libzecale/core/satisfiability_check.tcc"
+
+#endif // __ZECALE_CORE_SATISFIABILITY_CHECK_HPP__
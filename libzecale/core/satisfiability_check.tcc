@@ -0,0 +1,155 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_SATISFIABILITY_CHECK_TCC__
+#define __ZECALE_CORE_SATISFIABILITY_CHECK_TCC__
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace libzecale
+{
+
+namespace internal
+{
+
+/// Record `index` as unsatisfied, if it is less than the current first
+/// unsatisfied constraint.
+inline void update_first_unsatisfied(
+    std::atomic<size_t> &first_unsatisfied, size_t index)
+{
+    size_t current = first_unsatisfied.load();
+    while (index < current &&
+           !first_unsatisfied.compare_exchange_weak(current, index)) {
+    }
+}
+
+/// Evaluate the constraints [begin, end), stopping at the first unsatisfied
+/// one, or once a constraint before `begin` is known to be unsatisfied.
+template<typename FieldT>
+void check_constraints(
+    const libsnark::r1cs_constraint_system<FieldT> &constraint_system,
+    const libsnark::r1cs_variable_assignment<FieldT> &full_assignment,
+    size_t begin,
+    size_t end,
+    std::atomic<size_t> &first_unsatisfied)
+{
+    for (size_t i = begin; i < end; ++i) {
+        if (first_unsatisfied.load(std::memory_order_relaxed) < begin) {
+            return;
+        }
+        const libsnark::r1cs_constraint<FieldT> &constraint =
+            constraint_system.constraints[i];
+        const FieldT a = constraint.a.evaluate(full_assignment);
+        const FieldT b = constraint.b.evaluate(full_assignment);
+        const FieldT c = constraint.c.evaluate(full_assignment);
+        if (!(a * b == c)) {
+            update_first_unsatisfied(first_unsatisfied, i);
+            return;
+        }
+    }
+}
+
+} // namespace internal
+
+template<typename FieldT>
+satisfiability_result check_satisfiability(
+    const libsnark::r1cs_constraint_system<FieldT> &constraint_system,
+    const libsnark::r1cs_variable_assignment<FieldT> &full_assignment,
+    size_t num_threads)
+{
+    if (full_assignment.size() != constraint_system.num_variables()) {
+        throw std::invalid_argument(
+            "assignment does not match the constraint system");
+    }
+
+    const size_t num_constraints = constraint_system.num_constraints();
+    std::atomic<size_t> first_unsatisfied(num_constraints);
+    num_threads = std::max<size_t>(
+        1, std::min<size_t>(num_threads, num_constraints));
+    if (num_threads == 1) {
+        internal::check_constraints(
+            constraint_system,
+            full_assignment,
+            0,
+            num_constraints,
+            first_unsatisfied);
+    } else {
+        // Contiguous ranges of constraints, so that each thread stops at the
+        // first unsatisfied constraint of its range.
+        const size_t range_size =
+            (num_constraints + num_threads - 1) / num_threads;
+        std::vector<std::thread> threads;
+        for (size_t begin = 0; begin < num_constraints; begin += range_size) {
+            const size_t end = std::min(begin + range_size, num_constraints);
+            threads.emplace_back([&, begin, end]() {
+                internal::check_constraints(
+                    constraint_system,
+                    full_assignment,
+                    begin,
+                    end,
+                    first_unsatisfied);
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    satisfiability_result result;
+    result.satisfied = (first_unsatisfied == num_constraints);
+    if (!result.satisfied) {
+        result.first_unsatisfied_constraint = first_unsatisfied;
+    }
+    return result;
+}
+
+template<typename FieldT>
+std::string constraint_annotation(
+    const libsnark::protoboard<FieldT> &pb, size_t constraint_index)
+{
+#ifdef DEBUG
+    const libsnark::r1cs_constraint_system<FieldT> constraint_system =
+        pb.get_constraint_system();
+    const auto it =
+        constraint_system.constraint_annotations.find(constraint_index);
+    if (it != constraint_system.constraint_annotations.end()) {
+        return it->second;
+    }
+#else
+    (void)pb;
+    (void)constraint_index;
+#endif
+    return "";
+}
+
+template<typename FieldT>
+void check_witness(
+    satisfiability_check_policy &policy,
+    const libsnark::protoboard<FieldT> &pb,
+    const libsnark::r1cs_constraint_system<FieldT> &constraint_system)
+{
+    if (!policy.should_check()) {
+        return;
+    }
+
+    const satisfiability_result result = check_satisfiability(
+        constraint_system, pb.full_variable_assignment(), policy.num_threads());
+    if (result.satisfied) {
+        log_stream(log_level::debug) << "Witness satisfies the constraints";
+        return;
+    }
+
+    log_stream(log_level::warning)
+        << "Witness does not satisfy constraint "
+        << result.first_unsatisfied_constraint << " ("
+        << constraint_annotation(pb, result.first_unsatisfied_constraint)
+        << ")";
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_SATISFIABILITY_CHECK_TCC__
@@ -0,0 +1,107 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/server_config.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace libzecale
+{
+
+const char *ingest_policy_name(ingest_policy policy)
+{
+    switch (policy) {
+    case ingest_policy::reject:
+        return "reject";
+    case ingest_policy::evict_lowest_fee:
+        return "evict-lowest-fee";
+    }
+    return "unknown";
+}
+
+ingest_policy ingest_policy_from_string(const std::string &name)
+{
+    if (name == "reject") {
+        return ingest_policy::reject;
+    }
+    if (name == "evict-lowest-fee") {
+        return ingest_policy::evict_lowest_fee;
+    }
+    throw std::invalid_argument("invalid ingest policy: " + name);
+}
+
+server_config::server_config()
+    : listen_address("0.0.0.0:50052")
+    , num_completion_queues(1)
+    , num_polling_threads(2)
+    , max_concurrent_streams(0)
+    , max_message_size(0)
+    , max_pool_size(0)
+    , pool_full_policy(ingest_policy::reject)
+    , target_time_to_proof_seconds(0.0)
+    , congested_min_fee_wei(0)
+    , max_application_share(1.0)
+    , max_time_to_proof_seconds(0.0)
+    , pool_snapshot_file()
+    , drain_timeout_seconds(0.0)
+    , proof_cache_size(16)
+    , proof_store_dir()
+    , max_stored_proofs(1024)
+    , satisfiability_check(satisfiability_check_mode::sampled)
+    , satisfiability_check_interval(100)
+{
+}
+
+void server_config::validate() const
+{
+    if (listen_address.empty()) {
+        throw std::invalid_argument("listen address not set");
+    }
+    if (num_completion_queues == 0) {
+        throw std::invalid_argument("at least one completion queue required");
+    }
+    if (num_polling_threads == 0) {
+        throw std::invalid_argument("at least one polling thread required");
+    }
+    // gRPC takes these settings as int
+    const size_t max_int = (size_t)std::numeric_limits<int>::max();
+    if (max_concurrent_streams > max_int) {
+        throw std::invalid_argument("max concurrent streams too large");
+    }
+    if (max_message_size > max_int) {
+        throw std::invalid_argument("max message size too large");
+    }
+    if (target_time_to_proof_seconds < 0.0 || max_time_to_proof_seconds < 0.0) {
+        throw std::invalid_argument("negative time-to-proof");
+    }
+    if (max_application_share <= 0.0 || max_application_share > 1.0) {
+        throw std::invalid_argument("application share must be in (0, 1]");
+    }
+    if (drain_timeout_seconds < 0.0) {
+        throw std::invalid_argument("negative drain timeout");
+    }
+    if (!proof_store_dir.empty() && max_stored_proofs == 0) {
+        throw std::invalid_argument("at least one stored proof required");
+    }
+    if (satisfiability_check == satisfiability_check_mode::sampled &&
+        satisfiability_check_interval == 0) {
+        throw std::invalid_argument("satisfiability check interval is zero");
+    }
+}
+
+ingest_decision server_config::decide_ingest(
+    size_t pool_size, uint32_t lowest_fee_wei, uint32_t fee_wei) const
+{
+    if (max_pool_size == 0 || pool_size < max_pool_size) {
+        return ingest_decision::accept;
+    }
+    if (pool_full_policy == ingest_policy::evict_lowest_fee && pool_size > 0 &&
+        fee_wei > lowest_fee_wei) {
+        return ingest_decision::evict_and_accept;
+    }
+    return ingest_decision::reject;
+}
+
+} // namespace libzecale
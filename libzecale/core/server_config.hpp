@@ -0,0 +1,111 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_CORE_SERVER_CONFIG_HPP__
+#define __ZECALE_CORE_SERVER_CONFIG_HPP__
+
+#include "libzecale/core/satisfiability_check.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace libzecale
+{
+
+/// Behaviour of the server when a transaction is submitted for an
+/// application whose pool is full.
+enum class ingest_policy {
+    /// Reject the transaction (RESOURCE_EXHAUSTED)
+    reject,
+    /// Evict the lowest fee transaction of the pool if the submitted
+    /// transaction pays a higher fee, and reject it otherwise
+    evict_lowest_fee,
+};
+
+/// Name of the policy, as used in the configuration ("reject", ...).
+const char *ingest_policy_name(ingest_policy policy);
+
+/// Parse a policy name. Throws `std::invalid_argument` if the name is not
+/// recognised.
+ingest_policy ingest_policy_from_string(const std::string &name);
+
+/// Outcome of the submission of a transaction to a pool.
+enum class ingest_decision {
+    accept,
+    /// Accept the transaction after evicting the lowest fee transaction
+    evict_and_accept,
+    reject,
+};
+
+/// Settings of the aggregator server: listening address, threading model of
+/// the gRPC server, and resource limits.
+class server_config
+{
+public:
+    /// Address (host:port) on which the gRPC server listens
+    std::string listen_address;
+    /// Number of gRPC completion queues
+    size_t num_completion_queues;
+    /// Number of threads polling each completion queue (and running the
+    /// handlers of the requests which do not generate a proof)
+    size_t num_polling_threads;
+    /// Maximum number of concurrent streams (i.e. calls in progress) per
+    /// client connection (0 for the gRPC default)
+    size_t max_concurrent_streams;
+    /// Maximum size of the messages received and sent, in bytes (0 for the
+    /// gRPC default)
+    size_t max_message_size;
+    /// Maximum number of transactions in the pool of an application (0 for
+    /// no limit)
+    size_t max_pool_size;
+    /// Behaviour when the pool of an application is full
+    ingest_policy pool_full_policy;
+    /// Estimated time-to-proof (see `admission_controller`), in seconds,
+    /// above which the prover is considered congested (0 to disable the
+    /// admission control). While congested, transactions must pay at least
+    /// `congested_min_fee_wei`, and each application may hold at most
+    /// `max_application_share` of the pending transactions.
+    double target_time_to_proof_seconds;
+    uint32_t congested_min_fee_wei;
+    double max_application_share;
+    /// Estimated time-to-proof above which all transactions are rejected (0
+    /// for no limit)
+    double max_time_to_proof_seconds;
+    /// File in which the pending transactions are written on shutdown, and
+    /// from which they are reloaded on start (empty to disable)
+    std::string pool_snapshot_file;
+    /// Maximum time, in seconds, to wait on shutdown for the running proofs
+    /// to complete (0 for no limit). Batches whose proof is not generated are
+    /// written back to the pool snapshot.
+    double drain_timeout_seconds;
+    /// Number of completed aggregate proofs kept in memory, to be fetched
+    /// again by the clients (see `proof_store`)
+    size_t proof_cache_size;
+    /// Directory in which the completed aggregate proofs are kept (empty to
+    /// only keep them in memory), and maximum number of proofs in it
+    std::string proof_store_dir;
+    size_t max_stored_proofs;
+    /// Batches whose witness is checked against the constraints before
+    /// proving (see `satisfiability_check_policy`), and interval between the
+    /// checked batches in `sampled` mode
+    satisfiability_check_mode satisfiability_check;
+    size_t satisfiability_check_interval;
+
+    /// The default configuration
+    server_config();
+
+    /// Throws `std::invalid_argument` if a setting is invalid.
+    void validate() const;
+
+    /// Decide what to do with a transaction paying `fee_wei`, submitted to a
+    /// pool of `pool_size` transactions whose lowest fee is
+    /// `lowest_fee_wei` (ignored if the pool is empty).
+    ingest_decision decide_ingest(
+        size_t pool_size, uint32_t lowest_fee_wei, uint32_t fee_wei) const;
+};
+
+} // namespace libzecale
+
+#endif // __ZECALE_CORE_SERVER_CONFIG_HPP__
@@ -6,6 +6,9 @@
 #define __ZECALE_TYPES_TRANSACTION_TO_AGGREGATE_HPP__
 
 #include <array>
+#include <chrono>
+#include <memory>
+#include <string>
 #include <libzeth/core/extended_proof.hpp>
 
 namespace libzecale
@@ -20,17 +23,33 @@ private:
     std::string _application_name;
     std::shared_ptr<libzeth::extended_proof<nppT, nsnarkT>> _extended_proof;
     uint32_t _fee_wei;
+    std::chrono::steady_clock::time_point _received_time;
     // TODO: switch to something better like a hash
-    // size_t identifier;
+    uint64_t _id;
 
 public:
-    transaction_to_aggregate(){};
+    transaction_to_aggregate() : _fee_wei(0), _id(0){};
     transaction_to_aggregate(
         const std::string &application_name,
         const libzeth::extended_proof<nppT, nsnarkT> &extended_proof,
         uint32_t fee_wei = 0);
+    /// Construct from an extended proof which is moved into the (single)
+    /// shared allocation held by the transaction. This is the constructor
+    /// used on the ingest path, so that the proof parsed from the request is
+    /// never copied.
+    transaction_to_aggregate(
+        std::string &&application_name,
+        libzeth::extended_proof<nppT, nsnarkT> &&extended_proof,
+        uint32_t fee_wei = 0);
+    transaction_to_aggregate(const transaction_to_aggregate &other) = default;
+    transaction_to_aggregate(transaction_to_aggregate &&other) = default;
     virtual ~transaction_to_aggregate(){};
 
+    transaction_to_aggregate &operator=(
+        const transaction_to_aggregate &other) = default;
+    transaction_to_aggregate &operator=(transaction_to_aggregate &&other) =
+        default;
+
     inline const std::string &application_name() const
     {
         return this->_application_name;
@@ -43,6 +62,18 @@ public:
 
     inline uint32_t fee_wei() const { return this->_fee_wei; };
 
+    /// Identifier assigned by the aggregator when the transaction is received
+    /// (0 if not assigned).
+    inline uint64_t id() const { return this->_id; };
+    inline void set_id(uint64_t id) { this->_id = id; };
+
+    /// Time at which the transaction was constructed, i.e. received by the
+    /// aggregator (used to measure the end-to-end latency).
+    inline std::chrono::steady_clock::time_point received_time() const
+    {
+        return this->_received_time;
+    };
+
     std::ostream &write_json(std::ostream &) const;
 
     /// Overload the less-than operator in order to compare objects in priority
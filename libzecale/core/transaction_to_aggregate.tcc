@@ -13,13 +13,30 @@ transaction_to_aggregate<nppT, nsnarkT>::transaction_to_aggregate(
     const std::string &application_name,
     const libzeth::extended_proof<nppT, nsnarkT> &extended_proof,
     uint32_t fee_wei)
-    : _application_name(application_name), _fee_wei(fee_wei)
+    : _application_name(application_name)
+    , _fee_wei(fee_wei)
+    , _received_time(std::chrono::steady_clock::now())
+    , _id(0)
 {
     this->_extended_proof =
         std::make_shared<libzeth::extended_proof<nppT, nsnarkT>>(
             extended_proof);
 }
 
+template<typename nppT, typename nsnarkT>
+transaction_to_aggregate<nppT, nsnarkT>::transaction_to_aggregate(
+    std::string &&application_name,
+    libzeth::extended_proof<nppT, nsnarkT> &&extended_proof,
+    uint32_t fee_wei)
+    : _application_name(std::move(application_name))
+    , _extended_proof(std::make_shared<libzeth::extended_proof<nppT, nsnarkT>>(
+          std::move(extended_proof)))
+    , _fee_wei(fee_wei)
+    , _received_time(std::chrono::steady_clock::now())
+    , _id(0)
+{
+}
+
 template<typename nppT, typename nsnarkT>
 std::ostream &transaction_to_aggregate<nppT, nsnarkT>::write_json(
     std::ostream &os) const
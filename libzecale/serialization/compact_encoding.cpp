@@ -0,0 +1,95 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/serialization/compact_encoding.hpp"
+
+#include <stdexcept>
+
+namespace libzecale
+{
+
+namespace
+{
+
+const uint8_t compact_format_version = 1;
+const uint8_t compact_flag_compressed_points = 0x01;
+
+} // namespace
+
+compact_writer::compact_writer(std::string &out, bool compress_points)
+    : _out(out), _compress_points(compress_points)
+{
+}
+
+uint8_t *compact_writer::append(size_t num_bytes)
+{
+    const size_t pos = _out.size();
+    _out.resize(pos + num_bytes, '\0');
+    return (uint8_t *)&_out[pos];
+}
+
+void compact_writer::write_uint8(uint8_t value) { *append(1) = value; }
+
+void compact_writer::write_uint32(uint32_t value)
+{
+    uint8_t *out = append(4);
+    for (size_t i = 0; i < 4; ++i) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+compact_reader::compact_reader(const std::string &in)
+    : _in(in), _pos(0), _compress_points(false)
+{
+}
+
+const uint8_t *compact_reader::consume(size_t num_bytes)
+{
+    if (num_bytes > remaining()) {
+        throw std::invalid_argument("truncated compact encoding");
+    }
+    const uint8_t *data = (const uint8_t *)_in.data() + _pos;
+    _pos += num_bytes;
+    return data;
+}
+
+uint8_t compact_reader::read_uint8() { return *consume(1); }
+
+uint32_t compact_reader::read_uint32()
+{
+    const uint8_t *in = consume(4);
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        value |= ((uint32_t)in[i]) << (8 * i);
+    }
+    return value;
+}
+
+void compact_reader::check_end() const
+{
+    if (_pos != _in.size()) {
+        throw std::invalid_argument("trailing bytes in compact encoding");
+    }
+}
+
+void compact_write_header(compact_writer &writer)
+{
+    writer.write_uint8(compact_format_version);
+    writer.write_uint8(
+        writer.compress_points() ? compact_flag_compressed_points : 0);
+}
+
+void compact_read_header(compact_reader &reader)
+{
+    if (reader.read_uint8() != compact_format_version) {
+        throw std::invalid_argument("unsupported compact encoding version");
+    }
+    const uint8_t flags = reader.read_uint8();
+    if ((flags & ~compact_flag_compressed_points) != 0) {
+        throw std::invalid_argument("unknown compact encoding flags");
+    }
+    reader.set_compress_points((flags & compact_flag_compressed_points) != 0);
+}
+
+} // namespace libzecale
@@ -0,0 +1,139 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_SERIALIZATION_COMPACT_ENCODING_HPP__
+#define __ZECALE_SERIALIZATION_COMPACT_ENCODING_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <libzeth/core/extended_proof.hpp>
+#include <string>
+
+/// Compact binary encoding of the nested proofs and verification keys, used
+/// by the `compact_*` fields of the aggregator API as an alternative to the
+/// (hexadecimal) zeth_proto messages, which are several times larger and
+/// slower to parse:
+///
+/// - field elements are fixed-width little-endian integers (in canonical,
+///   not Montgomery, form) of ceil(log2(p) / 8) bytes. The elements of
+///   extension fields are the concatenation of their coefficients, c0 first.
+/// - group elements are a flag byte followed by affine coordinates:
+///     0x00: the point at infinity (the coordinates are zero)
+///     0x01: x and y
+///     0x02 | s: x only (compressed), where s is the sign of y, i.e. the
+///           parity of its first non-zero coefficient
+/// - vectors are a 32-bit little-endian number of elements, followed by the
+///   elements.
+///
+/// An encoded proof or key starts with a format version byte and a byte of
+/// flags (bit 0: compressed points). Points are compressed by default if the
+/// build enables point compression (USE_PT_COMPRESSION). Decoding accepts
+/// both forms, and throws `std::invalid_argument` on malformed input
+/// (including points not on the curve).
+
+namespace libzecale
+{
+
+/// Whether the encoder compresses points by default
+#ifdef NO_PT_COMPRESSION
+static const bool compact_default_point_compression = false;
+#else
+static const bool compact_default_point_compression = true;
+#endif
+
+/// Appends the encoding of values to a string.
+class compact_writer
+{
+public:
+    compact_writer(std::string &out, bool compress_points);
+
+    inline bool compress_points() const { return this->_compress_points; }
+
+    /// Append `num_bytes` bytes (initially 0) and return their address,
+    /// valid until the next call.
+    uint8_t *append(size_t num_bytes);
+    void write_uint8(uint8_t value);
+    void write_uint32(uint32_t value);
+
+private:
+    std::string &_out;
+    const bool _compress_points;
+};
+
+/// Reads encoded values from a buffer.
+class compact_reader
+{
+public:
+    /// Points are read as compressed or not depending on the header (see
+    /// `compact_read_header`). `in` must outlive the reader.
+    explicit compact_reader(const std::string &in);
+
+    inline bool compress_points() const { return this->_compress_points; }
+    inline void set_compress_points(bool compress_points)
+    {
+        this->_compress_points = compress_points;
+    }
+
+    /// Consume `num_bytes` bytes and return their address. Throws if the
+    /// buffer is too short.
+    const uint8_t *consume(size_t num_bytes);
+    uint8_t read_uint8();
+    uint32_t read_uint32();
+
+    /// Number of bytes left to consume
+    inline size_t remaining() const { return this->_in.size() - this->_pos; }
+
+    /// Throws if the buffer has not been entirely consumed.
+    void check_end() const;
+
+private:
+    const std::string &_in;
+    size_t _pos;
+    bool _compress_points;
+};
+
+/// Write the header of an encoded proof or key.
+void compact_write_header(compact_writer &writer);
+
+/// Read the header of an encoded proof or key, and set the point compression
+/// of `reader` accordingly.
+void compact_read_header(compact_reader &reader);
+
+template<typename FieldT>
+void field_element_write_compact(compact_writer &writer, const FieldT &el);
+
+template<typename FieldT>
+FieldT field_element_read_compact(compact_reader &reader);
+
+template<typename GroupT>
+void group_element_write_compact(compact_writer &writer, const GroupT &g);
+
+template<typename GroupT>
+GroupT group_element_read_compact(compact_reader &reader);
+
+/// Encode an extended proof (of a snark supported by libzeth).
+template<typename ppT, typename snarkT>
+std::string extended_proof_to_compact(
+    const libzeth::extended_proof<ppT, snarkT> &ext_proof,
+    bool compress_points = compact_default_point_compression);
+
+template<typename ppT, typename snarkT>
+libzeth::extended_proof<ppT, snarkT> extended_proof_from_compact(
+    const std::string &bytes);
+
+/// Encode a verification key (of a snark supported by libzeth).
+template<typename snarkT>
+std::string verification_key_to_compact(
+    const typename snarkT::verification_key &vk,
+    bool compress_points = compact_default_point_compression);
+
+template<typename snarkT>
+typename snarkT::verification_key verification_key_from_compact(
+    const std::string &bytes);
+
+} // namespace libzecale
+
+#include "libzecale/serialization/compact_encoding.tcc"
+
+#endif // __ZECALE_SERIALIZATION_COMPACT_ENCODING_HPP__
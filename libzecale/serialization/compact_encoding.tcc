@@ -0,0 +1,481 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef __ZECALE_SERIALIZATION_COMPACT_ENCODING_TCC__
+#define __ZECALE_SERIALIZATION_COMPACT_ENCODING_TCC__
+
+#include "libzecale/serialization/compact_encoding.hpp"
+
+#include <libff/algebra/fields/bigint.hpp>
+#include <libff/algebra/fields/fp.hpp>
+#include <libff/algebra/fields/fp2.hpp>
+#include <libff/algebra/fields/fp3.hpp>
+#include <libsnark/zk_proof_systems/ppzksnark/r1cs_gg_ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <libsnark/zk_proof_systems/ppzksnark/r1cs_ppzksnark/r1cs_ppzksnark.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace libzecale
+{
+
+namespace internal
+{
+
+static const uint8_t compact_point_zero = 0x00;
+static const uint8_t compact_point_uncompressed = 0x01;
+static const uint8_t compact_point_compressed = 0x02;
+
+/// Fixed-width encoding of the elements of a field (specialised below for
+/// the prime fields and their extensions used by the curves).
+template<typename FieldT> class compact_field_codec;
+
+template<mp_size_t n, const libff::bigint<n> &modulus>
+class compact_field_codec<libff::Fp_model<n, modulus>>
+{
+public:
+    using field = libff::Fp_model<n, modulus>;
+
+    static size_t num_bytes()
+    {
+        static const size_t bytes = (modulus.num_bits() + 7) / 8;
+        return bytes;
+    }
+
+    static void write(const field &el, uint8_t *out)
+    {
+        const libff::bigint<n> value = el.as_bigint();
+        const size_t limb_bytes = sizeof(mp_limb_t);
+        const size_t bytes = num_bytes();
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = (uint8_t)(
+                value.data[i / limb_bytes] >> (8 * (i % limb_bytes)));
+        }
+    }
+
+    static field read(const uint8_t *in)
+    {
+        libff::bigint<n> value;
+        value.clear();
+        const size_t limb_bytes = sizeof(mp_limb_t);
+        const size_t bytes = num_bytes();
+        for (size_t i = 0; i < bytes; ++i) {
+            value.data[i / limb_bytes] |= ((mp_limb_t)in[i])
+                                          << (8 * (i % limb_bytes));
+        }
+        if (mpn_cmp(value.data, modulus.data, n) >= 0) {
+            throw std::invalid_argument("field element out of range");
+        }
+        return field(value);
+    }
+
+    /// Parity of the canonical representation
+    static bool sign(const field &el)
+    {
+        return (el.as_bigint().data[0] & 1) != 0;
+    }
+};
+
+template<mp_size_t n, const libff::bigint<n> &modulus>
+class compact_field_codec<libff::Fp2_model<n, modulus>>
+{
+public:
+    using field = libff::Fp2_model<n, modulus>;
+    using base_codec = compact_field_codec<typename field::my_Fp>;
+
+    static size_t num_bytes() { return 2 * base_codec::num_bytes(); }
+
+    static void write(const field &el, uint8_t *out)
+    {
+        base_codec::write(el.c0, out);
+        base_codec::write(el.c1, out + base_codec::num_bytes());
+    }
+
+    static field read(const uint8_t *in)
+    {
+        const size_t base_bytes = base_codec::num_bytes();
+        return field(base_codec::read(in), base_codec::read(in + base_bytes));
+    }
+
+    static bool sign(const field &el)
+    {
+        return el.c0.is_zero() ? base_codec::sign(el.c1)
+                               : base_codec::sign(el.c0);
+    }
+};
+
+template<mp_size_t n, const libff::bigint<n> &modulus>
+class compact_field_codec<libff::Fp3_model<n, modulus>>
+{
+public:
+    using field = libff::Fp3_model<n, modulus>;
+    using base_codec = compact_field_codec<typename field::my_Fp>;
+
+    static size_t num_bytes() { return 3 * base_codec::num_bytes(); }
+
+    static void write(const field &el, uint8_t *out)
+    {
+        const size_t base_bytes = base_codec::num_bytes();
+        base_codec::write(el.c0, out);
+        base_codec::write(el.c1, out + base_bytes);
+        base_codec::write(el.c2, out + 2 * base_bytes);
+    }
+
+    static field read(const uint8_t *in)
+    {
+        const size_t base_bytes = base_codec::num_bytes();
+        return field(
+            base_codec::read(in),
+            base_codec::read(in + base_bytes),
+            base_codec::read(in + 2 * base_bytes));
+    }
+
+    static bool sign(const field &el)
+    {
+        if (!el.c0.is_zero()) {
+            return base_codec::sign(el.c0);
+        }
+        return el.c1.is_zero() ? base_codec::sign(el.c2)
+                               : base_codec::sign(el.c1);
+    }
+};
+
+/// Encoding of the points of a curve in short Weierstrass form, with
+/// coordinates in any field supported by `compact_field_codec`.
+template<typename GroupT> class compact_group_codec
+{
+public:
+    using coordinate = typename std::decay<decltype(GroupT().X)>::type;
+    using coordinate_codec = compact_field_codec<coordinate>;
+
+    static size_t num_bytes(bool compressed)
+    {
+        return 1 + (compressed ? 1 : 2) * coordinate_codec::num_bytes();
+    }
+
+    static void write(compact_writer &writer, const GroupT &g)
+    {
+        const bool compressed = writer.compress_points();
+        // The coordinates of the point at infinity are left to 0.
+        uint8_t *out = writer.append(num_bytes(compressed));
+        if (g.is_zero()) {
+            out[0] = compact_point_zero;
+            return;
+        }
+
+        GroupT affine(g);
+        affine.to_affine_coordinates();
+        coordinate_codec::write(affine.X, out + 1);
+        if (compressed) {
+            out[0] = compact_point_compressed |
+                     (coordinate_codec::sign(affine.Y) ? 1 : 0);
+        } else {
+            out[0] = compact_point_uncompressed;
+            coordinate_codec::write(
+                affine.Y, out + 1 + coordinate_codec::num_bytes());
+        }
+    }
+
+    static GroupT read(compact_reader &reader)
+    {
+        const bool compressed = reader.compress_points();
+        const uint8_t *in = reader.consume(num_bytes(compressed));
+        const uint8_t flag = in[0];
+        if (flag == compact_point_zero) {
+            return GroupT::zero();
+        }
+
+        const coordinate x = coordinate_codec::read(in + 1);
+        coordinate y;
+        if (!compressed && flag == compact_point_uncompressed) {
+            y = coordinate_codec::read(in + 1 + coordinate_codec::num_bytes());
+        } else if (compressed && (flag & ~1) == compact_point_compressed) {
+            y = recover_y(x, (flag & 1) != 0);
+        } else {
+            throw std::invalid_argument("invalid point encoding");
+        }
+
+        GroupT g(x, y, coordinate::one());
+        if (!g.is_well_formed()) {
+            throw std::invalid_argument("point not on the curve");
+        }
+        return g;
+    }
+
+private:
+    /// The coefficients (a, b) of the curve equation y^2 = x^3 + a.x + b,
+    /// computed from two points of the group, so that no curve-specific
+    /// parameter is needed.
+    static std::pair<coordinate, coordinate> curve_coefficients()
+    {
+        GroupT p1 = GroupT::one();
+        p1.to_affine_coordinates();
+        GroupT p2 = GroupT::one().dbl();
+        p2.to_affine_coordinates();
+        // r_i = y_i^2 - x_i^3 = a.x_i + b
+        const coordinate r1 = p1.Y.squared() - p1.X.squared() * p1.X;
+        const coordinate r2 = p2.Y.squared() - p2.X.squared() * p2.X;
+        const coordinate a = (r1 - r2) * (p1.X - p2.X).inverse();
+        return std::make_pair(a, r1 - a * p1.X);
+    }
+
+    static coordinate recover_y(const coordinate &x, bool sign)
+    {
+        static const std::pair<coordinate, coordinate> a_b =
+            curve_coefficients();
+        const coordinate y2 = x.squared() * x + a_b.first * x + a_b.second;
+        // `sqrt()` does not terminate on non-residues: check the Euler
+        // criterion first.
+        if (!y2.is_zero() && (y2 ^ coordinate::euler) != coordinate::one()) {
+            throw std::invalid_argument("point not on the curve");
+        }
+        coordinate y = y2.sqrt();
+        if (coordinate_codec::sign(y) != sign) {
+            y = -y;
+        }
+        return y;
+    }
+};
+
+template<typename GroupT>
+void accumulation_vector_write_compact(
+    compact_writer &writer, const libsnark::accumulation_vector<GroupT> &acc)
+{
+    group_element_write_compact(writer, acc.first);
+    writer.write_uint32((uint32_t)acc.rest.values.size());
+    for (size_t i = 0; i < acc.rest.values.size(); ++i) {
+        if (acc.rest.indices[i] != i) {
+            throw std::invalid_argument("sparse accumulation vector");
+        }
+        group_element_write_compact(writer, acc.rest.values[i]);
+    }
+}
+
+template<typename GroupT>
+libsnark::accumulation_vector<GroupT> accumulation_vector_read_compact(
+    compact_reader &reader)
+{
+    GroupT first = group_element_read_compact<GroupT>(reader);
+    const size_t num_elements = reader.read_uint32();
+    // Check the size before allocating anything.
+    if (num_elements >
+        reader.remaining() /
+            compact_group_codec<GroupT>::num_bytes(reader.compress_points())) {
+        throw std::invalid_argument("truncated compact encoding");
+    }
+    std::vector<GroupT> rest;
+    rest.reserve(num_elements);
+    for (size_t i = 0; i < num_elements; ++i) {
+        rest.push_back(group_element_read_compact<GroupT>(reader));
+    }
+    return libsnark::accumulation_vector<GroupT>(
+        std::move(first), std::move(rest));
+}
+
+// Groth16
+
+template<typename ppT>
+void proof_write_compact(
+    compact_writer &writer, const libsnark::r1cs_gg_ppzksnark_proof<ppT> &proof)
+{
+    group_element_write_compact(writer, proof.g_A);
+    group_element_write_compact(writer, proof.g_B);
+    group_element_write_compact(writer, proof.g_C);
+}
+
+template<typename ppT>
+void proof_read_compact(
+    compact_reader &reader, libsnark::r1cs_gg_ppzksnark_proof<ppT> &proof)
+{
+    proof.g_A = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_B = group_element_read_compact<libff::G2<ppT>>(reader);
+    proof.g_C = group_element_read_compact<libff::G1<ppT>>(reader);
+}
+
+template<typename ppT>
+void verification_key_write_compact(
+    compact_writer &writer,
+    const libsnark::r1cs_gg_ppzksnark_verification_key<ppT> &vk)
+{
+    group_element_write_compact(writer, vk.alpha_g1);
+    group_element_write_compact(writer, vk.beta_g2);
+    group_element_write_compact(writer, vk.delta_g2);
+    accumulation_vector_write_compact(writer, vk.ABC_g1);
+}
+
+template<typename ppT>
+void verification_key_read_compact(
+    compact_reader &reader,
+    libsnark::r1cs_gg_ppzksnark_verification_key<ppT> &vk)
+{
+    vk.alpha_g1 = group_element_read_compact<libff::G1<ppT>>(reader);
+    vk.beta_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.delta_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.ABC_g1 = accumulation_vector_read_compact<libff::G1<ppT>>(reader);
+}
+
+// PGHR13
+
+template<typename ppT>
+void proof_write_compact(
+    compact_writer &writer, const libsnark::r1cs_ppzksnark_proof<ppT> &proof)
+{
+    group_element_write_compact(writer, proof.g_A.g);
+    group_element_write_compact(writer, proof.g_A.h);
+    group_element_write_compact(writer, proof.g_B.g);
+    group_element_write_compact(writer, proof.g_B.h);
+    group_element_write_compact(writer, proof.g_C.g);
+    group_element_write_compact(writer, proof.g_C.h);
+    group_element_write_compact(writer, proof.g_H);
+    group_element_write_compact(writer, proof.g_K);
+}
+
+template<typename ppT>
+void proof_read_compact(
+    compact_reader &reader, libsnark::r1cs_ppzksnark_proof<ppT> &proof)
+{
+    proof.g_A.g = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_A.h = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_B.g = group_element_read_compact<libff::G2<ppT>>(reader);
+    proof.g_B.h = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_C.g = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_C.h = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_H = group_element_read_compact<libff::G1<ppT>>(reader);
+    proof.g_K = group_element_read_compact<libff::G1<ppT>>(reader);
+}
+
+template<typename ppT>
+void verification_key_write_compact(
+    compact_writer &writer,
+    const libsnark::r1cs_ppzksnark_verification_key<ppT> &vk)
+{
+    group_element_write_compact(writer, vk.alphaA_g2);
+    group_element_write_compact(writer, vk.alphaB_g1);
+    group_element_write_compact(writer, vk.alphaC_g2);
+    group_element_write_compact(writer, vk.gamma_g2);
+    group_element_write_compact(writer, vk.gamma_beta_g1);
+    group_element_write_compact(writer, vk.gamma_beta_g2);
+    group_element_write_compact(writer, vk.rC_Z_g2);
+    accumulation_vector_write_compact(writer, vk.encoded_IC_query);
+}
+
+template<typename ppT>
+void verification_key_read_compact(
+    compact_reader &reader,
+    libsnark::r1cs_ppzksnark_verification_key<ppT> &vk)
+{
+    vk.alphaA_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.alphaB_g1 = group_element_read_compact<libff::G1<ppT>>(reader);
+    vk.alphaC_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.gamma_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.gamma_beta_g1 = group_element_read_compact<libff::G1<ppT>>(reader);
+    vk.gamma_beta_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.rC_Z_g2 = group_element_read_compact<libff::G2<ppT>>(reader);
+    vk.encoded_IC_query =
+        accumulation_vector_read_compact<libff::G1<ppT>>(reader);
+}
+
+} // namespace internal
+
+template<typename FieldT>
+void field_element_write_compact(compact_writer &writer, const FieldT &el)
+{
+    using codec = internal::compact_field_codec<FieldT>;
+    codec::write(el, writer.append(codec::num_bytes()));
+}
+
+template<typename FieldT>
+FieldT field_element_read_compact(compact_reader &reader)
+{
+    using codec = internal::compact_field_codec<FieldT>;
+    return codec::read(reader.consume(codec::num_bytes()));
+}
+
+template<typename GroupT>
+void group_element_write_compact(compact_writer &writer, const GroupT &g)
+{
+    internal::compact_group_codec<GroupT>::write(writer, g);
+}
+
+template<typename GroupT>
+GroupT group_element_read_compact(compact_reader &reader)
+{
+    return internal::compact_group_codec<GroupT>::read(reader);
+}
+
+template<typename ppT, typename snarkT>
+std::string extended_proof_to_compact(
+    const libzeth::extended_proof<ppT, snarkT> &ext_proof, bool compress_points)
+{
+    std::string bytes;
+    compact_writer writer(bytes, compress_points);
+    compact_write_header(writer);
+    internal::proof_write_compact(writer, ext_proof.get_proof());
+
+    const std::vector<libff::Fr<ppT>> &inputs = ext_proof.get_primary_inputs();
+    writer.write_uint32((uint32_t)inputs.size());
+    // Write all inputs in a single block
+    using codec = internal::compact_field_codec<libff::Fr<ppT>>;
+    const size_t input_bytes = codec::num_bytes();
+    uint8_t *out = writer.append(inputs.size() * input_bytes);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        codec::write(inputs[i], out + i * input_bytes);
+    }
+    return bytes;
+}
+
+template<typename ppT, typename snarkT>
+libzeth::extended_proof<ppT, snarkT> extended_proof_from_compact(
+    const std::string &bytes)
+{
+    compact_reader reader(bytes);
+    compact_read_header(reader);
+    typename snarkT::proof proof;
+    internal::proof_read_compact(reader, proof);
+
+    using codec = internal::compact_field_codec<libff::Fr<ppT>>;
+    const size_t input_bytes = codec::num_bytes();
+    const size_t num_inputs = reader.read_uint32();
+    if (num_inputs > reader.remaining() / input_bytes) {
+        throw std::invalid_argument("truncated compact encoding");
+    }
+    const uint8_t *in = reader.consume(num_inputs * input_bytes);
+    std::vector<libff::Fr<ppT>> inputs;
+    inputs.reserve(num_inputs);
+    for (size_t i = 0; i < num_inputs; ++i) {
+        inputs.push_back(codec::read(in + i * input_bytes));
+    }
+    reader.check_end();
+
+    return libzeth::extended_proof<ppT, snarkT>(
+        std::move(proof), std::move(inputs));
+}
+
+template<typename snarkT>
+std::string verification_key_to_compact(
+    const typename snarkT::verification_key &vk, bool compress_points)
+{
+    std::string bytes;
+    compact_writer writer(bytes, compress_points);
+    compact_write_header(writer);
+    internal::verification_key_write_compact(writer, vk);
+    return bytes;
+}
+
+template<typename snarkT>
+typename snarkT::verification_key verification_key_from_compact(
+    const std::string &bytes)
+{
+    compact_reader reader(bytes);
+    compact_read_header(reader);
+    typename snarkT::verification_key vk;
+    internal::verification_key_read_compact(reader, vk);
+    reader.check_end();
+    return vk;
+}
+
+} // namespace libzecale
+
+#endif // __ZECALE_SERIALIZATION_COMPACT_ENCODING_TCC__
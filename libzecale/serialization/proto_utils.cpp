@@ -0,0 +1,83 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/serialization/proto_utils.hpp"
+
+namespace libzecale
+{
+
+namespace
+{
+
+void histogram_to_proto(const histogram &h, zecale_proto::Histogram *proto)
+{
+    const std::vector<double> &bounds = h.upper_bounds();
+    const std::vector<uint64_t> &counts = h.bucket_counts();
+    uint64_t cumulative_count = 0;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        cumulative_count += counts[i];
+        zecale_proto::HistogramBucket *bucket = proto->add_buckets();
+        bucket->set_upper_bound(bounds[i]);
+        bucket->set_cumulative_count(cumulative_count);
+    }
+    proto->set_count(h.count());
+    proto->set_sum(h.sum());
+    proto->set_p50(h.quantile(0.5));
+    proto->set_p90(h.quantile(0.9));
+    proto->set_p99(h.quantile(0.99));
+}
+
+} // namespace
+
+void metrics_to_proto(
+    const metrics_snapshot &snapshot, zecale_proto::Metrics *metrics)
+{
+    metrics->set_uptime_seconds(snapshot.uptime_seconds);
+    for (const metrics_snapshot::application &app : snapshot.applications) {
+        zecale_proto::ApplicationMetrics *app_metrics =
+            metrics->add_applications();
+        app_metrics->set_name(app.name);
+        app_metrics->set_pool_size(app.pool_size);
+        app_metrics->set_transactions_received(app.transactions_received);
+        app_metrics->set_ingest_rate(app.ingest_rate);
+        app_metrics->set_batches(app.batches);
+        app_metrics->set_batch_fill_ratio(app.batch_fill_ratio);
+    }
+    histogram_to_proto(
+        snapshot.witness_generation_seconds,
+        metrics->mutable_witness_generation_seconds());
+    histogram_to_proto(
+        snapshot.proof_generation_seconds,
+        metrics->mutable_proof_generation_seconds());
+    histogram_to_proto(
+        snapshot.end_to_end_seconds, metrics->mutable_end_to_end_seconds());
+    metrics->set_cpu_seconds(snapshot.cpu_seconds);
+    metrics->set_prover_cpu_utilisation(snapshot.prover_cpu_utilisation);
+    metrics->set_peak_rss_bytes(snapshot.peak_rss_bytes);
+    for (const metrics_snapshot::prove_phase &phase : snapshot.prove_phases) {
+        zecale_proto::ProvePhaseMetrics *phase_metrics =
+            metrics->add_prove_phases();
+        phase_metrics->set_phase(phase.name);
+        histogram_to_proto(
+            phase.wall_seconds, phase_metrics->mutable_wall_seconds());
+        phase_metrics->set_cpu_seconds(phase.cpu_seconds);
+    }
+    metrics->set_prove_peak_rss_bytes(snapshot.prove_peak_rss_bytes);
+}
+
+void prove_timings_to_proto(
+    const prove_timings &timings, zecale_proto::ProveTimings *proto)
+{
+    for (const auto &name_timing : timings.phases()) {
+        zecale_proto::ProvePhaseTiming *phase = proto->add_phases();
+        phase->set_phase(name_timing.first);
+        phase->set_wall_seconds(name_timing.second.wall_seconds);
+        phase->set_cpu_seconds(name_timing.second.cpu_seconds);
+    }
+    proto->set_peak_rss_bytes(timings.peak_rss_bytes);
+    proto->set_num_constraints(timings.num_constraints);
+    proto->set_num_variables(timings.num_variables);
+}
+
+} // namespace libzecale
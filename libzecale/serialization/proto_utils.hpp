@@ -6,6 +6,8 @@
 #define __ZECALE_SERIALIZATION_PROTO_UTILS_HPP__
 
 #include "api/aggregator.pb.h"
+#include "libzecale/core/metrics.hpp"
+#include "libzecale/core/prove_timings.hpp"
 #include "libzecale/core/transaction_to_aggregate.hpp"
 
 namespace libzecale
@@ -16,6 +18,18 @@ transaction_to_aggregate<ppT, typename apiHandlerT::snark>
 transaction_to_aggregate_from_proto(
     const zecale_proto::TransactionToAggregate &transaction);
 
+/// The verification key of an application registration, in either encoding.
+template<typename apiHandlerT>
+typename apiHandlerT::snark::verification_key
+verification_key_from_registration(
+    const zecale_proto::ApplicationRegistration &registration);
+
+void metrics_to_proto(
+    const metrics_snapshot &snapshot, zecale_proto::Metrics *metrics);
+
+void prove_timings_to_proto(
+    const prove_timings &timings, zecale_proto::ProveTimings *proto);
+
 } // namespace libzecale
 
 #include "proto_utils.tcc"
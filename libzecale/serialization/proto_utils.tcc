@@ -6,6 +6,7 @@
 #define __ZECALE_SERIALIZATION_PROTO_UTILS_TCC__
 
 #include "libzecale/core/transaction_to_aggregate.hpp"
+#include "libzecale/serialization/compact_encoding.hpp"
 
 #include <cstring>
 #include <libff/algebra/curves/public_params.hpp>
@@ -22,11 +23,31 @@ transaction_to_aggregate_from_proto(
     using snark = typename apiHandlerT::snark;
     std::string app_name = grpc_transaction_obj.application_name();
     libzeth::extended_proof<ppT, snark> ext_proof =
-        apiHandlerT::extended_proof_from_proto(
-            grpc_transaction_obj.extended_proof());
+        (grpc_transaction_obj.proof_case() ==
+         zecale_proto::TransactionToAggregate::kCompactExtendedProof)
+            ? extended_proof_from_compact<ppT, snark>(
+                  grpc_transaction_obj.compact_extended_proof())
+            : apiHandlerT::extended_proof_from_proto(
+                  grpc_transaction_obj.extended_proof());
     uint32_t fee = uint32_t(grpc_transaction_obj.fee_in_wei());
 
-    return transaction_to_aggregate<ppT, snark>(app_name, ext_proof, fee);
+    // The parsed proof is moved into the transaction, which holds the only
+    // copy of it from here on.
+    return transaction_to_aggregate<ppT, snark>(
+        std::move(app_name), std::move(ext_proof), fee);
+}
+
+template<typename apiHandlerT>
+typename apiHandlerT::snark::verification_key
+verification_key_from_registration(
+    const zecale_proto::ApplicationRegistration &registration)
+{
+    using snark = typename apiHandlerT::snark;
+    if (registration.key_case() ==
+        zecale_proto::ApplicationRegistration::kCompactVk) {
+        return verification_key_from_compact<snark>(registration.compact_vk());
+    }
+    return apiHandlerT::verification_key_from_proto(registration.vk());
 }
 
 } // namespace libzecale
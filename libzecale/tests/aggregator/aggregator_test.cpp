@@ -7,6 +7,7 @@
 #include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
 #include "libzecale/circuits/pghr13_verifier/pghr13_verifier_parameters.hpp"
 #include "libzecale/core/aggregator_circuit_wrapper.hpp"
+#include "libzecale/core/multi_application_aggregator_circuit_wrapper.hpp"
 
 #include <gtest/gtest.h>
 #include <libff/algebra/fields/field_utils.hpp>
@@ -219,6 +220,33 @@ bool test_valid_aggregation_batch_proofs(
     std::cout << "[DEBUG] Displaying the extended proof" << std::endl;
     ext_proof.write_json(std::cout);
 
+    // The first primary input is the digest of the nested VK, which can be
+    // computed from the VK alone. The processed VK leads to the same proof
+    // statement.
+    const processed_nested_verification_key<wppT> processed_vk =
+        aggregator_prover.process_nested_verification_key(zeth_keypair.vk);
+    if (ext_proof.get_primary_inputs()[0] != processed_vk.hash) {
+        return false;
+    }
+
+    libzeth::extended_proof<wppT, wsnark> ext_proof_processed_vk =
+        aggregator_prover.prove(
+            processed_vk, nested_proofs, aggregator_keypair.pk);
+    if (ext_proof_processed_vk.get_primary_inputs() !=
+        ext_proof.get_primary_inputs()) {
+        return false;
+    }
+
+    // A processed VK whose digest does not match its bits is rejected
+    // before the proof is generated
+    processed_nested_verification_key<wppT> invalid_processed_vk =
+        processed_vk;
+    invalid_processed_vk.hash += libff::Fr<wppT>::one();
+    EXPECT_THROW(
+        aggregator_prover.prove(
+            invalid_processed_vk, nested_proofs, aggregator_keypair.pk),
+        std::invalid_argument);
+
     return res;
 }
 
@@ -280,6 +308,111 @@ void aggregator_test()
     ASSERT_TRUE(res);
 }
 
+/// Test aggregation of a batch of proofs generated for 2 distinct
+/// applications (here, 2 distinct keypairs for the Zeth circuit).
+template<typename nppT, typename wppT, typename nsnarkT, typename wverifierT>
+void multi_application_aggregator_test()
+{
+    using wsnark = typename wverifierT::snark;
+    const size_t num_vks = 2;
+
+    libzeth::circuit_wrapper<
+        hash<nppT>,
+        hashTree<nppT>,
+        nppT,
+        nsnarkT,
+        inputs_number,
+        outputs_number,
+        tree_depth>
+        zeth_prover;
+    typename nsnarkT::keypair app_a_keypair =
+        zeth_prover.generate_trusted_setup();
+    typename nsnarkT::keypair app_b_keypair =
+        zeth_prover.generate_trusted_setup();
+    libzeth::extended_proof<nppT, nsnarkT> app_a_proof =
+        generate_valid_zeth_proof(zeth_prover, app_a_keypair);
+    libzeth::extended_proof<nppT, nsnarkT> app_b_proof =
+        generate_valid_zeth_proof(zeth_prover, app_b_keypair);
+
+    using wrapper_type = multi_application_aggregator_circuit_wrapper<
+        nppT,
+        wppT,
+        nsnarkT,
+        wverifierT,
+        batch_size,
+        num_vks>;
+    wrapper_type aggregator_prover;
+    typename wsnark::keypair aggregator_keypair =
+        aggregator_prover.generate_trusted_setup();
+
+    const std::array<const typename nsnarkT::verification_key *, num_vks>
+        nested_vks = {&app_a_keypair.vk, &app_b_keypair.vk};
+
+    // Valid batch: each proof is checked against the key of its application
+    const std::array<size_t, batch_size> vk_indices = {1, 0};
+    const std::array<const libzeth::extended_proof<nppT, nsnarkT> *, batch_size>
+        batch = {&app_b_proof, &app_a_proof};
+    libzeth::extended_proof<wppT, wsnark> ext_proof = aggregator_prover.prove(
+        nested_vks, vk_indices, batch, aggregator_keypair.pk);
+    ASSERT_TRUE(wsnark::verify(
+        ext_proof.get_primary_inputs(),
+        ext_proof.get_proof(),
+        aggregator_keypair.vk));
+
+    // The digests of the VKs, and then the VK indices, are the first primary
+    // inputs
+    const libff::Fr<wppT> app_a_vk_hash =
+        wrapper_type::compute_nested_vk_hash(app_a_keypair.vk);
+    const libff::Fr<wppT> app_b_vk_hash =
+        wrapper_type::compute_nested_vk_hash(app_b_keypair.vk);
+    ASSERT_EQ(app_a_vk_hash, ext_proof.get_primary_inputs()[0]);
+    ASSERT_EQ(app_b_vk_hash, ext_proof.get_primary_inputs()[1]);
+    ASSERT_EQ(libff::Fr<wppT>::one(), ext_proof.get_primary_inputs()[num_vks]);
+    ASSERT_EQ(
+        libff::Fr<wppT>::zero(), ext_proof.get_primary_inputs()[num_vks + 1]);
+
+    using gadget_type = multi_application_aggregator_gadget<
+        nppT,
+        wppT,
+        nsnarkT,
+        wverifierT,
+        batch_size,
+        num_vks>;
+    // Variable of the primary input at `index` (the variable 0 is the
+    // constant 1)
+    const auto primary_input_var = [](size_t index) {
+        return libsnark::pb_variable<libff::Fr<wppT>>(index + 1);
+    };
+
+    // A VK other than the one whose digest is public is rejected: here, the
+    // proofs of both slots are verified against the VK of application B,
+    // while the first digest is the one of the VK of application A.
+    {
+        libsnark::protoboard<libff::Fr<wppT>> pb;
+        gadget_type g(pb);
+        g.generate_r1cs_constraints();
+        g.generate_r1cs_witness(
+            {&app_b_keypair.vk, &app_b_keypair.vk}, vk_indices, batch);
+        ASSERT_TRUE(pb.is_satisfied());
+        pb.val(primary_input_var(0)) = app_a_vk_hash;
+        ASSERT_FALSE(pb.is_satisfied());
+    }
+
+    // Each slot is verified against the VK at its public index: swapping the
+    // VK indices of the slots is rejected.
+    {
+        libsnark::protoboard<libff::Fr<wppT>> pb;
+        gadget_type g(pb);
+        g.generate_r1cs_constraints();
+        g.generate_r1cs_witness(nested_vks, vk_indices, batch);
+        ASSERT_TRUE(pb.is_satisfied());
+        pb.val(primary_input_var(num_vks)) = libff::Fr<wppT>(vk_indices[1]);
+        pb.val(primary_input_var(num_vks + 1)) =
+            libff::Fr<wppT>(vk_indices[0]);
+        ASSERT_FALSE(pb.is_satisfied());
+    }
+}
+
 template<typename nppT, typename wppT> void aggregator_test_groth16()
 {
     aggregator_test<
@@ -308,6 +441,15 @@ TEST(AggregatorTests, AggregatorBls12Bw6Groth16)
     aggregator_test_groth16<libff::bls12_377_pp, libff::bw6_761_pp>();
 }
 
+TEST(AggregatorTests, MultiApplicationAggregatorMnt4Mnt6Groth16)
+{
+    multi_application_aggregator_test<
+        libff::mnt4_pp,
+        libff::mnt6_pp,
+        libzeth::groth16_snark<libff::mnt4_pp>,
+        libzecale::groth16_verifier_parameters<libff::mnt6_pp>>();
+}
+
 #if 0 // TODO: Enable and fix this test
 TEST(AggregatorTests, AggregatorMnt4Mnt6Pghr13)
 {
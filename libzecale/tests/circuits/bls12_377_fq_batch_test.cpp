@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/circuits/fields/bls12_377_fq_batch.hpp"
+#include "libzecale/circuits/fields/fp2_native_witness.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+
+using Fq = libff::bls12_377_Fq;
+using Fq2 = libff::bls12_377_Fq2;
+
+namespace
+{
+
+const libzecale::fq_batch_kernel kernels[] = {
+    libzecale::fq_batch_kernel::scalar,
+    libzecale::fq_batch_kernel::avx2,
+    libzecale::fq_batch_kernel::avx512_ifma,
+};
+
+// Random elements, starting with some edge cases.
+std::vector<Fq> test_elements(size_t n)
+{
+    const std::vector<Fq> edge_cases{
+        Fq::zero(), Fq::one(), -Fq::one(), Fq("2"), -Fq("2")};
+    std::vector<Fq> elements;
+    for (size_t i = 0; i < n; ++i) {
+        elements.push_back(
+            (i < edge_cases.size()) ? edge_cases[i] : Fq::random_element());
+    }
+    return elements;
+}
+
+TEST(BLS12_377_FqBatchTest, DefaultKernelIsSupported)
+{
+    ASSERT_TRUE(libzecale::fq_batch_kernel_is_supported(
+        libzecale::fq_batch_kernel::scalar));
+    ASSERT_TRUE(libzecale::fq_batch_kernel_is_supported(
+        libzecale::fq_batch_kernel_default()));
+}
+
+TEST(BLS12_377_FqBatchTest, MulMatchesLibff)
+{
+    // Batch sizes covering partial and multiple vectors of all kernels
+    for (const size_t n : {0U, 1U, 3U, 4U, 5U, 8U, 9U, 33U}) {
+        const std::vector<Fq> a = test_elements(n);
+        std::vector<Fq> b = test_elements(n);
+        std::reverse(b.begin(), b.end());
+
+        for (const libzecale::fq_batch_kernel kernel : kernels) {
+            if (!libzecale::fq_batch_kernel_is_supported(kernel)) {
+                continue;
+            }
+
+            std::vector<Fq> a_times_b(n);
+            std::vector<Fq> a_squared(n);
+            libzecale::bls12_377_fq_batch_mul(
+                a.data(), b.data(), a_times_b.data(), n, kernel);
+            libzecale::bls12_377_fq_batch_square(
+                a.data(), a_squared.data(), n, kernel);
+            for (size_t i = 0; i < n; ++i) {
+                ASSERT_EQ(a[i] * b[i], a_times_b[i])
+                    << libzecale::fq_batch_kernel_name(kernel) << " " << i;
+                ASSERT_EQ(a[i].squared(), a_squared[i])
+                    << libzecale::fq_batch_kernel_name(kernel) << " " << i;
+            }
+
+            // In place
+            std::vector<Fq> in_place = a;
+            libzecale::bls12_377_fq_batch_mul(
+                in_place.data(), b.data(), in_place.data(), n, kernel);
+            ASSERT_EQ(a_times_b, in_place);
+            in_place = a;
+            libzecale::bls12_377_fq_batch_square(
+                in_place.data(), in_place.data(), n, kernel);
+            ASSERT_EQ(a_squared, in_place);
+        }
+    }
+}
+
+TEST(BLS12_377_FqBatchTest, UnsupportedKernelThrows)
+{
+    const Fq a = Fq::random_element();
+    Fq result;
+    for (const libzecale::fq_batch_kernel kernel : kernels) {
+        if (!libzecale::fq_batch_kernel_is_supported(kernel)) {
+            ASSERT_THROW(
+                libzecale::bls12_377_fq_batch_mul(&a, &a, &result, 1, kernel),
+                std::invalid_argument);
+        }
+    }
+}
+
+TEST(BLS12_377_FqBatchTest, Fq2BatchMatchesLibff)
+{
+    const size_t n = 11;
+    std::vector<Fq2> a;
+    std::vector<Fq2> b;
+    for (size_t i = 0; i < n; ++i) {
+        a.push_back(Fq2::random_element());
+        b.push_back(Fq2::random_element());
+    }
+    a[0] = Fq2::zero();
+    b[1] = Fq2::one();
+
+    const std::vector<Fq> a_c0_times_b_c0 = libzecale::fp_batch_mul(
+        std::vector<Fq>{a[2].c0, a[3].c0}, std::vector<Fq>{b[2].c0, b[3].c0});
+    ASSERT_EQ(a[2].c0 * b[2].c0, a_c0_times_b_c0[0]);
+    ASSERT_EQ(a[3].c0 * b[3].c0, a_c0_times_b_c0[1]);
+
+    const std::vector<Fq2> a_times_b = libzecale::fp2_batch_mul(a, b);
+    const std::vector<Fq2> a_squared = libzecale::fp2_batch_squared(a);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(a[i] * b[i], a_times_b[i]);
+        ASSERT_EQ(a[i].squared(), a_squared[i]);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    libff::bls12_377_pp::init_public_params();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
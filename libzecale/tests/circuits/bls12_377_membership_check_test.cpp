@@ -0,0 +1,133 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/circuits/pairing/bls12_377_membership_check.hpp"
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+
+#include <gtest/gtest.h>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <libff/algebra/curves/bw6_761/bw6_761_pp.hpp>
+
+using namespace libzecale;
+
+using wpp = libff::bw6_761_pp;
+
+namespace
+{
+
+/// A point of E(Fq) which is not in G1 (the cofactor of G1 is not 1).
+libff::bls12_377_G1 random_G1_non_member()
+{
+    using Fq = libff::bls12_377_Fq;
+    while (true) {
+        const Fq x = Fq::random_element();
+        const Fq y_squared = x.squared() * x + libff::bls12_377_coeff_b;
+        if ((y_squared ^ Fq::euler) == Fq::one()) {
+            const libff::bls12_377_G1 P(x, y_squared.sqrt(), Fq::one());
+            if (!(libff::bls12_377_modulus_r * P).is_zero()) {
+                return P;
+            }
+        }
+    }
+}
+
+/// A point of the twist E'(Fq2) which is not in G2.
+libff::bls12_377_G2 random_G2_non_member()
+{
+    using Fq2 = libff::bls12_377_Fq2;
+    while (true) {
+        const Fq2 x = Fq2::random_element();
+        const Fq2 y_squared = x.squared() * x + libff::bls12_377_twist_coeff_b;
+        if ((y_squared ^ Fq2::euler) == Fq2::one()) {
+            const libff::bls12_377_G2 Q(x, y_squared.sqrt(), Fq2::one());
+            if (!(libff::bls12_377_modulus_r * Q).is_zero()) {
+                return Q;
+            }
+        }
+    }
+}
+
+/// Run the membership check gadget `checkT` on the (on-curve) point P, and
+/// return whether the constraints are satisfied.
+template<typename checkT, typename pointVariableT, typename pointT>
+bool run_membership_check(const pointT &P, size_t &num_constraints)
+{
+    libsnark::protoboard<libff::Fr<wpp>> pb;
+    pointVariableT P_var(pb, "P");
+    checkT check(pb, P_var, "check");
+
+    check.generate_r1cs_constraints();
+    num_constraints = pb.num_constraints();
+
+    P_var.generate_r1cs_witness(P);
+    check.generate_r1cs_witness();
+    return pb.is_satisfied();
+}
+
+TEST(BLS12_377_MembershipCheckTest, G1MembershipCheckGadget)
+{
+    using check = bls12_377_G1_membership_check_gadget<wpp>;
+    using variable = libsnark::G1_variable<wpp>;
+    size_t num_constraints = 0;
+
+    // Natively, phi(P) = [-z^2]P for P in G1.
+    const libff::bls12_377_G1 P =
+        libff::bls12_377_Fr::random_element() * libff::bls12_377_G1::one();
+    libff::bls12_377_G1 z_squared_P =
+        libff::bls12_377_final_exponent_z *
+        (libff::bls12_377_final_exponent_z * P);
+    z_squared_P.to_affine_coordinates();
+    libff::bls12_377_G1 P_affine = P;
+    P_affine.to_affine_coordinates();
+    ASSERT_EQ(check::endomorphism_omega() * P_affine.X, z_squared_P.X);
+    ASSERT_EQ(-P_affine.Y, z_squared_P.Y);
+
+    ASSERT_TRUE((run_membership_check<check, variable>(P, num_constraints)));
+    ASSERT_TRUE((run_membership_check<check, variable>(
+        libff::bls12_377_G1::one(), num_constraints)));
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_FALSE((run_membership_check<check, variable>(
+            random_G1_non_member(), num_constraints)));
+    }
+
+    std::cout << "G1 membership check: " << num_constraints << " constraints"
+              << std::endl;
+}
+
+TEST(BLS12_377_MembershipCheckTest, G2MembershipCheckGadget)
+{
+    using check = bls12_377_G2_membership_check_gadget<wpp>;
+    using variable = libsnark::G2_variable<wpp>;
+    size_t num_constraints = 0;
+
+    // Natively, psi(Q) = [z]Q for Q in G2.
+    const libff::bls12_377_G2 Q =
+        libff::bls12_377_Fr::random_element() * libff::bls12_377_G2::one();
+    libff::bls12_377_G2 z_Q = libff::bls12_377_final_exponent_z * Q;
+    if (libff::bls12_377_final_exponent_is_z_neg) {
+        z_Q = -z_Q;
+    }
+    ASSERT_EQ(z_Q, Q.mul_by_q());
+
+    ASSERT_TRUE((run_membership_check<check, variable>(Q, num_constraints)));
+    ASSERT_TRUE((run_membership_check<check, variable>(
+        libff::bls12_377_G2::one(), num_constraints)));
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_FALSE((run_membership_check<check, variable>(
+            random_G2_non_member(), num_constraints)));
+    }
+
+    std::cout << "G2 membership check: " << num_constraints << " constraints"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    libff::bw6_761_pp::init_public_params();
+    libff::bls12_377_pp::init_public_params();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -89,10 +89,17 @@ TEST(BLS12_377_PairingTest, PrecomputeDoubleGadgetTest)
     pb.set_input_sizes(num_primary_inputs);
     std::cout << "num_primary_inputs: " << std::to_string(num_primary_inputs)
               << "\n";
+    const size_t num_variables_before = pb.num_variables();
     libzecale::bls12_377_ate_dbl_gadget<wpp> check_double_R0(
         pb, R0_var, R1_var, R1_coeffs_var, "check R1");
 
     check_double_R0.generate_r1cs_constraints();
+
+    // Only A, B, E^2 and the v1 variables of the 3 Fqe multiplications are
+    // allocated by the gadget (out_R and the coefficients are allocated by
+    // the caller). 3 Fqe multiplications and 6 Fqe squarings.
+    ASSERT_EQ((size_t)9, pb.num_variables() - num_variables_before);
+    ASSERT_EQ((size_t)21, pb.num_constraints());
     R0_var.generate_r1cs_witness(R0);
     check_double_R0.generate_r1cs_witness();
 
@@ -184,11 +191,18 @@ TEST(BLS12_377_PairingTest, PrecomputeAddGadgetTest)
     std::cout << "num_primary_inputs: " << std::to_string(num_primary_inputs)
               << "\n";
 
+    const size_t num_variables_before = pb.num_variables();
     libzecale::bls12_377_ate_add_gadget<wpp> check_add_R0(
         pb, Q_X, Q_Y, R0_var, R1_var, R1_coeffs_var, "check R1");
 
     check_add_R0.generate_r1cs_constraints();
 
+    // C, D, E, F, G, I, theta * Q.X and the v1 variables of the 11 Fqe
+    // multiplications are allocated by the gadget. 11 Fqe multiplications
+    // and 2 Fqe squarings.
+    ASSERT_EQ((size_t)25, pb.num_variables() - num_variables_before);
+    ASSERT_EQ((size_t)37, pb.num_constraints());
+
     // Populate R0 and Q, and generate values via the gadget
 
     Q_X.generate_r1cs_witness(Q.X);
@@ -392,6 +406,132 @@ TEST(BLS12_377_PairingTest, MillerLoopGadgetTest)
     ASSERT_TRUE(snark::verify(primary_input, proof, keypair.vk));
 }
 
+TEST(BLS12_377_PairingTest, PrecomputeAddAffineGadgetTest)
+{
+    using FqT = libff::Fq<npp>;
+    using FqeT = libff::Fqe<npp>;
+
+    libff::bls12_377_G2 Q =
+        libff::bls12_377_Fr("7") * libff::bls12_377_G2::one();
+    libff::bls12_377_G2 R0 =
+        libff::bls12_377_Fr("13") * libff::bls12_377_G2::one();
+    libff::bls12_377_G2 R1 = Q + R0;
+    Q.to_affine_coordinates();
+    R0.to_affine_coordinates();
+    R1.to_affine_coordinates();
+
+    libsnark::protoboard<libff::Fr<wpp>> pb;
+    libzecale::Fqe_variable<wpp> Q_X(pb, "Q_X");
+    libzecale::Fqe_variable<wpp> Q_Y(pb, "Q_Y");
+    libsnark::G2_variable<wpp> R0_var(pb, "R0");
+    libsnark::G2_variable<wpp> R1_var(pb, "R1");
+    libzecale::bls12_377_ate_ell_coeffs<wpp> R1_coeffs_var(
+        libzecale::Fqe_variable<wpp>(pb, "ell_0"),
+        libzecale::Fqe_variable<wpp>(pb, -FqeT::one(), "ell_vw"),
+        libzecale::Fqe_variable<wpp>(pb, "ell_vv"));
+
+    libzecale::bls12_377_ate_add_affine_gadget<wpp> add_R0(
+        pb, Q_X, Q_Y, R0_var, R1_var, R1_coeffs_var, "add_R0");
+    add_R0.generate_r1cs_constraints();
+
+    Q_X.generate_r1cs_witness(Q.X);
+    Q_Y.generate_r1cs_witness(Q.Y);
+    R0_var.generate_r1cs_witness(R0);
+    add_R0.generate_r1cs_witness();
+    ASSERT_TRUE(pb.is_satisfied());
+    ASSERT_EQ(R1.X, R1_var.X->get_element());
+    ASSERT_EQ(R1.Y, R1_var.Y->get_element());
+
+    // Witness for R0 = Q, where lambda is the slope of the tangent at Q and
+    // R1 = 2 * Q. This satisfies all the constraints of the gadget except
+    // inv * (Q.X - R0.X) = 1.
+    const FqeT lambda = (FqT(3) * Q.X.squared()) * (FqT(2) * Q.Y).inverse();
+    libff::bls12_377_G2 Q_dbl = Q.dbl();
+    Q_dbl.to_affine_coordinates();
+    R0_var.generate_r1cs_witness(Q);
+    R1_var.generate_r1cs_witness(Q_dbl);
+    R1_coeffs_var.ell_vv.generate_r1cs_witness(lambda);
+    R1_coeffs_var.ell_0.generate_r1cs_witness(
+        libff::bls12_377_twist * (Q.Y - lambda * Q.X));
+    add_R0._check_lambda.B.evaluate();
+    add_R0._check_lambda.result.evaluate();
+    add_R0._check_lambda.generate_r1cs_witness();
+    add_R0._check_no_special_cases.B.evaluate();
+    add_R0._check_no_special_cases.generate_r1cs_witness();
+    add_R0._check_out_Rx.result.evaluate();
+    add_R0._check_out_Rx.generate_r1cs_witness();
+    add_R0._check_out_Ry.B.evaluate();
+    add_R0._check_out_Ry.result.evaluate();
+    add_R0._check_out_Ry.generate_r1cs_witness();
+    add_R0._check_ell_0.result.evaluate();
+    add_R0._check_ell_0.generate_r1cs_witness();
+    ASSERT_FALSE(pb.is_satisfied());
+}
+
+TEST(BLS12_377_PairingTest, G2AffinePrecomputeGadgetTest)
+{
+    // Native calculation
+    const libff::bls12_377_G1 P =
+        libff::bls12_377_Fr("13") * libff::bls12_377_G1::one();
+    libff::bls12_377_G2 Q =
+        libff::bls12_377_Fr("7") * libff::bls12_377_G2::one();
+    Q.to_affine_coordinates();
+    const libff::bls12_377_Fq12 miller = libff::bls12_377_ate_miller_loop(
+        libff::bls12_377_ate_precompute_G1(P),
+        libff::bls12_377_ate_precompute_G2(Q));
+
+    // Circuit with affine precompute and Miller loop gadgets
+    libsnark::protoboard<libff::Fr<wpp>> pb;
+    libsnark::G1_variable<wpp> P_var(pb, "P");
+    libsnark::G2_variable<wpp> Q_var(pb, "Q");
+    libsnark::Fqk_variable<wpp> miller_var(pb, "miller");
+    const size_t num_primary_inputs = pb.num_inputs();
+    pb.set_input_sizes(num_primary_inputs);
+
+    libzecale::G1_precomputation<wpp> P_prec_var;
+    libzecale::G1_precompute_gadget<wpp> precompute_P(
+        pb, P_var, P_prec_var, "precomp_P");
+
+    libzecale::bls12_377_G2_precomputation<wpp> Q_prec_var;
+    libzecale::bls12_377_G2_affine_precompute_gadget<wpp> precompute_Q(
+        pb, Q_var, Q_prec_var, "precomp_Q");
+
+    libzecale::bls12_377_miller_loop_gadget<wpp> miller_loop_gadget(
+        pb, P_prec_var, Q_prec_var, miller_var, "miller loop");
+
+    precompute_P.generate_r1cs_constraints();
+    const size_t num_constraints_before = pb.num_constraints();
+    precompute_Q.generate_r1cs_constraints();
+    const size_t num_affine_constraints =
+        pb.num_constraints() - num_constraints_before;
+    miller_loop_gadget.generate_r1cs_constraints();
+
+    // Set values
+    P_var.generate_r1cs_witness(P);
+    Q_var.generate_r1cs_witness(Q);
+    precompute_P.generate_r1cs_witness();
+    precompute_Q.generate_r1cs_witness();
+    miller_loop_gadget.generate_r1cs_witness();
+    ASSERT_TRUE(pb.is_satisfied());
+
+    // The line coefficients differ from the projective ones by factors in
+    // Fqe, so the Miller loop outputs agree after the final exponentiation.
+    const libff::Fqk<npp> miller_val = miller_var.get_element();
+    ASSERT_NE(miller, miller_val);
+    ASSERT_EQ(
+        libff::bls12_377_final_exponentiation(miller),
+        libff::bls12_377_final_exponentiation(miller_val));
+
+    // Compare with the size of the projective precompute gadget
+    libsnark::protoboard<libff::Fr<wpp>> proj_pb;
+    libsnark::G2_variable<wpp> proj_Q_var(proj_pb, "Q");
+    libzecale::bls12_377_G2_precomputation<wpp> proj_Q_prec_var;
+    libzecale::bls12_377_G2_precompute_gadget<wpp> proj_precompute_Q(
+        proj_pb, proj_Q_var, proj_Q_prec_var, "precomp_Q");
+    proj_precompute_Q.generate_r1cs_constraints();
+    ASSERT_LT(num_affine_constraints, proj_pb.num_constraints());
+}
+
 TEST(BLS12_377_PairingTest, MillerLoopGadgetWithConstantG1Precomputation)
 {
     // Native calculation
@@ -500,6 +640,86 @@ TEST(BLS12_377_PairingTest, MillerLoopGadgetWithConstantG2Precomputation)
     ASSERT_TRUE(snark::verify(primary_input, proof, keypair.vk));
 }
 
+TEST(BLS12_377_PairingTest, ComputeFEllPWithConstantCoefficients)
+{
+    using FqeT = libff::Fqe<npp>;
+    using FqkT = libff::Fqk<npp>;
+
+    const libff::bls12_377_G1 P =
+        libff::bls12_377_Fr("13") * libff::bls12_377_G1::one();
+    const libff::bls12_377_G1_precomp P_prec =
+        libff::bls12_377_ate_precompute_G1(P);
+    const FqkT f = FqkT::random_element();
+    const FqeT ell_0 = FqeT::random_element();
+    const FqeT ell_vw = FqeT::random_element();
+    const FqeT ell_vv = FqeT::random_element();
+    const FqkT f_ell_P =
+        f.mul_by_024(ell_0, ell_vw * P_prec.PY, ell_vv * P_prec.PX);
+
+    // Returns the number of variables and constraints of the
+    // bls12_377_ate_compute_f_ell_P gadget, for constant or variable line
+    // coefficients.
+    const auto compute_f_ell_P = [&](bool constant_coeffs,
+                                     size_t &num_variables,
+                                     size_t &num_constraints) {
+        libsnark::protoboard<libff::Fr<wpp>> pb;
+        libsnark::G1_variable<wpp> P_var(pb, "P");
+        libzecale::Fp12_2over3over2_variable<FqkT> f_var(pb, "f");
+        libzecale::G1_precomputation<wpp> P_prec_var;
+        libzecale::G1_precompute_gadget<wpp> precompute_P(
+            pb, P_var, P_prec_var, "precompute_P");
+        std::shared_ptr<libzecale::bls12_377_ate_ell_coeffs<wpp>> coeffs;
+        if (constant_coeffs) {
+            coeffs.reset(new libzecale::bls12_377_ate_ell_coeffs<wpp>(
+                pb, ell_0, ell_vw, ell_vv, "coeffs"));
+        } else {
+            coeffs.reset(
+                new libzecale::bls12_377_ate_ell_coeffs<wpp>(pb, "coeffs"));
+        }
+        const size_t num_variables_before = pb.num_variables();
+
+        libzecale::bls12_377_ate_compute_f_ell_P<wpp> compute(
+            pb,
+            *P_prec_var._Px,
+            *P_prec_var._Py,
+            *coeffs,
+            f_var,
+            libzecale::Fp12_2over3over2_variable<FqkT>(pb, "f_out"),
+            "compute_f_ell_P");
+        compute.generate_r1cs_constraints();
+        num_variables = pb.num_variables() - num_variables_before;
+        num_constraints = pb.num_constraints();
+
+        P_var.generate_r1cs_witness(P);
+        precompute_P.generate_r1cs_witness();
+        f_var.generate_r1cs_witness(f);
+        if (!constant_coeffs) {
+            coeffs->ell_0.generate_r1cs_witness(ell_0);
+            coeffs->ell_vw.generate_r1cs_witness(ell_vw);
+            coeffs->ell_vv.generate_r1cs_witness(ell_vv);
+        }
+        compute.generate_r1cs_witness();
+        ASSERT_EQ(f_ell_P, compute.result().get_element());
+        ASSERT_TRUE(pb.is_satisfied());
+    };
+
+    size_t num_variables = 0;
+    size_t num_constraints = 0;
+    compute_f_ell_P(false, num_variables, num_constraints);
+    size_t lean_num_variables = 0;
+    size_t lean_num_constraints = 0;
+    compute_f_ell_P(true, lean_num_variables, lean_num_constraints);
+
+    // With constant coefficients, ell_vv * Px and ell_vw * Py are linear
+    // combinations of Px and Py (2 Fp2_mul_by_lc_gadgets less).
+    ASSERT_EQ(num_variables - 4, lean_num_variables);
+    ASSERT_EQ(num_constraints - 4, lean_num_constraints);
+    std::cout << "compute_f_ell_P: " << num_variables << " variables, "
+              << num_constraints << " constraints (constant coefficients: "
+              << lean_num_variables << " variables, " << lean_num_constraints
+              << " constraints)" << std::endl;
+}
+
 TEST(BLS12_377_PairingTest, FinalExpFirstPart)
 {
     using FieldT = libff::Fr<wpp>;
@@ -635,6 +855,11 @@ TEST(BLS12_377_PairingTest, FinalExpLastPart)
 
     final_exp_last_part_gadget.generate_r1cs_constraints();
 
+    // With intermediate values in T2(Fq6): 5988 constraints (and as many
+    // variables, besides the input), against 7030 in Fq12.
+    ASSERT_EQ(5988U, pb.num_constraints());
+    ASSERT_EQ(pb.num_constraints(), pb.num_variables() - 12);
+
     a_var.generate_r1cs_witness(final_exp_first_part);
     final_exp_last_part_gadget.generate_r1cs_witness();
 
@@ -769,6 +994,143 @@ TEST(BLS12_377_PairingTest, FinalExpGadget)
     ASSERT_EQ(FieldT::one(), pb.val(final_exp_ee_is_one_var));
 }
 
+// Build the circuit checking e(P1,Q1)*e(P2,Q2)*e(P3,Q3)*e(P4,Q4)^{-1} == 1
+// (precomputations, Miller loop and final exponentiation), generate the
+// witness either natively or gadget by gadget, and return the full variable
+// assignment.
+libsnark::r1cs_variable_assignment<libff::Fr<wpp>> pairing_check_assignment(
+    const std::vector<libff::G1<npp>> &P,
+    const std::vector<libff::G2<npp>> &Q,
+    bool per_gadget,
+    bool &is_satisfied,
+    libff::Fr<wpp> &result_is_one)
+{
+    using FieldT = libff::Fr<wpp>;
+    const size_t num_pairs = 4;
+    assert(P.size() == num_pairs);
+    assert(Q.size() == num_pairs);
+
+    libsnark::protoboard<FieldT> pb;
+    std::vector<std::shared_ptr<libsnark::G1_variable<wpp>>> P_vars;
+    std::vector<std::shared_ptr<libsnark::G2_variable<wpp>>> Q_vars;
+    std::vector<libzecale::bls12_377_G1_precomputation<wpp>> P_precs(
+        num_pairs);
+    std::vector<libzecale::bls12_377_G2_precomputation<wpp>> Q_precs(
+        num_pairs);
+    std::vector<std::shared_ptr<libzecale::bls12_377_G1_precompute_gadget<wpp>>>
+        precompute_Ps;
+    std::vector<std::shared_ptr<libzecale::bls12_377_G2_precompute_gadget<wpp>>>
+        precompute_Qs;
+    for (size_t i = 0; i < num_pairs; ++i) {
+        const std::string idx = std::to_string(i);
+        P_vars.emplace_back(new libsnark::G1_variable<wpp>(pb, "P" + idx));
+        Q_vars.emplace_back(new libsnark::G2_variable<wpp>(pb, "Q" + idx));
+        precompute_Ps.emplace_back(
+            new libzecale::bls12_377_G1_precompute_gadget<wpp>(
+                pb, *P_vars.back(), P_precs[i], "precompute_P" + idx));
+        precompute_Qs.emplace_back(
+            new libzecale::bls12_377_G2_precompute_gadget<wpp>(
+                pb, *Q_vars.back(), Q_precs[i], "precompute_Q" + idx));
+    }
+
+    libzecale::Fqk_variable<wpp> miller_var(pb, "miller");
+    libzecale::bls12_377_e_times_e_times_e_over_e_miller_loop_gadget<wpp>
+        miller_loop(
+            pb,
+            P_precs[0],
+            Q_precs[0],
+            P_precs[1],
+            Q_precs[1],
+            P_precs[2],
+            Q_precs[2],
+            P_precs[3],
+            Q_precs[3],
+            miller_var,
+            "miller_loop");
+    libsnark::pb_variable<FieldT> result_is_one_var;
+    result_is_one_var.allocate(pb, "result_is_one");
+    libzecale::bls12_377_final_exp_gadget<wpp> final_exp(
+        pb, miller_var, result_is_one_var, "final_exp");
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        precompute_Ps[i]->generate_r1cs_constraints();
+        precompute_Qs[i]->generate_r1cs_constraints();
+    }
+    miller_loop.generate_r1cs_constraints();
+    final_exp.generate_r1cs_constraints();
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        P_vars[i]->generate_r1cs_witness(P[i]);
+        Q_vars[i]->generate_r1cs_witness(Q[i]);
+        precompute_Ps[i]->generate_r1cs_witness();
+        if (per_gadget) {
+            precompute_Qs[i]->generate_r1cs_witness_per_gadget();
+        } else {
+            precompute_Qs[i]->generate_r1cs_witness();
+        }
+    }
+    if (per_gadget) {
+        miller_loop.generate_r1cs_witness_per_gadget();
+        final_exp.generate_r1cs_witness_per_gadget();
+    } else {
+        miller_loop.generate_r1cs_witness();
+        final_exp.generate_r1cs_witness();
+    }
+
+    is_satisfied = pb.is_satisfied();
+    result_is_one = pb.val(result_is_one_var);
+    return pb.full_variable_assignment();
+}
+
+TEST(BLS12_377_PairingTest, NativeWitnessMatchesPerGadgetWitness)
+{
+    using FieldT = libff::Fr<wpp>;
+
+    const libff::Fr<npp> a = libff::Fr<npp>::random_element();
+    const libff::Fr<npp> b = libff::Fr<npp>::random_element();
+    const libff::Fr<npp> c = libff::Fr<npp>::random_element();
+    const libff::Fr<npp> d = libff::Fr<npp>::random_element();
+    const libff::Fr<npp> e = libff::Fr<npp>::random_element();
+    const libff::Fr<npp> f = libff::Fr<npp>::random_element();
+    const std::vector<libff::G1<npp>> P{a * libff::G1<npp>::one(),
+                                        c * libff::G1<npp>::one(),
+                                        e * libff::G1<npp>::one(),
+                                        libff::G1<npp>::one()};
+
+    // e(aG1, bG2) * e(cG1, dG2) * e(eG1, fG2) * e(G1, xG2)^{-1} == 1 iff
+    // x == ab + cd + ef.
+    for (const bool valid : {true, false}) {
+        const libff::Fr<npp> x =
+            a * b + c * d + e * f + (valid ? libff::Fr<npp>::zero()
+                                           : libff::Fr<npp>::one());
+        const std::vector<libff::G2<npp>> Q{b * libff::G2<npp>::one(),
+                                            d * libff::G2<npp>::one(),
+                                            f * libff::G2<npp>::one(),
+                                            x * libff::G2<npp>::one()};
+
+        bool per_gadget_satisfied = false;
+        FieldT per_gadget_result_is_one;
+        const libsnark::r1cs_variable_assignment<FieldT> per_gadget =
+            pairing_check_assignment(
+                P, Q, true, per_gadget_satisfied, per_gadget_result_is_one);
+
+        bool native_satisfied = false;
+        FieldT native_result_is_one;
+        const libsnark::r1cs_variable_assignment<FieldT> native =
+            pairing_check_assignment(
+                P, Q, false, native_satisfied, native_result_is_one);
+
+        ASSERT_TRUE(per_gadget_satisfied);
+        ASSERT_TRUE(native_satisfied);
+        ASSERT_EQ(valid ? FieldT::one() : FieldT::zero(), native_result_is_one);
+        ASSERT_EQ(per_gadget_result_is_one, native_result_is_one);
+        ASSERT_EQ(per_gadget.size(), native.size());
+        for (size_t i = 0; i < native.size(); ++i) {
+            ASSERT_EQ(per_gadget[i], native[i]) << "variable " << i;
+        }
+    }
+}
+
 } // namespace
 
 int main(int argc, char **argv)
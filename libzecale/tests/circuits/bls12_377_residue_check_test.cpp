@@ -0,0 +1,185 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/circuits/pairing/bls12_377_residue_check.hpp"
+#include "libzecale/circuits/pairing/pairing_checks.hpp"
+
+#include <array>
+#include <gtest/gtest.h>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <libff/algebra/curves/bw6_761/bw6_761_pp.hpp>
+
+using namespace libzecale;
+
+using wpp = libff::bw6_761_pp;
+using npp = libff::bls12_377_pp;
+
+namespace
+{
+
+/// Miller loop output for e(P1, Q1) * e(P2, Q2) * e(P3, Q3) / e(P4, Q4)
+libff::bls12_377_Fq12 native_miller_loop(
+    const std::array<libff::bls12_377_G1, 4> &P,
+    const std::array<libff::bls12_377_G2, 4> &Q)
+{
+    libff::bls12_377_Fq12 f = libff::bls12_377_Fq12::one();
+    for (size_t i = 0; i < 4; ++i) {
+        const libff::bls12_377_G1 P_i = (i == 3) ? -P[i] : P[i];
+        f = f * npp::miller_loop(
+                    npp::precompute_G1(P_i), npp::precompute_G2(Q[i]));
+    }
+    return f;
+}
+
+/// Points such that e(P1, Q1) * e(P2, Q2) * e(P3, Q3) == e(P4, Q4) iff
+/// `valid`.
+void generate_points(
+    bool valid,
+    std::array<libff::bls12_377_G1, 4> &P,
+    std::array<libff::bls12_377_G2, 4> &Q)
+{
+    libff::bls12_377_Fr lhs_scalar = libff::bls12_377_Fr::zero();
+    for (size_t i = 0; i < 3; ++i) {
+        const libff::bls12_377_Fr a = libff::bls12_377_Fr::random_element();
+        const libff::bls12_377_Fr b = libff::bls12_377_Fr::random_element();
+        P[i] = a * libff::bls12_377_G1::one();
+        Q[i] = b * libff::bls12_377_G2::one();
+        lhs_scalar = lhs_scalar + a * b;
+    }
+    if (!valid) {
+        lhs_scalar = lhs_scalar + libff::bls12_377_Fr::one();
+    }
+    P[3] = lhs_scalar * libff::bls12_377_G1::one();
+    Q[3] = libff::bls12_377_G2::one();
+}
+
+/// Run the pairing check gadget `checkT` on the given points, and return the
+/// value of the result.
+template<typename checkT>
+libff::Fr<wpp> run_pairing_check(
+    const std::array<libff::bls12_377_G1, 4> &P,
+    const std::array<libff::bls12_377_G2, 4> &Q,
+    size_t &num_constraints)
+{
+    libsnark::protoboard<libff::Fr<wpp>> pb;
+
+    std::vector<std::shared_ptr<libsnark::G1_variable<wpp>>> P_vars;
+    std::vector<std::shared_ptr<libsnark::G2_variable<wpp>>> Q_vars;
+    std::vector<std::shared_ptr<G1_precomputation<wpp>>> P_precs;
+    std::vector<std::shared_ptr<G2_precomputation<wpp>>> Q_precs;
+    std::vector<std::shared_ptr<G1_precompute_gadget<wpp>>> compute_P_precs;
+    std::vector<std::shared_ptr<G2_precompute_gadget<wpp>>> compute_Q_precs;
+    for (size_t i = 0; i < 4; ++i) {
+        P_vars.emplace_back(new libsnark::G1_variable<wpp>(pb, "P"));
+        Q_vars.emplace_back(new libsnark::G2_variable<wpp>(pb, "Q"));
+        P_precs.emplace_back(new G1_precomputation<wpp>());
+        Q_precs.emplace_back(new G2_precomputation<wpp>());
+        compute_P_precs.emplace_back(new G1_precompute_gadget<wpp>(
+            pb, *P_vars[i], *P_precs[i], "compute_P_prec"));
+        compute_Q_precs.emplace_back(new G2_precompute_gadget<wpp>(
+            pb, *Q_vars[i], *Q_precs[i], "compute_Q_prec"));
+    }
+
+    libsnark::pb_variable<libff::Fr<wpp>> result;
+    result.allocate(pb, "result");
+
+    // P4, Q4 is the lhs of the check
+    checkT check(
+        pb,
+        *P_precs[3],
+        *Q_precs[3],
+        *P_precs[0],
+        *Q_precs[0],
+        *P_precs[1],
+        *Q_precs[1],
+        *P_precs[2],
+        *Q_precs[2],
+        result,
+        "check");
+
+    for (size_t i = 0; i < 4; ++i) {
+        compute_P_precs[i]->generate_r1cs_constraints();
+        compute_Q_precs[i]->generate_r1cs_constraints();
+    }
+    const size_t num_constraints_before = pb.num_constraints();
+    check.generate_r1cs_constraints();
+    num_constraints = pb.num_constraints() - num_constraints_before;
+
+    for (size_t i = 0; i < 4; ++i) {
+        P_vars[i]->generate_r1cs_witness(P[i]);
+        compute_P_precs[i]->generate_r1cs_witness();
+        Q_vars[i]->generate_r1cs_witness(Q[i]);
+        compute_Q_precs[i]->generate_r1cs_witness();
+    }
+    check.generate_r1cs_witness();
+
+    EXPECT_TRUE(pb.is_satisfied());
+    return pb.val(result);
+}
+
+TEST(BLS12_377_ResidueCheckTest, NativeWitness)
+{
+    std::array<libff::bls12_377_G1, 4> P;
+    std::array<libff::bls12_377_G2, 4> Q;
+
+    generate_points(true, P, Q);
+    const libff::bls12_377_Fq12 f_valid = native_miller_loop(P, Q);
+    ASSERT_EQ(
+        libff::bls12_377_Fq12::one(), npp::final_exponentiation(f_valid));
+    bls12_377_residue_witness witness;
+    ASSERT_TRUE(witness.compute(f_valid));
+    ASSERT_TRUE(witness.check(f_valid));
+
+    // The witness does not satisfy the check for any other f.
+    ASSERT_FALSE(witness.check(f_valid * f_valid.Frobenius_map(1)));
+
+    generate_points(false, P, Q);
+    const libff::bls12_377_Fq12 f_invalid = native_miller_loop(P, Q);
+    ASSERT_NE(
+        libff::bls12_377_Fq12::one(), npp::final_exponentiation(f_invalid));
+    ASSERT_FALSE(witness.compute(f_invalid));
+    ASSERT_FALSE(witness.check(f_invalid));
+}
+
+TEST(BLS12_377_ResidueCheckTest, ResidueCheckGadget)
+{
+    using residue_check = bls12_377_residue_check_e_equals_eee_gadget<wpp>;
+    using final_exp_check = check_e_equals_eee_gadget<wpp>;
+
+    std::array<libff::bls12_377_G1, 4> P;
+    std::array<libff::bls12_377_G2, 4> Q;
+    size_t num_residue_constraints = 0;
+    size_t num_final_exp_constraints = 0;
+
+    generate_points(true, P, Q);
+    ASSERT_EQ(
+        libff::Fr<wpp>::one(),
+        run_pairing_check<residue_check>(P, Q, num_residue_constraints));
+    ASSERT_EQ(
+        libff::Fr<wpp>::one(),
+        run_pairing_check<final_exp_check>(P, Q, num_final_exp_constraints));
+
+    generate_points(false, P, Q);
+    ASSERT_EQ(
+        libff::Fr<wpp>::zero(),
+        run_pairing_check<residue_check>(P, Q, num_residue_constraints));
+    ASSERT_EQ(
+        libff::Fr<wpp>::zero(),
+        run_pairing_check<final_exp_check>(P, Q, num_final_exp_constraints));
+
+    std::cout << "residue check: " << num_residue_constraints
+              << " constraints, final exponentiation check: "
+              << num_final_exp_constraints << " constraints" << std::endl;
+    ASSERT_LT(num_residue_constraints, num_final_exp_constraints);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    libff::bw6_761_pp::init_public_params();
+    libff::bls12_377_pp::init_public_params();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
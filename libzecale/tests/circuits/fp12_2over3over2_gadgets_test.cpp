@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0+
 
 #include "libzecale/circuits/fields/fp12_2over3over2_gadgets.hpp"
+#include "libzecale/circuits/fields/fp12_2over3over2_torus_gadgets.hpp"
 #include "libzecale/circuits/pairing/bls12_377_pairing.hpp"
 #include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
 
@@ -235,6 +236,130 @@ TEST(Fp12_2over3over2_Test, MulBy024GadgetTest)
     ASSERT_TRUE(snark::verify(primary_input, proof, keypair.vk));
 }
 
+TEST(Fp12_2over3over2_Test, Mul024By024GadgetTest)
+{
+    using Fp12T = libff::bls12_377_Fq12;
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp2T = typename Fp12T::my_Fp2;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    // Native multiplication of sparse elements x = ((x0, 0, x2), (0, x4, 0))
+    // and y = ((y0, 0, y2), (0, y4, 0)).
+    const Fp2T x0(FieldT("11"), FieldT("12"));
+    const Fp2T x2(FieldT("15"), FieldT("16"));
+    const Fp2T x4(FieldT("3"), FieldT("4"));
+    const Fp2T y0(FieldT("5"), FieldT("6"));
+    const Fp2T y2(FieldT("7"), FieldT("8"));
+    const Fp2T y4(FieldT("9"), FieldT("10"));
+    const Fp12T x(
+        Fp6T(x0, Fp2T::zero(), x2), Fp6T(Fp2T::zero(), x4, Fp2T::zero()));
+    const Fp12T y(
+        Fp6T(y0, Fp2T::zero(), y2), Fp6T(Fp2T::zero(), y4, Fp2T::zero()));
+    const Fp12T x_times_y = x * y;
+    ASSERT_EQ(x_times_y, x.mul_by_024(y0, y4, y2));
+
+    // Multiplication in a circuit
+    libsnark::protoboard<FieldT> pb;
+    libsnark::Fp2_variable<Fp2T> x0_var(pb, " x0");
+    libsnark::Fp2_variable<Fp2T> x2_var(pb, " x2");
+    libsnark::Fp2_variable<Fp2T> x4_var(pb, " x4");
+    libsnark::Fp2_variable<Fp2T> y0_var(pb, " y0");
+    libsnark::Fp2_variable<Fp2T> y2_var(pb, " y2");
+    libsnark::Fp2_variable<Fp2T> y4_var(pb, " y4");
+    const size_t num_primary_inputs = pb.num_inputs();
+    pb.set_input_sizes(num_primary_inputs);
+
+    libzecale::Fp12_2over3over2_mul_024_by_024_gadget<Fp12T> mul_024_by_024(
+        pb, x0_var, x2_var, x4_var, y0_var, y2_var, y4_var, "mul_024_by_024");
+
+    // Constraints (6 multiplications in Fp2)
+    mul_024_by_024.generate_r1cs_constraints();
+    ASSERT_EQ(18U, pb.num_constraints());
+
+    // Values
+    x0_var.generate_r1cs_witness(x0);
+    x2_var.generate_r1cs_witness(x2);
+    x4_var.generate_r1cs_witness(x4);
+    y0_var.generate_r1cs_witness(y0);
+    y2_var.generate_r1cs_witness(y2);
+    y4_var.generate_r1cs_witness(y4);
+    mul_024_by_024.generate_r1cs_witness();
+
+    ASSERT_EQ(x0 * y0, mul_024_by_024._compute_x0_y0.result.get_element());
+    ASSERT_EQ(x2 * y2, mul_024_by_024._compute_x2_y2.result.get_element());
+    ASSERT_EQ(x4 * y4, mul_024_by_024._compute_x4_y4.result.get_element());
+    ASSERT_EQ(x_times_y, mul_024_by_024.result().get_element());
+    ASSERT_TRUE(pb.is_satisfied());
+
+    // The result must not be satisfiable with a different product.
+    mul_024_by_024._result._c1._c1.generate_r1cs_witness(
+        x_times_y.coeffs[1].coeffs[1] + Fp2T::one());
+    ASSERT_FALSE(pb.is_satisfied());
+}
+
+TEST(Fp12_2over3over2_Test, Mul024By024GadgetConstantOperandTest)
+{
+    using Fp12T = libff::bls12_377_Fq12;
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp2T = typename Fp12T::my_Fp2;
+    using Fp6T = typename Fp12T::my_Fp6;
+
+    const Fp2T x0(FieldT("11"), FieldT("12"));
+    const Fp2T x2(FieldT("15"), FieldT("16"));
+    const Fp2T x4(FieldT("3"), FieldT("4"));
+    const Fp2T y0(FieldT("5"), FieldT("6"));
+    const Fp2T y2(FieldT("7"), FieldT("8"));
+    const Fp2T y4(FieldT("9"), FieldT("10"));
+    const Fp12T x(
+        Fp6T(x0, Fp2T::zero(), x2), Fp6T(Fp2T::zero(), x4, Fp2T::zero()));
+    const Fp12T y(
+        Fp6T(y0, Fp2T::zero(), y2), Fp6T(Fp2T::zero(), y4, Fp2T::zero()));
+    const Fp12T x_times_y = x * y;
+
+    // y0 is a constant, as the coefficient ell_0 of a line function from a
+    // constant G2 precomputation.
+    libsnark::protoboard<FieldT> pb;
+    libsnark::Fp2_variable<Fp2T> x0_var(pb, " x0");
+    libsnark::Fp2_variable<Fp2T> x2_var(pb, " x2");
+    libsnark::Fp2_variable<Fp2T> x4_var(pb, " x4");
+    libsnark::Fp2_variable<Fp2T> y0_var(pb, y0, " y0");
+    libsnark::Fp2_variable<Fp2T> y2_var(pb, " y2");
+    libsnark::Fp2_variable<Fp2T> y4_var(pb, " y4");
+    const size_t num_primary_inputs = pb.num_inputs();
+    pb.set_input_sizes(num_primary_inputs);
+    const size_t num_variables_before = pb.num_variables();
+
+    libzecale::Fp12_2over3over2_mul_024_by_024_gadget<Fp12T> mul_024_by_024(
+        pb, x0_var, x2_var, x4_var, y0_var, y2_var, y4_var, "mul_024_by_024");
+
+    // x0*y0 is a linear combination of x0: 5 multiplications in Fp2, and 3
+    // variables fewer than with a variable y0 (v1 and x0*y0).
+    ASSERT_TRUE(mul_024_by_024._compute_x0_y0.is_lean());
+    ASSERT_FALSE(mul_024_by_024._compute_x2_y2.is_lean());
+    ASSERT_FALSE(mul_024_by_024._compute_x4_y4.is_lean());
+    mul_024_by_024.generate_r1cs_constraints();
+    ASSERT_EQ(15U, pb.num_constraints());
+    ASSERT_EQ(15U, pb.num_variables() - num_variables_before);
+
+    // Values
+    x0_var.generate_r1cs_witness(x0);
+    x2_var.generate_r1cs_witness(x2);
+    x4_var.generate_r1cs_witness(x4);
+    y2_var.generate_r1cs_witness(y2);
+    y4_var.generate_r1cs_witness(y4);
+    mul_024_by_024.generate_r1cs_witness();
+
+    ASSERT_EQ(x0 * y0, mul_024_by_024._compute_x0_y0.result.get_element());
+    ASSERT_EQ(x_times_y, mul_024_by_024.result().get_element());
+    ASSERT_TRUE(pb.is_satisfied());
+
+    // The native witness agrees.
+    ASSERT_EQ(
+        x_times_y,
+        mul_024_by_024.generate_r1cs_witness_native(x0, x2, x4, y0, y2, y4));
+    ASSERT_TRUE(pb.is_satisfied());
+}
+
 TEST(Fp12_2over3over2_Test, MulGadgetTest)
 {
     using Fp12T = libff::bls12_377_Fq12;
@@ -464,6 +589,242 @@ TEST(Fp12_2over3over2_Test, CyclotomicSquareGadget)
     ASSERT_TRUE(snark::verify(primary_input, proof, keypair.vk));
 }
 
+TEST(Fp12_2over3over2_Test, Toom6MulAndSquareGadgetTest)
+{
+    using Fp12T = libff::bls12_377_Fq12;
+    using FieldT = typename Fp12T::my_Fp;
+
+    // Edge cases, followed by random elements
+    std::vector<Fp12T> values{Fp12T::zero(), Fp12T::one(), -Fp12T::one()};
+    for (size_t i = 0; i < 32; ++i) {
+        values.push_back(Fp12T::random_element());
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        const Fp12T a = values[i];
+        const Fp12T b = values[(i * 7 + 1) % values.size()];
+
+        libsnark::protoboard<FieldT> pb;
+        libzecale::Fp12_2over3over2_variable<Fp12T> a_var(pb, "a");
+        libzecale::Fp12_2over3over2_variable<Fp12T> b_var(pb, "b");
+        libzecale::Fp12_2over3over2_variable<Fp12T> a_times_b_var(pb, "a*b");
+        libzecale::Fp12_2over3over2_variable<Fp12T> a_squared_var(pb, "a^2");
+        libzecale::Fp12_2over3over2_toom6_mul_gadget<Fp12T> mul_a_b(
+            pb, a_var, b_var, a_times_b_var, "mul_a_b");
+        libzecale::Fp12_2over3over2_toom6_square_gadget<Fp12T> square_a(
+            pb, a_var, a_squared_var, "square_a");
+
+        mul_a_b.generate_r1cs_constraints();
+        ASSERT_EQ(33U, pb.num_constraints());
+        square_a.generate_r1cs_constraints();
+        ASSERT_EQ(55U, pb.num_constraints());
+
+        a_var.generate_r1cs_witness(a);
+        b_var.generate_r1cs_witness(b);
+        mul_a_b.generate_r1cs_witness();
+        square_a.generate_r1cs_witness();
+
+        ASSERT_TRUE(pb.is_satisfied());
+        ASSERT_EQ(a * b, a_times_b_var.get_element());
+        ASSERT_EQ(a.squared(), a_squared_var.get_element());
+
+        // Any other result is rejected
+        a_times_b_var.generate_r1cs_witness(a * b + Fp12T::one());
+        ASSERT_FALSE(pb.is_satisfied());
+    }
+}
+
+TEST(Fp12_2over3over2_Test, TorusGadgetsTest)
+{
+    using Fp12T = libff::bls12_377_Fq12;
+    using FieldT = typename Fp12T::my_Fp;
+    using Fp6T = typename Fp12T::my_Fp6;
+    using Fp6_variable = libzecale::Fp6_3over2_variable<Fp6T>;
+    using Fp12_variable = libzecale::Fp12_2over3over2_variable<Fp12T>;
+
+    for (size_t i = 0; i < 8; ++i) {
+        // Elements of the cyclotomic subgroup
+        const Fp12T a = libff::bls12_377_final_exponentiation_first_chunk(
+            Fp12T::random_element());
+        const Fp12T b = libff::bls12_377_final_exponentiation_first_chunk(
+            Fp12T::random_element());
+
+        // Native compression and Frobenius maps
+        const Fp6T c_a = libzecale::fp12_torus_compress(a);
+        ASSERT_EQ(a, libzecale::fp12_torus_decompress<Fp12T>(c_a));
+        ASSERT_EQ(
+            a.unitary_inverse(), libzecale::fp12_torus_decompress<Fp12T>(-c_a));
+        for (size_t power = 1; power < 4; ++power) {
+            ASSERT_EQ(
+                a.Frobenius_map(power),
+                libzecale::fp12_torus_decompress<Fp12T>(
+                    libzecale::fp12_torus_frobenius_map<Fp12T>(c_a, power)));
+        }
+
+        // Check the per-gadget and native witness generation
+        for (const bool native : {false, true}) {
+            libsnark::protoboard<FieldT> pb;
+            Fp12_variable a_var(pb, "a");
+            Fp12_variable b_var(pb, "b");
+            libzecale::Fp12_2over3over2_torus_compress_gadget<Fp12T>
+                compress_a(pb, a_var, Fp6_variable(pb, "c_a"), "compress_a");
+            libzecale::Fp12_2over3over2_torus_compress_gadget<Fp12T>
+                compress_b(pb, b_var, Fp6_variable(pb, "c_b"), "compress_b");
+            libzecale::Fp12_2over3over2_torus_mul_gadget<Fp12T> mul_a_b(
+                pb,
+                compress_a.result(),
+                compress_b.result(),
+                Fp6_variable(pb, "c_a*b"),
+                "mul_a_b");
+            libzecale::Fp12_2over3over2_torus_square_gadget<Fp12T> square_a(
+                pb, compress_a.result(), Fp6_variable(pb, "c_a^2"), "square_a");
+            libzecale::Fp12_2over3over2_torus_decompress_gadget<Fp12T>
+                decompress_a_b(
+                    pb, mul_a_b.result(), Fp12_variable(pb, "a*b"), "a*b");
+            libzecale::Fp12_2over3over2_torus_decompress_gadget<Fp12T>
+                decompress_a_squared(
+                    pb, square_a.result(), Fp12_variable(pb, "a^2"), "a^2");
+            // The result of a * a^(-1) (= 1) has no compressed form
+            libzecale::Fp12_2over3over2_torus_mul_decompress_gadget<Fp12T>
+                mul_a_a_inv(
+                    pb,
+                    compress_a.result(),
+                    -compress_a.result(),
+                    Fp12_variable(pb, "a*a^(-1)"),
+                    "mul_a_a_inv");
+            libzecale::Fp12_2over3over2_torus_mul_decompress_gadget<Fp12T>
+                mul_decompress_a_b(
+                    pb,
+                    compress_a.result(),
+                    compress_b.result(),
+                    Fp12_variable(pb, "a*b"),
+                    "mul_decompress_a_b");
+
+            compress_a.generate_r1cs_constraints();
+            compress_b.generate_r1cs_constraints();
+            ASSERT_EQ(30U, pb.num_constraints());
+            mul_a_b.generate_r1cs_constraints();
+            ASSERT_EQ(60U, pb.num_constraints());
+            square_a.generate_r1cs_constraints();
+            ASSERT_EQ(75U, pb.num_constraints());
+            decompress_a_b.generate_r1cs_constraints();
+            decompress_a_squared.generate_r1cs_constraints();
+            ASSERT_EQ(135U, pb.num_constraints());
+            mul_a_a_inv.generate_r1cs_constraints();
+            mul_decompress_a_b.generate_r1cs_constraints();
+            ASSERT_EQ(231U, pb.num_constraints());
+            ASSERT_EQ(pb.num_constraints(), pb.num_variables() - 24);
+
+            a_var.generate_r1cs_witness(a);
+            b_var.generate_r1cs_witness(b);
+            if (native) {
+                const Fp6T c_a = compress_a.generate_r1cs_witness_native(a);
+                const Fp6T c_b = compress_b.generate_r1cs_witness_native(b);
+                decompress_a_b.generate_r1cs_witness_native(
+                    mul_a_b.generate_r1cs_witness_native(c_a, c_b));
+                decompress_a_squared.generate_r1cs_witness_native(
+                    square_a.generate_r1cs_witness_native(c_a));
+                mul_a_a_inv.generate_r1cs_witness_native(c_a, -c_a);
+                mul_decompress_a_b.generate_r1cs_witness_native(c_a, c_b);
+            } else {
+                compress_a.generate_r1cs_witness();
+                compress_b.generate_r1cs_witness();
+                mul_a_b.generate_r1cs_witness();
+                square_a.generate_r1cs_witness();
+                decompress_a_b.generate_r1cs_witness();
+                decompress_a_squared.generate_r1cs_witness();
+                mul_a_a_inv.generate_r1cs_witness();
+                mul_decompress_a_b.generate_r1cs_witness();
+            }
+
+            ASSERT_TRUE(pb.is_satisfied());
+            ASSERT_EQ(a * b, decompress_a_b.result().get_element());
+            ASSERT_EQ(
+                a.cyclotomic_squared(),
+                decompress_a_squared.result().get_element());
+            ASSERT_EQ(Fp12T::one(), mul_a_a_inv.result().get_element());
+            ASSERT_EQ(a * b, mul_decompress_a_b.result().get_element());
+
+            // Any other result is rejected
+            Fp6_variable c_a_times_b = mul_a_b.result();
+            c_a_times_b.generate_r1cs_witness(
+                c_a_times_b.get_element() + Fp6T::one());
+            ASSERT_FALSE(pb.is_satisfied());
+        }
+    }
+}
+
+/// Number of constraints of a gadget computing result = a * b.
+template<typename VariableT, typename MulGadgetT> size_t mul_num_constraints()
+{
+    libsnark::protoboard<typename VariableT::FieldT> pb;
+    VariableT a_var(pb, "a");
+    VariableT b_var(pb, "b");
+    VariableT result_var(pb, "result");
+    MulGadgetT mul(pb, a_var, b_var, result_var, "mul");
+    mul.generate_r1cs_constraints();
+    return pb.num_constraints();
+}
+
+/// Number of constraints of a gadget computing result = a^2.
+template<typename VariableT, typename SquareGadgetT>
+size_t square_num_constraints()
+{
+    libsnark::protoboard<typename VariableT::FieldT> pb;
+    VariableT a_var(pb, "a");
+    VariableT result_var(pb, "result");
+    SquareGadgetT square(pb, a_var, result_var, "square");
+    square.generate_r1cs_constraints();
+    return pb.num_constraints();
+}
+
+TEST(Fp12_2over3over2_Test, Toom6AndTorusGadgetsAgainstSchoolbook)
+{
+    using Fp12T = libff::bls12_377_Fq12;
+    using Fp6T = typename Fp12T::my_Fp6;
+    using Fp6_variable = libzecale::Fp6_3over2_variable<Fp6T>;
+    using Fp12_variable = libzecale::Fp12_2over3over2_variable<Fp12T>;
+
+    // Multiplication
+    const size_t schoolbook_mul = mul_num_constraints<
+        Fp12_variable,
+        libzecale::Fp12_2over3over2_mul_gadget<Fp12T>>();
+    const size_t toom6_mul = mul_num_constraints<
+        Fp12_variable,
+        libzecale::Fp12_2over3over2_toom6_mul_gadget<Fp12T>>();
+    const size_t torus_mul = mul_num_constraints<
+        Fp6_variable,
+        libzecale::Fp12_2over3over2_torus_mul_gadget<Fp12T>>();
+
+    ASSERT_EQ(54U, schoolbook_mul);
+    ASSERT_EQ(33U, toom6_mul);
+    ASSERT_EQ(30U, torus_mul);
+    ASSERT_LT(toom6_mul, schoolbook_mul);
+    ASSERT_LT(torus_mul, toom6_mul);
+
+    // Squaring (the cyclotomic and torus squarings only apply to elements of
+    // the cyclotomic subgroup)
+    const size_t schoolbook_square = square_num_constraints<
+        Fp12_variable,
+        libzecale::Fp12_2over3over2_square_gadget<Fp12T>>();
+    const size_t toom6_square = square_num_constraints<
+        Fp12_variable,
+        libzecale::Fp12_2over3over2_toom6_square_gadget<Fp12T>>();
+    const size_t cyclotomic_square = square_num_constraints<
+        Fp12_variable,
+        libzecale::Fp12_2over3over2_cyclotomic_square_gadget<Fp12T>>();
+    const size_t torus_square = square_num_constraints<
+        Fp6_variable,
+        libzecale::Fp12_2over3over2_torus_square_gadget<Fp12T>>();
+
+    ASSERT_EQ(36U, schoolbook_square);
+    ASSERT_EQ(22U, toom6_square);
+    ASSERT_EQ(18U, cyclotomic_square);
+    ASSERT_EQ(15U, torus_square);
+    ASSERT_LT(toom6_square, schoolbook_square);
+    ASSERT_LT(torus_square, cyclotomic_square);
+}
+
 } // namespace
 
 int main(int argc, char **argv)
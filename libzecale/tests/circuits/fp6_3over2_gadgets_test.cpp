@@ -156,6 +156,99 @@ TEST(Fp6_3over2_Test, MulGadgetTest)
     ASSERT_TRUE(snark::verify(primary_input, proof, keypair.vk));
 }
 
+TEST(Fp6_3over2_Test, Toom3MulAndSquareGadgetTest)
+{
+    using Fp6T = libff::bls12_377_Fq6;
+    using FieldT = typename Fp6T::my_Fp;
+
+    // Edge cases, followed by random elements
+    std::vector<Fp6T> values{Fp6T::zero(), Fp6T::one(), -Fp6T::one()};
+    for (size_t i = 0; i < 32; ++i) {
+        values.push_back(Fp6T::random_element());
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        const Fp6T a = values[i];
+        const Fp6T b = values[(i * 7 + 1) % values.size()];
+
+        libsnark::protoboard<FieldT> pb;
+        libzecale::Fp6_3over2_variable<Fp6T> a_var(pb, "a");
+        libzecale::Fp6_3over2_variable<Fp6T> b_var(pb, "b");
+        libzecale::Fp6_3over2_variable<Fp6T> a_times_b_var(pb, "a*b");
+        libzecale::Fp6_3over2_variable<Fp6T> a_squared_var(pb, "a^2");
+        libzecale::Fp6_3over2_toom3_mul_gadget<Fp6T> mul_a_b(
+            pb, a_var, b_var, a_times_b_var, "mul_a_b");
+        libzecale::Fp6_3over2_toom3_square_gadget<Fp6T> square_a(
+            pb, a_var, a_squared_var, "square_a");
+
+        mul_a_b.generate_r1cs_constraints();
+        ASSERT_EQ(15U, pb.num_constraints());
+        square_a.generate_r1cs_constraints();
+        ASSERT_EQ(25U, pb.num_constraints());
+
+        a_var.generate_r1cs_witness(a);
+        b_var.generate_r1cs_witness(b);
+        mul_a_b.generate_r1cs_witness();
+        square_a.generate_r1cs_witness();
+
+        ASSERT_TRUE(pb.is_satisfied());
+        ASSERT_EQ(a * b, a_times_b_var.get_element());
+        ASSERT_EQ(a.squared(), a_squared_var.get_element());
+
+        // Any other result is rejected
+        a_times_b_var.generate_r1cs_witness(a * b + Fp6T::one());
+        ASSERT_FALSE(pb.is_satisfied());
+    }
+}
+
+/// Number of constraints of a gadget computing result = a * b.
+template<typename VariableT, typename MulGadgetT> size_t mul_num_constraints()
+{
+    libsnark::protoboard<typename VariableT::FieldT> pb;
+    VariableT a_var(pb, "a");
+    VariableT b_var(pb, "b");
+    VariableT result_var(pb, "result");
+    MulGadgetT mul(pb, a_var, b_var, result_var, "mul");
+    mul.generate_r1cs_constraints();
+    return pb.num_constraints();
+}
+
+/// Number of constraints of a gadget computing result = a^2.
+template<typename VariableT, typename SquareGadgetT>
+size_t square_num_constraints()
+{
+    libsnark::protoboard<typename VariableT::FieldT> pb;
+    VariableT a_var(pb, "a");
+    VariableT result_var(pb, "result");
+    SquareGadgetT square(pb, a_var, result_var, "square");
+    square.generate_r1cs_constraints();
+    return pb.num_constraints();
+}
+
+TEST(Fp6_3over2_Test, Toom3GadgetsAgainstSchoolbook)
+{
+    using Fp6T = libff::bls12_377_Fq6;
+    using Fp6_variable = libzecale::Fp6_3over2_variable<Fp6T>;
+
+    // Schoolbook (Karatsuba) multiplication, which is also the only way to
+    // square without the Toom-3 gadgets.
+    const size_t schoolbook_mul = mul_num_constraints<
+        Fp6_variable,
+        libzecale::Fp6_3over2_mul_gadget<Fp6T>>();
+    const size_t toom3_mul = mul_num_constraints<
+        Fp6_variable,
+        libzecale::Fp6_3over2_toom3_mul_gadget<Fp6T>>();
+    const size_t toom3_square = square_num_constraints<
+        Fp6_variable,
+        libzecale::Fp6_3over2_toom3_square_gadget<Fp6T>>();
+
+    ASSERT_EQ(18U, schoolbook_mul);
+    ASSERT_EQ(15U, toom3_mul);
+    ASSERT_EQ(10U, toom3_square);
+    ASSERT_LT(toom3_mul, schoolbook_mul);
+    ASSERT_LT(toom3_square, toom3_mul);
+}
+
 } // namespace
 
 int main(int argc, char **argv)
@@ -208,6 +208,87 @@ TEST(MillerLoopGadgets, TestMntEEEoverEmillerLoop)
         " test_eee_over_e_miller_loop_mnt6");
 }
 
+/// Check the k-pair MNT Miller loop gadget against the product of the native
+/// Miller loops of the pairs, where the pairs flagged in `inverted` are
+/// inverted.
+template<typename ppT>
+void test_mnt_multi_miller_loop(
+    const std::vector<bool> &inverted, const std::string &annotation)
+{
+    using npp = other_curve<ppT>;
+    const size_t num_pairs = inverted.size();
+
+    libsnark::protoboard<libff::Fr<ppT>> pb;
+    std::vector<libff::G1<npp>> P_vals;
+    std::vector<libff::G2<npp>> Q_vals;
+    std::vector<std::shared_ptr<libsnark::G1_variable<ppT>>> Ps;
+    std::vector<std::shared_ptr<libsnark::G2_variable<ppT>>> Qs;
+    std::vector<G1_precomputation<ppT>> prec_Ps(num_pairs);
+    std::vector<G2_precomputation<ppT>> prec_Qs(num_pairs);
+    std::vector<std::shared_ptr<G1_precompute_gadget<ppT>>> compute_prec_Ps;
+    std::vector<std::shared_ptr<G2_precompute_gadget<ppT>>> compute_prec_Qs;
+    libff::Fqk<npp> expect_result = libff::Fqk<npp>::one();
+    for (size_t i = 0; i < num_pairs; ++i) {
+        P_vals.push_back(
+            libff::Fr<npp>::random_element() * libff::G1<npp>::one());
+        Q_vals.push_back(
+            libff::Fr<npp>::random_element() * libff::G2<npp>::one());
+        const libff::Fqk<npp> miller_P_Q = npp::affine_ate_miller_loop(
+            npp::affine_ate_precompute_G1(P_vals[i]),
+            npp::affine_ate_precompute_G2(Q_vals[i]));
+        expect_result =
+            expect_result * (inverted[i] ? miller_P_Q.inverse() : miller_P_Q);
+
+        Ps.emplace_back(
+            new libsnark::G1_variable<ppT>(pb, FMT(annotation, " P_%zu", i)));
+        Qs.emplace_back(
+            new libsnark::G2_variable<ppT>(pb, FMT(annotation, " Q_%zu", i)));
+        compute_prec_Ps.emplace_back(new G1_precompute_gadget<ppT>(
+            pb, *Ps[i], prec_Ps[i], FMT(annotation, " compute_prec_P_%zu", i)));
+        compute_prec_Qs.emplace_back(new G2_precompute_gadget<ppT>(
+            pb, *Qs[i], prec_Qs[i], FMT(annotation, " compute_prec_Q_%zu", i)));
+    }
+
+    Fqk_variable<ppT> result(pb, "result");
+    mnt_multi_miller_loop_gadget<ppT> miller(
+        pb, prec_Ps, prec_Qs, inverted, result, "miller");
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        compute_prec_Ps[i]->generate_r1cs_constraints();
+        compute_prec_Qs[i]->generate_r1cs_constraints();
+    }
+    miller.generate_r1cs_constraints();
+
+    for (size_t i = 0; i < num_pairs; ++i) {
+        Ps[i]->generate_r1cs_witness(P_vals[i]);
+        compute_prec_Ps[i]->generate_r1cs_witness();
+        Qs[i]->generate_r1cs_witness(Q_vals[i]);
+        compute_prec_Qs[i]->generate_r1cs_witness();
+    }
+    miller.generate_r1cs_witness();
+
+    ASSERT_TRUE(pb.is_satisfied());
+    ASSERT_EQ(expect_result, result.get_element());
+
+    printf(
+        "number of constraints for %zu-pair Miller loop (Fr is %s)  = %zu\n",
+        num_pairs,
+        annotation.c_str(),
+        pb.num_constraints());
+}
+
+TEST(MillerLoopGadgets, TestMntMultiMillerLoop)
+{
+    test_mnt_multi_miller_loop<libff::mnt4_pp>(
+        {false}, " test_multi_miller_loop_mnt4");
+    test_mnt_multi_miller_loop<libff::mnt4_pp>(
+        {true, false, false, true, false}, " test_multi_miller_loop_mnt4");
+    test_mnt_multi_miller_loop<libff::mnt6_pp>(
+        {true}, " test_multi_miller_loop_mnt6");
+    test_mnt_multi_miller_loop<libff::mnt6_pp>(
+        {false, true, false, false, true}, " test_multi_miller_loop_mnt6");
+}
+
 TEST(MillerLoopGadgets, TestBlsEEEoverEmillerLoop)
 {
     using wpp = libff::bw6_761_pp;
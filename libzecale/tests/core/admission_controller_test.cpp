@@ -0,0 +1,79 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/admission_controller.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace libzecale;
+
+namespace
+{
+
+TEST(AdmissionControllerTest, EstimateTimeToProof)
+{
+    const server_config config;
+    // Batches of 2 transactions, 2 proved concurrently
+    admission_controller controller(config, 2, 2);
+
+    // Unknown throughput
+    ASSERT_EQ(0.0, controller.estimate_time_to_proof(100, 100, 1));
+    ASSERT_EQ(
+        admission_decision::admit, controller.admit(100, 100, 1, 0).decision);
+
+    // 10s per batch, i.e. 5s per transaction
+    controller.on_batch_proved(2, 10.0);
+
+    // 3 transactions ahead: 2 batches, proved concurrently
+    ASSERT_DOUBLE_EQ(10.0, controller.estimate_time_to_proof(3, 3, 1));
+    // 4 ahead: 3 batches
+    ASSERT_DOUBLE_EQ(15.0, controller.estimate_time_to_proof(4, 4, 1));
+    // Prover shared with 3 other applications
+    ASSERT_DOUBLE_EQ(40.0, controller.estimate_time_to_proof(3, 100, 4));
+    // ... but bounded by the time to prove all pending transactions
+    ASSERT_DOUBLE_EQ(20.0, controller.estimate_time_to_proof(3, 6, 4));
+
+    // Moving average
+    controller.on_batch_proved(2, 20.0);
+    ASSERT_DOUBLE_EQ(12.0, controller.estimate_time_to_proof(3, 3, 1));
+}
+
+TEST(AdmissionControllerTest, Admit)
+{
+    server_config config;
+    config.target_time_to_proof_seconds = 100.0;
+    config.congested_min_fee_wei = 10;
+    config.max_application_share = 0.5;
+    config.max_time_to_proof_seconds = 1000.0;
+    // 1 transaction per batch, 1s per batch, 1 worker
+    admission_controller controller(config, 1, 1);
+    controller.on_batch_proved(1, 1.0);
+
+    // Not congested
+    admission_result result = controller.admit(50, 50, 1, 0);
+    ASSERT_EQ(admission_decision::admit, result.decision);
+    ASSERT_DOUBLE_EQ(51.0, result.time_to_proof_seconds);
+
+    // Congested: the minimum fee applies
+    result = controller.admit(200, 200, 1, 9);
+    ASSERT_EQ(admission_decision::fee_too_low, result.decision);
+    ASSERT_EQ(10u, result.min_fee_wei);
+    ASSERT_DOUBLE_EQ(101.0, result.retry_after_seconds);
+    ASSERT_EQ(
+        admission_decision::admit, controller.admit(200, 200, 1, 10).decision);
+
+    // Congested, and another application is waiting: the quota applies
+    result = controller.admit(150, 200, 2, 100);
+    ASSERT_EQ(admission_decision::over_quota, result.decision);
+    ASSERT_DOUBLE_EQ(2.0 * 51.0, result.retry_after_seconds);
+    ASSERT_EQ(
+        admission_decision::admit, controller.admit(50, 200, 2, 100).decision);
+
+    // Overloaded
+    result = controller.admit(2000, 2000, 1, 100);
+    ASSERT_EQ(admission_decision::overloaded, result.decision);
+    ASSERT_DOUBLE_EQ(1001.0, result.retry_after_seconds);
+}
+
+} // namespace
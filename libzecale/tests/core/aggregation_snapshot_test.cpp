@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/aggregation_snapshot.hpp"
+
+#include "gtest/gtest.h"
+#include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
+#include <libzeth/snarks/groth16/groth16_snark.hpp>
+#include <sstream>
+
+using namespace libzecale;
+
+namespace
+{
+
+using ppT = libff::mnt4_pp;
+using snarkT = libzeth::groth16_snark<ppT>;
+static const size_t num_proofs = 2;
+using snapshot = aggregation_snapshot<ppT, snarkT, num_proofs>;
+
+libzeth::extended_proof<ppT, snarkT> random_extended_proof()
+{
+    libsnark::r1cs_gg_ppzksnark_proof<ppT> proof(
+        libff::G1<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        libff::G1<ppT>::random_element());
+    std::vector<libff::Fr<ppT>> inputs;
+    inputs.push_back(libff::Fr<ppT>::random_element());
+    inputs.push_back(libff::Fr<ppT>::random_element());
+    return libzeth::extended_proof<ppT, snarkT>(
+        std::move(proof), std::move(inputs));
+}
+
+circuit_fingerprint dummy_fingerprint()
+{
+    circuit_fingerprint fingerprint;
+    fingerprint.wrapping_field_bits = 298;
+    fingerprint.nested_field_bits = 298;
+    fingerprint.num_proofs = num_proofs;
+    fingerprint.num_constraints = 123456;
+    fingerprint.num_variables = 234567;
+    fingerprint.num_inputs = 21;
+    return fingerprint;
+}
+
+TEST(AggregationSnapshotTest, WriteAndReadMnt4Groth16)
+{
+    const circuit_fingerprint fingerprint = dummy_fingerprint();
+    const typename snarkT::verification_key vk =
+        libsnark::r1cs_gg_ppzksnark_verification_key<
+            ppT>::dummy_verification_key(2);
+    const libzeth::extended_proof<ppT, snarkT> proof_0 =
+        random_extended_proof();
+    const libzeth::extended_proof<ppT, snarkT> proof_1 =
+        random_extended_proof();
+
+    std::stringstream ss;
+    snapshot::write(ss, fingerprint, vk, {{&proof_0, &proof_1}});
+    const snapshot read_snapshot = snapshot::read(ss);
+
+    ASSERT_EQ(fingerprint, read_snapshot.fingerprint);
+    ASSERT_EQ(vk, read_snapshot.nested_vk);
+    ASSERT_EQ(
+        proof_0.get_proof(), read_snapshot.extended_proofs[0]->get_proof());
+    ASSERT_EQ(
+        proof_0.get_primary_inputs(),
+        read_snapshot.extended_proofs[0]->get_primary_inputs());
+    ASSERT_EQ(
+        proof_1.get_proof(), read_snapshot.extended_proofs[1]->get_proof());
+    ASSERT_EQ(
+        proof_1.get_primary_inputs(),
+        read_snapshot.extended_proofs[1]->get_primary_inputs());
+}
+
+TEST(AggregationSnapshotTest, RejectInvalidSnapshot)
+{
+    const libzeth::extended_proof<ppT, snarkT> proof_0 =
+        random_extended_proof();
+    const libzeth::extended_proof<ppT, snarkT> proof_1 =
+        random_extended_proof();
+
+    std::stringstream ss;
+    snapshot::write(
+        ss,
+        dummy_fingerprint(),
+        libsnark::r1cs_gg_ppzksnark_verification_key<
+            ppT>::dummy_verification_key(2),
+        {{&proof_0, &proof_1}});
+
+    // Truncated snapshot
+    const std::string data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() / 2));
+    ASSERT_THROW(snapshot::read(truncated), std::runtime_error);
+
+    // Wrong number of proofs
+    std::stringstream wrong_size(data);
+    ASSERT_THROW(
+        (aggregation_snapshot<ppT, snarkT, 1>::read(wrong_size)),
+        std::runtime_error);
+
+    // Not a snapshot
+    std::stringstream garbage("not a snapshot");
+    ASSERT_THROW(snapshot::read(garbage), std::runtime_error);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Initialize the curve parameters before running the tests
+    libff::mnt4_pp::init_public_params();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
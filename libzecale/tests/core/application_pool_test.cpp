@@ -6,6 +6,7 @@
 #include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
 #include "libzecale/circuits/pghr13_verifier/pghr13_verifier_parameters.hpp"
 #include "libzecale/core/application_pool.hpp"
+#include "libzecale/core/mixed_batch.hpp"
 
 #include "gtest/gtest.h"
 // #include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
@@ -140,6 +141,174 @@ void test_add_and_retrieve_transactions()
     ASSERT_EQ(pool.tx_pool_size(), (size_t)5 - BATCH_SIZE);
 }
 
+template<typename ppT, typename snarkT>
+void test_move_transactions_through_pool()
+{
+    const size_t BATCH_SIZE = 2;
+    std::string dummy_app_name = std::string("test_application");
+    typename snarkT::verification_key vk =
+        dummy_provider<snarkT>::get_verification_key(42);
+    application_pool<ppT, snarkT, BATCH_SIZE> pool(dummy_app_name, vk);
+    pool.reserve(3);
+
+    // Create transactions by moving freshly constructed extended proofs in,
+    // and record the address of each nested proof.
+    const uint32_t fees[] = {7, 42, 3};
+    std::array<const libzeth::extended_proof<ppT, snarkT> *, 3> proof_ptrs;
+    for (size_t i = 0; i < 3; i++) {
+        std::vector<libff::Fr<ppT>> dummy_inputs;
+        dummy_inputs.push_back(libff::Fr<ppT>::random_element());
+        libzeth::extended_proof<ppT, snarkT> ext_proof(
+            dummy_provider<snarkT>::get_proof(), std::move(dummy_inputs));
+        transaction_to_aggregate<ppT, snarkT> tx(
+            std::string(dummy_app_name), std::move(ext_proof), fees[i]);
+        proof_ptrs[i] = &tx.extended_proof();
+        pool.add_tx(std::move(tx));
+    }
+    ASSERT_EQ(pool.tx_pool_size(), (size_t)3);
+
+    // The batch must contain the highest fee transactions, in order, and hold
+    // the very same nested proofs (i.e. no copy has been made on the way).
+    std::array<transaction_to_aggregate<ppT, snarkT>, BATCH_SIZE> batch =
+        pool.get_next_batch();
+    ASSERT_EQ(pool.tx_pool_size(), (size_t)1);
+    ASSERT_EQ((uint32_t)42, batch[0].fee_wei());
+    ASSERT_EQ((uint32_t)7, batch[1].fee_wei());
+    ASSERT_EQ(proof_ptrs[1], &batch[0].extended_proof());
+    ASSERT_EQ(proof_ptrs[0], &batch[1].extended_proof());
+
+    // Draining the pool yields a partially filled batch.
+    std::array<transaction_to_aggregate<ppT, snarkT>, BATCH_SIZE> last_batch =
+        pool.get_next_batch();
+    ASSERT_EQ(pool.tx_pool_size(), (size_t)0);
+    ASSERT_EQ((uint32_t)3, last_batch[0].fee_wei());
+    ASSERT_EQ(proof_ptrs[2], &last_batch[0].extended_proof());
+}
+
+template<typename ppT, typename snarkT> void test_evict_lowest_fee()
+{
+    const size_t BATCH_SIZE = 2;
+    std::string dummy_app_name = std::string("test_application");
+    application_pool<ppT, snarkT, BATCH_SIZE> pool(
+        dummy_app_name, dummy_provider<snarkT>::get_verification_key(42));
+    ASSERT_EQ(nullptr, pool.lowest_fee_tx());
+
+    std::vector<libff::Fr<ppT>> dummy_inputs;
+    dummy_inputs.push_back(libff::Fr<ppT>::random_element());
+    libzeth::extended_proof<ppT, snarkT> dummy_extended_proof(
+        dummy_provider<snarkT>::get_proof(), std::move(dummy_inputs));
+    const uint32_t fees[] = {15, 4, 23, 8, 42, 16};
+    for (const uint32_t fee : fees) {
+        pool.add_tx(transaction_to_aggregate<ppT, snarkT>(
+            dummy_app_name, dummy_extended_proof, fee));
+    }
+
+    // Evict the lowest fee transactions, one at a time
+    ASSERT_EQ((uint32_t)4, pool.lowest_fee_tx()->fee_wei());
+    ASSERT_EQ((uint32_t)4, pool.pop_lowest_fee_tx().fee_wei());
+    ASSERT_EQ((uint32_t)8, pool.pop_lowest_fee_tx().fee_wei());
+    ASSERT_EQ((size_t)4, pool.tx_pool_size());
+
+    // The remaining transactions are still retrieved by decreasing fee
+    ASSERT_EQ((uint32_t)42, pool.pop_tx().fee_wei());
+    ASSERT_EQ((uint32_t)23, pool.pop_tx().fee_wei());
+    ASSERT_EQ((uint32_t)16, pool.pop_tx().fee_wei());
+    ASSERT_EQ((uint32_t)15, pool.lowest_fee_tx()->fee_wei());
+    ASSERT_EQ((uint32_t)15, pool.pop_lowest_fee_tx().fee_wei());
+    ASSERT_EQ((size_t)0, pool.tx_pool_size());
+}
+
+template<typename ppT, typename snarkT> void test_mixed_batch()
+{
+    const size_t POOL_BATCH_SIZE = 2;
+    const size_t MIXED_BATCH_SIZE = 3;
+    const size_t NUM_VKS = 2;
+    using pool_type = application_pool<ppT, snarkT, POOL_BATCH_SIZE>;
+
+    const std::array<std::string, 3> app_names = {"app_a", "app_b", "app_c"};
+    std::array<pool_type, 3> pools;
+    for (size_t p = 0; p < app_names.size(); p++) {
+        pools[p] = pool_type(
+            app_names[p], dummy_provider<snarkT>::get_verification_key(9));
+    }
+
+    // (pool index, fee) of the transactions to add
+    const std::vector<std::pair<size_t, uint32_t>> txs = {
+        {0, 5}, {1, 30}, {2, 20}, {0, 10}, {2, 4}, {1, 1}};
+    for (const std::pair<size_t, uint32_t> &pool_fee : txs) {
+        std::vector<libff::Fr<ppT>> dummy_inputs;
+        dummy_inputs.push_back(libff::Fr<ppT>::random_element());
+        libzeth::extended_proof<ppT, snarkT> ext_proof(
+            dummy_provider<snarkT>::get_proof(), std::move(dummy_inputs));
+        pools[pool_fee.first].add_tx(transaction_to_aggregate<ppT, snarkT>(
+            std::string(app_names[pool_fee.first]),
+            std::move(ext_proof),
+            pool_fee.second));
+    }
+
+    const std::vector<pool_type *> pool_ptrs = {
+        &pools[0], &pools[1], &pools[2]};
+    mixed_batch<ppT, snarkT, MIXED_BATCH_SIZE, NUM_VKS> batch =
+        get_next_mixed_batch<
+            ppT,
+            snarkT,
+            POOL_BATCH_SIZE,
+            MIXED_BATCH_SIZE,
+            NUM_VKS>(pool_ptrs);
+
+    // Highest fees are 30 (app_b) and 20 (app_c). The next highest is 10
+    // (app_a), but the batch is already full of applications, so the next
+    // transaction is taken from app_c (fee 4).
+    ASSERT_EQ(MIXED_BATCH_SIZE, batch.num_txs());
+    ASSERT_EQ(NUM_VKS, batch.num_applications());
+    ASSERT_EQ("app_b", batch.application_name(0));
+    ASSERT_EQ("app_c", batch.application_name(1));
+    ASSERT_EQ((uint32_t)30, batch.tx(0).fee_wei());
+    ASSERT_EQ((uint32_t)20, batch.tx(1).fee_wei());
+    ASSERT_EQ((uint32_t)4, batch.tx(2).fee_wei());
+    ASSERT_EQ((size_t)0, batch.vk_indices()[0]);
+    ASSERT_EQ((size_t)1, batch.vk_indices()[1]);
+    ASSERT_EQ((size_t)1, batch.vk_indices()[2]);
+    ASSERT_EQ(&pools[1].verification_key(), batch.nested_vks()[0]);
+    ASSERT_EQ(&pools[2].verification_key(), batch.nested_vks()[1]);
+
+    ASSERT_EQ((size_t)2, pools[0].tx_pool_size());
+    ASSERT_EQ((size_t)1, pools[1].tx_pool_size());
+    ASSERT_EQ((size_t)0, pools[2].tx_pool_size());
+
+    // The batch shares the verification keys with the pools, and remains
+    // valid if a pool is replaced
+    pools[1] = pool_type(
+        app_names[1], dummy_provider<snarkT>::get_verification_key(9));
+    ASSERT_NE(&pools[1].verification_key(), batch.nested_vks()[0]);
+    ASSERT_NE(nullptr, batch.nested_vks()[0]);
+
+    // A pool without a verification key is skipped. The 2 transactions of
+    // app_a cannot fill a batch: they are returned to their pool.
+    pool_type unregistered_pool;
+    ASSERT_FALSE(unregistered_pool.has_verification_key());
+    std::vector<libff::Fr<ppT>> dummy_inputs;
+    dummy_inputs.push_back(libff::Fr<ppT>::random_element());
+    unregistered_pool.add_tx(transaction_to_aggregate<ppT, snarkT>(
+        "unregistered",
+        libzeth::extended_proof<ppT, snarkT>(
+            dummy_provider<snarkT>::get_proof(), std::move(dummy_inputs)),
+        100));
+    const std::vector<pool_type *> incomplete_pool_ptrs = {
+        &pools[0], &unregistered_pool};
+    mixed_batch<ppT, snarkT, MIXED_BATCH_SIZE, NUM_VKS> empty_batch =
+        get_next_mixed_batch<
+            ppT,
+            snarkT,
+            POOL_BATCH_SIZE,
+            MIXED_BATCH_SIZE,
+            NUM_VKS>(incomplete_pool_ptrs);
+    ASSERT_EQ((size_t)0, empty_batch.num_txs());
+    ASSERT_EQ((size_t)2, pools[0].tx_pool_size());
+    ASSERT_EQ((uint32_t)10, pools[0].top_tx()->fee_wei());
+    ASSERT_EQ((size_t)1, unregistered_pool.tx_pool_size());
+}
+
 template<typename ppT> void test_add_and_retrieve_transactions_groth16()
 {
     test_add_and_retrieve_transactions<ppT, libzeth::groth16_snark<ppT>>();
@@ -160,6 +329,25 @@ TEST(ApplicationPoolTests, AddAndRetrieveTransactionsMnt4Pghr13)
     test_add_and_retrieve_transactions_pghr13<libff::mnt4_pp>();
 }
 
+TEST(ApplicationPoolTests, MoveTransactionsThroughPoolMnt4Groth16)
+{
+    test_move_transactions_through_pool<
+        libff::mnt4_pp,
+        libzeth::groth16_snark<libff::mnt4_pp>>();
+}
+
+TEST(ApplicationPoolTests, EvictLowestFeeMnt4Groth16)
+{
+    test_evict_lowest_fee<
+        libff::mnt4_pp,
+        libzeth::groth16_snark<libff::mnt4_pp>>();
+}
+
+TEST(ApplicationPoolTests, MixedBatchMnt4Groth16)
+{
+    test_mixed_batch<libff::mnt4_pp, libzeth::groth16_snark<libff::mnt4_pp>>();
+}
+
 } // namespace
 
 int main(int argc, char **argv)
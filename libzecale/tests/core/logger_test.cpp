@@ -0,0 +1,123 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/logger.hpp"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace libzecale;
+
+namespace
+{
+
+size_t count_occurrences(const std::string &s, const std::string &pattern)
+{
+    size_t count = 0;
+    for (size_t pos = s.find(pattern); pos != std::string::npos;
+         pos = s.find(pattern, pos + pattern.size())) {
+        ++count;
+    }
+    return count;
+}
+
+size_t count_lines(const std::string &s) { return count_occurrences(s, "\n"); }
+
+TEST(LoggerTest, LevelNames)
+{
+    ASSERT_EQ(log_level::debug, log_level_from_string("debug"));
+    ASSERT_EQ(log_level::warning, log_level_from_string("WARNING"));
+    ASSERT_EQ(std::string("ERROR"), log_level_name(log_level::error));
+    ASSERT_THROW(log_level_from_string("verbose"), std::invalid_argument);
+}
+
+TEST(LoggerTest, FormatAndLevels)
+{
+    std::ostringstream out;
+    {
+        logger log(out, log_level::info);
+        ASSERT_FALSE(log.enabled(log_level::debug));
+        ASSERT_TRUE(log.enabled(log_level::error));
+
+        log.log(log_level::debug, log_fields(), "filtered");
+        log.log(log_level::info, log_fields("zeth", 12, 3), "first");
+        log_stream(log_level::warning, log_fields("", 0, 4), log)
+            << "second " << 2;
+        log_stream(log_level::debug, log_fields(), log) << "filtered";
+        log.flush();
+
+        const std::string text = out.str();
+        ASSERT_EQ((size_t)2, count_lines(text));
+        ASSERT_EQ(std::string::npos, text.find("filtered"));
+        ASSERT_NE(
+            std::string::npos,
+            text.find("Z [INFO] [app=zeth tx=12 job=3] first\n"));
+        ASSERT_NE(
+            std::string::npos, text.find("Z [WARNING] [job=4] second 2\n"));
+
+        log.set_level(log_level::debug);
+        log.log(log_level::debug, log_fields(), "third");
+    }
+
+    // Pending records are written on destruction
+    ASSERT_NE(std::string::npos, out.str().find("Z [DEBUG] third\n"));
+}
+
+TEST(LoggerTest, ConcurrentProducers)
+{
+    const size_t num_threads = 4;
+    const size_t num_records = 10000;
+    std::ostringstream out;
+    {
+        logger log(out, log_level::info, 1 << 16);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&log, t]() {
+                for (size_t i = 0; i < num_records; ++i) {
+                    log.log(
+                        log_level::info,
+                        log_fields("app", t + 1, i + 1),
+                        "record");
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        log.flush();
+        ASSERT_EQ((uint64_t)0, log.num_dropped());
+    }
+
+    ASSERT_EQ(num_threads * num_records, count_lines(out.str()));
+}
+
+TEST(LoggerTest, DropWhenFull)
+{
+    // Records in excess of the capacity are dropped (and reported) rather
+    // than blocking the producer, while the flusher is busy writing.
+    std::ostringstream out;
+    size_t num_dropped = 0;
+    {
+        logger log(out, log_level::info, 2);
+        for (size_t i = 0; i < 1000; ++i) {
+            log.log(log_level::info, log_fields(), "record");
+        }
+        log.flush();
+        num_dropped = log.num_dropped();
+    }
+
+    const std::string text = out.str();
+    ASSERT_EQ(1000 - num_dropped, count_occurrences(text, "] record\n"));
+    if (num_dropped != 0) {
+        ASSERT_NE(
+            std::string::npos,
+            text.find("log record(s) dropped (buffer full)"));
+    }
+}
+
+} // namespace
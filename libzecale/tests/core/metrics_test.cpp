@@ -0,0 +1,226 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/metrics.hpp"
+#include "libzecale/core/metrics_exporter.hpp"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace libzecale;
+
+namespace
+{
+
+TEST(MetricsTest, HistogramBuckets)
+{
+    histogram h({1.0, 2.0, 4.0});
+    h.observe(0.5);
+    h.observe(1.0);
+    h.observe(1.5);
+    h.observe(3.0);
+    h.observe(10.0);
+
+    const std::vector<uint64_t> expected_counts = {2, 1, 1, 1};
+    ASSERT_EQ(expected_counts, h.bucket_counts());
+    ASSERT_EQ((uint64_t)5, h.count());
+    ASSERT_DOUBLE_EQ(16.0, h.sum());
+}
+
+TEST(MetricsTest, HistogramQuantiles)
+{
+    histogram empty({1.0, 2.0});
+    ASSERT_EQ(0.0, empty.quantile(0.5));
+
+    // 10 values uniformly spread in each of the buckets (0, 1] and (1, 2]
+    histogram h({1.0, 2.0, 4.0});
+    for (size_t i = 0; i < 10; ++i) {
+        h.observe(0.5);
+        h.observe(1.5);
+    }
+    ASSERT_DOUBLE_EQ(0.5, h.quantile(0.25));
+    ASSERT_DOUBLE_EQ(1.0, h.quantile(0.5));
+    ASSERT_DOUBLE_EQ(1.8, h.quantile(0.9));
+    ASSERT_DOUBLE_EQ(2.0, h.quantile(1.0));
+
+    // Values beyond the last bound are reported as the last bound
+    h.observe(100.0);
+    ASSERT_DOUBLE_EQ(4.0, h.quantile(1.0));
+}
+
+TEST(MetricsTest, LatencyBounds)
+{
+    const std::vector<double> bounds = histogram::latency_bounds();
+    ASSERT_DOUBLE_EQ(0.001, bounds.front());
+    ASSERT_GT(bounds.back(), 3600.0);
+    for (size_t i = 1; i < bounds.size(); ++i) {
+        ASSERT_DOUBLE_EQ(2.0 * bounds[i - 1], bounds[i]);
+    }
+}
+
+TEST(MetricsTest, RateMeter)
+{
+    using std::chrono::seconds;
+    rate_meter meter(10);
+    const rate_meter::clock::time_point t0 = rate_meter::clock::now();
+    ASSERT_EQ(0.0, meter.rate(t0));
+
+    // 4 events per second for 5 seconds: averaged over the elapsed time
+    // until the window is full.
+    for (size_t s = 0; s < 5; ++s) {
+        meter.record(4, t0 + seconds(s));
+    }
+    ASSERT_DOUBLE_EQ(4.0, meter.rate(t0 + seconds(4)));
+
+    // Over a full window, only 5 of the 10 seconds have events
+    ASSERT_DOUBLE_EQ(2.0, meter.rate(t0 + seconds(9)));
+
+    // Events older than the window are discarded
+    ASSERT_DOUBLE_EQ(0.0, meter.rate(t0 + seconds(30)));
+    meter.record(10, t0 + seconds(30));
+    ASSERT_DOUBLE_EQ(1.0, meter.rate(t0 + seconds(30)));
+}
+
+TEST(MetricsTest, AggregatorMetricsSnapshot)
+{
+    aggregator_metrics metrics(4);
+    metrics.on_transaction_received("app1");
+    metrics.on_transaction_received("app1");
+    metrics.on_transaction_received("app1");
+    metrics.set_pool_size("app1", 3);
+    metrics.on_batch("app1", 2, 2);
+    metrics.on_batch("app1", 1, 2);
+    metrics.set_pool_size("app1", 0);
+    metrics.set_pool_size("app2", 5);
+    metrics.observe_witness_generation(1.5);
+    metrics.observe_proof_generation(20.0);
+    metrics.observe_end_to_end(30.0);
+    metrics.observe_end_to_end(40.0);
+
+    const metrics_snapshot snapshot = metrics.snapshot();
+    ASSERT_EQ((size_t)2, snapshot.applications.size());
+
+    const metrics_snapshot::application &app1 = snapshot.applications[0];
+    ASSERT_EQ("app1", app1.name);
+    ASSERT_EQ((uint64_t)0, app1.pool_size);
+    ASSERT_EQ((uint64_t)3, app1.transactions_received);
+    ASSERT_GT(app1.ingest_rate, 0.0);
+    ASSERT_EQ((uint64_t)2, app1.batches);
+    ASSERT_DOUBLE_EQ(0.75, app1.batch_fill_ratio);
+
+    const metrics_snapshot::application &app2 = snapshot.applications[1];
+    ASSERT_EQ("app2", app2.name);
+    ASSERT_EQ((uint64_t)5, app2.pool_size);
+    ASSERT_EQ((uint64_t)0, app2.batches);
+    ASSERT_EQ(0.0, app2.batch_fill_ratio);
+
+    ASSERT_EQ((uint64_t)1, snapshot.witness_generation_seconds.count());
+    ASSERT_EQ((uint64_t)1, snapshot.proof_generation_seconds.count());
+    ASSERT_EQ((uint64_t)2, snapshot.end_to_end_seconds.count());
+    ASSERT_DOUBLE_EQ(70.0, snapshot.end_to_end_seconds.sum());
+    ASSERT_GE(snapshot.prover_cpu_utilisation, 0.0);
+}
+
+TEST(MetricsTest, WriteMetricsText)
+{
+    aggregator_metrics metrics(1);
+    metrics.on_transaction_received("zeth");
+    metrics.set_pool_size("zeth", 1);
+    metrics.on_batch("zeth", 1, 2);
+    metrics.observe_end_to_end(0.003);
+
+    std::ostringstream out;
+    write_metrics_text(metrics.snapshot(), out);
+    const std::string text = out.str();
+
+    ASSERT_NE(
+        std::string::npos,
+        text.find("# TYPE zecale_pool_size gauge\n"
+                  "zecale_pool_size{application=\"zeth\"} 1\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_transactions_received_total{application=\"zeth\"} "
+                  "1\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_batch_fill_ratio{application=\"zeth\"} 0.5\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("# TYPE zecale_end_to_end_seconds histogram\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_end_to_end_seconds_bucket{le=\"0.002\"} 0\n"
+                  "zecale_end_to_end_seconds_bucket{le=\"0.004\"} 1\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_end_to_end_seconds_bucket{le=\"+Inf\"} 1\n"
+                  "zecale_end_to_end_seconds_sum 0.003\n"
+                  "zecale_end_to_end_seconds_count 1\n"));
+    ASSERT_NE(std::string::npos, text.find("zecale_process_peak_rss_bytes "));
+}
+
+TEST(MetricsTest, ProvePhases)
+{
+    aggregator_metrics metrics(1);
+    prove_timings timings;
+    timings.witness_generation.wall_seconds = 0.003;
+    timings.witness_generation.cpu_seconds = 0.01;
+    timings.peak_rss_bytes = 1000;
+    metrics.observe_prove_phases(timings);
+    timings.peak_rss_bytes = 500;
+    metrics.observe_prove_phases(timings);
+
+    const metrics_snapshot snapshot = metrics.snapshot();
+    ASSERT_EQ(timings.phases().size(), snapshot.prove_phases.size());
+    const metrics_snapshot::prove_phase &witness_phase =
+        snapshot.prove_phases[1];
+    ASSERT_EQ("witness_generation", witness_phase.name);
+    ASSERT_EQ((uint64_t)2, witness_phase.wall_seconds.count());
+    ASSERT_DOUBLE_EQ(0.006, witness_phase.wall_seconds.sum());
+    ASSERT_DOUBLE_EQ(0.02, witness_phase.cpu_seconds);
+    ASSERT_EQ((uint64_t)1000, snapshot.prove_peak_rss_bytes);
+
+    std::ostringstream out;
+    write_metrics_text(snapshot, out);
+    const std::string text = out.str();
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_prove_phase_seconds_bucket{phase=\"witness_"
+                  "generation\",le=\"0.004\"} 2\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_prove_phase_seconds_count{phase=\"witness_"
+                  "generation\"} 2\n"));
+    ASSERT_NE(
+        std::string::npos,
+        text.find("zecale_prove_phase_cpu_seconds_total{phase=\"witness_"
+                  "generation\"} 0.02\n"));
+    ASSERT_NE(
+        std::string::npos, text.find("zecale_prove_peak_rss_bytes 1000\n"));
+}
+
+TEST(MetricsTest, ExporterWritesFile)
+{
+    const std::string file = "metrics_test_exporter.prom";
+    aggregator_metrics metrics(1);
+    metrics.set_pool_size("zeth", 7);
+    {
+        metrics_exporter exporter(metrics, file, 0);
+        ASSERT_EQ(0, exporter.http_port());
+        exporter.write_file();
+    }
+
+    std::ifstream in(file.c_str());
+    std::stringstream contents;
+    contents << in.rdbuf();
+    ASSERT_NE(
+        std::string::npos,
+        contents.str().find("zecale_pool_size{application=\"zeth\"} 7\n"));
+    std::remove(file.c_str());
+}
+
+} // namespace
@@ -0,0 +1,118 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/pool_snapshot.hpp"
+
+#include "gtest/gtest.h"
+#include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
+#include <libzeth/snarks/groth16/groth16_snark.hpp>
+#include <sstream>
+
+using namespace libzecale;
+
+namespace
+{
+
+using ppT = libff::mnt4_pp;
+using snarkT = libzeth::groth16_snark<ppT>;
+using snapshot = pool_snapshot<ppT, snarkT>;
+
+transaction_to_aggregate<ppT, snarkT> random_transaction(
+    const std::string &application_name, uint64_t id, uint32_t fee_wei)
+{
+    libsnark::r1cs_gg_ppzksnark_proof<ppT> proof(
+        libff::G1<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        libff::G1<ppT>::random_element());
+    std::vector<libff::Fr<ppT>> inputs;
+    inputs.push_back(libff::Fr<ppT>::random_element());
+    inputs.push_back(libff::Fr<ppT>::random_element());
+    transaction_to_aggregate<ppT, snarkT> tx(
+        std::string(application_name),
+        libzeth::extended_proof<ppT, snarkT>(
+            std::move(proof), std::move(inputs)),
+        fee_wei);
+    tx.set_id(id);
+    return tx;
+}
+
+snapshot dummy_snapshot()
+{
+    snapshot pools;
+    pools.applications.resize(2);
+    pools.applications[0].name = "zeth";
+    pools.applications[0].nested_vk =
+        libsnark::r1cs_gg_ppzksnark_verification_key<
+            ppT>::dummy_verification_key(2);
+    pools.applications[0].transactions.push_back(
+        random_transaction("zeth", 1, 12));
+    pools.applications[0].transactions.push_back(
+        random_transaction("zeth", 3, 7));
+    // An application without pending transactions
+    pools.applications[1].name = "other";
+    pools.applications[1].nested_vk =
+        libsnark::r1cs_gg_ppzksnark_verification_key<
+            ppT>::dummy_verification_key(2);
+    return pools;
+}
+
+TEST(PoolSnapshotTest, WriteAndReadMnt4Groth16)
+{
+    const snapshot pools = dummy_snapshot();
+    ASSERT_EQ((size_t)2, pools.num_transactions());
+
+    std::stringstream ss;
+    pools.write(ss);
+    const snapshot read_pools = snapshot::read(ss);
+
+    ASSERT_EQ(pools.applications.size(), read_pools.applications.size());
+    for (size_t i = 0; i < pools.applications.size(); ++i) {
+        const snapshot::application &app = pools.applications[i];
+        const snapshot::application &read_app = read_pools.applications[i];
+        ASSERT_EQ(app.name, read_app.name);
+        ASSERT_EQ(app.nested_vk, read_app.nested_vk);
+        ASSERT_EQ(app.transactions.size(), read_app.transactions.size());
+        for (size_t j = 0; j < app.transactions.size(); ++j) {
+            const transaction_to_aggregate<ppT, snarkT> &tx =
+                app.transactions[j];
+            const transaction_to_aggregate<ppT, snarkT> &read_tx =
+                read_app.transactions[j];
+            ASSERT_EQ(app.name, read_tx.application_name());
+            ASSERT_EQ(tx.id(), read_tx.id());
+            ASSERT_EQ(tx.fee_wei(), read_tx.fee_wei());
+            ASSERT_EQ(
+                tx.extended_proof().get_proof(),
+                read_tx.extended_proof().get_proof());
+            ASSERT_EQ(
+                tx.extended_proof().get_primary_inputs(),
+                read_tx.extended_proof().get_primary_inputs());
+        }
+    }
+}
+
+TEST(PoolSnapshotTest, RejectInvalidSnapshot)
+{
+    std::stringstream ss;
+    dummy_snapshot().write(ss);
+
+    // Truncated snapshot
+    const std::string data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() / 2));
+    ASSERT_THROW(snapshot::read(truncated), std::runtime_error);
+
+    // Not a pool snapshot
+    std::stringstream garbage("not a snapshot");
+    ASSERT_THROW(snapshot::read(garbage), std::runtime_error);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Initialize the curve parameters before running the tests
+    libff::mnt4_pp::init_public_params();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
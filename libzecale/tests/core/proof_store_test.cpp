@@ -0,0 +1,180 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/proof_store.hpp"
+
+#include "gtest/gtest.h"
+#include <boost/filesystem.hpp>
+#include <sstream>
+
+using namespace libzecale;
+
+namespace
+{
+
+const std::string vk_0 = verification_key_fingerprint("verification key 0");
+const std::string vk_1 = verification_key_fingerprint("verification key 1");
+
+stored_proof dummy_proof(
+    uint64_t batch_id,
+    std::vector<uint64_t> tx_ids,
+    const std::string &vk_fingerprint = vk_0)
+{
+    stored_proof proof;
+    proof.batch_id = batch_id;
+    proof.application_names.push_back("zeth");
+    proof.tx_ids = tx_ids;
+    proof.proof = "proof of batch " + std::to_string(batch_id);
+    proof.timings = "timings of batch " + std::to_string(batch_id);
+    proof.vk_fingerprint = vk_fingerprint;
+    return proof;
+}
+
+TEST(ProofStoreTest, WriteAndRead)
+{
+    const stored_proof proof = dummy_proof(3, {5, 7});
+    std::stringstream ss;
+    proof_store::write(ss, proof);
+    const stored_proof read_proof = proof_store::read(ss);
+    ASSERT_EQ(proof.batch_id, read_proof.batch_id);
+    ASSERT_EQ(proof.application_names, read_proof.application_names);
+    ASSERT_EQ(proof.tx_ids, read_proof.tx_ids);
+    ASSERT_EQ(proof.proof, read_proof.proof);
+    ASSERT_EQ(proof.timings, read_proof.timings);
+    ASSERT_EQ(proof.vk_fingerprint, read_proof.vk_fingerprint);
+
+    const std::string data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() - 1));
+    ASSERT_THROW(proof_store::read(truncated), std::runtime_error);
+
+    // Version 2 (after the magic), without the VK fingerprint
+    std::string v2_data = data.substr(
+        0, data.size() - sizeof(uint64_t) - proof.vk_fingerprint.size());
+    v2_data[8] = 2;
+    std::stringstream v2(v2_data);
+    const stored_proof v2_proof = proof_store::read(v2);
+    ASSERT_EQ(proof.timings, v2_proof.timings);
+    ASSERT_EQ("", v2_proof.vk_fingerprint);
+
+    // Version 1, without the timings
+    std::string v1_data = v2_data.substr(
+        0, v2_data.size() - sizeof(uint64_t) - proof.timings.size());
+    v1_data[8] = 1;
+    std::stringstream v1(v1_data);
+    const stored_proof v1_proof = proof_store::read(v1);
+    ASSERT_EQ(proof.proof, v1_proof.proof);
+    ASSERT_EQ("", v1_proof.timings);
+}
+
+TEST(ProofStoreTest, InMemory)
+{
+    proof_store store(2);
+    store.put(dummy_proof(1, {1, 2}));
+    store.put(dummy_proof(2, {3}));
+    ASSERT_EQ("proof of batch 1", store.find_batch(1)->proof);
+    ASSERT_EQ((uint64_t)2, store.find_transaction(3)->batch_id);
+    ASSERT_EQ(nullptr, store.find_batch(4));
+    ASSERT_EQ(nullptr, store.find_transaction(4));
+
+    // Batch 1 has been used more recently than batch 2, which is evicted
+    store.find_batch(1);
+    store.put(dummy_proof(3, {4}));
+    ASSERT_EQ((size_t)2, store.size());
+    ASSERT_EQ(nullptr, store.find_batch(2));
+    ASSERT_EQ(nullptr, store.find_transaction(3));
+    ASSERT_NE(nullptr, store.find_transaction(2));
+    ASSERT_EQ((uint64_t)3, store.max_batch_id());
+    ASSERT_EQ((uint64_t)4, store.max_tx_id());
+}
+
+TEST(ProofStoreTest, OnDisk)
+{
+    const boost::filesystem::path dir =
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("proof_store_test_%%%%%%%%");
+    {
+        // Only 1 proof in memory, 2 on disk
+        proof_store store(1, dir, 2);
+        store.put(dummy_proof(1, {1}));
+        store.put(dummy_proof(2, {2}));
+        ASSERT_EQ("proof of batch 1", store.find_transaction(1)->proof);
+        ASSERT_EQ("proof of batch 2", store.find_batch(2)->proof);
+
+        store.put(dummy_proof(3, {3}));
+        ASSERT_EQ((size_t)2, store.size());
+        ASSERT_EQ(nullptr, store.find_batch(1));
+    }
+
+    // Reloaded from disk
+    {
+        proof_store store(1, dir, 2);
+        ASSERT_EQ((size_t)2, store.size());
+        ASSERT_EQ((uint64_t)3, store.max_batch_id());
+        ASSERT_EQ((uint64_t)3, store.max_tx_id());
+        ASSERT_EQ("proof of batch 2", store.find_transaction(2)->proof);
+        ASSERT_EQ("proof of batch 3", store.find_batch(3)->proof);
+        ASSERT_EQ(nullptr, store.find_transaction(1));
+    }
+
+    // Fewer proofs kept after a restart
+    {
+        proof_store store(1, dir, 1);
+        ASSERT_EQ((size_t)1, store.size());
+        ASSERT_EQ(nullptr, store.find_batch(2));
+        ASSERT_NE(nullptr, store.find_batch(3));
+    }
+
+    boost::filesystem::remove_all(dir);
+}
+
+TEST(ProofStoreTest, ReloadAfterKeypairChange)
+{
+    ASSERT_EQ(vk_0, verification_key_fingerprint("verification key 0"));
+    ASSERT_NE(vk_0, vk_1);
+
+    const boost::filesystem::path dir =
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("proof_store_test_%%%%%%%%");
+    {
+        proof_store store(1, dir, 4, {vk_0, vk_1});
+        store.put(dummy_proof(1, {1}, vk_0));
+        store.put(dummy_proof(2, {2}, vk_1));
+        store.put(dummy_proof(3, {3, 4}, vk_0));
+    }
+
+    // Same keys: all the proofs are reloaded
+    {
+        proof_store store(1, dir, 4, {vk_0, vk_1});
+        ASSERT_EQ((size_t)3, store.size());
+        ASSERT_EQ((size_t)0, store.num_discarded());
+    }
+
+    // The keypair of vk_0 has changed: its proofs are removed, but their
+    // identifiers are not reused.
+    const std::string new_vk_0 =
+        verification_key_fingerprint("new verification key 0");
+    {
+        proof_store store(1, dir, 4, {new_vk_0, vk_1});
+        ASSERT_EQ((size_t)1, store.size());
+        ASSERT_EQ((size_t)2, store.num_discarded());
+        ASSERT_EQ(nullptr, store.find_batch(1));
+        ASSERT_EQ(nullptr, store.find_transaction(4));
+        ASSERT_EQ("proof of batch 2", store.find_transaction(2)->proof);
+        ASSERT_EQ((uint64_t)3, store.max_batch_id());
+        ASSERT_EQ((uint64_t)4, store.max_tx_id());
+    }
+    ASSERT_FALSE(boost::filesystem::exists(dir / "batch_1.proof"));
+    ASSERT_FALSE(boost::filesystem::exists(dir / "batch_3.proof"));
+
+    // Without fingerprints, the remaining proof is kept
+    {
+        proof_store store(1, dir, 4);
+        ASSERT_EQ((size_t)1, store.size());
+        ASSERT_EQ((size_t)0, store.num_discarded());
+    }
+
+    boost::filesystem::remove_all(dir);
+}
+
+} // namespace
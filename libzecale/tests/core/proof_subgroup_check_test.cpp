@@ -0,0 +1,93 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/proof_subgroup_check.hpp"
+
+#include <gtest/gtest.h>
+#include <libff/algebra/curves/bls12_377/bls12_377_pp.hpp>
+#include <stdexcept>
+
+using namespace libzecale;
+
+using ppT = libff::bls12_377_pp;
+
+namespace
+{
+
+/// A point of E(Fq) which is not in G1 (the cofactor of G1 is not 1).
+libff::bls12_377_G1 random_G1_non_member()
+{
+    using Fq = libff::bls12_377_Fq;
+    while (true) {
+        const Fq x = Fq::random_element();
+        const Fq y_squared = x.squared() * x + libff::bls12_377_coeff_b;
+        if ((y_squared ^ Fq::euler) == Fq::one()) {
+            const libff::bls12_377_G1 P(x, y_squared.sqrt(), Fq::one());
+            if (!(libff::bls12_377_modulus_r * P).is_zero()) {
+                return P;
+            }
+        }
+    }
+}
+
+/// A point of the twist E'(Fq2) which is not in G2.
+libff::bls12_377_G2 random_G2_non_member()
+{
+    using Fq2 = libff::bls12_377_Fq2;
+    while (true) {
+        const Fq2 x = Fq2::random_element();
+        const Fq2 y_squared = x.squared() * x + libff::bls12_377_twist_coeff_b;
+        if ((y_squared ^ Fq2::euler) == Fq2::one()) {
+            const libff::bls12_377_G2 Q(x, y_squared.sqrt(), Fq2::one());
+            if (!(libff::bls12_377_modulus_r * Q).is_zero()) {
+                return Q;
+            }
+        }
+    }
+}
+
+libsnark::r1cs_gg_ppzksnark_proof<ppT> random_proof()
+{
+    return libsnark::r1cs_gg_ppzksnark_proof<ppT>(
+        libff::G1<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        libff::G1<ppT>::random_element());
+}
+
+TEST(ProofSubgroupCheckTest, PrimeOrderSubgroup)
+{
+    ASSERT_TRUE(is_in_prime_order_subgroup(libff::G1<ppT>::random_element()));
+    ASSERT_TRUE(is_in_prime_order_subgroup(libff::G2<ppT>::random_element()));
+    ASSERT_TRUE(is_in_prime_order_subgroup(libff::G1<ppT>::zero()));
+    ASSERT_FALSE(is_in_prime_order_subgroup(random_G1_non_member()));
+    ASSERT_FALSE(is_in_prime_order_subgroup(random_G2_non_member()));
+}
+
+TEST(ProofSubgroupCheckTest, Groth16Proof)
+{
+    ASSERT_NO_THROW(check_proof_points(random_proof()));
+
+    // A point on the curve, outside of the subgroup
+    libsnark::r1cs_gg_ppzksnark_proof<ppT> proof = random_proof();
+    proof.g_A = random_G1_non_member();
+    ASSERT_THROW(check_proof_points(proof), std::invalid_argument);
+
+    proof = random_proof();
+    proof.g_B = random_G2_non_member();
+    ASSERT_THROW(check_proof_points(proof), std::invalid_argument);
+
+    // A point which is not on the curve
+    proof = random_proof();
+    proof.g_C.Y += libff::Fq<ppT>::one();
+    ASSERT_THROW(check_proof_points(proof), std::invalid_argument);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    libff::bls12_377_pp::init_public_params();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,63 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/prove_timings.hpp"
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+
+using namespace libzecale;
+
+namespace
+{
+
+TEST(ProveTimingsTest, PhaseTimer)
+{
+    prove_timings timings;
+    prove_phase_timer timer(&timings);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timer.end_phase(&prove_timings::constraint_generation);
+    timer.end_phase(&prove_timings::witness_generation);
+    // Busy loop, to consume CPU time
+    volatile uint64_t sum = 0;
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start <
+           std::chrono::milliseconds(20)) {
+        sum = sum + 1;
+    }
+    timer.end_phase(&prove_timings::proof_generation);
+
+    ASSERT_GE(timings.constraint_generation.wall_seconds, 0.02);
+    ASSERT_GE(timings.proof_generation.wall_seconds, 0.02);
+    ASSERT_GT(timings.proof_generation.cpu_seconds, 0.0);
+    ASSERT_EQ(0.0, timings.satisfiability_check.wall_seconds);
+    ASSERT_DOUBLE_EQ(
+        timings.constraint_generation.wall_seconds +
+            timings.witness_generation.wall_seconds,
+        timings.witness_seconds());
+#ifdef __linux__
+    ASSERT_GT(timings.peak_rss_bytes, (uint64_t)0);
+#endif
+
+    // Nothing is measured without timings
+    prove_phase_timer null_timer(nullptr);
+    null_timer.end_phase(&prove_timings::constraint_generation);
+}
+
+TEST(ProveTimingsTest, Phases)
+{
+    prove_timings timings;
+    timings.satisfiability_check.wall_seconds = 1.5;
+    const std::vector<std::pair<std::string, phase_timing>> phases =
+        timings.phases();
+    ASSERT_EQ((size_t)5, phases.size());
+    ASSERT_EQ("constraint_generation", phases[0].first);
+    ASSERT_EQ("satisfiability_check", phases[2].first);
+    ASSERT_EQ(1.5, phases[2].second.wall_seconds);
+    ASSERT_EQ("primary_input_extraction", phases[4].first);
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/prover_scheduler.hpp"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+
+using namespace libzecale;
+
+namespace
+{
+
+TEST(ProverSchedulerTest, ParseCpuList)
+{
+    const std::vector<size_t> expected = {0, 1, 2, 3, 8, 10, 11};
+    ASSERT_EQ(expected, cpu_topology::parse_cpu_list("0-3,8,10-11\n"));
+    ASSERT_TRUE(cpu_topology::parse_cpu_list("").empty());
+}
+
+TEST(ProverSchedulerTest, PartitionWithinNodes)
+{
+    const cpu_topology topology = cpu_topology::uniform(2, 8);
+    ASSERT_EQ((size_t)16, topology.num_cpus());
+
+    // 4 workers on 2 nodes: 2 workers of 4 CPUs per node
+    const prover_partition partition = prover_partition::make(topology, 4);
+    ASSERT_EQ((size_t)4, partition.num_workers());
+    ASSERT_EQ((size_t)4, partition.threads_per_worker());
+    const std::vector<size_t> expected_worker_2 = {8, 9, 10, 11};
+    ASSERT_EQ(expected_worker_2, partition.worker_cpus[2]);
+
+    // A single worker spans both nodes
+    const prover_partition wide = prover_partition::make(topology, 1);
+    ASSERT_EQ((size_t)1, wide.num_workers());
+    ASSERT_EQ((size_t)16, wide.threads_per_worker());
+
+    ASSERT_THROW(prover_partition::make(topology, 0), std::invalid_argument);
+    ASSERT_THROW(prover_partition::make(topology, 17), std::invalid_argument);
+}
+
+TEST(ProverSchedulerTest, SelectPartition)
+{
+    const cpu_topology topology = cpu_topology::uniform(2, 8);
+    const std::vector<size_t> expected_candidates = {1, 2, 4, 8, 16};
+    ASSERT_EQ(
+        expected_candidates, prover_partition::candidate_num_workers(topology));
+
+    // Throughput peaks with 4 workers
+    const prover_partition best = prover_partition::select(
+        topology, [](const prover_partition &partition) {
+            const double w = (double)partition.num_workers();
+            return w * (8.0 - w);
+        });
+    ASSERT_EQ((size_t)4, best.num_workers());
+}
+
+TEST(ProverSchedulerTest, RunJobs)
+{
+    const prover_partition partition =
+        prover_partition::make(cpu_topology::uniform(1, 2), 2);
+    std::atomic<size_t> num_run(0);
+    std::vector<std::future<size_t>> results;
+    {
+        prover_scheduler scheduler(partition);
+        for (size_t i = 0; i < 8; ++i) {
+            results.push_back(scheduler.submit<size_t>([i, &num_run]() {
+                ++num_run;
+                return i * i;
+            }));
+        }
+
+        std::future<size_t> failing = scheduler.submit<size_t>(
+            []() -> size_t { throw std::runtime_error("failed job"); });
+        ASSERT_THROW(failing.get(), std::runtime_error);
+    }
+
+    // All jobs have run when the scheduler is destroyed
+    ASSERT_EQ((size_t)8, num_run.load());
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_EQ(i * i, results[i].get());
+    }
+}
+
+TEST(ProverSchedulerTest, WaitIdle)
+{
+    const prover_partition partition =
+        prover_partition::make(cpu_topology::uniform(1, 1), 1);
+    prover_scheduler scheduler(partition);
+    ASSERT_TRUE(scheduler.wait_idle(0.1));
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> num_run(0);
+    for (size_t i = 0; i < 2; ++i) {
+        scheduler.submit<void>([released, &num_run]() {
+            released.wait();
+            ++num_run;
+        });
+    }
+
+    // The first job is blocked, and the second one queued
+    ASSERT_FALSE(scheduler.wait_idle(0.05));
+    release.set_value();
+    ASSERT_TRUE(scheduler.wait_idle());
+    ASSERT_EQ((size_t)2, num_run.load());
+}
+
+TEST(ProverSchedulerTest, MeasureThroughput)
+{
+    const prover_partition partition =
+        prover_partition::make(cpu_topology::uniform(1, 2), 2);
+    std::atomic<size_t> num_run(0);
+    const double throughput =
+        measure_prover_throughput(partition, [&num_run]() { ++num_run; }, 3);
+    ASSERT_EQ((size_t)6, num_run.load());
+    ASSERT_LT(0.0, throughput);
+}
+
+} // namespace
@@ -0,0 +1,127 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/satisfiability_check.hpp"
+
+#include "gtest/gtest.h"
+#include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
+#include <libsnark/gadgetlib1/pb_variable.hpp>
+#include <stdexcept>
+
+using namespace libzecale;
+
+namespace
+{
+
+using Field = libff::Fr<libff::mnt4_pp>;
+
+// Protoboard with the constraints x_i * x_i = y_i for i < num, satisfied by
+// x_i = i.
+libsnark::protoboard<Field> squares_protoboard(size_t num)
+{
+    libsnark::protoboard<Field> pb;
+    for (size_t i = 0; i < num; ++i) {
+        libsnark::pb_variable<Field> x;
+        libsnark::pb_variable<Field> y;
+        x.allocate(pb, "x");
+        y.allocate(pb, "y");
+        pb.add_r1cs_constraint(
+            libsnark::r1cs_constraint<Field>(x, x, y),
+            "square_" + std::to_string(i));
+        pb.val(x) = Field(i);
+        pb.val(y) = Field(i * i);
+    }
+    return pb;
+}
+
+// Assign a value to y_i which is not a square of an integer
+void break_constraint(libsnark::protoboard<Field> &pb, size_t i)
+{
+    pb.val(libsnark::pb_variable<Field>(2 * i + 2)) = Field(7);
+}
+
+TEST(SatisfiabilityCheckTest, Satisfied)
+{
+    const libsnark::protoboard<Field> pb = squares_protoboard(100);
+    ASSERT_TRUE(pb.is_satisfied());
+    for (const size_t num_threads : {1, 3, 8, 200}) {
+        ASSERT_TRUE(check_satisfiability(
+                        pb.get_constraint_system(),
+                        pb.full_variable_assignment(),
+                        num_threads)
+                        .satisfied);
+    }
+}
+
+TEST(SatisfiabilityCheckTest, FirstUnsatisfiedConstraint)
+{
+    libsnark::protoboard<Field> pb = squares_protoboard(100);
+    break_constraint(pb, 70);
+    break_constraint(pb, 30);
+    ASSERT_FALSE(pb.is_satisfied());
+    for (const size_t num_threads : {1, 3, 8, 200}) {
+        const satisfiability_result result = check_satisfiability(
+            pb.get_constraint_system(),
+            pb.full_variable_assignment(),
+            num_threads);
+        ASSERT_FALSE(result.satisfied);
+        ASSERT_EQ((size_t)30, result.first_unsatisfied_constraint);
+    }
+#ifdef DEBUG
+    ASSERT_EQ("square_30", constraint_annotation(pb, 30));
+#endif
+
+    // The assignment of another constraint system
+    const libsnark::protoboard<Field> other_pb = squares_protoboard(10);
+    ASSERT_THROW(
+        check_satisfiability(
+            pb.get_constraint_system(), other_pb.full_variable_assignment(), 1),
+        std::invalid_argument);
+}
+
+TEST(SatisfiabilityCheckTest, Policy)
+{
+    satisfiability_check_policy off(satisfiability_check_mode::off);
+    satisfiability_check_policy always(satisfiability_check_mode::always);
+    satisfiability_check_policy sampled(satisfiability_check_mode::sampled, 3);
+    std::vector<bool> sampled_checks;
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_FALSE(off.should_check());
+        ASSERT_TRUE(always.should_check());
+        sampled_checks.push_back(sampled.should_check());
+    }
+    const std::vector<bool> expected_checks = {
+        true, false, false, true, false, false, true};
+    ASSERT_EQ(expected_checks, sampled_checks);
+
+    ASSERT_THROW(
+        satisfiability_check_policy(satisfiability_check_mode::sampled, 0),
+        std::invalid_argument);
+}
+
+TEST(SatisfiabilityCheckTest, ModeNames)
+{
+    for (const satisfiability_check_mode mode :
+         {satisfiability_check_mode::off,
+          satisfiability_check_mode::sampled,
+          satisfiability_check_mode::always}) {
+        ASSERT_EQ(
+            mode,
+            satisfiability_check_mode_from_string(
+                satisfiability_check_mode_name(mode)));
+    }
+    ASSERT_THROW(
+        satisfiability_check_mode_from_string("never"), std::invalid_argument);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Initialize the curve parameters before running the tests
+    libff::mnt4_pp::init_public_params();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
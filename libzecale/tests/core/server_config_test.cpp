@@ -0,0 +1,73 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "libzecale/core/server_config.hpp"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+using namespace libzecale;
+
+namespace
+{
+
+TEST(ServerConfigTest, Defaults)
+{
+    const server_config config;
+    ASSERT_EQ("0.0.0.0:50052", config.listen_address);
+    ASSERT_NO_THROW(config.validate());
+
+    server_config invalid;
+    invalid.num_polling_threads = 0;
+    ASSERT_THROW(invalid.validate(), std::invalid_argument);
+
+    invalid = server_config();
+    invalid.drain_timeout_seconds = -1.0;
+    ASSERT_THROW(invalid.validate(), std::invalid_argument);
+
+    invalid = server_config();
+    invalid.proof_store_dir = "proofs";
+    invalid.max_stored_proofs = 0;
+    ASSERT_THROW(invalid.validate(), std::invalid_argument);
+
+    invalid = server_config();
+    invalid.satisfiability_check = satisfiability_check_mode::sampled;
+    invalid.satisfiability_check_interval = 0;
+    ASSERT_THROW(invalid.validate(), std::invalid_argument);
+    invalid.satisfiability_check = satisfiability_check_mode::off;
+    ASSERT_NO_THROW(invalid.validate());
+}
+
+TEST(ServerConfigTest, IngestPolicyNames)
+{
+    ASSERT_EQ(
+        ingest_policy::evict_lowest_fee,
+        ingest_policy_from_string(
+            ingest_policy_name(ingest_policy::evict_lowest_fee)));
+    ASSERT_EQ(
+        ingest_policy::reject,
+        ingest_policy_from_string(ingest_policy_name(ingest_policy::reject)));
+    ASSERT_THROW(ingest_policy_from_string("drop"), std::invalid_argument);
+}
+
+TEST(ServerConfigTest, DecideIngest)
+{
+    server_config config;
+
+    // No limit
+    ASSERT_EQ(ingest_decision::accept, config.decide_ingest(1000000, 0, 0));
+
+    config.max_pool_size = 10;
+    config.pool_full_policy = ingest_policy::reject;
+    ASSERT_EQ(ingest_decision::accept, config.decide_ingest(9, 5, 1));
+    ASSERT_EQ(ingest_decision::reject, config.decide_ingest(10, 5, 100));
+
+    config.pool_full_policy = ingest_policy::evict_lowest_fee;
+    ASSERT_EQ(
+        ingest_decision::evict_and_accept, config.decide_ingest(10, 5, 6));
+    ASSERT_EQ(ingest_decision::reject, config.decide_ingest(10, 5, 5));
+}
+
+} // namespace
@@ -0,0 +1,243 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "api/aggregator.pb.h"
+#include "libzecale/serialization/compact_encoding.hpp"
+#include "libzecale/serialization/proto_utils.hpp"
+
+#include "gtest/gtest.h"
+#include <libff/algebra/curves/mnt/mnt4/mnt4_pp.hpp>
+#include <libff/algebra/curves/mnt/mnt6/mnt6_pp.hpp>
+#include <libzeth/core/extended_proof.hpp>
+#include <libzeth/snarks/groth16/groth16_api_handler.hpp>
+#include <libzeth/snarks/pghr13/pghr13_api_handler.hpp>
+
+using namespace libzecale;
+
+namespace
+{
+
+template<typename ppT> std::vector<libff::Fr<ppT>> random_inputs(size_t num)
+{
+    std::vector<libff::Fr<ppT>> inputs;
+    for (size_t i = 0; i < num; ++i) {
+        inputs.push_back(libff::Fr<ppT>::random_element());
+    }
+    return inputs;
+}
+
+template<typename ppT>
+libzeth::extended_proof<ppT, libzeth::groth16_snark<ppT>>
+random_groth16_extended_proof()
+{
+    libsnark::r1cs_gg_ppzksnark_proof<ppT> proof(
+        libff::G1<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        // The point at infinity has a specific encoding
+        libff::G1<ppT>::zero());
+    return libzeth::extended_proof<ppT, libzeth::groth16_snark<ppT>>(
+        std::move(proof), random_inputs<ppT>(9));
+}
+
+template<typename ppT>
+libsnark::accumulation_vector<libff::G1<ppT>> random_accumulation_vector(
+    size_t num)
+{
+    std::vector<libff::G1<ppT>> rest;
+    for (size_t i = 0; i < num; ++i) {
+        rest.push_back(libff::G1<ppT>::random_element());
+    }
+    return libsnark::accumulation_vector<libff::G1<ppT>>(
+        libff::G1<ppT>::random_element(), std::move(rest));
+}
+
+template<typename ppT> void test_groth16_round_trip(bool compress_points)
+{
+    using snark = libzeth::groth16_snark<ppT>;
+
+    const libzeth::extended_proof<ppT, snark> ext_proof =
+        random_groth16_extended_proof<ppT>();
+    const std::string proof_bytes =
+        extended_proof_to_compact(ext_proof, compress_points);
+    const libzeth::extended_proof<ppT, snark> decoded_proof =
+        extended_proof_from_compact<ppT, snark>(proof_bytes);
+    ASSERT_EQ(ext_proof.get_proof(), decoded_proof.get_proof());
+    ASSERT_EQ(
+        ext_proof.get_primary_inputs(), decoded_proof.get_primary_inputs());
+
+    const typename snark::verification_key vk(
+        libff::G1<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        libff::G2<ppT>::random_element(),
+        random_accumulation_vector<ppT>(9));
+    const std::string vk_bytes =
+        verification_key_to_compact<snark>(vk, compress_points);
+    ASSERT_EQ(vk, verification_key_from_compact<snark>(vk_bytes));
+}
+
+template<typename ppT> void test_pghr13_round_trip(bool compress_points)
+{
+    using snark = libzeth::pghr13_snark<ppT>;
+    using G1 = libff::G1<ppT>;
+    using G2 = libff::G2<ppT>;
+
+    libsnark::r1cs_ppzksnark_proof<ppT> proof(
+        libsnark::knowledge_commitment<G1, G1>(
+            G1::random_element(), G1::random_element()),
+        libsnark::knowledge_commitment<G2, G1>(
+            G2::random_element(), G1::random_element()),
+        libsnark::knowledge_commitment<G1, G1>(
+            G1::random_element(), G1::random_element()),
+        G1::random_element(),
+        G1::random_element());
+    const libzeth::extended_proof<ppT, snark> ext_proof(
+        std::move(proof), random_inputs<ppT>(3));
+    const std::string proof_bytes =
+        extended_proof_to_compact(ext_proof, compress_points);
+    const libzeth::extended_proof<ppT, snark> decoded_proof =
+        extended_proof_from_compact<ppT, snark>(proof_bytes);
+    ASSERT_EQ(ext_proof.get_proof(), decoded_proof.get_proof());
+    ASSERT_EQ(
+        ext_proof.get_primary_inputs(), decoded_proof.get_primary_inputs());
+
+    const typename snark::verification_key vk(
+        G2::random_element(),
+        G1::random_element(),
+        G2::random_element(),
+        G2::random_element(),
+        G1::random_element(),
+        G2::random_element(),
+        G2::random_element(),
+        random_accumulation_vector<ppT>(3));
+    const std::string vk_bytes =
+        verification_key_to_compact<snark>(vk, compress_points);
+    ASSERT_EQ(vk, verification_key_from_compact<snark>(vk_bytes));
+}
+
+TEST(CompactEncodingTest, Groth16RoundTripMnt4)
+{
+    test_groth16_round_trip<libff::mnt4_pp>(false);
+    test_groth16_round_trip<libff::mnt4_pp>(true);
+}
+
+TEST(CompactEncodingTest, Groth16RoundTripMnt6)
+{
+    test_groth16_round_trip<libff::mnt6_pp>(false);
+    test_groth16_round_trip<libff::mnt6_pp>(true);
+}
+
+TEST(CompactEncodingTest, PGHR13RoundTripMnt4)
+{
+    test_pghr13_round_trip<libff::mnt4_pp>(false);
+    test_pghr13_round_trip<libff::mnt4_pp>(true);
+}
+
+TEST(CompactEncodingTest, Size)
+{
+    using ppT = libff::mnt4_pp;
+    using codec = internal::compact_field_codec<libff::Fq<ppT>>;
+    const size_t fq_bytes = codec::num_bytes();
+    const size_t fr_bytes =
+        internal::compact_field_codec<libff::Fr<ppT>>::num_bytes();
+
+    // Header, 2 points of G1 and 1 of G2 (with 2 coordinates in Fq2), and
+    // the inputs.
+    const std::string uncompressed = extended_proof_to_compact(
+        random_groth16_extended_proof<ppT>(), false);
+    ASSERT_EQ(
+        2 + 2 * (1 + 2 * fq_bytes) + (1 + 4 * fq_bytes) + 4 + 9 * fr_bytes,
+        uncompressed.size());
+    const std::string compressed = extended_proof_to_compact(
+        random_groth16_extended_proof<ppT>(), true);
+    ASSERT_EQ(
+        2 + 2 * (1 + fq_bytes) + (1 + 2 * fq_bytes) + 4 + 9 * fr_bytes,
+        compressed.size());
+}
+
+TEST(CompactEncodingTest, RejectInvalid)
+{
+    using ppT = libff::mnt4_pp;
+    using snark = libzeth::groth16_snark<ppT>;
+    const size_t fq_bytes =
+        internal::compact_field_codec<libff::Fq<ppT>>::num_bytes();
+
+    const std::string bytes = extended_proof_to_compact(
+        random_groth16_extended_proof<ppT>(), false);
+    ASSERT_NO_THROW((extended_proof_from_compact<ppT, snark>(bytes)));
+
+    // Truncated, and trailing bytes
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(
+            bytes.substr(0, bytes.size() - 1))),
+        std::invalid_argument);
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(bytes + '\0')),
+        std::invalid_argument);
+
+    // Unknown version
+    std::string invalid = bytes;
+    invalid[0] = 2;
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(invalid)),
+        std::invalid_argument);
+
+    // Point not on the curve (g_A starts at offset 2, after the header)
+    invalid = bytes;
+    invalid[3] ^= 1;
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(invalid)),
+        std::invalid_argument);
+
+    // Coordinate not in the field
+    invalid = bytes;
+    for (size_t i = 0; i < fq_bytes; ++i) {
+        invalid[3 + i] = '\xff';
+    }
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(invalid)),
+        std::invalid_argument);
+
+    // Invalid point flag
+    invalid = bytes;
+    invalid[2] = 0x02;
+    ASSERT_THROW(
+        (extended_proof_from_compact<ppT, snark>(invalid)),
+        std::invalid_argument);
+}
+
+TEST(CompactEncodingTest, ParseCompactTransactionToAggregate)
+{
+    using ppT = libff::mnt4_pp;
+    using snark = libzeth::groth16_snark<ppT>;
+
+    const libzeth::extended_proof<ppT, snark> ext_proof =
+        random_groth16_extended_proof<ppT>();
+    zecale_proto::TransactionToAggregate grpc_tx;
+    grpc_tx.set_application_name("zeth");
+    grpc_tx.set_fee_in_wei(12);
+    grpc_tx.set_compact_extended_proof(extended_proof_to_compact(ext_proof));
+
+    const transaction_to_aggregate<ppT, snark> tx =
+        transaction_to_aggregate_from_proto<
+            ppT,
+            libzeth::groth16_api_handler<ppT>>(grpc_tx);
+    ASSERT_EQ(ext_proof.get_proof(), tx.extended_proof().get_proof());
+    ASSERT_EQ(
+        ext_proof.get_primary_inputs(),
+        tx.extended_proof().get_primary_inputs());
+    ASSERT_EQ("zeth", tx.application_name());
+    ASSERT_EQ(12, tx.fee_wei());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Initialize the curve parameters before running the tests
+    libff::mnt4_pp::init_public_params();
+    libff::mnt6_pp::init_public_params();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
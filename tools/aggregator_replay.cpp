@@ -0,0 +1,209 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Replay an aggregation from a snapshot written by the aggregator_server
+// (see the `--snapshot-dir` option), re-running the witness generation and
+// the prover on the exact same inputs, and reporting the time taken by each
+// phase. The tool must be built with the same configuration (curve and snark)
+// as the server which wrote the snapshot.
+
+#include "libzecale/core/aggregation_snapshot.hpp"
+#include "libzecale/core/aggregator_circuit_wrapper.hpp"
+#include "libzecale/core/satisfiability_check.hpp"
+#include "zecale_config.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace po = boost::program_options;
+
+#if defined(ZECALE_CURVE_MNT6)
+#include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
+using wpp = libff::mnt6_pp;
+#elif defined(ZECALE_CURVE_BW6_761)
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+using wpp = libff::bw6_761_pp;
+#else
+#error "ZECALE_CURVE_* variable not set to supported curve"
+#endif
+
+using npp = libzecale::other_curve<wpp>;
+
+#if defined(ZECALE_SNARK_PGHR13)
+#include <libzecale/circuits/pghr13_verifier/pghr13_verifier_parameters.hpp>
+using wverifier = libzecale::pghr13_verifier_parameters<wpp>;
+using nsnark = libzeth::pghr13_snark<npp>;
+#elif defined(ZECALE_SNARK_GROTH16)
+#include <libzecale/circuits/groth16_verifier/groth16_verifier_parameters.hpp>
+using wverifier = libzecale::groth16_verifier_parameters<wpp>;
+using nsnark = libzeth::groth16_snark<npp>;
+#else
+#error "ZECALE_SNARK_* variable not set to supported ZK snark"
+#endif
+
+using wsnark = typename wverifier::snark;
+
+// Must match the aggregator_server
+static const size_t batch_size = 1;
+
+using snapshot = libzecale::aggregation_snapshot<npp, nsnark, batch_size>;
+using aggregator_gadget = libzecale::
+    aggregator_gadget<npp, wpp, nsnark, wverifier, batch_size>;
+
+/// Run `f` and print the time it took, in seconds
+template<typename F> static void timed_phase(const std::string &name, F f)
+{
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << name << "\t" << elapsed.count() << std::endl;
+}
+
+#ifdef ZKSNARK_GROTH16
+static wsnark::KeypairT load_keypair(const std::string &keypair_file)
+{
+    std::ifstream in(keypair_file, std::ios_base::in | std::ios_base::binary);
+    in.exceptions(
+        std::ios_base::eofbit | std::ios_base::badbit | std::ios_base::failbit);
+    return wsnark::keypair_read_bytes(in);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "keypair,k", po::value<std::string>(), "file to load keypair from");
+    options.add_options()(
+        "snapshot", po::value<boost::filesystem::path>(), "snapshot file");
+    po::positional_options_description positional;
+    positional.add("snapshot", 1);
+
+    auto usage = [&]() {
+        std::cout << "Usage:\n  " << argv[0] << " [<options>] <snapshot>\n\n"
+                  << options << std::endl;
+    };
+
+    std::string keypair_file;
+    boost::filesystem::path snapshot_file;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv)
+                .options(options)
+                .positional(positional)
+                .run(),
+            vm);
+        if (vm.count("help")) {
+            usage();
+            return 0;
+        }
+        if (vm.count("keypair")) {
+            keypair_file = vm["keypair"].as<std::string>();
+        }
+        if (!vm.count("snapshot")) {
+            throw po::error("snapshot file not specified");
+        }
+        snapshot_file = vm["snapshot"].as<boost::filesystem::path>();
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        usage();
+        return 1;
+    }
+
+    npp::init_public_params();
+    wpp::init_public_params();
+
+    snapshot batch_snapshot;
+    try {
+        std::ifstream in(
+            snapshot_file.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!in.good()) {
+            throw std::runtime_error("cannot open " + snapshot_file.string());
+        }
+        batch_snapshot = snapshot::read(in);
+    } catch (const std::exception &e) {
+        std::cerr << " ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    libzecale::
+        aggregator_circuit_wrapper<npp, wpp, nsnark, wverifier, batch_size>
+            aggregator;
+    const libzecale::circuit_fingerprint fingerprint =
+        libzecale::circuit_fingerprint::from_constraint_system<npp, wpp>(
+            aggregator.get_constraint_system(), batch_size);
+    if (fingerprint != batch_snapshot.fingerprint) {
+        std::cerr << " ERROR: snapshot taken for a different circuit\n"
+                  << "snapshot circuit:\n";
+        batch_snapshot.fingerprint.write_json(std::cerr);
+        std::cerr << "current circuit:\n";
+        fingerprint.write_json(std::cerr);
+        return 1;
+    }
+
+    const typename wsnark::keypair keypair = [&]() {
+        if (!keypair_file.empty()) {
+#ifdef ZKSNARK_GROTH16
+            return load_keypair(keypair_file);
+#else
+            std::cerr << "Keypair loading not supported in this config"
+                      << std::endl;
+            exit(1);
+#endif
+        }
+        return aggregator.generate_trusted_setup();
+    }();
+
+    // Replay the steps of `aggregator_circuit_wrapper::prove()`
+    std::cout << "phase\tseconds" << std::endl;
+    libsnark::protoboard<libff::Fr<wpp>> pb;
+    aggregator_gadget g(pb);
+    timed_phase("constraints", [&]() { g.generate_r1cs_constraints(); });
+
+    libff::bit_vector nested_vk_bits;
+    timed_phase("process_vk", [&]() {
+        nested_vk_bits =
+            aggregator_gadget::get_nested_vk_bits(batch_snapshot.nested_vk);
+    });
+    timed_phase("witness", [&]() {
+        g.generate_r1cs_witness(
+            nested_vk_bits, batch_snapshot.extended_proof_ptrs());
+    });
+
+    // Evaluate the constraints on all the CPUs, to find the first
+    // unsatisfied one
+    libzecale::satisfiability_result satisfiability;
+    timed_phase("is_satisfied", [&]() {
+        satisfiability = libzecale::check_satisfiability(
+            keypair.pk.constraint_system,
+            pb.full_variable_assignment(),
+            std::thread::hardware_concurrency());
+    });
+
+    typename wsnark::proof proof;
+    timed_phase(
+        "prove", [&]() { proof = wsnark::generate_proof(pb, keypair.pk); });
+
+    bool is_verified = false;
+    timed_phase("verify", [&]() {
+        is_verified = wsnark::verify(pb.primary_input(), proof, keypair.vk);
+    });
+
+    std::cout << "satisfied: " << satisfiability.satisfied << "\n";
+    if (!satisfiability.satisfied) {
+        const size_t constraint = satisfiability.first_unsatisfied_constraint;
+        std::cout << "first unsatisfied constraint: " << constraint << " ("
+                  << libzecale::constraint_annotation(pb, constraint) << ")\n";
+    }
+    std::cout << "verified: " << is_verified << std::endl;
+    return (satisfiability.satisfied && is_verified) ? 0 : 1;
+}
@@ -0,0 +1,548 @@
+// Copyright (c) 2015-2020 Clearmatics Technologies Ltd
+//
+// SPDX-License-Identifier: LGPL-3.0+
+
+// Load generator for the aggregator_server. A corpus of valid nested proofs
+// for a small test circuit is generated up-front, the test application is
+// registered, and transactions are then submitted from several client
+// threads (each with its own connection) at a configurable rate, while other
+// threads request aggregate proofs back-to-back. At the end, the tool
+// reports:
+//
+// - the latency percentiles of SubmitTransaction, as seen by the clients
+// - the admission rate (transactions accepted / submitted)
+// - the number of aggregate proofs generated per hour
+// - the end-to-end latency (from the reception of a transaction to the proof
+//   aggregating it), from the metrics of the server over the run
+//
+// The tool must be built with the same configuration (curve and snark) as
+// the server, and is intended to run on the same machine (over loopback).
+
+#include "libzecale/serialization/compact_encoding.hpp"
+#include "zecale_config.h"
+
+#include <algorithm>
+#include <api/aggregator.grpc.pb.h>
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
+#include <grpc/grpc.h>
+#include <grpcpp/channel.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/create_channel.h>
+#include <grpcpp/security/credentials.h>
+#include <iomanip>
+#include <iostream>
+#include <libsnark/gadgetlib1/protoboard.hpp>
+#include <libzeth/core/extended_proof.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace proto = google::protobuf;
+namespace po = boost::program_options;
+
+#if defined(ZECALE_CURVE_MNT6)
+#include "libzecale/circuits/pairing/mnt_pairing_params.hpp"
+using wpp = libff::mnt6_pp;
+#elif defined(ZECALE_CURVE_BW6_761)
+#include "libzecale/circuits/pairing/bw6_761_pairing_params.hpp"
+using wpp = libff::bw6_761_pp;
+#else
+#error "ZECALE_CURVE_* variable not set to supported curve"
+#endif
+
+using npp = libzecale::other_curve<wpp>;
+
+#if defined(ZECALE_SNARK_PGHR13)
+#include <libzeth/snarks/pghr13/pghr13_api_handler.hpp>
+using nsnark = libzeth::pghr13_snark<npp>;
+using napi_handler = libzeth::pghr13_api_handler<npp>;
+#elif defined(ZECALE_SNARK_GROTH16)
+#include <libzeth/snarks/groth16/groth16_api_handler.hpp>
+using nsnark = libzeth::groth16_snark<npp>;
+using napi_handler = libzeth::groth16_api_handler<npp>;
+#else
+#error "ZECALE_SNARK_* variable not set to supported ZK snark"
+#endif
+
+using clock_type = std::chrono::steady_clock;
+
+// Number of primary inputs of the nested proofs expected by the aggregator
+// circuit (see `aggregator_gadget`)
+static const size_t nested_num_inputs = 9;
+
+/// Test circuit with `nested_num_inputs` primary inputs x_i and a single
+/// auxiliary input w, such that x_i = (i + 1) * w. Each value of w gives a
+/// distinct proof.
+static void test_circuit(
+    libsnark::protoboard<libff::Fr<npp>> &pb, const libff::Fr<npp> *w_value)
+{
+    libsnark::pb_variable_array<libff::Fr<npp>> x;
+    x.allocate(pb, nested_num_inputs, "x");
+    libsnark::pb_variable<libff::Fr<npp>> w;
+    w.allocate(pb, "w");
+    pb.set_input_sizes(nested_num_inputs);
+    for (size_t i = 0; i < nested_num_inputs; ++i) {
+        pb.add_r1cs_constraint(
+            libsnark::r1cs_constraint<libff::Fr<npp>>(w, i + 1, x[i]), "x_i");
+    }
+
+    if (w_value) {
+        pb.val(w) = *w_value;
+        for (size_t i = 0; i < nested_num_inputs; ++i) {
+            pb.val(x[i]) = libff::Fr<npp>(i + 1) * *w_value;
+        }
+    }
+}
+
+/// Generate the keypair of the test circuit, and `corpus_size` transactions
+/// (with a fee of 0) for the application `app_name`. If `compact` is set,
+/// the proofs use the compact binary encoding.
+static typename nsnark::keypair generate_corpus(
+    const std::string &app_name,
+    size_t corpus_size,
+    bool compact,
+    std::vector<zecale_proto::TransactionToAggregate> &corpus)
+{
+    libsnark::protoboard<libff::Fr<npp>> setup_pb;
+    test_circuit(setup_pb, nullptr);
+    const typename nsnark::keypair keypair = nsnark::generate_setup(setup_pb);
+
+    for (size_t i = 0; i < corpus_size; ++i) {
+        const libff::Fr<npp> w = libff::Fr<npp>::random_element();
+        libsnark::protoboard<libff::Fr<npp>> pb;
+        test_circuit(pb, &w);
+        const libzeth::extended_proof<npp, nsnark> ext_proof(
+            nsnark::generate_proof(pb, keypair.pk), pb.primary_input());
+
+        zecale_proto::TransactionToAggregate tx;
+        tx.set_application_name(app_name);
+        if (compact) {
+            tx.set_compact_extended_proof(
+                libzecale::extended_proof_to_compact(ext_proof));
+        } else {
+            napi_handler::extended_proof_to_proto(
+                ext_proof, tx.mutable_extended_proof());
+        }
+        corpus.push_back(tx);
+    }
+
+    return keypair;
+}
+
+/// Results of a client thread
+class client_results
+{
+public:
+    std::vector<double> latencies;
+    size_t num_accepted;
+    size_t num_rejected;
+    size_t num_failed;
+
+    client_results() : num_accepted(0), num_rejected(0), num_failed(0) {}
+
+    void merge(const client_results &other)
+    {
+        this->latencies.insert(
+            this->latencies.end(),
+            other.latencies.begin(),
+            other.latencies.end());
+        this->num_accepted += other.num_accepted;
+        this->num_rejected += other.num_rejected;
+        this->num_failed += other.num_failed;
+    }
+};
+
+/// The q-quantile of the (sorted) values, or 0 if there is none.
+static double sorted_quantile(const std::vector<double> &sorted, double q)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t rank = (size_t)std::ceil(q * (double)sorted.size());
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+/// The q-quantile of the observations made between two readings of a
+/// histogram of the server, interpolated linearly within the bucket
+/// containing it (as done by the server for the whole histogram).
+static double histogram_delta_quantile(
+    const zecale_proto::Histogram &before,
+    const zecale_proto::Histogram &after,
+    double q)
+{
+    const uint64_t count = after.count() - before.count();
+    if (count == 0) {
+        return 0.0;
+    }
+
+    auto cumulative_count = [&](int i) {
+        const uint64_t prev =
+            (i < before.buckets_size()) ? before.buckets(i).cumulative_count()
+                                        : 0;
+        return after.buckets(i).cumulative_count() - prev;
+    };
+
+    const double rank = q * (double)count;
+    double lower_bound = 0.0;
+    uint64_t lower_count = 0;
+    for (int i = 0; i < after.buckets_size(); ++i) {
+        const double upper_bound = after.buckets(i).upper_bound();
+        const uint64_t upper_count = cumulative_count(i);
+        if ((double)upper_count >= rank && upper_count > lower_count) {
+            return lower_bound + (upper_bound - lower_bound) *
+                                     (rank - (double)lower_count) /
+                                     (double)(upper_count - lower_count);
+        }
+        lower_bound = upper_bound;
+        lower_count = upper_count;
+    }
+
+    // In the last (unbounded) bucket
+    return lower_bound;
+}
+
+static std::shared_ptr<grpc::Channel> create_channel(const std::string &server)
+{
+    // Do not share the connection with the other threads, so that the
+    // clients are not serialised on a single HTTP/2 connection.
+    grpc::ChannelArguments args;
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+    return grpc::CreateCustomChannel(
+        server, grpc::InsecureChannelCredentials(), args);
+}
+
+/// Submit `num_txs` transactions taken from the corpus (with random fees),
+/// at a rate of `rate` transactions per second (as fast as possible if 0).
+static client_results run_client(
+    const std::string &server,
+    const std::vector<zecale_proto::TransactionToAggregate> &shared_corpus,
+    size_t num_txs,
+    double rate,
+    uint32_t max_fee_wei,
+    size_t seed)
+{
+    std::unique_ptr<zecale_proto::Aggregator::Stub> stub =
+        zecale_proto::Aggregator::NewStub(create_channel(server));
+    // Copy of the corpus, in which the fees are set (so that the messages are
+    // not serialised again for each submission)
+    std::vector<zecale_proto::TransactionToAggregate> corpus(shared_corpus);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> fee_distribution(0, max_fee_wei);
+
+    client_results results;
+    results.latencies.reserve(num_txs);
+    const clock_type::time_point start = clock_type::now();
+    for (size_t i = 0; i < num_txs; ++i) {
+        if (rate > 0.0) {
+            // Open loop: the i-th transaction is sent at `start + i / rate`,
+            // whatever the latency of the previous ones.
+            std::this_thread::sleep_until(
+                start + std::chrono::duration_cast<clock_type::duration>(
+                            std::chrono::duration<double>((double)i / rate)));
+        }
+
+        zecale_proto::TransactionToAggregate &tx = corpus[i % corpus.size()];
+        tx.set_fee_in_wei((int32_t)fee_distribution(rng));
+        grpc::ClientContext context;
+        zecale_proto::SubmittedTransaction response;
+        const clock_type::time_point sent = clock_type::now();
+        const grpc::Status status =
+            stub->SubmitTransaction(&context, tx, &response);
+        results.latencies.push_back(
+            std::chrono::duration<double>(clock_type::now() - sent).count());
+
+        if (status.ok()) {
+            ++results.num_accepted;
+        } else if (status.error_code() == grpc::RESOURCE_EXHAUSTED) {
+            ++results.num_rejected;
+        } else {
+            ++results.num_failed;
+            if (results.num_failed == 1) {
+                std::cerr << "SubmitTransaction: " << status.error_message()
+                          << std::endl;
+            }
+        }
+    }
+
+    return results;
+}
+
+/// Request aggregate proofs for `app_name` back-to-back until `stop` is set.
+static client_results run_prover_client(
+    const std::string &server,
+    const std::string &app_name,
+    const std::atomic<bool> &stop)
+{
+    std::unique_ptr<zecale_proto::Aggregator::Stub> stub =
+        zecale_proto::Aggregator::NewStub(create_channel(server));
+    zecale_proto::ApplicationName request;
+    request.set_name(app_name);
+
+    client_results results;
+    while (!stop) {
+        grpc::ClientContext context;
+        zeth_proto::ExtendedProof response;
+        const clock_type::time_point sent = clock_type::now();
+        const grpc::Status status =
+            stub->GenerateAggregateProof(&context, request, &response);
+        if (status.ok()) {
+            results.latencies.push_back(
+                std::chrono::duration<double>(clock_type::now() - sent)
+                    .count());
+            ++results.num_accepted;
+        } else {
+            ++results.num_failed;
+            // Typically, the pool is empty: do not spin on the server.
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    return results;
+}
+
+static void print_latencies(const std::string &name, std::vector<double> &v)
+{
+    std::sort(v.begin(), v.end());
+    std::cout << name << "_p50_ms\t" << 1000.0 * sorted_quantile(v, 0.5)
+              << "\n"
+              << name << "_p90_ms\t" << 1000.0 * sorted_quantile(v, 0.9)
+              << "\n"
+              << name << "_p99_ms\t" << 1000.0 * sorted_quantile(v, 0.99)
+              << "\n"
+              << name << "_max_ms\t" << 1000.0 * sorted_quantile(v, 1.0)
+              << "\n";
+}
+
+int main(int argc, char **argv)
+{
+    po::options_description options("");
+    options.add_options()("help,h", "display this help message");
+    options.add_options()(
+        "server,s",
+        po::value<std::string>(),
+        "address of the aggregator server (default: localhost:50052)");
+    options.add_options()(
+        "app,a",
+        po::value<std::string>(),
+        "name of the test application to register (default: loadgen)");
+    options.add_options()(
+        "corpus-size,n",
+        po::value<size_t>(),
+        "number of distinct nested proofs to generate (default: 64)");
+    options.add_options()(
+        "transactions,t",
+        po::value<size_t>(),
+        "total number of transactions to submit (default: 10000)");
+    options.add_options()(
+        "concurrency,c",
+        po::value<size_t>(),
+        "number of client threads submitting transactions (default: 8)");
+    options.add_options()(
+        "rate,r",
+        po::value<double>(),
+        "total submission rate, in transactions per second (default: 0, as "
+        "fast as possible)");
+    options.add_options()(
+        "max-fee",
+        po::value<uint32_t>(),
+        "fees are drawn uniformly in [0, max-fee] (default: 1000)");
+    options.add_options()(
+        "provers,p",
+        po::value<size_t>(),
+        "number of client threads requesting aggregate proofs, while the "
+        "transactions are submitted (default: 1)");
+    options.add_options()(
+        "compact",
+        "submit the proofs (and verification key) in the compact binary "
+        "encoding");
+
+    auto usage = [&]() {
+        std::cout << "Usage:\n  " << argv[0] << " [<options>]\n\n"
+                  << options << std::endl;
+    };
+
+    std::string server = "localhost:50052";
+    std::string app_name = "loadgen";
+    size_t corpus_size = 64;
+    size_t num_txs = 10000;
+    size_t concurrency = 8;
+    double rate = 0.0;
+    uint32_t max_fee_wei = 1000;
+    size_t num_provers = 1;
+    bool compact = false;
+    try {
+        po::variables_map vm;
+        po::store(
+            po::command_line_parser(argc, argv).options(options).run(), vm);
+        if (vm.count("help")) {
+            usage();
+            return 0;
+        }
+        if (vm.count("server")) {
+            server = vm["server"].as<std::string>();
+        }
+        if (vm.count("app")) {
+            app_name = vm["app"].as<std::string>();
+        }
+        if (vm.count("corpus-size")) {
+            corpus_size = vm["corpus-size"].as<size_t>();
+        }
+        if (vm.count("transactions")) {
+            num_txs = vm["transactions"].as<size_t>();
+        }
+        if (vm.count("concurrency")) {
+            concurrency = vm["concurrency"].as<size_t>();
+        }
+        if (vm.count("rate")) {
+            rate = vm["rate"].as<double>();
+        }
+        if (vm.count("max-fee")) {
+            max_fee_wei = vm["max-fee"].as<uint32_t>();
+        }
+        if (vm.count("provers")) {
+            num_provers = vm["provers"].as<size_t>();
+        }
+        compact = vm.count("compact") != 0;
+        if (corpus_size == 0 || concurrency == 0) {
+            throw po::error("corpus size and concurrency must be positive");
+        }
+        if (max_fee_wei > (uint32_t)INT32_MAX) {
+            throw po::error("max fee too large");
+        }
+    } catch (po::error &error) {
+        std::cerr << " ERROR: " << error.what() << std::endl;
+        usage();
+        return 1;
+    }
+
+    npp::init_public_params();
+
+    std::cerr << "Generating a corpus of " << corpus_size << " proofs..."
+              << std::endl;
+    std::vector<zecale_proto::TransactionToAggregate> corpus;
+    const typename nsnark::keypair keypair =
+        generate_corpus(app_name, corpus_size, compact, corpus);
+
+    std::unique_ptr<zecale_proto::Aggregator::Stub> stub =
+        zecale_proto::Aggregator::NewStub(create_channel(server));
+    {
+        zecale_proto::ApplicationRegistration registration;
+        registration.set_name(app_name);
+        if (compact) {
+            registration.set_compact_vk(
+                libzecale::verification_key_to_compact<nsnark>(keypair.vk));
+        } else {
+            napi_handler::verification_key_to_proto(
+                keypair.vk, registration.mutable_vk());
+        }
+        grpc::ClientContext context;
+        proto::Empty response;
+        const grpc::Status status =
+            stub->RegisterApplication(&context, registration, &response);
+        if (!status.ok()) {
+            std::cerr << " ERROR: RegisterApplication: "
+                      << status.error_message() << std::endl;
+            return 1;
+        }
+    }
+
+    zecale_proto::Metrics metrics_before;
+    {
+        grpc::ClientContext context;
+        stub->GetMetrics(&context, proto::Empty(), &metrics_before);
+    }
+
+    std::cerr << "Submitting " << num_txs << " transactions from "
+              << concurrency << " client(s)..." << std::endl;
+    std::vector<client_results> results(concurrency);
+    std::vector<client_results> prover_results(num_provers);
+    std::atomic<bool> stop_provers(false);
+    std::vector<std::thread> provers;
+    const clock_type::time_point start = clock_type::now();
+    for (size_t i = 0; i < num_provers; ++i) {
+        provers.emplace_back([&, i]() {
+            prover_results[i] =
+                run_prover_client(server, app_name, stop_provers);
+        });
+    }
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < concurrency; ++i) {
+        // Distribute the transactions and the rate over the clients
+        const size_t client_num_txs =
+            num_txs / concurrency + ((i < num_txs % concurrency) ? 1 : 0);
+        clients.emplace_back([&, i, client_num_txs]() {
+            results[i] = run_client(
+                server,
+                corpus,
+                client_num_txs,
+                rate / (double)concurrency,
+                max_fee_wei,
+                i);
+        });
+    }
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    const double submission_seconds =
+        std::chrono::duration<double>(clock_type::now() - start).count();
+    stop_provers = true;
+    for (std::thread &prover : provers) {
+        prover.join();
+    }
+    const double total_seconds =
+        std::chrono::duration<double>(clock_type::now() - start).count();
+
+    zecale_proto::Metrics metrics_after;
+    {
+        grpc::ClientContext context;
+        stub->GetMetrics(&context, proto::Empty(), &metrics_after);
+    }
+
+    client_results submissions;
+    for (const client_results &r : results) {
+        submissions.merge(r);
+    }
+    client_results proofs;
+    for (const client_results &r : prover_results) {
+        proofs.merge(r);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "submitted\t" << num_txs << "\n"
+              << "accepted\t" << submissions.num_accepted << "\n"
+              << "rejected\t" << submissions.num_rejected << "\n"
+              << "failed\t" << submissions.num_failed << "\n"
+              << "admission_rate\t"
+              << (num_txs ? (double)submissions.num_accepted / num_txs : 0.0)
+              << "\n"
+              << "submission_seconds\t" << submission_seconds << "\n"
+              << "submissions_per_second\t"
+              << (double)num_txs / submission_seconds << "\n";
+    print_latencies("ingest_latency", submissions.latencies);
+
+    std::cout << "batches\t" << proofs.num_accepted << "\n"
+              << "batches_per_hour\t"
+              << 3600.0 * (double)proofs.num_accepted / total_seconds << "\n";
+    print_latencies("proof_request_latency", proofs.latencies);
+
+    const zecale_proto::Histogram &e2e_before =
+        metrics_before.end_to_end_seconds();
+    const zecale_proto::Histogram &e2e_after =
+        metrics_after.end_to_end_seconds();
+    std::cout << "end_to_end_count\t"
+              << (e2e_after.count() - e2e_before.count()) << "\n"
+              << "end_to_end_p50_s\t"
+              << histogram_delta_quantile(e2e_before, e2e_after, 0.5) << "\n"
+              << "end_to_end_p90_s\t"
+              << histogram_delta_quantile(e2e_before, e2e_after, 0.9) << "\n"
+              << "end_to_end_p99_s\t"
+              << histogram_delta_quantile(e2e_before, e2e_after, 0.99)
+              << std::endl;
+
+    return (submissions.num_failed == 0) ? 0 : 1;
+}